@@ -439,7 +439,7 @@ class CPPCLASS {
             },
 
             fmadd: () => {
-                if (this.suffix == 'ps') {
+                if (this.suffix == 'ps' || this.suffix == 'pd') {
                     let entry = `${this.funcType}_fmadd_${this.suffix}`;
                     if (hasEntry(entry)) {
                         let ret = getParamsList(`const ${this.name} &`, 2);
@@ -464,6 +464,10 @@ class CPPCLASS {
             round: () => {
                 if (this.suffix == 'ps' || this.suffix == 'pd') {
                     let entry = `${this.funcType}_round_${this.suffix}`;
+                    if (!hasEntry(entry)) {
+                        // AVX-512 spells round as roundscale, which is the same operation with a zero scale
+                        entry = `${this.funcType}_roundscale_${this.suffix}`;
+                    }
                     if (hasEntry(entry)) {
                         let f = new CPPFunction('round', `template <int rounding>\n    ${this.name}`, [], ['const', 'noexcept']);
                         f.S(`return ${entry}(v, rounding)`);
@@ -501,6 +505,37 @@ class CPPCLASS {
                     }
                 }
             },
+
+            popcnt: () => {
+                let entry = this.getEntry('popcnt');
+                if (hasEntry(entry)) {
+                    let f = new CPPFunction('popcnt', `${this.name}`, [], ['const', 'noexcept']);
+                    f.S(`return ${entry}(v)`);
+                    return f;
+                }
+            },
+
+            lzcnt: () => {
+                let entry = this.getEntry('lzcnt');
+                if (hasEntry(entry)) {
+                    let f = new CPPFunction('lzcnt', `${this.name}`, [], ['const', 'noexcept']);
+                    f.S(`return ${entry}(v)`);
+                    return f;
+                }
+            },
+
+            tzcnt: () => {
+                // the mask below the lowest set bit has exactly tzcnt bits, so tzcnt = width - lzcnt(mask)
+                let entry = this.getEntry('lzcnt');
+                if (hasEntry(entry)) {
+                    let set1   = this.getSetEntry('set1');
+                    let sub    = this.getEntry('sub');
+                    let andnot = `${this.funcType}_andnot_si${BytesMap[this.mmType] * 8}`;
+                    let f = new CPPFunction('tzcnt', `${this.name}`, [], ['const', 'noexcept']);
+                    f.S(`return ${sub}(${set1}(${BytesMap[this.cType] * 8}), ${entry}(${andnot}(v, ${sub}(v, ${set1}(1)))))`);
+                    return f;
+                }
+            },
         };
 
         let str = `struct ${this.name}\n{\n`;
@@ -562,7 +597,7 @@ function genMin(klass) {
 class CPPFile {
     constructor(name) {
         this.name = name;
-        this.body = `${license}\n`;
+        this.body = `${license}\n#pragma once\n\n`;
     }
 
     Include(file, property) {
@@ -668,11 +703,11 @@ for (let c in classes)  {
 concept.constraint(conditions, 'or');
 
 let statics = [
-    { func:  genPow, limit: (klass) => { return klass.cType == 'float'; } },
-    { func:  genSin, limit: (klass) => { return klass.cType == 'float'; } },
-    { func:  genCos, limit: (klass) => { return klass.cType == 'float'; } },
-    { func: genASin, limit: (klass) => { return klass.cType == 'float'; } },
-    { func: genACos, limit: (klass) => { return klass.cType == 'float'; } },
+    { func:  genPow, limit: (klass) => { return klass.cType == 'float' || klass.cType == 'double'; } },
+    { func:  genSin, limit: (klass) => { return klass.cType == 'float' || klass.cType == 'double'; } },
+    { func:  genCos, limit: (klass) => { return klass.cType == 'float' || klass.cType == 'double'; } },
+    { func: genASin, limit: (klass) => { return klass.cType == 'float' || klass.cType == 'double'; } },
+    { func: genACos, limit: (klass) => { return klass.cType == 'float' || klass.cType == 'double'; } },
     { func:  genMin, limit: (klass) => { return true; } },
     { func:  genMax, limit: (klass) => { return true; } },
 ];
@@ -0,0 +1,642 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+#if defined(__AVX512F__)
+using AudioFloat = FLOATX16;
+#else
+using AudioFloat = FLOATX8;
+#endif
+
+static constexpr size_t AUDIO_LANES = sizeof(AudioFloat) / sizeof(float);
+
+static inline __m256 clampLanes(__m256 v, float lo, float hi) noexcept
+{
+    return _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(lo)), _mm256_set1_ps(hi));
+}
+
+/* The scalar clampLanes: maxps returns its second operand for NaN, so NaN clamps to lo on both paths */
+static inline float clampLane(float x, float lo, float hi) noexcept
+{
+    return x == x ? std::min(std::max(x, lo), hi) : lo;
+}
+
+static inline float sumLanes(__m256 v) noexcept
+{
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_add_ss(x, _mm_movehdup_ps(x)));
+}
+
+#if defined(__AVX512F__)
+static inline __m512 clampLanes(__m512 v, float lo, float hi) noexcept
+{
+    return _mm512_min_ps(_mm512_max_ps(v, _mm512_set1_ps(lo)), _mm512_set1_ps(hi));
+}
+
+static inline float sumLanes(__m512 v) noexcept
+{
+    return _mm512_reduce_add_ps(v);
+}
+#endif
+
+/**
+ * y[o] = taps[0] * x[o] + taps[1] * x[o - stride] + ... for o < count.
+ * With stride equal to the channel count this filters every channel of an
+ * interleaved buffer at once, since the outputs stay contiguous in o.
+ */
+static inline void firRun(const float *x, ptrdiff_t stride, const float *taps, size_t length, float *y, size_t count) noexcept
+{
+    using V = AudioFloat;
+    constexpr size_t L = AUDIO_LANES;
+
+    size_t o = 0;
+    for (; o + 4 * L <= count; o += 4 * L) {
+        V a0(0.0f), a1(0.0f), a2(0.0f), a3(0.0f);
+        const float *p = x + o;
+        for (size_t k = 0; k < length; k++, p -= stride) {
+            V h(taps[k]);
+            V x0, x1, x2, x3;
+            x0.loadu(p);
+            x1.loadu(p + L);
+            x2.loadu(p + 2 * L);
+            x3.loadu(p + 3 * L);
+            a0 = h.fmadd(x0, a0);
+            a1 = h.fmadd(x1, a1);
+            a2 = h.fmadd(x2, a2);
+            a3 = h.fmadd(x3, a3);
+        }
+        a0.storeu(y + o);
+        a1.storeu(y + o + L);
+        a2.storeu(y + o + 2 * L);
+        a3.storeu(y + o + 3 * L);
+    }
+    for (; o + L <= count; o += L) {
+        V            a(0.0f);
+        const float *p = x + o;
+        for (size_t k = 0; k < length; k++, p -= stride) {
+            V xk;
+            xk.loadu(p);
+            a = V(taps[k]).fmadd(xk, a);
+        }
+        a.storeu(y + o);
+    }
+    for (; o < count; o++) {
+        float a = 0;
+        for (size_t k = 0; k < length; k++) {
+            a += taps[k] * x[static_cast<ptrdiff_t>(o) - static_cast<ptrdiff_t>(k) * stride];
+        }
+        y[o] = a;
+    }
+}
+
+/* One output of a planar channel: the dot product of the last length samples up to x[0] with the reversed taps */
+static inline float firDot(const float *x, const float *reversed, size_t length) noexcept
+{
+    using V = AudioFloat;
+    constexpr size_t L = AUDIO_LANES;
+
+    const float *p = x + 1 - static_cast<ptrdiff_t>(length);
+    V            a0(0.0f), a1(0.0f);
+    size_t       k = 0;
+    for (; k + 2 * L <= length; k += 2 * L) {
+        V x0, x1, h0, h1;
+        x0.loadu(p + k);
+        x1.loadu(p + k + L);
+        h0.loadu(reversed + k);
+        h1.loadu(reversed + k + L);
+        a0 = h0.fmadd(x0, a0);
+        a1 = h1.fmadd(x1, a1);
+    }
+    float sum = sumLanes(a0 + a1);
+    for (; k < length; k++) {
+        sum += reversed[k] * p[k];
+    }
+    return sum;
+}
+
+/* Direct form II transposed; c holds b0, b1, b2, -a1, -a2 and z holds z1, z2, each pitch floats apart */
+static inline float biquadStep(float x, const float *c, size_t pitch, float *z) noexcept
+{
+    float y  = c[0] * x + z[0];
+    z[0]     = c[pitch] * x + c[3 * pitch] * y + z[pitch];
+    z[pitch] = c[2 * pitch] * x + c[4 * pitch] * y;
+    return y;
+}
+
+/* One direct form II transposed section across the lanes of V, held in registers */
+template <class V>
+struct BiquadSection
+{
+    V b0, b1, b2, na1, na2, z1, z2;
+
+    BiquadSection(const float *c, size_t pitch, const float *z) noexcept
+    {
+        b0.loadu(c);
+        b1.loadu(c + pitch);
+        b2.loadu(c + 2 * pitch);
+        na1.loadu(c + 3 * pitch);
+        na2.loadu(c + 4 * pitch);
+        z1.loadu(z);
+        z2.loadu(z + pitch);
+    }
+
+    V operator()(V x) noexcept
+    {
+        V y = b0.fmadd(x, z1);
+        z1  = na1.fmadd(y, b1.fmadd(x, z2));
+        z2  = na2.fmadd(y, b2 * x);
+        return y;
+    }
+
+    void save(float *z, size_t pitch) noexcept
+    {
+        z1.storeu(z);
+        z2.storeu(z + pitch);
+    }
+};
+
+template <class V>
+static inline V biquadLanes(V x, const float *c, size_t pitch, float *z) noexcept
+{
+    BiquadSection<V> section(c, pitch, z);
+    V y = section(x);
+    section.save(z, pitch);
+    return y;
+}
+
+static inline void transpose8x8(__m256 r[8]) noexcept
+{
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+} // namespace slimm::detail
+
+/**
+ * Multichannel FIR filter with polyphase resampling by up / down.
+ *
+ * Output frame n is computed from input frame n * down / up with the
+ * sub-filter taps[p], taps[p + up], ... where p = n * down % up, so zero
+ * stuffing and discarded outputs never cost a multiply. With up = down = 1
+ * it is a plain FIR filter. Interpolating filters usually need a gain of
+ * up folded into their taps. The last input frames are kept between calls,
+ * so a stream can be processed in blocks of any size. At least one tap is
+ * required, and src and dst must not overlap.
+ */
+class FirFilter
+{
+public:
+    FirFilter(const float *taps, size_t count, size_t channels, size_t up = 1, size_t down = 1) :
+        channels{ channels }, up{ up }, down{ down }, length{ (count + up - 1) / up }
+    {
+        phases.assign(up * length, 0.0f);
+        reversed.assign(up * length, 0.0f);
+        for (size_t k = 0; k < count; k++) {
+            phases[(k % up) * length + k / up] = taps[k];
+        }
+        for (size_t p = 0; p < up; p++) {
+            std::reverse_copy(&phases[p * length], &phases[p * length] + length, &reversed[p * length]);
+        }
+        line.assign(2 * (length - 1) * channels, 0.0f);
+    }
+
+    /**
+     * @brief Frames the next process call writes for the given input frames
+     */
+    size_t outputFrames(size_t frames) const noexcept
+    {
+        return next < frames * up ? (frames * up - next + down - 1) / down : 0;
+    }
+
+    void reset() noexcept
+    {
+        std::fill(line.begin(), line.end(), 0.0f);
+        next = 0;
+    }
+
+    /**
+     * @brief Filters frames of interleaved samples; returns the output frames written
+     */
+    size_t processInterleaved(const float *src, float *dst, size_t frames) noexcept
+    {
+        const size_t    H      = length - 1;
+        const size_t    head   = std::min(frames, H);
+        const ptrdiff_t stride = static_cast<ptrdiff_t>(channels);
+        std::copy(src, src + head * channels, line.data() + H * channels);
+
+        size_t n = outputFrames(frames);
+        if (up == 1 && down == 1) {
+            slimm::detail::firRun(line.data() + H * channels, stride, phases.data(), length, dst, head * channels);
+            if (frames > H) {
+                slimm::detail::firRun(src + H * channels, stride, phases.data(), length, dst + H * channels, (frames - H) * channels);
+            }
+        } else {
+            size_t pos = next;
+            for (size_t i = 0; i < n; i++, pos += down) {
+                size_t       t = pos / up;
+                const float *x = t < H ? line.data() + (H + t) * channels : src + t * channels;
+                slimm::detail::firRun(x, stride, &phases[(pos % up) * length], length, dst + i * channels, channels);
+            }
+        }
+        next = next + n * down - frames * up;
+
+        if (frames >= H) {
+            std::copy(src + (frames - H) * channels, src + frames * channels, line.data());
+        } else {
+            std::copy(line.data() + frames * channels, line.data() + (frames + H) * channels, line.data());
+        }
+        return n;
+    }
+
+    /**
+     * @brief Filters frames of planar samples, one pointer per channel; returns the output frames written
+     */
+    size_t processPlanar(const float *const *src, float *const *dst, size_t frames) noexcept
+    {
+        const size_t H    = length - 1;
+        const size_t head = std::min(frames, H);
+        const size_t end  = frames * up;
+        size_t       n    = outputFrames(frames);
+        for (size_t c = 0; c < channels; c++) {
+            float *hist = line.data() + c * 2 * H;
+            std::copy(src[c], src[c] + head, hist + H);
+
+            if (up == 1 && down == 1) {
+                slimm::detail::firRun(hist + H, 1, phases.data(), length, dst[c], head);
+                if (frames > H) {
+                    slimm::detail::firRun(src[c] + H, 1, phases.data(), length, dst[c] + H, frames - H);
+                }
+            } else {
+                size_t pos = next;
+                for (size_t i = 0; i < n; i++, pos += down) {
+                    size_t       t = pos / up;
+                    const float *x = t < H ? hist + H + t : src[c] + t;
+                    dst[c][i] = slimm::detail::firDot(x, &reversed[(pos % up) * length], length);
+                }
+            }
+
+            if (frames >= H) {
+                std::copy(src[c] + frames - H, src[c] + frames, hist);
+            } else {
+                std::copy(hist + frames, hist + frames + H, hist);
+            }
+        }
+        next = next + n * down - end;
+        return n;
+    }
+
+private:
+    size_t             channels;
+    size_t             up;
+    size_t             down;
+    size_t             length;
+    std::vector<float> phases;
+    std::vector<float> reversed;
+    std::vector<float> line;
+    size_t             next = 0;
+};
+
+/**
+ * Cascade of biquad sections per channel, vectorized across channels.
+ *
+ * Each section is a direct form II transposed biquad with a0 normalized
+ * to 1. Interleaved frames are filtered a register of channels at a time
+ * straight from the buffer; planar channels are filtered in groups of 8,
+ * transposing 8 x 8 tiles in registers so that every lane is a channel.
+ */
+class BiquadCascade
+{
+public:
+    struct Coefficients
+    {
+        float b0 = 1;
+        float b1 = 0;
+        float b2 = 0;
+        float a1 = 0;
+        float a2 = 0;
+    };
+
+    BiquadCascade(size_t channels, size_t stages) :
+        channels{ channels }, stages{ stages }, pitch{ (channels + slimm::detail::AUDIO_LANES - 1) / slimm::detail::AUDIO_LANES * slimm::detail::AUDIO_LANES }
+    {
+        coefficients.assign(stages * 5 * pitch, 0.0f);
+        state.assign(stages * 2 * pitch, 0.0f);
+        for (size_t s = 0; s < stages; s++) {
+            setCoefficients(s, Coefficients{});
+        }
+    }
+
+    /**
+     * @brief Sets section stage of every channel
+     */
+    void setCoefficients(size_t stage, const Coefficients &c) noexcept
+    {
+        for (size_t ch = 0; ch < channels; ch++) {
+            setCoefficients(stage, ch, c);
+        }
+    }
+
+    void setCoefficients(size_t stage, size_t channel, const Coefficients &c) noexcept
+    {
+        float *k = &coefficients[stage * 5 * pitch + channel];
+        k[0]         = c.b0;
+        k[pitch]     = c.b1;
+        k[2 * pitch] = c.b2;
+        k[3 * pitch] = -c.a1;
+        k[4 * pitch] = -c.a2;
+    }
+
+    void reset() noexcept
+    {
+        std::fill(state.begin(), state.end(), 0.0f);
+    }
+
+    /**
+     * @brief Filters frames of interleaved samples; src and dst may be the same buffer
+     */
+    void processInterleaved(const float *src, float *dst, size_t frames) noexcept
+    {
+        using V = slimm::detail::AudioFloat;
+        constexpr size_t L = slimm::detail::AUDIO_LANES;
+
+        const size_t full = channels / L * L;
+        for (size_t t = 0; t < frames; t++) {
+            const float *x = src + t * channels;
+            float       *y = dst + t * channels;
+            for (size_t c = 0; c < full; c += L) {
+                V v;
+                v.loadu(x + c);
+                v = cascade(v, c);
+                v.storeu(y + c);
+            }
+            if (full < channels) {
+                alignas(64) float tail[L] = {};
+                std::copy(x + full, x + channels, tail);
+                V v;
+                v.loadu(tail);
+                cascade(v, full).storeu(tail);
+                std::copy(tail, tail + channels - full, y + full);
+            }
+        }
+    }
+
+    /**
+     * @brief Filters frames of planar samples, one pointer per channel; src and dst may be the same buffers
+     */
+    void processPlanar(const float *const *src, float *const *dst, size_t frames) noexcept
+    {
+        const size_t end = frames - frames % 8;
+        for (size_t c = 0; c < channels; c += 8) {
+            size_t group = std::min<size_t>(8, channels - c);
+            for (size_t t = 0; t < end; t += 8) {
+                __m256 tile[8];
+                for (size_t i = 0; i < 8; i++) {
+                    tile[i] = i < group ? _mm256_loadu_ps(src[c + i] + t) : _mm256_setzero_ps();
+                }
+                slimm::detail::transpose8x8(tile);
+                for (size_t s = 0; s < stages; s++) {
+                    float *z = &state[s * 2 * pitch + c];
+                    slimm::detail::BiquadSection<FLOATX8> section(&coefficients[s * 5 * pitch + c], pitch, z);
+                    for (size_t i = 0; i < 8; i++) {
+                        tile[i] = section(FLOATX8(tile[i]));
+                    }
+                    section.save(z, pitch);
+                }
+                slimm::detail::transpose8x8(tile);
+                for (size_t i = 0; i < group; i++) {
+                    _mm256_storeu_ps(dst[c + i] + t, tile[i]);
+                }
+            }
+        }
+        for (size_t t = end; t < frames; t++) {
+            for (size_t c = 0; c < channels; c++) {
+                float v = src[c][t];
+                for (size_t s = 0; s < stages; s++) {
+                    v = slimm::detail::biquadStep(v, &coefficients[s * 5 * pitch + c], pitch, &state[s * 2 * pitch + c]);
+                }
+                dst[c][t] = v;
+            }
+        }
+    }
+
+private:
+    slimm::detail::AudioFloat cascade(slimm::detail::AudioFloat v, size_t c) noexcept
+    {
+        for (size_t s = 0; s < stages; s++) {
+            v = slimm::detail::biquadLanes(v, &coefficients[s * 5 * pitch + c], pitch, &state[s * 2 * pitch + c]);
+        }
+        return v;
+    }
+
+    size_t             channels;
+    size_t             stages;
+    size_t             pitch;
+    std::vector<float> coefficients;
+    std::vector<float> state;
+};
+
+/**
+ * @brief dst[i] = src[i] * gain, saturated to [-1, 1]; src and dst may be the same array
+ */
+static inline void applyGain(const float *src, float *dst, size_t n, float gain) noexcept
+{
+    using V = slimm::detail::AudioFloat;
+    constexpr size_t L = slimm::detail::AUDIO_LANES;
+
+    V      g(gain);
+    size_t i = 0;
+    for (; i + L <= n; i += L) {
+        V x;
+        x.loadu(src + i);
+        V(slimm::detail::clampLanes(x * g, -1.0f, 1.0f)).storeu(dst + i);
+    }
+    for (; i < n; i++) {
+        dst[i] = slimm::detail::clampLane(src[i] * gain, -1.0f, 1.0f);
+    }
+}
+
+/**
+ * @brief Interleaved frames times a gain per channel, saturated to [-1, 1]; src and dst may be the same array
+ */
+static inline void applyGain(const float *src, float *dst, size_t frames, size_t channels, const float *gains)
+{
+    using V = slimm::detail::AudioFloat;
+    constexpr size_t L = slimm::detail::AUDIO_LANES;
+
+    /* The gains of the register at sample i start at pattern[i % channels] */
+    std::vector<float> pattern(channels + L);
+    for (size_t j = 0; j < pattern.size(); j++) {
+        pattern[j] = gains[j % channels];
+    }
+
+    size_t n     = frames * channels;
+    size_t i     = 0;
+    size_t phase = 0;
+    for (; i + L <= n; i += L, phase = (phase + L) % channels) {
+        V x, g;
+        x.loadu(src + i);
+        g.loadu(pattern.data() + phase);
+        V(slimm::detail::clampLanes(x * g, -1.0f, 1.0f)).storeu(dst + i);
+    }
+    for (; i < n; i++) {
+        dst[i] = slimm::detail::clampLane(src[i] * gains[i % channels], -1.0f, 1.0f);
+    }
+}
+
+/**
+ * @brief dst[i] = sum of sources[s][i] * gains[s], saturated to [-1, 1]
+ *
+ * Works on interleaved buffers with matching layouts as well as on one
+ * planar channel at a time. dst may be one of the sources.
+ */
+static inline void mix(const float *const *sources, const float *gains, size_t count, float *dst, size_t n) noexcept
+{
+    using V = slimm::detail::AudioFloat;
+    constexpr size_t L = slimm::detail::AUDIO_LANES;
+
+    const size_t end = n - n % (2 * L);
+    for (size_t i = 0; i < end; i += 2 * L) {
+        V a0(0.0f), a1(0.0f);
+        for (size_t s = 0; s < count; s++) {
+            V g(gains[s]), x0, x1;
+            x0.loadu(sources[s] + i);
+            x1.loadu(sources[s] + i + L);
+            a0 = g.fmadd(x0, a0);
+            a1 = g.fmadd(x1, a1);
+        }
+        V(slimm::detail::clampLanes(a0, -1.0f, 1.0f)).storeu(dst + i);
+        V(slimm::detail::clampLanes(a1, -1.0f, 1.0f)).storeu(dst + i + L);
+    }
+    for (size_t i = end; i < n; i++) {
+        float a = 0;
+        for (size_t s = 0; s < count; s++) {
+            a += sources[s][i] * gains[s];
+        }
+        dst[i] = slimm::detail::clampLane(a, -1.0f, 1.0f);
+    }
+}
+
+/**
+ * @brief int16 samples to floats in [-1, 1)
+ */
+static inline void int16ToFloat(const int16_t *src, float *dst, size_t n) noexcept
+{
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768);
+
+    const size_t end = n - n % 16;
+    for (size_t i = 0; i < end; i += 16) {
+        INT16X16 x(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)));
+        __m256   lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(x)));
+        __m256   hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(lo, scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, scale));
+    }
+    for (size_t i = end; i < n; i++) {
+        dst[i] = src[i] * (1.0f / 32768);
+    }
+}
+
+/**
+ * @brief Floats to int16 samples, rounded to nearest and saturated; NaN saturates to -32768
+ */
+static inline void floatToInt16(const float *src, int16_t *dst, size_t n) noexcept
+{
+    constexpr float MAX = 32767.0f / 32768;
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 lo = slimm::detail::clampLanes(_mm256_loadu_ps(src + i), -1.0f, MAX);
+        __m256 hi = slimm::detail::clampLanes(_mm256_loadu_ps(src + i + 8), -1.0f, MAX);
+        __m256i a = _mm256_cvtps_epi32(_mm256_mul_ps(lo, _mm256_set1_ps(32768)));
+        __m256i b = _mm256_cvtps_epi32(_mm256_mul_ps(hi, _mm256_set1_ps(32768)));
+        INT16X16 x(_mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), x);
+    }
+    for (; i < n; i++) {
+        dst[i] = static_cast<int16_t>(_mm_cvtss_si32(_mm_set_ss(slimm::detail::clampLane(src[i], -1.0f, MAX) * 32768)));
+    }
+}
+
+/**
+ * @brief Packed little-endian 24-bit samples to floats in [-1, 1)
+ *
+ * Each sample lands in the top three bytes of a 32-bit lane, so the sign
+ * comes for free and the scale is 2^-31.
+ */
+static inline void int24ToFloat(const uint8_t *src, float *dst, size_t n) noexcept
+{
+    const __m256i spread = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    const __m256  scale  = _mm256_set1_ps(1.0f / 2147483648.0f);
+
+    size_t i = 0;
+    for (; i + 10 <= n; i += 8) {
+        __m256i x = _mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(src + 3 * i + 12), reinterpret_cast<const __m128i *>(src + 3 * i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_shuffle_epi8(x, spread)), scale));
+    }
+    for (; i < n; i++) {
+        int32_t x = static_cast<int32_t>(static_cast<uint32_t>(src[3 * i]) << 8 | static_cast<uint32_t>(src[3 * i + 1]) << 16 | static_cast<uint32_t>(src[3 * i + 2]) << 24);
+        dst[i] = static_cast<float>(x) * (1.0f / 2147483648.0f);
+    }
+}
+
+/**
+ * @brief Floats to packed little-endian 24-bit samples, rounded to nearest and saturated; NaN saturates to -8388608
+ */
+static inline void floatToInt24(const float *src, uint8_t *dst, size_t n) noexcept
+{
+    constexpr float MAX = 8388607.0f / 8388608;
+
+    const __m256i pack  = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                           0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    const __m256i store = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256  x = slimm::detail::clampLanes(_mm256_loadu_ps(src + i), -1.0f, MAX);
+        __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(8388608)));
+        v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, pack), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_maskstore_epi32(reinterpret_cast<int *>(dst + 3 * i), store, v);
+    }
+    for (; i < n; i++) {
+        int32_t x = _mm_cvtss_si32(_mm_set_ss(slimm::detail::clampLane(src[i], -1.0f, MAX) * 8388608));
+        dst[3 * i]     = static_cast<uint8_t>(x);
+        dst[3 * i + 1] = static_cast<uint8_t>(x >> 8);
+        dst[3 * i + 2] = static_cast<uint8_t>(x >> 16);
+    }
+}
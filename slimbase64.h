@@ -0,0 +1,422 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "slimmintrin.h"
+
+enum class Base64Alphabet
+{
+    Standard, /* RFC 4648 section 4: A-Z a-z 0-9 + / */
+    Url,      /* RFC 4648 section 5: A-Z a-z 0-9 - _ */
+};
+
+/**
+ * Outcome of a decode: the bytes written and the offset of the first
+ * character that could not be decoded, SIZE_MAX when there is none.
+ */
+struct DecodeResult
+{
+    size_t size  = 0;
+    size_t error = SIZE_MAX;
+
+    bool ok() const noexcept
+    {
+        return error == SIZE_MAX;
+    }
+};
+
+namespace slimm::detail
+{
+
+/**
+ * Lookup tables of one base64 alphabet, all derived from its 64 symbols:
+ *
+ * - decode maps every byte to its 6-bit value or 0x80; the first 128
+ *   entries double as the VBMI permutex2var table.
+ * - nibbleLo and nibbleHi give each high nibble 0-7 a bit, set in the
+ *   low-nibble entry wherever that character is invalid, so a character
+ *   is valid exactly when the two pshufb lookups share no bit.
+ * - roll is the value minus character offset per high nibble, shared by
+ *   every symbol but the last, which is blended in separately.
+ * - offset maps the pshufb class of a 6-bit value to its character offset.
+ */
+struct Base64Tables
+{
+    std::array<char, 64>     encode{};
+    std::array<uint8_t, 256> decode{};
+    std::array<int8_t, 16>   nibbleLo{};
+    std::array<int8_t, 16>   nibbleHi{};
+    std::array<int8_t, 16>   roll{};
+    std::array<int8_t, 16>   offset{};
+    char                     last = 0;
+};
+
+static constexpr Base64Tables makeBase64Tables(const char (&alphabet)[65])
+{
+    Base64Tables tables{};
+    for (size_t c = 0; c < 256; c++) {
+        tables.decode[c] = 0x80;
+    }
+    for (size_t v = 0; v < 64; v++) {
+        auto c = static_cast<uint8_t>(alphabet[v]);
+        tables.encode[v] = alphabet[v];
+        tables.decode[c] = static_cast<uint8_t>(v);
+        if (v != 63) {
+            tables.roll[c >> 4] = static_cast<int8_t>(static_cast<int>(v) - static_cast<int>(c));
+        }
+    }
+    for (size_t hi = 0; hi < 16; hi++) {
+        tables.nibbleHi[hi] = static_cast<int8_t>(hi < 8 ? 1 << hi : 0xFF);
+    }
+    for (size_t lo = 0; lo < 16; lo++) {
+        unsigned bits = 0;
+        for (size_t hi = 0; hi < 8; hi++) {
+            if (tables.decode[hi << 4 | lo] == 0x80) {
+                bits |= 1U << hi;
+            }
+        }
+        tables.nibbleLo[lo] = static_cast<int8_t>(bits);
+    }
+    tables.offset[0] = static_cast<int8_t>(alphabet[26] - 26);
+    for (size_t k = 1; k <= 10; k++) {
+        tables.offset[k] = static_cast<int8_t>(alphabet[52] - 52);
+    }
+    tables.offset[11] = static_cast<int8_t>(alphabet[62] - 62);
+    tables.offset[12] = static_cast<int8_t>(alphabet[63] - 63);
+    tables.offset[13] = static_cast<int8_t>(alphabet[0]);
+    tables.last       = alphabet[63];
+    return tables;
+}
+
+static constexpr Base64Tables BASE64_STANDARD = makeBase64Tables("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+static constexpr Base64Tables BASE64_URL      = makeBase64Tables("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_");
+
+static inline const Base64Tables &base64Tables(Base64Alphabet alphabet) noexcept
+{
+    return alphabet == Base64Alphabet::Url ? BASE64_URL : BASE64_STANDARD;
+}
+
+static inline __m256i broadcast16(const int8_t *table) noexcept
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table)));
+}
+
+/**
+ * Spreads each 3-byte group over a 32-bit lane as [b1 b0 b2 b1], so that
+ * every 6-bit field can be shifted into its own byte.
+ */
+static inline size_t base64EncodeVector(const uint8_t *src, size_t n, char *dst, const Base64Tables &tables) noexcept
+{
+    size_t i = 0;
+    size_t o = 0;
+#if defined(__AVX512VBMI__)
+    alignas(64) uint8_t spread[64];
+    for (size_t j = 0; j < 16; j++) {
+        spread[4 * j]     = static_cast<uint8_t>(3 * j + 1);
+        spread[4 * j + 1] = static_cast<uint8_t>(3 * j);
+        spread[4 * j + 2] = static_cast<uint8_t>(3 * j + 2);
+        spread[4 * j + 3] = static_cast<uint8_t>(3 * j + 1);
+    }
+    const __m512i spreads = _mm512_load_si512(spread);
+    const __m512i lut     = _mm512_loadu_si512(tables.encode.data());
+    const __m512i shifts  = _mm512_set1_epi64(0x3036242a1016040a);
+    for (; i + 48 <= n; i += 48, o += 64) {
+        __m512i in = _mm512_permutexvar_epi8(spreads, _mm512_maskz_loadu_epi8(0xFFFFFFFFFFFFULL, src + i));
+        __m512i v  = _mm512_multishift_epi64_epi8(shifts, in);
+        _mm512_storeu_si512(dst + o, _mm512_permutexvar_epi8(v, lut));
+    }
+#endif
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i offset  = broadcast16(tables.offset.data());
+    for (; i + 28 <= n; i += 24, o += 32) {
+        __m256i in = _mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(src + i + 12), reinterpret_cast<const __m128i *>(src + i));
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+        __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+        __m256i v  = _mm256_or_si256(t0, t1);
+
+        /* Class 0 is a-z, 1-10 digits, 11 and 12 the last two symbols, 13 A-Z */
+        __m256i cls = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+        cls = _mm256_or_si256(cls, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v), _mm256_set1_epi8(13)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + o), _mm256_add_epi8(v, _mm256_shuffle_epi8(offset, cls)));
+    }
+    return i;
+}
+
+/**
+ * Decodes whole 64 (VBMI) or 32 (AVX2) character blocks of the n
+ * characters; returns the characters consumed, stopping before a block
+ * that holds an invalid character so the scalar loop can locate it.
+ */
+static inline size_t base64DecodeVector(const char *src, size_t n, uint8_t *dst, const Base64Tables &tables) noexcept
+{
+    size_t i = 0;
+    size_t o = 0;
+#if defined(__AVX512VBMI__)
+    alignas(64) uint8_t gather[64] = {};
+    for (size_t j = 0; j < 16; j++) {
+        gather[3 * j]     = static_cast<uint8_t>(4 * j + 2);
+        gather[3 * j + 1] = static_cast<uint8_t>(4 * j + 1);
+        gather[3 * j + 2] = static_cast<uint8_t>(4 * j);
+    }
+    const __m512i gathers = _mm512_load_si512(gather);
+    const __m512i lut0    = _mm512_loadu_si512(tables.decode.data());
+    const __m512i lut1    = _mm512_loadu_si512(tables.decode.data() + 64);
+    for (; i + 64 <= n; i += 64, o += 48) {
+        __m512i in = _mm512_loadu_si512(src + i);
+        __m512i v  = _mm512_permutex2var_epi8(lut0, in, lut1);
+        if (_mm512_movepi8_mask(_mm512_or_si512(in, v)) != 0) {
+            return i;
+        }
+        v = _mm512_maddubs_epi16(v, _mm512_set1_epi32(0x01400140));
+        v = _mm512_madd_epi16(v, _mm512_set1_epi32(0x00011000));
+        _mm512_mask_storeu_epi8(dst + o, 0xFFFFFFFFFFFFULL, _mm512_permutexvar_epi8(gathers, v));
+    }
+#endif
+    const __m256i lo    = broadcast16(tables.nibbleLo.data());
+    const __m256i hi    = broadcast16(tables.nibbleHi.data());
+    const __m256i roll  = broadcast16(tables.roll.data());
+    const __m256i last  = _mm256_set1_epi8(tables.last);
+    const __m256i nib   = _mm256_set1_epi8(0x0F);
+    const __m256i pack  = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                           2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i store = _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+    for (; i + 32 <= n; i += 32, o += 24) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i h  = _mm256_and_si256(_mm256_srli_epi32(in, 4), nib);
+        __m256i c  = _mm256_and_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(in, nib)), _mm256_shuffle_epi8(hi, h));
+        if (!_mm256_testz_si256(c, c)) {
+            return i;
+        }
+        __m256i v = _mm256_add_epi8(in, _mm256_shuffle_epi8(roll, h));
+        v = _mm256_blendv_epi8(v, _mm256_set1_epi8(63), _mm256_cmpeq_epi8(in, last));
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, pack), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_maskstore_epi32(reinterpret_cast<int *>(dst + o), store, v);
+    }
+    return i;
+}
+
+static inline __m256i hexDigits(__m256i nibbles, bool upper) noexcept
+{
+    const __m256i lower = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                           '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    __m256i       c     = _mm256_shuffle_epi8(lower, nibbles);
+    return upper ? _mm256_sub_epi8(c, _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)), _mm256_set1_epi8(0x20))) : c;
+}
+
+static inline int hexValue(char c) noexcept
+{
+    unsigned d = static_cast<unsigned>(static_cast<uint8_t>(c)) - '0';
+    unsigned a = (static_cast<unsigned>(static_cast<uint8_t>(c)) | 0x20) - 'a';
+    return d < 10 ? static_cast<int>(d) : a < 6 ? static_cast<int>(a + 10) : -1;
+}
+
+/**
+ * Maps hex characters to nibbles: digits subtract '0', letters fold to
+ * lower case and subtract 'a' - 10; a character that is neither leaves its
+ * bit clear in valid.
+ */
+static inline __m256i hexNibbles(__m256i in, uint32_t &valid) noexcept
+{
+    __m256i d     = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+    __m256i a     = _mm256_sub_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+    valid = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(digit, alpha)));
+    return _mm256_blendv_epi8(_mm256_add_epi8(a, _mm256_set1_epi8(10)), d, digit);
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Characters written by base64Encode for n bytes, padding included
+ */
+static constexpr size_t base64EncodedSize(size_t n) noexcept
+{
+    return (n + 2) / 3 * 4;
+}
+
+/**
+ * @brief Upper bound on the bytes base64Decode writes for n characters
+ */
+static constexpr size_t base64DecodeBound(size_t n) noexcept
+{
+    return (n + 3) / 4 * 3;
+}
+
+/**
+ * @brief Base64-encodes n bytes with '=' padding; returns the characters written
+ */
+static inline size_t base64Encode(const uint8_t *src, size_t n, char *dst, Base64Alphabet alphabet = Base64Alphabet::Standard) noexcept
+{
+    const auto &tables = slimm::detail::base64Tables(alphabet);
+    const char *lut    = tables.encode.data();
+
+    size_t i = slimm::detail::base64EncodeVector(src, n, dst, tables);
+    char  *o = dst + i / 3 * 4;
+    for (; i + 3 <= n; i += 3) {
+        uint32_t v = static_cast<uint32_t>(src[i]) << 16 | static_cast<uint32_t>(src[i + 1]) << 8 | src[i + 2];
+        *o++ = lut[v >> 18];
+        *o++ = lut[(v >> 12) & 63];
+        *o++ = lut[(v >> 6) & 63];
+        *o++ = lut[v & 63];
+    }
+    if (i < n) {
+        uint32_t v = static_cast<uint32_t>(src[i]) << 16 | (i + 1 < n ? static_cast<uint32_t>(src[i + 1]) << 8 : 0);
+        *o++ = lut[v >> 18];
+        *o++ = lut[(v >> 12) & 63];
+        *o++ = i + 1 < n ? lut[(v >> 6) & 63] : '=';
+        *o++ = '=';
+    }
+    return static_cast<size_t>(o - dst);
+}
+
+/**
+ * @brief Decodes n base64 characters, padded or not
+ *
+ * Whitespace is not skipped. On invalid input the result holds the offset
+ * of the first offending character and the bytes decoded before its
+ * 4-character group.
+ */
+static inline DecodeResult base64Decode(const char *src, size_t n, uint8_t *dst, Base64Alphabet alphabet = Base64Alphabet::Standard) noexcept
+{
+    const auto &tables = slimm::detail::base64Tables(alphabet);
+    const auto &lut    = tables.decode;
+
+    DecodeResult result;
+    size_t       m = n;
+    if (n % 4 == 0 && n != 0 && src[n - 1] == '=') {
+        m -= src[n - 2] == '=' ? 2 : 1;
+    }
+
+    size_t   i = slimm::detail::base64DecodeVector(src, m, dst, tables);
+    uint8_t *o = dst + i / 4 * 3;
+    /* Also locates the first invalid character of a block the vector loop stopped at */
+    for (; i < m; i += 4) {
+        size_t   count = m - i < 4 ? m - i : 4;
+        uint32_t v     = 0;
+        for (size_t k = 0; k < count; k++) {
+            uint8_t x = lut[static_cast<uint8_t>(src[i + k])];
+            if (x & 0x80) {
+                result.error = i + k;
+                result.size  = static_cast<size_t>(o - dst);
+                return result;
+            }
+            v |= static_cast<uint32_t>(x) << (18 - 6 * k);
+        }
+        if (count == 1) {
+            result.error = i;
+            break;
+        }
+        *o++ = static_cast<uint8_t>(v >> 16);
+        if (count > 2) {
+            *o++ = static_cast<uint8_t>(v >> 8);
+        }
+        if (count > 3) {
+            *o++ = static_cast<uint8_t>(v);
+        }
+    }
+    result.size = static_cast<size_t>(o - dst);
+    return result;
+}
+
+/**
+ * @brief Writes the 2n hex digits of n bytes, high nibble first; returns 2n
+ */
+static inline size_t hexEncode(const uint8_t *src, size_t n, char *dst, bool upper = false) noexcept
+{
+    size_t i = 0;
+#if defined(__AVX512BW__)
+    const __m512i lut    = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(upper ? "0123456789ABCDEF" : "0123456789abcdef")));
+    const __m512i first  = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i second = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+    for (; i + 64 <= n; i += 64) {
+        __m512i in = _mm512_loadu_si512(src + i);
+        __m512i hi = _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(in, 4), _mm512_set1_epi8(0x0F)));
+        __m512i lo = _mm512_shuffle_epi8(lut, _mm512_and_si512(in, _mm512_set1_epi8(0x0F)));
+        __m512i a  = _mm512_unpacklo_epi8(hi, lo);
+        __m512i b  = _mm512_unpackhi_epi8(hi, lo);
+        _mm512_storeu_si512(dst + 2 * i, _mm512_permutex2var_epi64(a, first, b));
+        _mm512_storeu_si512(dst + 2 * i + 64, _mm512_permutex2var_epi64(a, second, b));
+    }
+#endif
+    for (; i + 32 <= n; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i hi = slimm::detail::hexDigits(_mm256_and_si256(_mm256_srli_epi16(in, 4), _mm256_set1_epi8(0x0F)), upper);
+        __m256i lo = slimm::detail::hexDigits(_mm256_and_si256(in, _mm256_set1_epi8(0x0F)), upper);
+        __m256i a  = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b  = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    for (; i < n; i++) {
+        dst[2 * i]     = digits[src[i] >> 4];
+        dst[2 * i + 1] = digits[src[i] & 15];
+    }
+    return 2 * n;
+}
+
+/**
+ * @brief Decodes n hex digits of either case into n / 2 bytes
+ *
+ * An odd n reports the last character as the error after decoding the
+ * complete pairs.
+ */
+static inline DecodeResult hexDecode(const char *src, size_t n, uint8_t *dst) noexcept
+{
+    DecodeResult result;
+    size_t       i = 0;
+#if defined(__AVX512BW__)
+    for (; i + 64 <= n; i += 64) {
+        __m512i   in    = _mm512_loadu_si512(src + i);
+        __m512i   d     = _mm512_sub_epi8(in, _mm512_set1_epi8('0'));
+        __m512i   a     = _mm512_sub_epi8(_mm512_or_si512(in, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+        __mmask64 digit = _mm512_cmplt_epu8_mask(d, _mm512_set1_epi8(10));
+        __mmask64 alpha = _mm512_cmplt_epu8_mask(a, _mm512_set1_epi8(6));
+        if ((digit | alpha) != ~0ULL) {
+            break;
+        }
+        __m512i v = _mm512_mask_mov_epi8(_mm512_add_epi8(a, _mm512_set1_epi8(10)), digit, d);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 2), _mm512_cvtepi16_epi8(_mm512_maddubs_epi16(v, _mm512_set1_epi16(0x0110))));
+    }
+#endif
+    for (; i + 64 <= n; i += 64) {
+        uint32_t v0;
+        uint32_t v1;
+        __m256i  a = slimm::detail::hexNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)), v0);
+        __m256i  b = slimm::detail::hexNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32)), v1);
+        if ((v0 & v1) != ~0U) {
+            break;
+        }
+        a = _mm256_maddubs_epi16(a, _mm256_set1_epi16(0x0110));
+        b = _mm256_maddubs_epi16(b, _mm256_set1_epi16(0x0110));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 2), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+    }
+    /* Also locates the first invalid character of a block the vector loops stopped at */
+    for (; i + 2 <= n; i += 2) {
+        int hi = slimm::detail::hexValue(src[i]);
+        int lo = slimm::detail::hexValue(src[i + 1]);
+        if (hi < 0 || lo < 0) {
+            result.error = hi < 0 ? i : i + 1;
+            break;
+        }
+        dst[i / 2] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+    if (result.ok() && i < n) {
+        result.error = i;
+    }
+    result.size = i / 2;
+    return result;
+}
@@ -0,0 +1,396 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+enum class BitOp
+{
+    And,
+    Or,
+    Xor,
+    AndNot,
+};
+
+template <BitOp OP>
+static inline uint64_t bitOp(uint64_t a, uint64_t b) noexcept
+{
+    switch (OP) {
+    case BitOp::And:
+        return a & b;
+    case BitOp::Or:
+        return a | b;
+    case BitOp::Xor:
+        return a ^ b;
+    default:
+        return a & ~b;
+    }
+}
+
+template <BitOp OP>
+static inline __m256i bitOp(__m256i a, __m256i b) noexcept
+{
+    switch (OP) {
+    case BitOp::And:
+        return _mm256_and_si256(a, b);
+    case BitOp::Or:
+        return _mm256_or_si256(a, b);
+    case BitOp::Xor:
+        return _mm256_xor_si256(a, b);
+    default:
+        return _mm256_andnot_si256(b, a);
+    }
+}
+
+template <BitOp OP>
+static inline __m512i bitOp(__m512i a, __m512i b) noexcept
+{
+    switch (OP) {
+    case BitOp::And:
+        return _mm512_and_si512(a, b);
+    case BitOp::Or:
+        return _mm512_or_si512(a, b);
+    case BitOp::Xor:
+        return _mm512_xor_si512(a, b);
+    default:
+        return _mm512_andnot_si512(b, a);
+    }
+}
+
+static inline void loadWords(__m256i &v, const uint64_t *src) noexcept { v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src)); }
+static inline void loadWords(__m512i &v, const uint64_t *src) noexcept { v = _mm512_loadu_si512(src); }
+static inline void storeWords(uint64_t *dst, __m256i v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v); }
+static inline void storeWords(uint64_t *dst, __m512i v) noexcept { _mm512_storeu_si512(dst, v); }
+
+/* Carry-save adder: h:l = a + b + c, bit by bit */
+static inline void csa(__m256i &h, __m256i &l, __m256i a, __m256i b, __m256i c) noexcept
+{
+    __m256i u = _mm256_xor_si256(a, b);
+    h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+    l = _mm256_xor_si256(u, c);
+}
+
+static inline void csa(__m512i &h, __m512i &l, __m512i a, __m512i b, __m512i c) noexcept
+{
+    h = _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+    l = _mm512_ternarylogic_epi64(a, b, c, 0x96);
+}
+
+/* Bit counts of every 64-bit lane: pshufb nibble lookup summed with psadbw */
+static inline __m256i popcountLanes(__m256i v) noexcept
+{
+    const __m256i nibbles = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low     = _mm256_set1_epi8(0x0F);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(nibbles, _mm256_and_si256(v, low)),
+                                    _mm256_shuffle_epi8(nibbles, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+
+static inline __m512i popcountLanes(__m512i v) noexcept
+{
+#if defined(__AVX512VPOPCNTDQ__)
+    return UINT64X8(v).popcnt();
+#else
+    const __m512i nibbles = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    const __m512i low     = _mm512_set1_epi8(0x0F);
+    __m512i bytes = _mm512_add_epi8(_mm512_shuffle_epi8(nibbles, _mm512_and_si512(v, low)),
+                                    _mm512_shuffle_epi8(nibbles, _mm512_and_si512(_mm512_srli_epi16(v, 4), low)));
+    return _mm512_sad_epu8(bytes, _mm512_setzero_si512());
+#endif
+}
+
+static inline __m256i addLanes(__m256i a, __m256i b) noexcept { return _mm256_add_epi64(a, b); }
+static inline __m512i addLanes(__m512i a, __m512i b) noexcept { return _mm512_add_epi64(a, b); }
+
+template <int n> static inline __m256i shiftLanes(__m256i v) noexcept { return _mm256_slli_epi64(v, n); }
+template <int n> static inline __m512i shiftLanes(__m512i v) noexcept { return _mm512_slli_epi64(v, n); }
+
+static inline uint64_t sumLanes(__m256i v) noexcept
+{
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1));
+}
+
+static inline uint64_t sumLanes(__m512i v) noexcept
+{
+    return static_cast<uint64_t>(_mm512_reduce_add_epi64(v));
+}
+
+/**
+ * Harley-Seal population count over `vectors` registers produced by
+ * load(i). Sixteen registers are folded through a tree of carry-save
+ * adders so that only one register in sixteen needs a real popcount.
+ * With VPOPCNTDQ the popcount is a single instruction and the adder tree
+ * is skipped.
+ */
+template <class V, class Load>
+static inline uint64_t harleySeal(size_t vectors, Load &&load) noexcept
+{
+    V total{};
+    size_t i = 0;
+
+#if defined(__AVX512VPOPCNTDQ__)
+    if constexpr (sizeof(V) == 64) {
+        for (; i < vectors; i++) {
+            total = addLanes(total, popcountLanes(load(i)));
+        }
+        return sumLanes(total);
+    }
+#endif
+
+    V ones{}, twos{}, fours{}, eights{}, sixteens{};
+    V twosA, twosB, foursA, foursB, eightsA, eightsB;
+    for (; i + 16 <= vectors; i += 16) {
+        csa(twosA, ones, ones, load(i), load(i + 1));
+        csa(twosB, ones, ones, load(i + 2), load(i + 3));
+        csa(foursA, twos, twos, twosA, twosB);
+        csa(twosA, ones, ones, load(i + 4), load(i + 5));
+        csa(twosB, ones, ones, load(i + 6), load(i + 7));
+        csa(foursB, twos, twos, twosA, twosB);
+        csa(eightsA, fours, fours, foursA, foursB);
+        csa(twosA, ones, ones, load(i + 8), load(i + 9));
+        csa(twosB, ones, ones, load(i + 10), load(i + 11));
+        csa(foursA, twos, twos, twosA, twosB);
+        csa(twosA, ones, ones, load(i + 12), load(i + 13));
+        csa(twosB, ones, ones, load(i + 14), load(i + 15));
+        csa(foursB, twos, twos, twosA, twosB);
+        csa(eightsB, fours, fours, foursA, foursB);
+        csa(sixteens, eights, eights, eightsA, eightsB);
+        total = addLanes(total, popcountLanes(sixteens));
+    }
+
+    total = shiftLanes<4>(total);
+    total = addLanes(total, shiftLanes<3>(popcountLanes(eights)));
+    total = addLanes(total, shiftLanes<2>(popcountLanes(fours)));
+    total = addLanes(total, shiftLanes<1>(popcountLanes(twos)));
+    total = addLanes(total, popcountLanes(ones));
+    for (; i < vectors; i++) {
+        total = addLanes(total, popcountLanes(load(i)));
+    }
+    return sumLanes(total);
+}
+
+#if defined(__AVX512BW__)
+using BitmapVector = __m512i;
+#else
+using BitmapVector = __m256i;
+#endif
+
+/**
+ * dst = a OP b over whole words, optionally counting the result bits.
+ * A null b reads a alone, which turns the count into a plain popcount.
+ */
+template <BitOp OP, bool STORE, bool COUNT>
+static inline uint64_t bitmapCombine(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    using V = BitmapVector;
+    constexpr size_t W = sizeof(V) / sizeof(uint64_t);
+
+    auto load = [&](size_t i) {
+        V x;
+        loadWords(x, a + i * W);
+        if (b != nullptr) {
+            V y;
+            loadWords(y, b + i * W);
+            x = bitOp<OP>(x, y);
+        }
+        if constexpr (STORE) {
+            storeWords(dst + i * W, x);
+        }
+        return x;
+    };
+
+    size_t   vectors = words / W;
+    uint64_t count   = 0;
+    if constexpr (COUNT) {
+        count = harleySeal<V>(vectors, load);
+    } else {
+        for (size_t i = 0; i < vectors; i++) {
+            load(i);
+        }
+    }
+
+    for (size_t i = vectors * W; i < words; i++) {
+        uint64_t x = b != nullptr ? bitOp<OP>(a[i], b[i]) : a[i];
+        if constexpr (STORE) {
+            dst[i] = x;
+        }
+        count += static_cast<uint64_t>(_mm_popcnt_u64(x));
+    }
+    return count;
+}
+
+/* Byte-packed bit positions of every byte value, for the AVX2 decoder */
+static constexpr std::array<uint64_t, 256> makeBitPositions() noexcept
+{
+    std::array<uint64_t, 256> table{};
+    for (size_t byte = 0; byte < 256; byte++) {
+        size_t slot = 0;
+        for (size_t bit = 0; bit < 8; bit++) {
+            if ((byte >> bit) & 1) {
+                table[byte] |= static_cast<uint64_t>(bit) << (8 * slot++);
+            }
+        }
+    }
+    return table;
+}
+
+static constexpr std::array<uint64_t, 256> BIT_POSITIONS = makeBitPositions();
+
+/**
+ * AVX-512 compresses a running 16-lane index vector through each 16-bit
+ * chunk of the word; AVX2 expands a byte-indexed position table and stores
+ * only the valid lanes, so nothing is written past the last position.
+ */
+static inline size_t bitmapToPositions(const uint64_t *bitmap, size_t words, uint32_t *positions) noexcept
+{
+    uint32_t *out = positions;
+
+#if defined(__AVX512F__)
+    const __m512i iota  = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step  = _mm512_set1_epi32(16);
+    __m512i       index = iota;
+    for (size_t w = 0; w < words; w++, index = _mm512_add_epi32(index, _mm512_set1_epi32(64))) {
+        uint64_t word = bitmap[w];
+        if (word == 0) {
+            continue;
+        }
+        __m512i base = index;
+        for (int chunk = 0; chunk < 4; chunk++, word >>= 16, base = _mm512_add_epi32(base, step)) {
+            __mmask16 m = static_cast<__mmask16>(word);
+            _mm512_mask_compressstoreu_epi32(out, m, base);
+            out += _mm_popcnt_u32(m);
+        }
+    }
+#else
+    const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t w = 0; w < words; w++) {
+        uint64_t word = bitmap[w];
+        for (uint32_t base = static_cast<uint32_t>(w * 64); word != 0; word >>= 8, base += 8) {
+            uint32_t byte = word & 0xFF;
+            if (byte == 0) {
+                continue;
+            }
+            int     count = _mm_popcnt_u32(byte);
+            __m256i lanes = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<int64_t>(BIT_POSITIONS[byte])));
+            __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(count), iota);
+            _mm256_maskstore_epi32(reinterpret_cast<int *>(out), valid, _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(base))));
+            out += count;
+        }
+    }
+#endif
+
+    return static_cast<size_t>(out - positions);
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief dst = a & b, word by word; dst may alias a or b
+ */
+static inline void bitmapAnd(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    slimm::detail::bitmapCombine<slimm::detail::BitOp::And, true, false>(a, b, dst, words);
+}
+
+/**
+ * @brief dst = a | b, word by word; dst may alias a or b
+ */
+static inline void bitmapOr(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    slimm::detail::bitmapCombine<slimm::detail::BitOp::Or, true, false>(a, b, dst, words);
+}
+
+/**
+ * @brief dst = a ^ b, word by word; dst may alias a or b
+ */
+static inline void bitmapXor(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    slimm::detail::bitmapCombine<slimm::detail::BitOp::Xor, true, false>(a, b, dst, words);
+}
+
+/**
+ * @brief dst = a & ~b, word by word; dst may alias a or b
+ */
+static inline void bitmapAndNot(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    slimm::detail::bitmapCombine<slimm::detail::BitOp::AndNot, true, false>(a, b, dst, words);
+}
+
+/**
+ * @brief Number of set bits in the first words 64-bit words of a
+ *
+ * Uses VPOPCNTDQ when available, otherwise a Harley-Seal carry-save tree
+ * over a pshufb nibble popcount.
+ */
+static inline uint64_t bitmapCount(const uint64_t *a, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::And, false, true>(a, nullptr, nullptr, words);
+}
+
+/**
+ * @brief dst = a & b, returning the number of set bits in dst, in a single pass
+ */
+static inline uint64_t bitmapAndCount(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::And, true, true>(a, b, dst, words);
+}
+
+static inline uint64_t bitmapOrCount(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::Or, true, true>(a, b, dst, words);
+}
+
+static inline uint64_t bitmapXorCount(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::Xor, true, true>(a, b, dst, words);
+}
+
+static inline uint64_t bitmapAndNotCount(const uint64_t *a, const uint64_t *b, uint64_t *dst, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::AndNot, true, true>(a, b, dst, words);
+}
+
+/**
+ * @brief Number of set bits in a & b without materializing it
+ */
+static inline uint64_t bitmapAndCount(const uint64_t *a, const uint64_t *b, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::And, false, true>(a, b, nullptr, words);
+}
+
+static inline uint64_t bitmapOrCount(const uint64_t *a, const uint64_t *b, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::Or, false, true>(a, b, nullptr, words);
+}
+
+static inline uint64_t bitmapXorCount(const uint64_t *a, const uint64_t *b, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::Xor, false, true>(a, b, nullptr, words);
+}
+
+static inline uint64_t bitmapAndNotCount(const uint64_t *a, const uint64_t *b, size_t words) noexcept
+{
+    return slimm::detail::bitmapCombine<slimm::detail::BitOp::AndNot, false, true>(a, b, nullptr, words);
+}
+
+/**
+ * @brief Writes the index of every set bit in ascending order and returns how many there are
+ *
+ * positions needs room for bitmapCount(bitmap, words) entries; nothing is
+ * written past them.
+ */
+static inline size_t bitmapToPositions(const uint64_t *bitmap, size_t words, uint32_t *positions) noexcept
+{
+    return slimm::detail::bitmapToPositions(bitmap, words, positions);
+}
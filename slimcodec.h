@@ -0,0 +1,669 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <utility>
+#include "slimmintrin.h"
+#include "slimscan.h"
+
+/* Values per bit-packed block: 32 rows of 16 interleaved lanes */
+static constexpr size_t BITPACK_BLOCK = 512;
+
+namespace slimm::detail
+{
+
+static constexpr size_t BITPACK_LANES = 16;
+
+/**
+ * Lane operations of the codecs. A bit-packed block is laid out as rows of
+ * 16 uint32 lanes whatever the register width: AVX-512 handles a row with
+ * one UINT32X16, AVX2 handles lanes 0-7 and 8-15 as two UINT32X8 passes,
+ * so both builds read and write the same format.
+ */
+template <class V>
+struct CodecLanes;
+
+template <>
+struct CodecLanes<UINT32X8>
+{
+    using raw = __m256i;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const uint32_t *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static void storeu(uint32_t *p, raw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static raw set1(uint32_t x) noexcept { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_epi32(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm256_sub_epi32(a, b); }
+    static raw andv(raw a, raw b) noexcept { return _mm256_and_si256(a, b); }
+    static raw orv(raw a, raw b) noexcept { return _mm256_or_si256(a, b); }
+    static raw xorv(raw a, raw b) noexcept { return _mm256_xor_si256(a, b); }
+    static raw sll(raw v, int n) noexcept { return _mm256_slli_epi32(v, n); }
+    static raw srl(raw v, int n) noexcept { return _mm256_srli_epi32(v, n); }
+    static raw sra(raw v, int n) noexcept { return _mm256_srai_epi32(v, n); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_epu32(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_epu32(a, b); }
+
+    static uint32_t reduceOr(raw v) noexcept
+    {
+        __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        x = _mm_or_si128(x, _mm_shuffle_epi32(x, 0x4E));
+        x = _mm_or_si128(x, _mm_shuffle_epi32(x, 0xB1));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(x));
+    }
+
+    static uint32_t reduceMin(raw v) noexcept
+    {
+        __m128i x = _mm_min_epu32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        x = _mm_min_epu32(x, _mm_shuffle_epi32(x, 0x4E));
+        x = _mm_min_epu32(x, _mm_shuffle_epi32(x, 0xB1));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(x));
+    }
+
+    static uint32_t reduceMax(raw v) noexcept
+    {
+        __m128i x = _mm_max_epu32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        x = _mm_max_epu32(x, _mm_shuffle_epi32(x, 0x4E));
+        x = _mm_max_epu32(x, _mm_shuffle_epi32(x, 0xB1));
+        return static_cast<uint32_t>(_mm_cvtsi128_si32(x));
+    }
+};
+
+#if defined(__AVX512F__)
+template <>
+struct CodecLanes<UINT32X16>
+{
+    using raw = __m512i;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const uint32_t *p) noexcept { return _mm512_loadu_si512(p); }
+    static void storeu(uint32_t *p, raw v) noexcept { _mm512_storeu_si512(p, v); }
+    static raw set1(uint32_t x) noexcept { return _mm512_set1_epi32(static_cast<int>(x)); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_epi32(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm512_sub_epi32(a, b); }
+    static raw andv(raw a, raw b) noexcept { return _mm512_and_si512(a, b); }
+    static raw orv(raw a, raw b) noexcept { return _mm512_or_si512(a, b); }
+    static raw xorv(raw a, raw b) noexcept { return _mm512_xor_si512(a, b); }
+    static raw sll(raw v, int n) noexcept { return _mm512_slli_epi32(v, static_cast<unsigned>(n)); }
+    static raw srl(raw v, int n) noexcept { return _mm512_srli_epi32(v, static_cast<unsigned>(n)); }
+    static raw sra(raw v, int n) noexcept { return _mm512_srai_epi32(v, static_cast<unsigned>(n)); }
+    static raw min(raw a, raw b) noexcept { return _mm512_min_epu32(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm512_max_epu32(a, b); }
+    static uint32_t reduceOr(raw v) noexcept { return static_cast<uint32_t>(_mm512_reduce_or_epi32(v)); }
+    static uint32_t reduceMin(raw v) noexcept { return _mm512_reduce_min_epu32(v); }
+    static uint32_t reduceMax(raw v) noexcept { return _mm512_reduce_max_epu32(v); }
+};
+
+using CodecUint32 = CodecLanes<UINT32X16>;
+#else
+using CodecUint32 = CodecLanes<UINT32X8>;
+#endif
+
+static inline unsigned bitsOf(uint32_t x) noexcept
+{
+    return static_cast<unsigned>(std::bit_width(x));
+}
+
+/**
+ * Value I of every lane goes to bit (I * BITS) % 32 of row I * BITS / 32;
+ * a value that straddles two rows is completed by the next step. All
+ * offsets are compile-time constants, so each width unrolls into a
+ * straight run of shifts and ors.
+ */
+template <class Ops, unsigned BITS, size_t I>
+static inline void packStep(const uint32_t *src, uint32_t *dst, typename Ops::raw base, typename Ops::raw &acc) noexcept
+{
+    constexpr unsigned OFFSET = (I * BITS) % 32;
+    constexpr size_t   ROW    = (I * BITS) / 32;
+
+    auto v = Ops::sub(Ops::loadu(src + I * BITPACK_LANES), base);
+    if constexpr (BITS < 32) {
+        v = Ops::andv(v, Ops::set1((1U << BITS) - 1));
+    }
+    if constexpr (OFFSET == 0) {
+        acc = v;
+    } else {
+        acc = Ops::orv(acc, Ops::sll(v, OFFSET));
+    }
+    if constexpr (OFFSET + BITS >= 32) {
+        Ops::storeu(dst + ROW * BITPACK_LANES, acc);
+        if constexpr (OFFSET + BITS > 32) {
+            acc = Ops::srl(v, 32 - OFFSET);
+        }
+    }
+}
+
+template <class Ops, unsigned BITS, size_t I>
+static inline void unpackStep(const uint32_t *src, uint32_t *dst, typename Ops::raw base) noexcept
+{
+    constexpr unsigned OFFSET = (I * BITS) % 32;
+    constexpr size_t   ROW    = (I * BITS) / 32;
+
+    auto v = Ops::srl(Ops::loadu(src + ROW * BITPACK_LANES), OFFSET);
+    if constexpr (OFFSET + BITS > 32) {
+        v = Ops::orv(v, Ops::sll(Ops::loadu(src + (ROW + 1) * BITPACK_LANES), 32 - OFFSET));
+    }
+    if constexpr (BITS < 32) {
+        v = Ops::andv(v, Ops::set1((1U << BITS) - 1));
+    }
+    Ops::storeu(dst + I * BITPACK_LANES, Ops::add(v, base));
+}
+
+template <class Ops, unsigned BITS, size_t... I>
+static inline void packLanes(const uint32_t *src, uint32_t *dst, uint32_t base, std::index_sequence<I...>) noexcept
+{
+    auto b   = Ops::set1(base);
+    auto acc = Ops::set1(0);
+    (packStep<Ops, BITS, I>(src, dst, b, acc), ...);
+}
+
+template <class Ops, unsigned BITS, size_t... I>
+static inline void unpackLanes(const uint32_t *src, uint32_t *dst, uint32_t base, std::index_sequence<I...>) noexcept
+{
+    auto b = Ops::set1(base);
+    (unpackStep<Ops, BITS, I>(src, dst, b), ...);
+}
+
+/* Packs BITPACK_BLOCK values minus base into BITS rows */
+template <unsigned BITS>
+static inline void packBlock(const uint32_t *src, uint32_t *dst, uint32_t base) noexcept
+{
+    using Ops = CodecUint32;
+    if constexpr (BITS != 0) {
+        for (size_t lane = 0; lane < BITPACK_LANES; lane += Ops::lanes) {
+            packLanes<Ops, BITS>(src + lane, dst + lane, base, std::make_index_sequence<32>());
+        }
+    }
+}
+
+template <unsigned BITS>
+static inline void unpackBlock(const uint32_t *src, uint32_t *dst, uint32_t base) noexcept
+{
+    using Ops = CodecUint32;
+    if constexpr (BITS == 0) {
+        for (size_t i = 0; i < BITPACK_BLOCK; i += Ops::lanes) {
+            Ops::storeu(dst + i, Ops::set1(base));
+        }
+    } else {
+        for (size_t lane = 0; lane < BITPACK_LANES; lane += Ops::lanes) {
+            unpackLanes<Ops, BITS>(src + lane, dst + lane, base, std::make_index_sequence<32>());
+        }
+    }
+}
+
+using BlockCodec = void (*)(const uint32_t *, uint32_t *, uint32_t) noexcept;
+
+template <size_t... BITS>
+static constexpr std::array<BlockCodec, 33> makePackers(std::index_sequence<BITS...>)
+{
+    return { &packBlock<BITS>... };
+}
+
+template <size_t... BITS>
+static constexpr std::array<BlockCodec, 33> makeUnpackers(std::index_sequence<BITS...>)
+{
+    return { &unpackBlock<BITS>... };
+}
+
+static constexpr std::array<BlockCodec, 33> PACKERS   = makePackers(std::make_index_sequence<33>());
+static constexpr std::array<BlockCodec, 33> UNPACKERS = makeUnpackers(std::make_index_sequence<33>());
+
+/* Horizontal packing of the last partial block: value after value, low bits first */
+static inline size_t packTail(const uint32_t *src, size_t n, uint32_t *dst, unsigned bits, uint32_t base) noexcept
+{
+    uint32_t *start = dst;
+    uint64_t  acc   = 0;
+    unsigned  fill  = 0;
+    uint32_t  mask  = bits == 32 ? ~0U : (1U << bits) - 1;
+    if (bits == 0) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        acc  |= static_cast<uint64_t>((src[i] - base) & mask) << fill;
+        fill += bits;
+        if (fill >= 32) {
+            *dst++ = static_cast<uint32_t>(acc);
+            acc  >>= 32;
+            fill  -= 32;
+        }
+    }
+    if (fill != 0) {
+        *dst++ = static_cast<uint32_t>(acc);
+    }
+    return static_cast<size_t>(dst - start);
+}
+
+static inline size_t unpackTail(const uint32_t *src, size_t n, uint32_t *dst, unsigned bits, uint32_t base) noexcept
+{
+    const uint32_t *start = src;
+    uint64_t        acc   = 0;
+    unsigned        fill  = 0;
+    uint32_t        mask  = bits == 32 ? ~0U : (1U << bits) - 1;
+    for (size_t i = 0; i < n; i++) {
+        if (fill < bits) {
+            acc  |= static_cast<uint64_t>(*src++) << fill;
+            fill += 32;
+        }
+        dst[i] = base + (static_cast<uint32_t>(acc) & mask);
+        acc  >>= bits;
+        fill  -= bits;
+    }
+    return static_cast<size_t>(src - start);
+}
+
+/**
+ * Inclusive scan of n deltas starting from init, with uint32 wrap-around in
+ * the scalar tail as well. DECODE_ZIGZAG first maps zigzag codes back to
+ * signed deltas.
+ */
+template <bool DECODE_ZIGZAG>
+static inline uint32_t deltaScan(const uint32_t *src, uint32_t *dst, size_t n, uint32_t init) noexcept
+{
+    using Ops  = CodecUint32;
+    using Scan = ScanInt32;
+    constexpr size_t L = Ops::lanes;
+
+    auto   carry = Ops::set1(init);
+    size_t i     = 0;
+    for (; i + L <= n; i += L) {
+        auto d = Ops::loadu(src + i);
+        if constexpr (DECODE_ZIGZAG) {
+            d = Ops::xorv(Ops::srl(d, 1), Ops::sub(Ops::set1(0), Ops::andv(d, Ops::set1(1))));
+        }
+        auto s = Ops::add(carry, Scan::scan(d));
+        Ops::storeu(dst + i, s);
+        carry = Scan::last(s);
+    }
+
+    auto sum = static_cast<uint32_t>(Scan::first(carry));
+    for (; i < n; i++) {
+        uint32_t d = src[i];
+        if constexpr (DECODE_ZIGZAG) {
+            d = (d >> 1) ^ (0U - (d & 1));
+        }
+        sum   += d;
+        dst[i] = sum;
+    }
+    return sum;
+}
+
+/**
+ * StreamVByte: one control byte holds the byte lengths minus one of four
+ * values, and the data stream holds only those bytes. Decoding shuffles 16
+ * data bytes straight into four lanes; encoding shuffles them back out.
+ */
+struct VByteTables
+{
+    std::array<std::array<uint8_t, 16>, 256> decode{};
+    std::array<std::array<uint8_t, 16>, 256> encode{};
+    std::array<uint8_t, 256>                 length{};
+};
+
+static constexpr VByteTables makeVByteTables()
+{
+    VByteTables tables{};
+    for (size_t control = 0; control < 256; control++) {
+        uint8_t pos = 0;
+        for (size_t k = 0; k < 4; k++) {
+            size_t len = ((control >> (2 * k)) & 3) + 1;
+            for (size_t b = 0; b < 4; b++) {
+                tables.decode[control][4 * k + b] = b < len ? static_cast<uint8_t>(pos + b) : 0x80;
+            }
+            for (size_t b = 0; b < len; b++) {
+                tables.encode[control][pos + b] = static_cast<uint8_t>(4 * k + b);
+            }
+            pos = static_cast<uint8_t>(pos + len);
+        }
+        for (size_t b = pos; b < 16; b++) {
+            tables.encode[control][b] = 0x80;
+        }
+        tables.length[control] = pos;
+    }
+    return tables;
+}
+
+static constexpr VByteTables VBYTE_TABLES = makeVByteTables();
+
+static inline unsigned vbyteCode(uint32_t x) noexcept
+{
+    return (x > 0xFF) + (x > 0xFFFF) + (x > 0xFFFFFF);
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Number of bits needed by the largest of n values, 0 to 32
+ */
+static inline unsigned bitWidth(const uint32_t *src, size_t n) noexcept
+{
+    using Ops = slimm::detail::CodecUint32;
+
+    auto   acc  = Ops::set1(0);
+    size_t tail = n % Ops::lanes;
+    for (size_t i = 0; i < n - tail; i += Ops::lanes) {
+        acc = Ops::orv(acc, Ops::loadu(src + i));
+    }
+    uint32_t bits = Ops::reduceOr(acc);
+    for (size_t i = n - tail; i < n; i++) {
+        bits |= src[i];
+    }
+    return slimm::detail::bitsOf(bits);
+}
+
+/**
+ * @brief Packs BITPACK_BLOCK values into bits * 16 words; returns the words written
+ *
+ * Values are truncated to their low bits. The layout interleaves 16 lanes,
+ * so value i sits in lane i % 16 and the same format is produced on AVX2
+ * and AVX-512.
+ */
+static inline size_t bitPack(const uint32_t *src, uint32_t *dst, unsigned bits) noexcept
+{
+    slimm::detail::PACKERS[bits](src, dst, 0);
+    return bits * slimm::detail::BITPACK_LANES;
+}
+
+/**
+ * @brief Unpacks BITPACK_BLOCK values written by bitPack; returns the words read
+ */
+static inline size_t bitUnpack(const uint32_t *src, uint32_t *dst, unsigned bits) noexcept
+{
+    slimm::detail::UNPACKERS[bits](src, dst, 0);
+    return bits * slimm::detail::BITPACK_LANES;
+}
+
+/**
+ * @brief Upper bound on the words forEncode writes for n values
+ */
+static constexpr size_t forBound(size_t n) noexcept
+{
+    return (n / BITPACK_BLOCK) * (2 + BITPACK_BLOCK) + (n % BITPACK_BLOCK != 0 ? 2 + n % BITPACK_BLOCK : 0);
+}
+
+/**
+ * @brief Frame-of-reference encoding; returns the words written
+ *
+ * Every block of BITPACK_BLOCK values is stored as its minimum, the bit
+ * width of its range and the bit-packed offsets from the minimum. A final
+ * partial block is packed value after value.
+ */
+static inline size_t forEncode(const uint32_t *src, size_t n, uint32_t *dst) noexcept
+{
+    using Ops = slimm::detail::CodecUint32;
+
+    uint32_t *start = dst;
+    for (size_t i = 0; i < n; i += BITPACK_BLOCK) {
+        size_t   count = n - i < BITPACK_BLOCK ? n - i : BITPACK_BLOCK;
+        uint32_t lo    = ~0U;
+        uint32_t hi    = 0;
+        size_t   j     = 0;
+        if (count == BITPACK_BLOCK) {
+            auto vmin = Ops::loadu(src + i);
+            auto vmax = vmin;
+            for (j = Ops::lanes; j < BITPACK_BLOCK; j += Ops::lanes) {
+                auto v = Ops::loadu(src + i + j);
+                vmin   = Ops::min(vmin, v);
+                vmax   = Ops::max(vmax, v);
+            }
+            lo = Ops::reduceMin(vmin);
+            hi = Ops::reduceMax(vmax);
+        }
+        for (; j < count; j++) {
+            lo = src[i + j] < lo ? src[i + j] : lo;
+            hi = src[i + j] > hi ? src[i + j] : hi;
+        }
+
+        unsigned bits = slimm::detail::bitsOf(hi - lo);
+        *dst++ = lo;
+        *dst++ = bits;
+        if (count == BITPACK_BLOCK) {
+            slimm::detail::PACKERS[bits](src + i, dst, lo);
+            dst += bits * slimm::detail::BITPACK_LANES;
+        } else {
+            dst += slimm::detail::packTail(src + i, count, dst, bits, lo);
+        }
+    }
+    return static_cast<size_t>(dst - start);
+}
+
+/**
+ * @brief Decodes n values written by forEncode; returns the words read
+ */
+static inline size_t forDecode(const uint32_t *src, size_t n, uint32_t *dst) noexcept
+{
+    const uint32_t *start = src;
+    for (size_t i = 0; i < n; i += BITPACK_BLOCK) {
+        size_t   count = n - i < BITPACK_BLOCK ? n - i : BITPACK_BLOCK;
+        uint32_t base  = *src++;
+        unsigned bits  = *src++;
+        if (count == BITPACK_BLOCK) {
+            slimm::detail::UNPACKERS[bits](src, dst + i, base);
+            src += bits * slimm::detail::BITPACK_LANES;
+        } else {
+            src += slimm::detail::unpackTail(src, count, dst + i, bits, base);
+        }
+    }
+    return static_cast<size_t>(src - start);
+}
+
+/**
+ * Running state of the delta codecs, so a long series can be encoded and
+ * decoded chunk by chunk: the last value and the last difference seen.
+ */
+struct DeltaState
+{
+    uint32_t value = 0;
+    uint32_t delta = 0;
+};
+
+/**
+ * @brief dst[i] = src[i] - src[i-1], with src[-1] = state.value; src and dst may be the same array
+ */
+static inline void deltaEncode(const uint32_t *src, uint32_t *dst, size_t n, DeltaState &state) noexcept
+{
+    using Ops = slimm::detail::CodecUint32;
+
+    if (n == 0) {
+        return;
+    }
+    uint32_t last  = src[n - 1];
+    uint32_t delta = n > 1 ? last - src[n - 2] : last - state.value;
+
+    /* Walking down keeps src[i-1] intact when encoding in place */
+    size_t i = n;
+    while (i >= Ops::lanes + 1) {
+        i -= Ops::lanes;
+        Ops::storeu(dst + i, Ops::sub(Ops::loadu(src + i), Ops::loadu(src + i - 1)));
+    }
+    while (i > 1) {
+        i--;
+        dst[i] = src[i] - src[i - 1];
+    }
+    dst[0] = src[0] - state.value;
+
+    state.value = last;
+    state.delta = delta;
+}
+
+/**
+ * @brief Inverse of deltaEncode, a prefix sum starting from state.value
+ */
+static inline void deltaDecode(const uint32_t *src, uint32_t *dst, size_t n, DeltaState &state) noexcept
+{
+    if (n == 0) {
+        return;
+    }
+    uint32_t delta = src[n - 1];
+    state.value = slimm::detail::deltaScan<false>(src, dst, n, state.value);
+    state.delta = delta;
+}
+
+/**
+ * @brief Zigzag-coded second differences; small for series with a near-constant step such as timestamps
+ *
+ * dst[i] = zigzag((src[i] - src[i-1]) - (src[i-1] - src[i-2])), continuing
+ * from state. src and dst may be the same array.
+ */
+static inline void deltaOfDeltaEncode(const uint32_t *src, uint32_t *dst, size_t n, DeltaState &state) noexcept
+{
+    using Ops = slimm::detail::CodecUint32;
+
+    if (n == 0) {
+        return;
+    }
+    auto zigzag = [](uint32_t d) noexcept { return (d << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(d) >> 31); };
+
+    uint32_t last  = src[n - 1];
+    uint32_t delta = n > 1 ? last - src[n - 2] : last - state.value;
+
+    size_t i = n;
+    while (i >= Ops::lanes + 2) {
+        i -= Ops::lanes;
+        auto x0 = Ops::loadu(src + i);
+        auto x1 = Ops::loadu(src + i - 1);
+        auto x2 = Ops::loadu(src + i - 2);
+        auto d  = Ops::add(Ops::sub(x0, Ops::add(x1, x1)), x2);
+        Ops::storeu(dst + i, Ops::xorv(Ops::sll(d, 1), Ops::sra(d, 31)));
+    }
+    while (i > 2) {
+        i--;
+        dst[i] = zigzag(src[i] - 2 * src[i - 1] + src[i - 2]);
+    }
+    if (n > 1) {
+        dst[1] = zigzag(src[1] - 2 * src[0] + state.value);
+    }
+    dst[0] = zigzag(src[0] - state.value - state.delta);
+
+    state.value = last;
+    state.delta = delta;
+}
+
+/**
+ * @brief Inverse of deltaOfDeltaEncode, two prefix sums starting from state.delta and state.value
+ */
+static inline void deltaOfDeltaDecode(const uint32_t *src, uint32_t *dst, size_t n, DeltaState &state) noexcept
+{
+    state.delta = slimm::detail::deltaScan<true>(src, dst, n, state.delta);
+    state.value = slimm::detail::deltaScan<false>(dst, dst, n, state.value);
+}
+
+static inline void deltaEncode(const uint32_t *src, uint32_t *dst, size_t n) noexcept
+{
+    DeltaState state;
+    deltaEncode(src, dst, n, state);
+}
+
+static inline void deltaDecode(const uint32_t *src, uint32_t *dst, size_t n) noexcept
+{
+    DeltaState state;
+    deltaDecode(src, dst, n, state);
+}
+
+static inline void deltaOfDeltaEncode(const uint32_t *src, uint32_t *dst, size_t n) noexcept
+{
+    DeltaState state;
+    deltaOfDeltaEncode(src, dst, n, state);
+}
+
+static inline void deltaOfDeltaDecode(const uint32_t *src, uint32_t *dst, size_t n) noexcept
+{
+    DeltaState state;
+    deltaOfDeltaDecode(src, dst, n, state);
+}
+
+/**
+ * @brief Upper bound on the bytes streamVByteEncode writes for n values
+ */
+static constexpr size_t streamVByteBound(size_t n) noexcept
+{
+    return (n + 3) / 4 + 4 * n;
+}
+
+/**
+ * @brief StreamVByte encoding: (n + 3) / 4 control bytes followed by the data bytes; returns the bytes written
+ *
+ * dst must hold streamVByteBound(n) bytes. Chunks whose size is a multiple
+ * of 4 can be encoded separately and decoded as separate streams.
+ */
+static inline size_t streamVByteEncode(const uint32_t *src, size_t n, uint8_t *dst) noexcept
+{
+    const auto &tables  = slimm::detail::VBYTE_TABLES;
+    uint8_t    *control = dst;
+    uint8_t    *data    = dst + (n + 3) / 4;
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i t1 = _mm_set1_epi32(0xFF);
+        const __m128i t2 = _mm_set1_epi32(0xFFFF);
+        const __m128i t3 = _mm_set1_epi32(0xFFFFFF);
+
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        /* Each compare is -1 where the value fits under a byte boundary, so 3 plus the sum is the code */
+        __m128i c = _mm_add_epi32(_mm_add_epi32(_mm_cmpeq_epi32(_mm_min_epu32(v, t1), v), _mm_cmpeq_epi32(_mm_min_epu32(v, t2), v)),
+                                  _mm_cmpeq_epi32(_mm_min_epu32(v, t3), v));
+        c = _mm_add_epi32(c, _mm_set1_epi32(3));
+        c = _mm_packus_epi16(_mm_packus_epi32(c, c), c);
+
+        /* Gathers the four 2-bit codes from bytes 0-3 into the top byte */
+        uint8_t code = static_cast<uint8_t>((static_cast<uint32_t>(_mm_cvtsi128_si32(c)) * 0x01041040U) >> 24);
+        __m128i shuf = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables.encode[code].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data), _mm_shuffle_epi8(v, shuf));
+        *control++ = code;
+        data      += tables.length[code];
+    }
+    if (i < n) {
+        uint8_t code = 0;
+        for (size_t k = 0; i + k < n; k++) {
+            uint32_t x   = src[i + k];
+            unsigned len = slimm::detail::vbyteCode(x);
+            code |= static_cast<uint8_t>(len << (2 * k));
+            for (unsigned b = 0; b <= len; b++) {
+                *data++ = static_cast<uint8_t>(x >> (8 * b));
+            }
+        }
+        *control++ = code;
+    }
+    return static_cast<size_t>(data - dst);
+}
+
+/**
+ * @brief Decodes n values written by streamVByteEncode; returns the bytes read
+ *
+ * Groups are decoded with one 16-byte load and shuffle while at least 12
+ * more values follow, so the load never reaches past the encoded data.
+ */
+static inline size_t streamVByteDecode(const uint8_t *src, size_t n, uint32_t *dst) noexcept
+{
+    const auto    &tables  = slimm::detail::VBYTE_TABLES;
+    const uint8_t *control = src;
+    const uint8_t *data    = src + (n + 3) / 4;
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 4) {
+        uint8_t code = *control++;
+        __m128i shuf = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables.decode[code].data()));
+        __m128i v    = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), shuf);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+        data += tables.length[code];
+    }
+    for (; i < n; i += 4) {
+        uint8_t code = *control++;
+        for (size_t k = 0; k < 4 && i + k < n; k++) {
+            unsigned len = (code >> (2 * k)) & 3;
+            uint32_t x   = 0;
+            for (unsigned b = 0; b <= len; b++) {
+                x |= static_cast<uint32_t>(*data++) << (8 * b);
+            }
+            dst[i + k] = x;
+        }
+    }
+    return static_cast<size_t>(data - src);
+}
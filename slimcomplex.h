@@ -0,0 +1,420 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <complex>
+#include "slimmintrin.h"
+
+/**
+ * Complex vectors over interleaved storage: lane pairs hold (re, im), so
+ * they load and store straight from std::complex<T> arrays. COMPLEXFX4
+ * and COMPLEXDX2 need AVX2 and FMA, COMPLEXFX8 and COMPLEXDX4 AVX-512F.
+ *
+ * Multiplication duplicates the real and imaginary parts of the right
+ * operand, swaps the pairs of the left one and joins both products with
+ * a single fmaddsub.
+ */
+struct COMPLEXFX4
+{
+public:
+    using value_type = __m256;
+
+    COMPLEXFX4() noexcept
+    {
+    }
+
+    COMPLEXFX4(__m256 other) noexcept :
+        v{ other }
+    {
+    }
+
+    COMPLEXFX4(std::complex<float> value) noexcept :
+        v{ _mm256_setr_ps(value.real(), value.imag(), value.real(), value.imag(), value.real(), value.imag(), value.real(), value.imag()) }
+    {
+    }
+
+    COMPLEXFX4(float re, float im) noexcept :
+        COMPLEXFX4(std::complex<float>(re, im))
+    {
+    }
+
+    COMPLEXFX4 operator+(const COMPLEXFX4 &other) const noexcept
+    {
+        return _mm256_add_ps(v, other.v);
+    }
+
+    COMPLEXFX4 operator-(const COMPLEXFX4 &other) const noexcept
+    {
+        return _mm256_sub_ps(v, other.v);
+    }
+
+    COMPLEXFX4 operator*(const COMPLEXFX4 &other) const noexcept
+    {
+        __m256 re = _mm256_moveldup_ps(other.v);
+        __m256 im = _mm256_movehdup_ps(other.v);
+        return _mm256_fmaddsub_ps(v, re, _mm256_mul_ps(_mm256_permute_ps(v, 0xB1), im));
+    }
+
+    operator __m256 &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m256 &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const std::complex<float> *src) noexcept
+    {
+        v = _mm256_load_ps(reinterpret_cast<const float *>(src));
+    }
+
+    void store(std::complex<float> *dst) noexcept
+    {
+        _mm256_store_ps(reinterpret_cast<float *>(dst), v);
+    }
+
+    void loadu(const std::complex<float> *src) noexcept
+    {
+        v = _mm256_loadu_ps(reinterpret_cast<const float *>(src));
+    }
+
+    void storeu(std::complex<float> *dst) noexcept
+    {
+        _mm256_storeu_ps(reinterpret_cast<float *>(dst), v);
+    }
+
+    COMPLEXFX4 conj() const noexcept
+    {
+        return _mm256_xor_ps(v, _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f));
+    }
+
+    /** @brief Multiplies by the imaginary unit */
+    COMPLEXFX4 mulI() const noexcept
+    {
+        return _mm256_xor_ps(_mm256_permute_ps(v, 0xB1), _mm256_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f));
+    }
+
+    /** @brief Squared magnitudes, one per complex lane */
+    FLOATX4 norm() const noexcept
+    {
+        __m256 sq = _mm256_mul_ps(v, v);
+        __m256 re = _mm256_shuffle_ps(sq, sq, 0x88);
+        __m256 im = _mm256_shuffle_ps(sq, sq, 0xDD);
+        __m256 s  = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_add_ps(re, im)), 0x08));
+        return _mm256_castps256_ps128(s);
+    }
+
+    FLOATX4 abs() const noexcept
+    {
+        return _mm_sqrt_ps(norm());
+    }
+
+public:
+    __m256 v;
+};
+
+struct COMPLEXFX8
+{
+public:
+    using value_type = __m512;
+
+    COMPLEXFX8() noexcept
+    {
+    }
+
+    COMPLEXFX8(__m512 other) noexcept :
+        v{ other }
+    {
+    }
+
+    COMPLEXFX8(std::complex<float> value) noexcept :
+        v{ _mm512_broadcast_f32x4(_mm_setr_ps(value.real(), value.imag(), value.real(), value.imag())) }
+    {
+    }
+
+    COMPLEXFX8(float re, float im) noexcept :
+        COMPLEXFX8(std::complex<float>(re, im))
+    {
+    }
+
+    COMPLEXFX8 operator+(const COMPLEXFX8 &other) const noexcept
+    {
+        return _mm512_add_ps(v, other.v);
+    }
+
+    COMPLEXFX8 operator-(const COMPLEXFX8 &other) const noexcept
+    {
+        return _mm512_sub_ps(v, other.v);
+    }
+
+    COMPLEXFX8 operator*(const COMPLEXFX8 &other) const noexcept
+    {
+        __m512 re = _mm512_moveldup_ps(other.v);
+        __m512 im = _mm512_movehdup_ps(other.v);
+        return _mm512_fmaddsub_ps(v, re, _mm512_mul_ps(_mm512_permute_ps(v, 0xB1), im));
+    }
+
+    operator __m512 &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m512 &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const std::complex<float> *src) noexcept
+    {
+        v = _mm512_load_ps(reinterpret_cast<const float *>(src));
+    }
+
+    void store(std::complex<float> *dst) noexcept
+    {
+        _mm512_store_ps(reinterpret_cast<float *>(dst), v);
+    }
+
+    void loadu(const std::complex<float> *src) noexcept
+    {
+        v = _mm512_loadu_ps(reinterpret_cast<const float *>(src));
+    }
+
+    void storeu(std::complex<float> *dst) noexcept
+    {
+        _mm512_storeu_ps(reinterpret_cast<float *>(dst), v);
+    }
+
+    COMPLEXFX8 conj() const noexcept
+    {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(v), _mm512_set1_epi64(0x8000000000000000LL)));
+    }
+
+    /** @brief Multiplies by the imaginary unit */
+    COMPLEXFX8 mulI() const noexcept
+    {
+        __m512 swapped = _mm512_permute_ps(v, 0xB1);
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(swapped), _mm512_set1_epi64(0x80000000LL)));
+    }
+
+    /** @brief Squared magnitudes, one per complex lane */
+    FLOATX8 norm() const noexcept
+    {
+        __m512 sq = _mm512_mul_ps(v, v);
+        __m512 s  = _mm512_add_ps(sq, _mm512_permute_ps(sq, 0xB1));
+        return _mm512_castps512_ps256(_mm512_permutexvar_ps(_mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 0, 2, 4, 6, 8, 10, 12, 14), s));
+    }
+
+    FLOATX8 abs() const noexcept
+    {
+        return _mm256_sqrt_ps(norm());
+    }
+
+public:
+    __m512 v;
+};
+
+struct COMPLEXDX2
+{
+public:
+    using value_type = __m256d;
+
+    COMPLEXDX2() noexcept
+    {
+    }
+
+    COMPLEXDX2(__m256d other) noexcept :
+        v{ other }
+    {
+    }
+
+    COMPLEXDX2(std::complex<double> value) noexcept :
+        v{ _mm256_setr_pd(value.real(), value.imag(), value.real(), value.imag()) }
+    {
+    }
+
+    COMPLEXDX2(double re, double im) noexcept :
+        COMPLEXDX2(std::complex<double>(re, im))
+    {
+    }
+
+    COMPLEXDX2 operator+(const COMPLEXDX2 &other) const noexcept
+    {
+        return _mm256_add_pd(v, other.v);
+    }
+
+    COMPLEXDX2 operator-(const COMPLEXDX2 &other) const noexcept
+    {
+        return _mm256_sub_pd(v, other.v);
+    }
+
+    COMPLEXDX2 operator*(const COMPLEXDX2 &other) const noexcept
+    {
+        __m256d re = _mm256_movedup_pd(other.v);
+        __m256d im = _mm256_permute_pd(other.v, 0xF);
+        return _mm256_fmaddsub_pd(v, re, _mm256_mul_pd(_mm256_permute_pd(v, 0x5), im));
+    }
+
+    operator __m256d &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m256d &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const std::complex<double> *src) noexcept
+    {
+        v = _mm256_load_pd(reinterpret_cast<const double *>(src));
+    }
+
+    void store(std::complex<double> *dst) noexcept
+    {
+        _mm256_store_pd(reinterpret_cast<double *>(dst), v);
+    }
+
+    void loadu(const std::complex<double> *src) noexcept
+    {
+        v = _mm256_loadu_pd(reinterpret_cast<const double *>(src));
+    }
+
+    void storeu(std::complex<double> *dst) noexcept
+    {
+        _mm256_storeu_pd(reinterpret_cast<double *>(dst), v);
+    }
+
+    COMPLEXDX2 conj() const noexcept
+    {
+        return _mm256_xor_pd(v, _mm256_setr_pd(0.0, -0.0, 0.0, -0.0));
+    }
+
+    /** @brief Multiplies by the imaginary unit */
+    COMPLEXDX2 mulI() const noexcept
+    {
+        return _mm256_xor_pd(_mm256_permute_pd(v, 0x5), _mm256_setr_pd(-0.0, 0.0, -0.0, 0.0));
+    }
+
+    /** @brief Squared magnitudes, one per complex lane */
+    DOUBLEX2 norm() const noexcept
+    {
+        __m256d sq = _mm256_mul_pd(v, v);
+        __m256d s  = _mm256_hadd_pd(sq, sq);
+        return _mm256_castpd256_pd128(_mm256_permute4x64_pd(s, 0x08));
+    }
+
+    DOUBLEX2 abs() const noexcept
+    {
+        return _mm_sqrt_pd(norm());
+    }
+
+public:
+    __m256d v;
+};
+
+struct COMPLEXDX4
+{
+public:
+    using value_type = __m512d;
+
+    COMPLEXDX4() noexcept
+    {
+    }
+
+    COMPLEXDX4(__m512d other) noexcept :
+        v{ other }
+    {
+    }
+
+    COMPLEXDX4(std::complex<double> value) noexcept :
+        v{ _mm512_broadcast_f64x4(_mm256_setr_pd(value.real(), value.imag(), value.real(), value.imag())) }
+    {
+    }
+
+    COMPLEXDX4(double re, double im) noexcept :
+        COMPLEXDX4(std::complex<double>(re, im))
+    {
+    }
+
+    COMPLEXDX4 operator+(const COMPLEXDX4 &other) const noexcept
+    {
+        return _mm512_add_pd(v, other.v);
+    }
+
+    COMPLEXDX4 operator-(const COMPLEXDX4 &other) const noexcept
+    {
+        return _mm512_sub_pd(v, other.v);
+    }
+
+    COMPLEXDX4 operator*(const COMPLEXDX4 &other) const noexcept
+    {
+        __m512d re = _mm512_movedup_pd(other.v);
+        __m512d im = _mm512_permute_pd(other.v, 0xFF);
+        return _mm512_fmaddsub_pd(v, re, _mm512_mul_pd(_mm512_permute_pd(v, 0x55), im));
+    }
+
+    operator __m512d &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m512d &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const std::complex<double> *src) noexcept
+    {
+        v = _mm512_load_pd(reinterpret_cast<const double *>(src));
+    }
+
+    void store(std::complex<double> *dst) noexcept
+    {
+        _mm512_store_pd(reinterpret_cast<double *>(dst), v);
+    }
+
+    void loadu(const std::complex<double> *src) noexcept
+    {
+        v = _mm512_loadu_pd(reinterpret_cast<const double *>(src));
+    }
+
+    void storeu(std::complex<double> *dst) noexcept
+    {
+        _mm512_storeu_pd(reinterpret_cast<double *>(dst), v);
+    }
+
+    COMPLEXDX4 conj() const noexcept
+    {
+        __m512i sign = _mm512_setr_epi64(0, 1LL << 63, 0, 1LL << 63, 0, 1LL << 63, 0, 1LL << 63);
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(v), sign));
+    }
+
+    /** @brief Multiplies by the imaginary unit */
+    COMPLEXDX4 mulI() const noexcept
+    {
+        __m512i sign = _mm512_setr_epi64(1LL << 63, 0, 1LL << 63, 0, 1LL << 63, 0, 1LL << 63, 0);
+        return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(_mm512_permute_pd(v, 0x55)), sign));
+    }
+
+    /** @brief Squared magnitudes, one per complex lane */
+    DOUBLEX4 norm() const noexcept
+    {
+        __m512d sq = _mm512_mul_pd(v, v);
+        __m512d s  = _mm512_add_pd(sq, _mm512_permute_pd(sq, 0x55));
+        return _mm512_castpd512_pd256(_mm512_permutexvar_pd(_mm512_setr_epi64(0, 2, 4, 6, 0, 2, 4, 6), s));
+    }
+
+    DOUBLEX4 abs() const noexcept
+    {
+        return _mm256_sqrt_pd(norm());
+    }
+
+public:
+    __m512d v;
+};
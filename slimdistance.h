@@ -0,0 +1,460 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "slimmintrin.h"
+
+enum class Metric
+{
+    L2,           /* squared Euclidean distance, smaller is closer */
+    InnerProduct, /* larger is closer */
+    Cosine,       /* larger is closer */
+};
+
+namespace slimm
+{
+namespace detail
+{
+
+#if defined(__AVX512F__)
+using DistanceFloat = FLOATX16;
+/* Accumulators per vector when scoring a group of vectors; 32 registers leave room for two */
+constexpr size_t DISTANCE_UNROLL = 2;
+#else
+using DistanceFloat = FLOATX8;
+constexpr size_t DISTANCE_UNROLL = 1;
+#endif
+
+constexpr size_t DISTANCE_LANES = sizeof(DistanceFloat) / sizeof(float);
+/* Vectors scored together against one load of the query */
+constexpr size_t DISTANCE_GROUP = 4;
+
+static inline float distanceSum(__m256 v) noexcept
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s        = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s        = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+static inline float distanceSum(__m512 v) noexcept
+{
+    return _mm512_reduce_add_ps(v);
+}
+
+/* The first n <= lanes floats of src with zeros after, without reading past them */
+static inline DistanceFloat distanceLoad(const float *src, size_t n) noexcept
+{
+#if defined(__AVX512F__)
+    return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1), src);
+#else
+    __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    return _mm256_maskload_ps(src, mask);
+#endif
+}
+
+static inline float cosineOf(float dot, float aa, float bb) noexcept
+{
+    float norm = std::sqrt(aa * bb);
+    return norm > 0 ? dot / norm : 0.0f;
+}
+
+/*
+ * Scores N vectors against one query with U accumulators per vector, so
+ * every query register is loaded once for N vectors and N * U independent
+ * FMA chains are in flight. qq is the squared norm of the query, used by
+ * the cosine metric only.
+ */
+template <Metric METRIC, size_t N, size_t U>
+static inline void floatScores(const float *q, const float *const *v, size_t dim, float qq, float *out) noexcept
+{
+    using V            = DistanceFloat;
+    constexpr size_t L = DISTANCE_LANES;
+
+    V acc[N][U], norm[N][U];
+    for (size_t n = 0; n < N; n++) {
+        for (size_t u = 0; u < U; u++) {
+            acc[n][u]  = V(0.0f);
+            norm[n][u] = V(0.0f);
+        }
+    }
+    auto step = [&](size_t n, size_t u, V x, V y) {
+        if constexpr (METRIC == Metric::L2) {
+            V d       = y - x;
+            acc[n][u] = d.fmadd(d, acc[n][u]);
+        } else {
+            acc[n][u] = x.fmadd(y, acc[n][u]);
+            if constexpr (METRIC == Metric::Cosine) {
+                norm[n][u] = y.fmadd(y, norm[n][u]);
+            }
+        }
+    };
+
+    size_t i = 0;
+    for (; i + U * L <= dim; i += U * L) {
+        for (size_t u = 0; u < U; u++) {
+            V x;
+            x.loadu(q + i + u * L);
+            for (size_t n = 0; n < N; n++) {
+                V y;
+                y.loadu(v[n] + i + u * L);
+                step(n, u, x, y);
+            }
+        }
+    }
+    for (; i < dim; i += L) {
+        size_t r = std::min(L, dim - i);
+        V      x = distanceLoad(q + i, r);
+        for (size_t n = 0; n < N; n++) {
+            step(n, 0, x, distanceLoad(v[n] + i, r));
+        }
+    }
+
+    for (size_t n = 0; n < N; n++) {
+        V s = acc[n][0], t = norm[n][0];
+        for (size_t u = 1; u < U; u++) {
+            s = s + acc[n][u];
+            t = t + norm[n][u];
+        }
+        if constexpr (METRIC == Metric::Cosine) {
+            out[n] = cosineOf(distanceSum(s), qq, distanceSum(t));
+        } else {
+            out[n] = distanceSum(s);
+        }
+    }
+}
+
+/*
+ * Int8 products go through |a| as the unsigned operand and b with the
+ * sign of a as the signed one, so that products stay exact as long as
+ * both sides are within [-127, 127]. VNNI accumulates them with dpbusd;
+ * without it maddubs pairs them into int16, which cannot saturate in
+ * that range, and madd widens the pairs to int32. L2 widens the inputs to
+ * int16 first, where differences fit, and squares them with dpwssd or
+ * madd.
+ */
+#if defined(__AVX512BW__)
+struct Int8Lanes
+{
+    using raw = __m512i;
+
+    static constexpr size_t count = 64;
+
+    static raw load(const int8_t *p) noexcept { return _mm512_loadu_si512(p); }
+    static raw zero() noexcept { return _mm512_setzero_si512(); }
+    static raw abs(raw a) noexcept { return _mm512_abs_epi8(a); }
+    static raw widenLo(raw a) noexcept { return _mm512_cvtepi8_epi16(_mm512_castsi512_si256(a)); }
+    static raw widenHi(raw a) noexcept { return _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(a, 1)); }
+    static raw sub16(raw a, raw b) noexcept { return _mm512_sub_epi16(a, b); }
+    static int32_t sum(raw v) noexcept { return _mm512_reduce_add_epi32(v); }
+
+    /* acc + sum of a * b where au = |a| */
+    static raw dot(raw acc, raw a, raw au, raw b) noexcept
+    {
+        raw s = _mm512_mask_sub_epi8(b, _mm512_movepi8_mask(a), _mm512_setzero_si512(), b);
+#if defined(__AVX512VNNI__)
+        return _mm512_dpbusd_epi32(acc, au, s);
+#else
+        return _mm512_add_epi32(acc, _mm512_madd_epi16(_mm512_maddubs_epi16(au, s), _mm512_set1_epi16(1)));
+#endif
+    }
+
+    /* acc + sum of the squares of the int16 lanes of d */
+    static raw squares(raw acc, raw d) noexcept
+    {
+#if defined(__AVX512VNNI__)
+        return _mm512_dpwssd_epi32(acc, d, d);
+#else
+        return _mm512_add_epi32(acc, _mm512_madd_epi16(d, d));
+#endif
+    }
+};
+#else
+struct Int8Lanes
+{
+    using raw = __m256i;
+
+    static constexpr size_t count = 32;
+
+    static raw load(const int8_t *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static raw zero() noexcept { return _mm256_setzero_si256(); }
+    static raw abs(raw a) noexcept { return _mm256_abs_epi8(a); }
+    static raw widenLo(raw a) noexcept { return _mm256_cvtepi8_epi16(_mm256_castsi256_si128(a)); }
+    static raw widenHi(raw a) noexcept { return _mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 1)); }
+    static raw sub16(raw a, raw b) noexcept { return _mm256_sub_epi16(a, b); }
+
+    static int32_t sum(raw v) noexcept
+    {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s         = _mm_add_epi32(s, _mm_unpackhi_epi64(s, s));
+        s         = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x55));
+        return _mm_cvtsi128_si32(s);
+    }
+
+    static raw dot(raw acc, raw a, raw au, raw b) noexcept
+    {
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_maddubs_epi16(au, _mm256_sign_epi8(b, a)), _mm256_set1_epi16(1)));
+    }
+
+    static raw squares(raw acc, raw d) noexcept
+    {
+        return _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+    }
+};
+#endif
+
+/* Exact int32 sums of N vectors against one query: squared distances or products, and squared norms for cosine */
+template <Metric METRIC, size_t N>
+static inline void int8Sums(const int8_t *q, const int8_t *const *v, size_t dim, int32_t *sums, int32_t *norms) noexcept
+{
+    using I            = Int8Lanes;
+    using raw          = typename I::raw;
+    constexpr size_t C = I::count;
+
+    raw acc[N], norm[N];
+    for (size_t n = 0; n < N; n++) {
+        acc[n]  = I::zero();
+        norm[n] = I::zero();
+    }
+    auto chunk = [&](raw a, const raw *b) {
+        if constexpr (METRIC == Metric::L2) {
+            raw lo = I::widenLo(a), hi = I::widenHi(a);
+            for (size_t n = 0; n < N; n++) {
+                acc[n] = I::squares(acc[n], I::sub16(I::widenLo(b[n]), lo));
+                acc[n] = I::squares(acc[n], I::sub16(I::widenHi(b[n]), hi));
+            }
+        } else {
+            raw au = I::abs(a);
+            for (size_t n = 0; n < N; n++) {
+                acc[n] = I::dot(acc[n], a, au, b[n]);
+                if constexpr (METRIC == Metric::Cosine) {
+                    norm[n] = I::dot(norm[n], b[n], I::abs(b[n]), b[n]);
+                }
+            }
+        }
+    };
+
+    size_t i = 0;
+    for (; i + C <= dim; i += C) {
+        raw b[N];
+        for (size_t n = 0; n < N; n++) {
+            b[n] = I::load(v[n] + i);
+        }
+        chunk(I::load(q + i), b);
+    }
+    if (i < dim) {
+        /* Zero padding adds nothing to any of the sums */
+        alignas(64) int8_t tail[N + 1][C] = {};
+        std::memcpy(tail[N], q + i, dim - i);
+        raw b[N];
+        for (size_t n = 0; n < N; n++) {
+            std::memcpy(tail[n], v[n] + i, dim - i);
+            b[n] = I::load(tail[n]);
+        }
+        chunk(I::load(tail[N]), b);
+    }
+
+    for (size_t n = 0; n < N; n++) {
+        sums[n]  = I::sum(acc[n]);
+        norms[n] = I::sum(norm[n]);
+    }
+}
+
+template <Metric METRIC, size_t N>
+static inline void int8Scores(const int8_t *q, const int8_t *const *v, size_t dim, float qq, float *out) noexcept
+{
+    int32_t sums[N], norms[N];
+    int8Sums<METRIC, N>(q, v, dim, sums, norms);
+    for (size_t n = 0; n < N; n++) {
+        if constexpr (METRIC == Metric::Cosine) {
+            out[n] = cosineOf(static_cast<float>(sums[n]), qq, static_cast<float>(norms[n]));
+        } else {
+            out[n] = static_cast<float>(sums[n]);
+        }
+    }
+}
+
+template <class T, Metric METRIC, size_t N>
+static inline void scoreGroup(const T *q, const T *const *v, size_t dim, float qq, float *out) noexcept
+{
+    if constexpr (std::is_same_v<T, float>) {
+        floatScores<METRIC, N, N == 1 ? 4 : DISTANCE_UNROLL>(q, v, dim, qq, out);
+    } else {
+        int8Scores<METRIC, N>(q, v, dim, qq, out);
+    }
+}
+
+template <class T, Metric METRIC>
+static inline void scoreAll(const T *query, const T *vectors, size_t count, size_t dim, float *scores) noexcept
+{
+    float qq = 0;
+    if constexpr (METRIC == Metric::Cosine) {
+        scoreGroup<T, Metric::InnerProduct, 1>(query, &query, dim, 0, &qq);
+    }
+
+    constexpr size_t G = DISTANCE_GROUP;
+    const T         *v[G];
+    size_t           i = 0;
+    for (; i + G <= count; i += G) {
+        for (size_t n = 0; n < G; n++) {
+            v[n] = vectors + (i + n) * dim;
+        }
+        scoreGroup<T, METRIC, G>(query, v, dim, qq, scores + i);
+    }
+    for (; i < count; i++) {
+        v[0] = vectors + i * dim;
+        scoreGroup<T, METRIC, 1>(query, v, dim, qq, scores + i);
+    }
+}
+
+template <class T>
+static inline void scoreAll(Metric metric, const T *query, const T *vectors, size_t count, size_t dim, float *scores) noexcept
+{
+    switch (metric) {
+    case Metric::L2:
+        scoreAll<T, Metric::L2>(query, vectors, count, dim, scores);
+        break;
+    case Metric::InnerProduct:
+        scoreAll<T, Metric::InnerProduct>(query, vectors, count, dim, scores);
+        break;
+    case Metric::Cosine:
+        scoreAll<T, Metric::Cosine>(query, vectors, count, dim, scores);
+        break;
+    }
+}
+
+template <class T>
+static inline float scorePair(Metric metric, const T *a, const T *b, size_t dim) noexcept
+{
+    float score;
+    scoreAll(metric, a, b, 1, dim, &score);
+    return score;
+}
+
+} // namespace detail
+} // namespace slimm
+
+/**
+ * @brief Squared Euclidean distance of two float vectors
+ */
+static inline float l2Squared(const float *a, const float *b, size_t dim) noexcept
+{
+    return slimm::detail::scorePair(Metric::L2, a, b, dim);
+}
+
+static inline float innerProduct(const float *a, const float *b, size_t dim) noexcept
+{
+    return slimm::detail::scorePair(Metric::InnerProduct, a, b, dim);
+}
+
+/**
+ * @brief Cosine similarity of two float vectors, 0 if either is zero
+ */
+static inline float cosineSimilarity(const float *a, const float *b, size_t dim) noexcept
+{
+    return slimm::detail::scorePair(Metric::Cosine, a, b, dim);
+}
+
+/**
+ * @brief Squared Euclidean distance of two int8 vectors, exact up to dim = 33025
+ */
+static inline int32_t l2Squared(const int8_t *a, const int8_t *b, size_t dim) noexcept
+{
+    int32_t sum, norm;
+    slimm::detail::int8Sums<Metric::L2, 1>(a, &b, dim, &sum, &norm);
+    return sum;
+}
+
+/**
+ * @brief Inner product of two int8 vectors with components in [-127, 127]
+ */
+static inline int32_t innerProduct(const int8_t *a, const int8_t *b, size_t dim) noexcept
+{
+    int32_t sum, norm;
+    slimm::detail::int8Sums<Metric::InnerProduct, 1>(a, &b, dim, &sum, &norm);
+    return sum;
+}
+
+static inline float cosineSimilarity(const int8_t *a, const int8_t *b, size_t dim) noexcept
+{
+    return slimm::detail::scorePair(Metric::Cosine, a, b, dim);
+}
+
+/**
+ * @brief scores[i] = metric between query and the i-th of count vectors of dim components stored back to back
+ *
+ * Float and int8 vectors are supported; int8 components must be within
+ * [-127, 127] for the inner product and cosine metrics.
+ */
+template <class T>
+static inline void distances(Metric metric, const T *query, const T *vectors, size_t count, size_t dim, float *scores) noexcept
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, int8_t>, "distances supports float and int8_t vectors");
+    slimm::detail::scoreAll(metric, query, vectors, count, dim, scores);
+}
+
+/**
+ * Exact k nearest neighbours of nq queries among count vectors.
+ *
+ * The vectors are scored in blocks of about 256 KB, each block against
+ * every query while it is still in cache, and the scores are kept in a
+ * bounded heap per query. Results go to ids and scores, k per query and
+ * best first: smallest L2, largest inner product or cosine. Returns the
+ * number of results per query, min(k, count).
+ */
+template <class T>
+static inline size_t searchTopK(Metric metric, const T *queries, size_t nq, const T *vectors, size_t count, size_t dim, size_t k,
+                                uint32_t *ids, float *scores)
+{
+    k = std::min(k, count);
+    if (k == 0) {
+        return 0;
+    }
+
+    /* Keys are negated for the similarities, so the best is always the smallest */
+    const float  sign  = metric == Metric::L2 ? 1.0f : -1.0f;
+    const size_t block = std::clamp<size_t>((256 << 10) / std::max<size_t>(dim * sizeof(T), 1), slimm::detail::DISTANCE_GROUP, 4096);
+
+    std::vector<float>                                    buffer(block);
+    std::vector<std::vector<std::pair<float, uint32_t>>> heaps(nq);
+    for (size_t base = 0; base < count; base += block) {
+        size_t m = std::min(block, count - base);
+        for (size_t qi = 0; qi < nq; qi++) {
+            distances(metric, queries + qi * dim, vectors + base * dim, m, dim, buffer.data());
+            auto &heap = heaps[qi];
+            for (size_t j = 0; j < m; j++) {
+                std::pair<float, uint32_t> entry(sign * buffer[j], static_cast<uint32_t>(base + j));
+                if (heap.size() < k) {
+                    heap.push_back(entry);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (entry < heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = entry;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+        }
+    }
+
+    for (size_t qi = 0; qi < nq; qi++) {
+        auto &heap = heaps[qi];
+        std::sort_heap(heap.begin(), heap.end());
+        for (size_t j = 0; j < k; j++) {
+            ids[qi * k + j]    = heap[j].second;
+            scores[qi * k + j] = sign * heap[j].first;
+        }
+    }
+    return k;
+}
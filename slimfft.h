@@ -0,0 +1,546 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <type_traits>
+#include <vector>
+#include "slimcomplex.h"
+
+namespace slimm
+{
+namespace detail
+{
+
+/* One complex number with the interface of the complex vectors, for spans shorter than a register */
+template <class T>
+struct ComplexScalar
+{
+    T re;
+    T im;
+
+    ComplexScalar() noexcept
+    {
+    }
+
+    ComplexScalar(T re, T im) noexcept :
+        re{ re }, im{ im }
+    {
+    }
+
+    ComplexScalar operator+(const ComplexScalar &other) const noexcept
+    {
+        return { re + other.re, im + other.im };
+    }
+
+    ComplexScalar operator-(const ComplexScalar &other) const noexcept
+    {
+        return { re - other.re, im - other.im };
+    }
+
+    ComplexScalar operator*(const ComplexScalar &other) const noexcept
+    {
+        return { re * other.re - im * other.im, re * other.im + im * other.re };
+    }
+
+    void loadu(const std::complex<T> *src) noexcept
+    {
+        re = src->real();
+        im = src->imag();
+    }
+
+    void storeu(std::complex<T> *dst) noexcept
+    {
+        *dst = { re, im };
+    }
+
+    ComplexScalar conj() const noexcept
+    {
+        return { re, -im };
+    }
+
+    ComplexScalar mulI() const noexcept
+    {
+        return { -im, re };
+    }
+};
+
+template <class T>
+struct FftVectors;
+
+template <>
+struct FftVectors<float>
+{
+    using narrow = COMPLEXFX4;
+#if defined(__AVX512F__)
+    using wide = COMPLEXFX8;
+#else
+    using wide = COMPLEXFX4;
+#endif
+    /* Smallest size the transposed first stage handles */
+    static constexpr size_t FIRST = 16;
+};
+
+template <>
+struct FftVectors<double>
+{
+    using narrow = COMPLEXDX2;
+#if defined(__AVX512F__)
+    using wide = COMPLEXDX4;
+#else
+    using wide = COMPLEXDX2;
+#endif
+    static constexpr size_t FIRST = 8;
+};
+
+template <class V, class T>
+constexpr size_t FFT_LANES = sizeof(V) / sizeof(std::complex<T>);
+
+static inline COMPLEXFX4 fftReverse(const COMPLEXFX4 &x) noexcept
+{
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(x), 0x1B));
+}
+
+static inline COMPLEXDX2 fftReverse(const COMPLEXDX2 &x) noexcept
+{
+    return _mm256_permute2f128_pd(x, x, 0x01);
+}
+
+template <class T>
+static inline ComplexScalar<T> fftReverse(const ComplexScalar<T> &x) noexcept
+{
+    return x;
+}
+
+/*
+ * Radix-4 decimation in time on twiddled inputs. The sub-transforms sit in
+ * bit-reversed order, so x1 is the transform of the inputs 2 mod 4 and x2
+ * that of the inputs 1 mod 4.
+ */
+template <class V>
+static inline void fftButterfly4(V &x0, V &x1, V &x2, V &x3) noexcept
+{
+    V t0 = x0 + x1;
+    V t1 = x0 - x1;
+    V t2 = x2 + x3;
+    V t3 = (x3 - x2).mulI();
+    x0   = t0 + t2;
+    x1   = t1 + t3;
+    x2   = t0 - t2;
+    x3   = t1 - t3;
+}
+
+/* Joins spans of m into transforms of 4m; w holds W^k, W^2k and W^3k of 4m, m apart */
+template <class V, class T>
+static inline void fftRadix4(std::complex<T> *data, size_t n, size_t m, const std::complex<T> *w) noexcept
+{
+    constexpr size_t L = FFT_LANES<V, T>;
+
+    for (size_t base = 0; base < n; base += 4 * m) {
+        std::complex<T> *p = data + base;
+        for (size_t k = 0; k < m; k += L) {
+            V x0, x1, x2, x3, w1, w2, w3;
+            x0.loadu(p + k);
+            x1.loadu(p + m + k);
+            x2.loadu(p + 2 * m + k);
+            x3.loadu(p + 3 * m + k);
+            w1.loadu(w + k);
+            w2.loadu(w + m + k);
+            w3.loadu(w + 2 * m + k);
+            x1 = x1 * w2;
+            x2 = x2 * w1;
+            x3 = x3 * w3;
+            fftButterfly4(x0, x1, x2, x3);
+            x0.storeu(p + k);
+            x1.storeu(p + m + k);
+            x2.storeu(p + 2 * m + k);
+            x3.storeu(p + 3 * m + k);
+        }
+    }
+}
+
+/* Joins the two halves of the data into one transform */
+template <class V, class T>
+static inline void fftRadix2(std::complex<T> *data, size_t m, const std::complex<T> *w) noexcept
+{
+    constexpr size_t L = FFT_LANES<V, T>;
+
+    for (size_t k = 0; k < m; k += L) {
+        V a, b, t;
+        a.loadu(data + k);
+        b.loadu(data + m + k);
+        t.loadu(w + k);
+        b = b * t;
+        (a + b).storeu(data + k);
+        (a - b).storeu(data + m + k);
+    }
+}
+
+/* The first radix-4 stage has no twiddles; 4 x 4 transposes put each of the 4 inputs of a butterfly in its own register */
+static inline void fftTranspose4x4(__m256d r[4]) noexcept
+{
+    __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]);
+    __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]);
+    __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]);
+    __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]);
+    r[0]       = _mm256_permute2f128_pd(t0, t2, 0x20);
+    r[1]       = _mm256_permute2f128_pd(t1, t3, 0x20);
+    r[2]       = _mm256_permute2f128_pd(t0, t2, 0x31);
+    r[3]       = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+static inline void fftFirstRadix4(std::complex<float> *data, size_t n) noexcept
+{
+    float *p = reinterpret_cast<float *>(data);
+    for (size_t i = 0; i < 2 * n; i += 32) {
+        __m256d r[4];
+        for (size_t j = 0; j < 4; j++) {
+            r[j] = _mm256_castps_pd(_mm256_loadu_ps(p + i + 8 * j));
+        }
+        fftTranspose4x4(r);
+        COMPLEXFX4 x0(_mm256_castpd_ps(r[0])), x1(_mm256_castpd_ps(r[1])), x2(_mm256_castpd_ps(r[2])), x3(_mm256_castpd_ps(r[3]));
+        fftButterfly4(x0, x1, x2, x3);
+        r[0] = _mm256_castps_pd(x0);
+        r[1] = _mm256_castps_pd(x1);
+        r[2] = _mm256_castps_pd(x2);
+        r[3] = _mm256_castps_pd(x3);
+        fftTranspose4x4(r);
+        for (size_t j = 0; j < 4; j++) {
+            _mm256_storeu_ps(p + i + 8 * j, _mm256_castpd_ps(r[j]));
+        }
+    }
+}
+
+static inline void fftFirstRadix4(std::complex<double> *data, size_t n) noexcept
+{
+    double *p = reinterpret_cast<double *>(data);
+    for (size_t i = 0; i < 2 * n; i += 16) {
+        __m256d v0 = _mm256_loadu_pd(p + i);
+        __m256d v1 = _mm256_loadu_pd(p + i + 4);
+        __m256d v2 = _mm256_loadu_pd(p + i + 8);
+        __m256d v3 = _mm256_loadu_pd(p + i + 12);
+        COMPLEXDX2 x0(_mm256_permute2f128_pd(v0, v2, 0x20));
+        COMPLEXDX2 x1(_mm256_permute2f128_pd(v0, v2, 0x31));
+        COMPLEXDX2 x2(_mm256_permute2f128_pd(v1, v3, 0x20));
+        COMPLEXDX2 x3(_mm256_permute2f128_pd(v1, v3, 0x31));
+        fftButterfly4(x0, x1, x2, x3);
+        _mm256_storeu_pd(p + i, _mm256_permute2f128_pd(x0, x1, 0x20));
+        _mm256_storeu_pd(p + i + 4, _mm256_permute2f128_pd(x2, x3, 0x20));
+        _mm256_storeu_pd(p + i + 8, _mm256_permute2f128_pd(x0, x1, 0x31));
+        _mm256_storeu_pd(p + i + 12, _mm256_permute2f128_pd(x2, x3, 0x31));
+    }
+}
+
+/* data[i] = conj(data[i]) * scale */
+template <class T>
+static inline void fftConjugate(std::complex<T> *data, size_t n, T scale) noexcept
+{
+    using V            = typename FftVectors<T>::wide;
+    constexpr size_t L = FFT_LANES<V, T>;
+
+    V      s(scale, T(0));
+    size_t i = 0;
+    for (; i + L <= n; i += L) {
+        V x;
+        x.loadu(data + i);
+        (x.conj() * s).storeu(data + i);
+    }
+    for (; i < n; i++) {
+        data[i] = std::conj(data[i]) * scale;
+    }
+}
+
+/*
+ * Splits the transform z of the even and odd samples of a real signal into
+ * its spectrum: with A = z[k] and B = conj(z[m - k]), X[k] = P A + Q B and
+ * X[m - k] = conj(Q A + P B). The inverse runs the same pairs backwards on
+ * conjugated coefficients and writes conj(z), ready for the conjugated
+ * forward transform.
+ */
+template <bool INVERSE, class V, class T>
+static inline size_t fftRealPairs(const std::complex<T> *src, std::complex<T> *dst, size_t m, const std::complex<T> *p,
+                                  const std::complex<T> *q, size_t k, size_t limit) noexcept
+{
+    constexpr size_t L = FFT_LANES<V, T>;
+
+    for (; k + L <= limit; k += L) {
+        size_t j = m - k - (L - 1);
+        V      a, b, pk, qk;
+        a.loadu(src + k);
+        b.loadu(src + j);
+        pk.loadu(p + k);
+        qk.loadu(q + k);
+        b = fftReverse(b).conj();
+        if constexpr (INVERSE) {
+            pk = pk.conj();
+            qk = qk.conj();
+            (pk * a + qk * b).conj().storeu(dst + k);
+            fftReverse(qk * a + pk * b).storeu(dst + j);
+        } else {
+            (pk * a + qk * b).storeu(dst + k);
+            fftReverse((qk * a + pk * b).conj()).storeu(dst + j);
+        }
+    }
+    return k;
+}
+
+} // namespace detail
+} // namespace slimm
+
+/**
+ * Precomputed bit reversal and twiddles for power-of-two transforms.
+ *
+ * The transform runs in place: a bit-reversal permutation, radix-4 stages
+ * from the shortest span up and a final radix-2 stage when the size is an
+ * odd power of two. Stages use the widest complex vector that fits their
+ * span. Plans are immutable and shared through get(), which caches one
+ * plan per size.
+ */
+template <class T>
+class FftPlan
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "FftPlan supports float and double");
+
+public:
+    explicit FftPlan(size_t n) :
+        n{ n }
+    {
+        const unsigned bits = std::countr_zero(n);
+        reversed.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            reversed[i] = bits ? static_cast<uint32_t>(reverse(i) >> (64 - bits)) : 0;
+        }
+
+        size_t m = 1;
+        for (; 4 * m <= n; m *= 4) {
+            for (size_t r = 1; r <= 3; r++) {
+                for (size_t k = 0; k < m; k++) {
+                    twiddles.push_back(root(r * k, 4 * m));
+                }
+            }
+        }
+        if (m < n) {
+            for (size_t k = 0; k < m; k++) {
+                twiddles.push_back(root(k, n));
+            }
+        }
+
+        /* P and Q of the real transform of 2n samples, k <= n / 2 */
+        half = n / 2 + 1;
+        spectral.resize(2 * half);
+        for (size_t k = 0; k < half; k++) {
+            std::complex<double> g = std::complex<double>(0, -0.5) * std::complex<double>(root(k, 2 * n));
+            spectral[k]            = std::complex<T>(0.5 + g);
+            spectral[half + k]     = std::complex<T>(0.5 - g);
+        }
+    }
+
+    size_t size() const noexcept
+    {
+        return n;
+    }
+
+    /**
+     * @brief In-place forward transform, X[k] = sum of x[j] e^(-2 pi i jk / n)
+     */
+    void forward(std::complex<T> *data) const noexcept
+    {
+        transform(data);
+    }
+
+    /**
+     * @brief In-place inverse transform, scaled by 1 / n
+     */
+    void inverse(std::complex<T> *data) const noexcept
+    {
+        slimm::detail::fftConjugate(data, n, T(1));
+        transform(data);
+        slimm::detail::fftConjugate(data, n, T(1) / n);
+    }
+
+    /**
+     * @brief Spectrum of 2 * size() real samples, size() + 1 bins from 0 to Nyquist
+     */
+    void forwardReal(const T *src, std::complex<T> *dst) const noexcept
+    {
+        using V = typename slimm::detail::FftVectors<T>::narrow;
+        using S = slimm::detail::ComplexScalar<T>;
+
+        std::memcpy(static_cast<void *>(dst), src, 2 * n * sizeof(T));
+        transform(dst);
+
+        const std::complex<T> *p = spectral.data();
+        const std::complex<T> *q = p + half;
+        std::complex<T>        z = dst[0];
+        dst[0]                   = z.real() + z.imag();
+        dst[n]                   = z.real() - z.imag();
+        size_t k = slimm::detail::fftRealPairs<false, V>(dst, dst, n, p, q, 1, n / 2);
+        slimm::detail::fftRealPairs<false, S>(dst, dst, n, p, q, k, n / 2 + 1);
+    }
+
+    /**
+     * @brief 2 * size() real samples from size() + 1 bins, scaled by 1 / (2 * size())
+     */
+    void inverseReal(const std::complex<T> *src, T *dst) const noexcept
+    {
+        using V = typename slimm::detail::FftVectors<T>::narrow;
+        using S = slimm::detail::ComplexScalar<T>;
+
+        std::complex<T>       *z = reinterpret_cast<std::complex<T> *>(dst);
+        const std::complex<T> *p = spectral.data();
+        const std::complex<T> *q = p + half;
+        T                      e = (src[0].real() + src[n].real()) / 2;
+        T                      o = (src[0].real() - src[n].real()) / 2;
+        z[0]                     = { e, -o };
+        size_t k = slimm::detail::fftRealPairs<true, V>(src, z, n, p, q, 1, n / 2);
+        slimm::detail::fftRealPairs<true, S>(src, z, n, p, q, k, n / 2 + 1);
+        transform(z);
+        slimm::detail::fftConjugate(z, n, T(1) / n);
+    }
+
+    /**
+     * @brief The shared plan of size n, a power of two
+     */
+    static const FftPlan &get(size_t n)
+    {
+        static std::mutex               lock;
+        static std::unique_ptr<FftPlan> plans[64];
+
+        std::lock_guard<std::mutex> guard(lock);
+        std::unique_ptr<FftPlan>   &plan = plans[std::countr_zero(n)];
+        if (!plan) {
+            plan = std::make_unique<FftPlan>(n);
+        }
+        return *plan;
+    }
+
+private:
+    static uint64_t reverse(uint64_t x) noexcept
+    {
+        x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+#if defined(_MSC_VER)
+        return _byteswap_uint64(x);
+#else
+        return __builtin_bswap64(x);
+#endif
+    }
+
+    static std::complex<T> root(size_t k, size_t n) noexcept
+    {
+        double angle = -2 * std::numbers::pi * static_cast<double>(k) / static_cast<double>(n);
+        return std::complex<T>(std::cos(angle), std::sin(angle));
+    }
+
+    template <class F>
+    static void stage(size_t span, F &&fn) noexcept
+    {
+        using Vectors = slimm::detail::FftVectors<T>;
+        using Wide    = typename Vectors::wide;
+        using Narrow  = typename Vectors::narrow;
+
+        if (span >= slimm::detail::FFT_LANES<Wide, T>) {
+            fn(std::type_identity<Wide>{});
+        } else if (span >= slimm::detail::FFT_LANES<Narrow, T>) {
+            fn(std::type_identity<Narrow>{});
+        } else {
+            fn(std::type_identity<slimm::detail::ComplexScalar<T>>{});
+        }
+    }
+
+    void transform(std::complex<T> *data) const noexcept
+    {
+        for (size_t i = 0; i < n; i++) {
+            size_t j = reversed[i];
+            if (i < j) {
+                std::swap(data[i], data[j]);
+            }
+        }
+
+        size_t                 m = 1;
+        const std::complex<T> *w = twiddles.data();
+        if (n >= slimm::detail::FftVectors<T>::FIRST) {
+            slimm::detail::fftFirstRadix4(data, n);
+            m = 4;
+            w += 3;
+        }
+        for (; 4 * m <= n; m *= 4) {
+            stage(m, [&]<class V>(std::type_identity<V>) { slimm::detail::fftRadix4<V>(data, n, m, w); });
+            w += 3 * m;
+        }
+        if (m < n) {
+            stage(m, [&]<class V>(std::type_identity<V>) { slimm::detail::fftRadix2<V>(data, m, w); });
+        }
+    }
+
+    size_t                       n;
+    size_t                       half;
+    std::vector<uint32_t>        reversed;
+    std::vector<std::complex<T>> twiddles;
+    std::vector<std::complex<T>> spectral;
+};
+
+/**
+ * @brief In-place forward FFT of n points; false when n is not a power of two
+ */
+template <class T>
+static inline bool fft(std::complex<T> *data, size_t n)
+{
+    if (!std::has_single_bit(n)) {
+        return false;
+    }
+    FftPlan<T>::get(n).forward(data);
+    return true;
+}
+
+/**
+ * @brief In-place inverse FFT of n points scaled by 1 / n; false when n is not a power of two
+ */
+template <class T>
+static inline bool ifft(std::complex<T> *data, size_t n)
+{
+    if (!std::has_single_bit(n)) {
+        return false;
+    }
+    FftPlan<T>::get(n).inverse(data);
+    return true;
+}
+
+/**
+ * @brief FFT of n real samples into n / 2 + 1 bins; false unless n is a power of two of at least 2
+ */
+template <class T>
+static inline bool rfft(const T *src, std::complex<T> *dst, size_t n)
+{
+    if (n < 2 || !std::has_single_bit(n)) {
+        return false;
+    }
+    FftPlan<T>::get(n / 2).forwardReal(src, dst);
+    return true;
+}
+
+/**
+ * @brief n real samples from n / 2 + 1 bins, scaled by 1 / n so that irfft(rfft(x)) == x
+ */
+template <class T>
+static inline bool irfft(const std::complex<T> *src, T *dst, size_t n)
+{
+    if (n < 2 || !std::has_single_bit(n)) {
+        return false;
+    }
+    FftPlan<T>::get(n / 2).inverseReal(src, dst);
+    return true;
+}
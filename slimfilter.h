@@ -0,0 +1,346 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include "slimmintrin.h"
+#include "slimbits.h"
+
+namespace slimm::detail
+{
+
+/**
+ * Lane comparisons of the filter kernels. Every comparison returns a plain
+ * bitmask with one bit per lane, so that predicates over columns of
+ * different widths can be and-ed together.
+ */
+template <class V>
+struct FilterLanes;
+
+template <>
+struct FilterLanes<INT32X16>
+{
+    using scalar = int32_t;
+    using raw    = __m512i;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi32(x); }
+    static unsigned lt(raw a, raw b) noexcept { return _mm512_cmplt_epi32_mask(a, b); }
+    static unsigned le(raw a, raw b) noexcept { return _mm512_cmple_epi32_mask(a, b); }
+    static unsigned gt(raw a, raw b) noexcept { return _mm512_cmpgt_epi32_mask(a, b); }
+    static unsigned ge(raw a, raw b) noexcept { return _mm512_cmpge_epi32_mask(a, b); }
+    static unsigned eq(raw a, raw b) noexcept { return _mm512_cmpeq_epi32_mask(a, b); }
+    static unsigned ne(raw a, raw b) noexcept { return _mm512_cmpneq_epi32_mask(a, b); }
+};
+
+template <>
+struct FilterLanes<INT64X8>
+{
+    using scalar = int64_t;
+    using raw    = __m512i;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi64(x); }
+    static unsigned lt(raw a, raw b) noexcept { return _mm512_cmplt_epi64_mask(a, b); }
+    static unsigned le(raw a, raw b) noexcept { return _mm512_cmple_epi64_mask(a, b); }
+    static unsigned gt(raw a, raw b) noexcept { return _mm512_cmpgt_epi64_mask(a, b); }
+    static unsigned ge(raw a, raw b) noexcept { return _mm512_cmpge_epi64_mask(a, b); }
+    static unsigned eq(raw a, raw b) noexcept { return _mm512_cmpeq_epi64_mask(a, b); }
+    static unsigned ne(raw a, raw b) noexcept { return _mm512_cmpneq_epi64_mask(a, b); }
+};
+
+template <>
+struct FilterLanes<FLOATX16>
+{
+    using scalar = float;
+    using raw    = __m512;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_ps(p); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_ps(x); }
+    static unsigned lt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static unsigned le(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static unsigned gt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static unsigned ge(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static unsigned eq(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static unsigned ne(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+};
+
+template <>
+struct FilterLanes<INT32X8>
+{
+    using scalar = int32_t;
+    using raw    = __m256i;
+
+    static constexpr size_t lanes = 8;
+
+    static unsigned bits(__m256i m) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi32(x); }
+    static unsigned lt(raw a, raw b) noexcept { return bits(_mm256_cmpgt_epi32(b, a)); }
+    static unsigned le(raw a, raw b) noexcept { return gt(a, b) ^ 0xFF; }
+    static unsigned gt(raw a, raw b) noexcept { return bits(_mm256_cmpgt_epi32(a, b)); }
+    static unsigned ge(raw a, raw b) noexcept { return lt(a, b) ^ 0xFF; }
+    static unsigned eq(raw a, raw b) noexcept { return bits(_mm256_cmpeq_epi32(a, b)); }
+    static unsigned ne(raw a, raw b) noexcept { return eq(a, b) ^ 0xFF; }
+};
+
+template <>
+struct FilterLanes<INT64X4>
+{
+    using scalar = int64_t;
+    using raw    = __m256i;
+
+    static constexpr size_t lanes = 4;
+
+    static unsigned bits(__m256i m) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi64x(x); }
+    static unsigned lt(raw a, raw b) noexcept { return bits(_mm256_cmpgt_epi64(b, a)); }
+    static unsigned le(raw a, raw b) noexcept { return gt(a, b) ^ 0xF; }
+    static unsigned gt(raw a, raw b) noexcept { return bits(_mm256_cmpgt_epi64(a, b)); }
+    static unsigned ge(raw a, raw b) noexcept { return lt(a, b) ^ 0xF; }
+    static unsigned eq(raw a, raw b) noexcept { return bits(_mm256_cmpeq_epi64(a, b)); }
+    static unsigned ne(raw a, raw b) noexcept { return eq(a, b) ^ 0xF; }
+};
+
+template <>
+struct FilterLanes<FLOATX8>
+{
+    using scalar = float;
+    using raw    = __m256;
+
+    static constexpr size_t lanes = 8;
+
+    template <int cmp>
+    static unsigned compare(raw a, raw b) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, cmp))); }
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_ps(p); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_ps(x); }
+    static unsigned lt(raw a, raw b) noexcept { return compare<_CMP_LT_OQ>(a, b); }
+    static unsigned le(raw a, raw b) noexcept { return compare<_CMP_LE_OQ>(a, b); }
+    static unsigned gt(raw a, raw b) noexcept { return compare<_CMP_GT_OQ>(a, b); }
+    static unsigned ge(raw a, raw b) noexcept { return compare<_CMP_GE_OQ>(a, b); }
+    static unsigned eq(raw a, raw b) noexcept { return compare<_CMP_EQ_OQ>(a, b); }
+    static unsigned ne(raw a, raw b) noexcept { return compare<_CMP_NEQ_UQ>(a, b); }
+};
+
+template <class T>
+struct FilterTraits;
+
+#if defined(__AVX512F__)
+/* Rows per block: one 512-bit register of 32-bit values */
+static constexpr size_t FILTER_BLOCK = 16;
+
+template <> struct FilterTraits<int32_t> { using type = FilterLanes<INT32X16>; };
+template <> struct FilterTraits<int64_t> { using type = FilterLanes<INT64X8>; };
+template <> struct FilterTraits<float>   { using type = FilterLanes<FLOATX16>; };
+#else
+static constexpr size_t FILTER_BLOCK = 8;
+
+template <> struct FilterTraits<int32_t> { using type = FilterLanes<INT32X8>; };
+template <> struct FilterTraits<int64_t> { using type = FilterLanes<INT64X4>; };
+template <> struct FilterTraits<float>   { using type = FilterLanes<FLOATX8>; };
+#endif
+
+/**
+ * One column and the predicate it has to satisfy. A block of
+ * FILTER_BLOCK rows is tested with as many registers as the column width
+ * requires, and the lane masks are concatenated into one row mask.
+ */
+template <class T, class Pred>
+struct FilterColumn
+{
+    using Ops = typename FilterTraits<T>::type;
+
+    const T *data;
+    Pred     pred;
+
+    unsigned test(size_t row) const noexcept
+    {
+        unsigned m = 0;
+        for (size_t i = 0; i < FILTER_BLOCK; i += Ops::lanes) {
+            m |= pred.template test<Ops>(Ops::loadu(data + row + i)) << i;
+        }
+        return m;
+    }
+
+    /* The last count < FILTER_BLOCK rows, tested from a zero-padded copy */
+    unsigned testTail(size_t row, size_t count) const noexcept
+    {
+        alignas(64) T tail[FILTER_BLOCK] = {};
+        std::memcpy(tail, data + row, count * sizeof(T));
+        unsigned m = 0;
+        for (size_t i = 0; i < FILTER_BLOCK; i += Ops::lanes) {
+            m |= pred.template test<Ops>(Ops::loadu(tail + i)) << i;
+        }
+        return m;
+    }
+};
+
+/**
+ * Writes the ids of the rows selected by m, starting at row, to out and
+ * returns how many there are. A whole register is always stored; the
+ * lanes past the count land on slots that later rows overwrite, and they
+ * stay within the first row + FILTER_BLOCK slots, which out may use.
+ */
+static inline size_t compressRows(uint32_t *out, unsigned m, size_t row) noexcept
+{
+#if defined(__AVX512F__)
+    const __m512i iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512i ids = _mm512_add_epi32(iota, _mm512_set1_epi32(static_cast<int>(row)));
+    _mm512_storeu_si512(out, _mm512_maskz_compress_epi32(static_cast<__mmask16>(m), ids));
+#else
+    __m256i ids = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<int64_t>(BIT_POSITIONS[m])));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), _mm256_add_epi32(ids, _mm256_set1_epi32(static_cast<int>(row))));
+#endif
+    return static_cast<size_t>(_mm_popcnt_u32(m));
+}
+
+template <class... Columns>
+static inline size_t filterRows(size_t n, uint32_t *rows, const Columns &...columns) noexcept
+{
+    uint32_t *out = rows;
+
+    size_t row = 0;
+    for (; row + FILTER_BLOCK <= n; row += FILTER_BLOCK) {
+        unsigned m = (columns.test(row) & ...);
+        out += compressRows(out, m, row);
+    }
+    if (row < n) {
+        unsigned m = (columns.testTail(row, n - row) & ...) & ((1U << (n - row)) - 1);
+        for (; m != 0; m &= m - 1) {
+            *out++ = static_cast<uint32_t>(row + std::countr_zero(m));
+        }
+    }
+    return static_cast<size_t>(out - rows);
+}
+
+} // namespace slimm::detail
+
+/**
+ * Predicates for filter(). test<Ops>() evaluates the predicate on every
+ * lane of a register after converting the bounds to the column type.
+ * Comparisons involving NaN are false, except NotEqual.
+ */
+template <class T>
+struct Less
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::lt(x, Ops::set1(value)); }
+};
+
+template <class T>
+struct LessEqual
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::le(x, Ops::set1(value)); }
+};
+
+template <class T>
+struct Greater
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::gt(x, Ops::set1(value)); }
+};
+
+template <class T>
+struct GreaterEqual
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::ge(x, Ops::set1(value)); }
+};
+
+template <class T>
+struct Equal
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::eq(x, Ops::set1(value)); }
+};
+
+template <class T>
+struct NotEqual
+{
+    T value;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::ne(x, Ops::set1(value)); }
+};
+
+/* lo <= x < hi */
+template <class T>
+struct Range
+{
+    T lo;
+    T hi;
+
+    template <class Ops> unsigned test(typename Ops::raw x) const noexcept { return Ops::ge(x, Ops::set1(lo)) & Ops::lt(x, Ops::set1(hi)); }
+};
+
+/* x equals one of count values; every value costs one compare per register */
+template <class T>
+struct InList
+{
+    const T *values;
+    size_t   count;
+
+    template <class Ops>
+    unsigned test(typename Ops::raw x) const noexcept
+    {
+        unsigned m = 0;
+        for (size_t i = 0; i < count; i++) {
+            m |= Ops::eq(x, Ops::set1(values[i]));
+        }
+        return m;
+    }
+};
+
+/**
+ * @brief Pairs a column with a predicate for the multi-column filter()
+ */
+template <class T, class Pred>
+static inline slimm::detail::FilterColumn<T, Pred> where(const T *column, const Pred &pred) noexcept
+{
+    return { column, pred };
+}
+
+/**
+ * @brief Writes the ids of the rows of column that satisfy pred and returns how many there are
+ *
+ * rows needs room for n ids. The kernel compresses a block of row ids
+ * with AVX-512 compress or an AVX2 permutation table and has no branch
+ * that depends on the data, so its speed does not depend on selectivity.
+ */
+template <class T, class Pred>
+static inline size_t filter(const T *column, size_t n, uint32_t *rows, const Pred &pred) noexcept
+{
+    return slimm::detail::filterRows(n, rows, where(column, pred));
+}
+
+/**
+ * @brief Selects the rows that satisfy every where() clause, in a single pass
+ *
+ * The columns may mix int32_t, int64_t and float and must hold n rows each.
+ */
+template <class... Columns>
+static inline size_t filter(size_t n, uint32_t *rows, const Columns &...columns) noexcept
+{
+    return slimm::detail::filterRows(n, rows, columns...);
+}
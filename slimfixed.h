@@ -0,0 +1,669 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "slimmintrin.h"
+
+/**
+ * Signed fixed-point vectors: Q15 lanes are int16_t with 15 fraction bits
+ * and Q31 lanes int32_t with 31, both covering [-1, 1). Arithmetic follows
+ * the usual DSP rules: add and subtract saturate, and multiply rounds to
+ * nearest and saturates the single overflowing case, -1 * -1. Q15X8 and
+ * Q31X4 need SSE4.1, Q15X16 and Q31X8 AVX2, Q15X32 AVX-512BW and Q31X16
+ * AVX-512F. The one exception is Q15X8's FLOATX8 conversions, which need
+ * AVX2; its FLOATX4 pair conversions stay within SSE4.1.
+ *
+ * Q15 multiplication is one mulhrs plus the -1 * -1 fix. x86 has no Q31
+ * counterpart, so the even and odd lanes are multiplied to 64 bits with
+ * mul_epi32, rounded, and their bits 31..62 blended back together.
+ * Saturating Q31 addition compares signs, since there is no adds_epi32.
+ *
+ * Conversions from float scale by 2^15 or 2^31, clamp to the
+ * representable range (NaN becomes -1) and round to nearest even.
+ * Converting Q31 to float keeps 24 of its 31 bits.
+ */
+struct Q15X8
+{
+public:
+    using value_type = __m128i;
+
+    Q15X8() noexcept
+    {
+    }
+
+    Q15X8(__m128i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q15 value */
+    Q15X8(int16_t raw) noexcept :
+        v{ _mm_set1_epi16(raw) }
+    {
+    }
+
+    Q15X8 operator+(const Q15X8 &other) const noexcept
+    {
+        return _mm_adds_epi16(v, other.v);
+    }
+
+    Q15X8 operator-(const Q15X8 &other) const noexcept
+    {
+        return _mm_subs_epi16(v, other.v);
+    }
+
+    Q15X8 operator-() const noexcept
+    {
+        return _mm_subs_epi16(_mm_setzero_si128(), v);
+    }
+
+    Q15X8 operator*(const Q15X8 &other) const noexcept
+    {
+        __m128i r = _mm_mulhrs_epi16(v, other.v);
+        return _mm_xor_si128(r, _mm_cmpeq_epi16(r, _mm_set1_epi16(INT16_MIN)));
+    }
+
+    operator __m128i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m128i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int16_t *src) noexcept
+    {
+        v = _mm_load_si128(reinterpret_cast<const __m128i *>(src));
+    }
+
+    void store(int16_t *dst) noexcept
+    {
+        _mm_store_si128(reinterpret_cast<__m128i *>(dst), v);
+    }
+
+    void loadu(const int16_t *src) noexcept
+    {
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    }
+
+    void storeu(int16_t *dst) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q15X8 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 15, "shift must be in [1, 15]");
+        __m128i half = _mm_and_si128(_mm_srai_epi16(v, n - 1), _mm_set1_epi16(1));
+        return _mm_add_epi16(_mm_srai_epi16(v, n), half);
+    }
+
+    /** @brief Lanes 0..3 from lo and 4..7 from hi */
+    static Q15X8 fromFloat(const FLOATX4 &lo, const FLOATX4 &hi) noexcept
+    {
+        __m128  scale = _mm_set1_ps(32768.0f);
+        __m128  min   = _mm_set1_ps(-32768.0f);
+        __m128  max   = _mm_set1_ps(32767.0f);
+        __m128i a     = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(lo.v, scale), min), max));
+        __m128i b     = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(hi.v, scale), min), max));
+        return _mm_packs_epi32(a, b);
+    }
+
+    static Q15X8 fromFloat(const FLOATX8 &x) noexcept
+    {
+        __m256  s = _mm256_mul_ps(x.v, _mm256_set1_ps(32768.0f));
+        __m256i i = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(s, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f)));
+        return _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extracti128_si256(i, 1));
+    }
+
+    void toFloat(FLOATX4 &lo, FLOATX4 &hi) const noexcept
+    {
+        __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(v)), scale);
+        hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_unpackhi_epi64(v, v))), scale);
+    }
+
+    FLOATX8 toFloat() const noexcept
+    {
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(v)), _mm256_set1_ps(1.0f / 32768.0f));
+    }
+
+public:
+    __m128i v;
+};
+
+struct Q15X16
+{
+public:
+    using value_type = __m256i;
+
+    Q15X16() noexcept
+    {
+    }
+
+    Q15X16(__m256i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q15 value */
+    Q15X16(int16_t raw) noexcept :
+        v{ _mm256_set1_epi16(raw) }
+    {
+    }
+
+    Q15X16 operator+(const Q15X16 &other) const noexcept
+    {
+        return _mm256_adds_epi16(v, other.v);
+    }
+
+    Q15X16 operator-(const Q15X16 &other) const noexcept
+    {
+        return _mm256_subs_epi16(v, other.v);
+    }
+
+    Q15X16 operator-() const noexcept
+    {
+        return _mm256_subs_epi16(_mm256_setzero_si256(), v);
+    }
+
+    Q15X16 operator*(const Q15X16 &other) const noexcept
+    {
+        __m256i r = _mm256_mulhrs_epi16(v, other.v);
+        return _mm256_xor_si256(r, _mm256_cmpeq_epi16(r, _mm256_set1_epi16(INT16_MIN)));
+    }
+
+    operator __m256i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m256i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int16_t *src) noexcept
+    {
+        v = _mm256_load_si256(reinterpret_cast<const __m256i *>(src));
+    }
+
+    void store(int16_t *dst) noexcept
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(dst), v);
+    }
+
+    void loadu(const int16_t *src) noexcept
+    {
+        v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    }
+
+    void storeu(int16_t *dst) noexcept
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q15X16 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 15, "shift must be in [1, 15]");
+        __m256i half = _mm256_and_si256(_mm256_srai_epi16(v, n - 1), _mm256_set1_epi16(1));
+        return _mm256_add_epi16(_mm256_srai_epi16(v, n), half);
+    }
+
+    /** @brief Lanes 0..7 from lo and 8..15 from hi */
+    static Q15X16 fromFloat(const FLOATX8 &lo, const FLOATX8 &hi) noexcept
+    {
+        __m256  scale = _mm256_set1_ps(32768.0f);
+        __m256  min   = _mm256_set1_ps(-32768.0f);
+        __m256  max   = _mm256_set1_ps(32767.0f);
+        __m256i a     = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(lo.v, scale), min), max));
+        __m256i b     = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(hi.v, scale), min), max));
+        return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    }
+
+    void toFloat(FLOATX8 &lo, FLOATX8 &hi) const noexcept
+    {
+        __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        lo = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v))), scale);
+        hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1))), scale);
+    }
+
+public:
+    __m256i v;
+};
+
+struct Q15X32
+{
+public:
+    using value_type = __m512i;
+
+    Q15X32() noexcept
+    {
+    }
+
+    Q15X32(__m512i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q15 value */
+    Q15X32(int16_t raw) noexcept :
+        v{ _mm512_set1_epi16(raw) }
+    {
+    }
+
+    Q15X32 operator+(const Q15X32 &other) const noexcept
+    {
+        return _mm512_adds_epi16(v, other.v);
+    }
+
+    Q15X32 operator-(const Q15X32 &other) const noexcept
+    {
+        return _mm512_subs_epi16(v, other.v);
+    }
+
+    Q15X32 operator-() const noexcept
+    {
+        return _mm512_subs_epi16(_mm512_setzero_si512(), v);
+    }
+
+    Q15X32 operator*(const Q15X32 &other) const noexcept
+    {
+        __m512i r = _mm512_mulhrs_epi16(v, other.v);
+        return _mm512_mask_blend_epi16(_mm512_cmpeq_epi16_mask(r, _mm512_set1_epi16(INT16_MIN)), r, _mm512_set1_epi16(INT16_MAX));
+    }
+
+    operator __m512i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m512i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int16_t *src) noexcept
+    {
+        v = _mm512_load_si512(src);
+    }
+
+    void store(int16_t *dst) noexcept
+    {
+        _mm512_store_si512(dst, v);
+    }
+
+    void loadu(const int16_t *src) noexcept
+    {
+        v = _mm512_loadu_si512(src);
+    }
+
+    void storeu(int16_t *dst) noexcept
+    {
+        _mm512_storeu_si512(dst, v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q15X32 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 15, "shift must be in [1, 15]");
+        __m512i half = _mm512_and_si512(_mm512_srai_epi16(v, n - 1), _mm512_set1_epi16(1));
+        return _mm512_add_epi16(_mm512_srai_epi16(v, n), half);
+    }
+
+    /** @brief Lanes 0..15 from lo and 16..31 from hi */
+    static Q15X32 fromFloat(const FLOATX16 &lo, const FLOATX16 &hi) noexcept
+    {
+        __m512  scale = _mm512_set1_ps(32768.0f);
+        __m512  min   = _mm512_set1_ps(-32768.0f);
+        __m512  max   = _mm512_set1_ps(32767.0f);
+        __m512i a     = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(lo.v, scale), min), max));
+        __m512i b     = _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(hi.v, scale), min), max));
+        return _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtepi32_epi16(a)), _mm512_cvtepi32_epi16(b), 1);
+    }
+
+    void toFloat(FLOATX16 &lo, FLOATX16 &hi) const noexcept
+    {
+        __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+        lo = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_castsi512_si256(v))), scale);
+        hi = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_cvtepi16_epi32(_mm512_extracti64x4_epi64(v, 1))), scale);
+    }
+
+public:
+    __m512i v;
+};
+
+struct Q31X4
+{
+public:
+    using value_type = __m128i;
+
+    Q31X4() noexcept
+    {
+    }
+
+    Q31X4(__m128i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q31 value */
+    Q31X4(int32_t raw) noexcept :
+        v{ _mm_set1_epi32(raw) }
+    {
+    }
+
+    Q31X4 operator+(const Q31X4 &other) const noexcept
+    {
+        __m128i s = _mm_add_epi32(v, other.v);
+        return saturate(s, _mm_andnot_si128(_mm_xor_si128(v, other.v), _mm_xor_si128(v, s)));
+    }
+
+    Q31X4 operator-(const Q31X4 &other) const noexcept
+    {
+        __m128i s = _mm_sub_epi32(v, other.v);
+        return saturate(s, _mm_and_si128(_mm_xor_si128(v, other.v), _mm_xor_si128(v, s)));
+    }
+
+    Q31X4 operator-() const noexcept
+    {
+        return Q31X4(_mm_setzero_si128()) - *this;
+    }
+
+    Q31X4 operator*(const Q31X4 &other) const noexcept
+    {
+        __m128i round = _mm_set1_epi64x(1LL << 30);
+        __m128i even  = _mm_add_epi64(_mm_mul_epi32(v, other.v), round);
+        __m128i odd   = _mm_add_epi64(_mm_mul_epi32(_mm_srli_epi64(v, 32), _mm_srli_epi64(other.v, 32)), round);
+        __m128i r     = _mm_blend_epi16(_mm_srli_epi64(even, 31), _mm_slli_epi64(odd, 1), 0xCC);
+        return _mm_xor_si128(r, _mm_cmpeq_epi32(r, _mm_set1_epi32(INT32_MIN)));
+    }
+
+    operator __m128i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m128i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int32_t *src) noexcept
+    {
+        v = _mm_load_si128(reinterpret_cast<const __m128i *>(src));
+    }
+
+    void store(int32_t *dst) noexcept
+    {
+        _mm_store_si128(reinterpret_cast<__m128i *>(dst), v);
+    }
+
+    void loadu(const int32_t *src) noexcept
+    {
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    }
+
+    void storeu(int32_t *dst) noexcept
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q31X4 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 31, "shift must be in [1, 31]");
+        __m128i half = _mm_and_si128(_mm_srai_epi32(v, n - 1), _mm_set1_epi32(1));
+        return _mm_add_epi32(_mm_srai_epi32(v, n), half);
+    }
+
+    static Q31X4 fromFloat(const FLOATX4 &x) noexcept
+    {
+        /* 2147483520 is the largest float below 2^31 */
+        __m128 s = _mm_mul_ps(x.v, _mm_set1_ps(2147483648.0f));
+        return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(s, _mm_set1_ps(-2147483648.0f)), _mm_set1_ps(2147483520.0f)));
+    }
+
+    FLOATX4 toFloat() const noexcept
+    {
+        return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 2147483648.0f));
+    }
+
+public:
+    __m128i v;
+
+private:
+    /* Lanes whose sign bit is set in overflow take the bound on the side of the first operand */
+    __m128i saturate(__m128i s, __m128i overflow) const noexcept
+    {
+        __m128i bound = _mm_xor_si128(_mm_srai_epi32(v, 31), _mm_set1_epi32(INT32_MAX));
+        return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(s), _mm_castsi128_ps(bound), _mm_castsi128_ps(overflow)));
+    }
+};
+
+struct Q31X8
+{
+public:
+    using value_type = __m256i;
+
+    Q31X8() noexcept
+    {
+    }
+
+    Q31X8(__m256i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q31 value */
+    Q31X8(int32_t raw) noexcept :
+        v{ _mm256_set1_epi32(raw) }
+    {
+    }
+
+    Q31X8 operator+(const Q31X8 &other) const noexcept
+    {
+        __m256i s = _mm256_add_epi32(v, other.v);
+        return saturate(s, _mm256_andnot_si256(_mm256_xor_si256(v, other.v), _mm256_xor_si256(v, s)));
+    }
+
+    Q31X8 operator-(const Q31X8 &other) const noexcept
+    {
+        __m256i s = _mm256_sub_epi32(v, other.v);
+        return saturate(s, _mm256_and_si256(_mm256_xor_si256(v, other.v), _mm256_xor_si256(v, s)));
+    }
+
+    Q31X8 operator-() const noexcept
+    {
+        return Q31X8(_mm256_setzero_si256()) - *this;
+    }
+
+    Q31X8 operator*(const Q31X8 &other) const noexcept
+    {
+        __m256i round = _mm256_set1_epi64x(1LL << 30);
+        __m256i even  = _mm256_add_epi64(_mm256_mul_epi32(v, other.v), round);
+        __m256i odd   = _mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(v, 32), _mm256_srli_epi64(other.v, 32)), round);
+        __m256i r     = _mm256_blend_epi32(_mm256_srli_epi64(even, 31), _mm256_slli_epi64(odd, 1), 0xAA);
+        return _mm256_xor_si256(r, _mm256_cmpeq_epi32(r, _mm256_set1_epi32(INT32_MIN)));
+    }
+
+    operator __m256i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m256i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int32_t *src) noexcept
+    {
+        v = _mm256_load_si256(reinterpret_cast<const __m256i *>(src));
+    }
+
+    void store(int32_t *dst) noexcept
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(dst), v);
+    }
+
+    void loadu(const int32_t *src) noexcept
+    {
+        v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    }
+
+    void storeu(int32_t *dst) noexcept
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q31X8 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 31, "shift must be in [1, 31]");
+        __m256i half = _mm256_and_si256(_mm256_srai_epi32(v, n - 1), _mm256_set1_epi32(1));
+        return _mm256_add_epi32(_mm256_srai_epi32(v, n), half);
+    }
+
+    static Q31X8 fromFloat(const FLOATX8 &x) noexcept
+    {
+        __m256 s = _mm256_mul_ps(x.v, _mm256_set1_ps(2147483648.0f));
+        return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(s, _mm256_set1_ps(-2147483648.0f)), _mm256_set1_ps(2147483520.0f)));
+    }
+
+    FLOATX8 toFloat() const noexcept
+    {
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_set1_ps(1.0f / 2147483648.0f));
+    }
+
+public:
+    __m256i v;
+
+private:
+    __m256i saturate(__m256i s, __m256i overflow) const noexcept
+    {
+        __m256i bound = _mm256_xor_si256(_mm256_srai_epi32(v, 31), _mm256_set1_epi32(INT32_MAX));
+        return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(s), _mm256_castsi256_ps(bound), _mm256_castsi256_ps(overflow)));
+    }
+};
+
+struct Q31X16
+{
+public:
+    using value_type = __m512i;
+
+    Q31X16() noexcept
+    {
+    }
+
+    Q31X16(__m512i other) noexcept :
+        v{ other }
+    {
+    }
+
+    /** @brief Broadcasts the raw Q31 value */
+    Q31X16(int32_t raw) noexcept :
+        v{ _mm512_set1_epi32(raw) }
+    {
+    }
+
+    Q31X16 operator+(const Q31X16 &other) const noexcept
+    {
+        __m512i s = _mm512_add_epi32(v, other.v);
+        return saturate(s, _mm512_andnot_si512(_mm512_xor_si512(v, other.v), _mm512_xor_si512(v, s)));
+    }
+
+    Q31X16 operator-(const Q31X16 &other) const noexcept
+    {
+        __m512i s = _mm512_sub_epi32(v, other.v);
+        return saturate(s, _mm512_and_si512(_mm512_xor_si512(v, other.v), _mm512_xor_si512(v, s)));
+    }
+
+    Q31X16 operator-() const noexcept
+    {
+        return Q31X16(_mm512_setzero_si512()) - *this;
+    }
+
+    Q31X16 operator*(const Q31X16 &other) const noexcept
+    {
+        __m512i round = _mm512_set1_epi64(1LL << 30);
+        __m512i even  = _mm512_add_epi64(_mm512_mul_epi32(v, other.v), round);
+        __m512i odd   = _mm512_add_epi64(_mm512_mul_epi32(_mm512_srli_epi64(v, 32), _mm512_srli_epi64(other.v, 32)), round);
+        __m512i r     = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 31), _mm512_slli_epi64(odd, 1));
+        return _mm512_mask_blend_epi32(_mm512_cmpeq_epi32_mask(r, _mm512_set1_epi32(INT32_MIN)), r, _mm512_set1_epi32(INT32_MAX));
+    }
+
+    operator __m512i &() noexcept
+    {
+        return v;
+    }
+
+    operator const __m512i &() const noexcept
+    {
+        return v;
+    }
+
+    void load(const int32_t *src) noexcept
+    {
+        v = _mm512_load_si512(src);
+    }
+
+    void store(int32_t *dst) noexcept
+    {
+        _mm512_store_si512(dst, v);
+    }
+
+    void loadu(const int32_t *src) noexcept
+    {
+        v = _mm512_loadu_si512(src);
+    }
+
+    void storeu(int32_t *dst) noexcept
+    {
+        _mm512_storeu_si512(dst, v);
+    }
+
+    /** @brief Arithmetic shift right by n, rounding half up */
+    template <int n>
+    Q31X16 shrRound() const noexcept
+    {
+        static_assert(n >= 1 && n <= 31, "shift must be in [1, 31]");
+        __m512i half = _mm512_and_si512(_mm512_srai_epi32(v, n - 1), _mm512_set1_epi32(1));
+        return _mm512_add_epi32(_mm512_srai_epi32(v, n), half);
+    }
+
+    static Q31X16 fromFloat(const FLOATX16 &x) noexcept
+    {
+        __m512 s = _mm512_mul_ps(x.v, _mm512_set1_ps(2147483648.0f));
+        return _mm512_cvtps_epi32(_mm512_min_ps(_mm512_max_ps(s, _mm512_set1_ps(-2147483648.0f)), _mm512_set1_ps(2147483520.0f)));
+    }
+
+    FLOATX16 toFloat() const noexcept
+    {
+        return _mm512_mul_ps(_mm512_cvtepi32_ps(v), _mm512_set1_ps(1.0f / 2147483648.0f));
+    }
+
+public:
+    __m512i v;
+
+private:
+    __m512i saturate(__m512i s, __m512i overflow) const noexcept
+    {
+        __m512i bound = _mm512_xor_si512(_mm512_srai_epi32(v, 31), _mm512_set1_epi32(INT32_MAX));
+        return _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(overflow, _mm512_setzero_si512()), s, bound);
+    }
+};
@@ -0,0 +1,570 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include "slimmintrin.h"
+#include "slimfilter.h"
+#include "slimpoly.h"
+
+/**
+ * Coordinates are structure-of-arrays spans of latitudes and longitudes in
+ * degrees, and distances are in metres. The spherical kernels take the
+ * sphere radius, by default the IUGG mean Earth radius; vincenty() works
+ * on the WGS-84 ellipsoid.
+ */
+constexpr double GEO_EARTH_RADIUS = 6371008.8;
+
+namespace slimm::detail
+{
+
+/* WGS-84 semi-major axis and flattening */
+constexpr double GEO_WGS84_A = 6378137.0;
+constexpr double GEO_WGS84_F = 1 / 298.257223563;
+
+/* Vincenty gives up on nearly antipodal points after this many iterations */
+constexpr int GEO_VINCENTY_ITERATIONS = 200;
+
+constexpr double GEO_RADIANS = std::numbers::pi / 180;
+
+/**
+ * Lane operations of the geodesic kernels. Masks come from ordered
+ * comparisons, so a NaN coordinate never passes a radius test or wins a
+ * nearest-point search. Index registers count points for the
+ * nearest-point search, in lanes as wide as the value lanes.
+ */
+template <class T>
+struct GeoLanes;
+
+#if defined(__AVX512F__)
+template <>
+struct GeoLanes<float>
+{
+    using V           = FLOATX16;
+    using mask        = __mmask16;
+    using index       = __m512i;
+    using indexScalar = uint32_t;
+
+    static constexpr size_t lanes = 16;
+
+    static V load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+    static V load(const float *p, size_t n) noexcept { return _mm512_maskz_loadu_ps(prefix(n), p); }
+    static void store(float *p, const V &v) noexcept { _mm512_storeu_ps(p, v); }
+    static void store(float *p, const V &v, size_t n) noexcept { _mm512_mask_storeu_ps(p, prefix(n), v); }
+    static V sqrt(const V &v) noexcept { return _mm512_sqrt_ps(v); }
+    static V abs(const V &v) noexcept { return _mm512_abs_ps(v); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1u << n) - 1); }
+    static mask lt(const V &a, const V &b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask le(const V &a, const V &b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static mask either(mask a, mask b) noexcept { return a | b; }
+    static unsigned bits(mask m) noexcept { return m; }
+    static V select(mask m, const V &a, const V &b) noexcept { return _mm512_mask_blend_ps(m, b, a); }
+    static index iota() noexcept { return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+    static index next(index i) noexcept { return _mm512_add_epi32(i, _mm512_set1_epi32(16)); }
+    static index selectIndex(mask m, index a, index b) noexcept { return _mm512_mask_blend_epi32(m, b, a); }
+    static void storeIndex(uint32_t *p, index i) noexcept { _mm512_storeu_si512(p, i); }
+};
+
+template <>
+struct GeoLanes<double>
+{
+    using V           = DOUBLEX8;
+    using mask        = __mmask8;
+    using index       = __m512i;
+    using indexScalar = uint64_t;
+
+    static constexpr size_t lanes = 8;
+
+    static V load(const double *p) noexcept { return _mm512_loadu_pd(p); }
+    static V load(const double *p, size_t n) noexcept { return _mm512_maskz_loadu_pd(prefix(n), p); }
+    static void store(double *p, const V &v) noexcept { _mm512_storeu_pd(p, v); }
+    static void store(double *p, const V &v, size_t n) noexcept { _mm512_mask_storeu_pd(p, prefix(n), v); }
+    static V sqrt(const V &v) noexcept { return _mm512_sqrt_pd(v); }
+    static V abs(const V &v) noexcept { return _mm512_abs_pd(v); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1u << n) - 1); }
+    static mask lt(const V &a, const V &b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static mask le(const V &a, const V &b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+    static mask either(mask a, mask b) noexcept { return a | b; }
+    static unsigned bits(mask m) noexcept { return m; }
+    static V select(mask m, const V &a, const V &b) noexcept { return _mm512_mask_blend_pd(m, b, a); }
+    static index iota() noexcept { return _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7); }
+    static index next(index i) noexcept { return _mm512_add_epi64(i, _mm512_set1_epi64(8)); }
+    static index selectIndex(mask m, index a, index b) noexcept { return _mm512_mask_blend_epi64(m, b, a); }
+    static void storeIndex(uint64_t *p, index i) noexcept { _mm512_storeu_si512(p, i); }
+};
+#else
+template <>
+struct GeoLanes<float>
+{
+    using V           = FLOATX8;
+    using mask        = __m256;
+    using index       = __m256i;
+    using indexScalar = uint32_t;
+
+    static constexpr size_t lanes = 8;
+
+    static V load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+    static V load(const float *p, size_t n) noexcept { return _mm256_maskload_ps(p, _mm256_castps_si256(prefix(n))); }
+    static void store(float *p, const V &v) noexcept { _mm256_storeu_ps(p, v); }
+    static void store(float *p, const V &v, size_t n) noexcept { _mm256_maskstore_ps(p, _mm256_castps_si256(prefix(n)), v); }
+    static V sqrt(const V &v) noexcept { return _mm256_sqrt_ps(v); }
+    static V abs(const V &v) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+    static mask lt(const V &a, const V &b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mask le(const V &a, const V &b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static mask either(mask a, mask b) noexcept { return _mm256_or_ps(a, b); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(m)); }
+    static V select(mask m, const V &a, const V &b) noexcept { return _mm256_blendv_ps(b, a, m); }
+    static index iota() noexcept { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static index next(index i) noexcept { return _mm256_add_epi32(i, _mm256_set1_epi32(8)); }
+    static void storeIndex(uint32_t *p, index i) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), i); }
+
+    static mask prefix(size_t n) noexcept
+    {
+        return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), iota()));
+    }
+
+    static index selectIndex(mask m, index a, index b) noexcept
+    {
+        return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m));
+    }
+};
+
+template <>
+struct GeoLanes<double>
+{
+    using V           = DOUBLEX4;
+    using mask        = __m256d;
+    using index       = __m256i;
+    using indexScalar = uint64_t;
+
+    static constexpr size_t lanes = 4;
+
+    static V load(const double *p) noexcept { return _mm256_loadu_pd(p); }
+    static V load(const double *p, size_t n) noexcept { return _mm256_maskload_pd(p, _mm256_castpd_si256(prefix(n))); }
+    static void store(double *p, const V &v) noexcept { _mm256_storeu_pd(p, v); }
+    static void store(double *p, const V &v, size_t n) noexcept { _mm256_maskstore_pd(p, _mm256_castpd_si256(prefix(n)), v); }
+    static V sqrt(const V &v) noexcept { return _mm256_sqrt_pd(v); }
+    static V abs(const V &v) noexcept { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v); }
+    static mask lt(const V &a, const V &b) noexcept { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static mask le(const V &a, const V &b) noexcept { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+    static mask either(mask a, mask b) noexcept { return _mm256_or_pd(a, b); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(m)); }
+    static V select(mask m, const V &a, const V &b) noexcept { return _mm256_blendv_pd(b, a, m); }
+    static index iota() noexcept { return _mm256_setr_epi64x(0, 1, 2, 3); }
+    static index next(index i) noexcept { return _mm256_add_epi64(i, _mm256_set1_epi64x(4)); }
+    static void storeIndex(uint64_t *p, index i) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), i); }
+
+    static mask prefix(size_t n) noexcept
+    {
+        return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(n)), iota()));
+    }
+
+    static index selectIndex(mask m, index a, index b) noexcept
+    {
+        return _mm256_castpd_si256(_mm256_blendv_pd(_mm256_castsi256_pd(b), _mm256_castsi256_pd(a), m));
+    }
+};
+#endif
+
+/* The first count lanes from p; the others read as zero */
+template <class Ops, class T>
+static inline typename Ops::V geoLoad(const T *p, size_t count) noexcept
+{
+    return count == Ops::lanes ? Ops::load(p) : Ops::load(p, count);
+}
+
+template <class Ops, class T>
+static inline void geoStore(T *p, const typename Ops::V &v, size_t count) noexcept
+{
+    if (count == Ops::lanes) {
+        Ops::store(p, v);
+    } else {
+        Ops::store(p, v, count);
+    }
+}
+
+/**
+ * h = sin^2(dlat / 2) + cos(lat1) cos(lat2) sin^2(dlon / 2) for degrees,
+ * the haversine of the central angle. cosProduct is cos(lat1) cos(lat2).
+ * The form stays accurate for nearby points, where the spherical law of
+ * cosines cancels catastrophically.
+ */
+template <class Ops, class V>
+static inline V geoHaversine(V lat1, V lon1, V lat2, V lon2, V cosProduct) noexcept
+{
+    using scalar  = typename PolyTraits<V>::scalar;
+    V halfRadians = V(static_cast<scalar>(GEO_RADIANS / 2));
+    V dlat        = sin((lat2 - lat1) * halfRadians);
+    V dlon        = sin((lon2 - lon1) * halfRadians);
+    return (cosProduct * dlon).fmadd(dlon, dlat * dlat);
+}
+
+/* 2 r asin(sqrt(h)), with h clamped so that rounding cannot push asin past 1 */
+template <class Ops, class V, class T>
+static inline V geoCentral(V h, T radius) noexcept
+{
+    V one = V(T(1));
+    return V(2 * radius) * asin(min(Ops::sqrt(h), one));
+}
+
+/* The largest h within meters, so a radius test needs neither sqrt nor asin */
+static inline double geoThreshold(double meters, double radius) noexcept
+{
+    double angle = meters / (2 * radius);
+    if (!(angle >= 0)) {
+        return -1;
+    }
+    if (angle >= std::numbers::pi / 2) {
+        return 1;
+    }
+    double s = std::sin(angle);
+    return s * s;
+}
+
+/* Haversines from one query point to the points of block i */
+template <class Ops, class T>
+struct GeoQuery
+{
+    using V = typename Ops::V;
+
+    T lat0;
+    T lon0;
+    T cosLat0;
+
+    V h(const T *lat, const T *lon, size_t i, size_t count) const noexcept
+    {
+        V lat1 = geoLoad<Ops>(lat + i, count);
+        V lon1 = geoLoad<Ops>(lon + i, count);
+        V cosProduct = V(cosLat0) * cos(lat1 * V(static_cast<T>(GEO_RADIANS)));
+        return geoHaversine<Ops>(V(lat0), V(lon0), lat1, lon1, cosProduct);
+    }
+};
+
+template <class T>
+static inline GeoQuery<GeoLanes<T>, T> geoQuery(T lat0, T lon0) noexcept
+{
+    return { lat0, lon0, static_cast<T>(std::cos(lat0 * GEO_RADIANS)) };
+}
+
+template <class T>
+static inline void haversinePairs(const T *lat1, const T *lon1, const T *lat2, const T *lon2, size_t n, T *out, double radius) noexcept
+{
+    using Ops = GeoLanes<T>;
+    using V   = typename Ops::V;
+
+    V rad = V(static_cast<T>(GEO_RADIANS));
+    for (size_t i = 0; i < n; i += Ops::lanes) {
+        size_t count = std::min(Ops::lanes, n - i);
+        V      a     = geoLoad<Ops>(lat1 + i, count);
+        V      b     = geoLoad<Ops>(lat2 + i, count);
+        V      h     = geoHaversine<Ops>(a, geoLoad<Ops>(lon1 + i, count), b, geoLoad<Ops>(lon2 + i, count), cos(a * rad) * cos(b * rad));
+        geoStore<Ops>(out + i, geoCentral<Ops>(h, static_cast<T>(radius)), count);
+    }
+}
+
+template <class T>
+static inline void haversineFrom(T lat0, T lon0, const T *lat, const T *lon, size_t n, T *out, double radius) noexcept
+{
+    using Ops = GeoLanes<T>;
+
+    auto query = geoQuery(lat0, lon0);
+    for (size_t i = 0; i < n; i += Ops::lanes) {
+        size_t count = std::min(Ops::lanes, n - i);
+        geoStore<Ops>(out + i, geoCentral<Ops>(query.h(lat, lon, i, count), static_cast<T>(radius)), count);
+    }
+}
+
+/* Bits of the points in [i, i + count) whose h is at most limit */
+template <class Ops, class T>
+static inline uint64_t geoWithin(const GeoQuery<Ops, T> &query, const T *lat, const T *lon, size_t i, size_t count, T limit) noexcept
+{
+    using V = typename Ops::V;
+
+    uint64_t bits = 0;
+    for (size_t j = 0; j < count; j += Ops::lanes) {
+        size_t part = std::min(Ops::lanes, count - j);
+        auto   m    = Ops::le(query.h(lat, lon, i + j, part), V(limit));
+        bits |= uint64_t(Ops::bits(m) & ((1u << part) - 1)) << j;
+    }
+    return bits;
+}
+
+template <class T>
+static inline size_t withinRadiusRows(T lat0, T lon0, const T *lat, const T *lon, size_t n, double meters, uint32_t *rows, double radius) noexcept
+{
+    auto      query = geoQuery(lat0, lon0);
+    T         limit = static_cast<T>(geoThreshold(meters, radius));
+    uint32_t *out   = rows;
+
+    size_t i = 0;
+    for (; i + FILTER_BLOCK <= n; i += FILTER_BLOCK) {
+        out += compressRows(out, static_cast<unsigned>(geoWithin(query, lat, lon, i, FILTER_BLOCK, limit)), i);
+    }
+    if (i < n) {
+        unsigned m = static_cast<unsigned>(geoWithin(query, lat, lon, i, n - i, limit));
+        for (; m != 0; m &= m - 1) {
+            *out++ = static_cast<uint32_t>(i + std::countr_zero(m));
+        }
+    }
+    return static_cast<size_t>(out - rows);
+}
+
+template <class T>
+static inline void withinRadiusBitmap(T lat0, T lon0, const T *lat, const T *lon, size_t n, double meters, uint64_t *bitmap, double radius) noexcept
+{
+    auto query = geoQuery(lat0, lon0);
+    T    limit = static_cast<T>(geoThreshold(meters, radius));
+    for (size_t i = 0; i < n; i += 64) {
+        bitmap[i / 64] = geoWithin(query, lat, lon, i, std::min<size_t>(64, n - i), limit);
+    }
+}
+
+template <class T>
+static inline size_t nearest(T lat0, T lon0, const T *lat, const T *lon, size_t n, T *distance, double radius) noexcept
+{
+    using Ops = GeoLanes<T>;
+    using V   = typename Ops::V;
+
+    auto query = geoQuery(lat0, lon0);
+    V    inf   = V(std::numeric_limits<T>::infinity());
+    V    best  = inf;
+    auto slot  = Ops::iota();
+    auto where = slot;
+    for (size_t i = 0; i < n; i += Ops::lanes) {
+        size_t count = std::min(Ops::lanes, n - i);
+        V      h     = query.h(lat, lon, i, count);
+        if (count < Ops::lanes) {
+            h = Ops::select(Ops::prefix(count), h, inf);
+        }
+        auto closer = Ops::lt(h, best);
+        best        = Ops::select(closer, h, best);
+        where       = Ops::selectIndex(closer, slot, where);
+        slot        = Ops::next(slot);
+    }
+
+    alignas(64) T bestLane[Ops::lanes];
+    alignas(64) typename Ops::indexScalar whereLane[Ops::lanes];
+    Ops::store(bestLane, best);
+    Ops::storeIndex(whereLane, where);
+
+    size_t found = n;
+    T      h     = std::numeric_limits<T>::infinity();
+    for (size_t l = 0; l < Ops::lanes; l++) {
+        if (bestLane[l] < h || (bestLane[l] == h && whereLane[l] < found)) {
+            h     = bestLane[l];
+            found = static_cast<size_t>(whereLane[l]);
+        }
+    }
+    if (!(h < std::numeric_limits<T>::infinity())) {
+        found = n;
+    }
+    if (distance != nullptr) {
+        *distance = found < n ? static_cast<T>(2 * radius * std::asin(std::min(std::sqrt(static_cast<double>(h)), 1.0))) : std::numeric_limits<T>::quiet_NaN();
+    }
+    return found;
+}
+
+/* Vincenty's A and B series in u^2, expanded from the nested form */
+constexpr auto GEO_VINCENTY_A = polyCoeffs(1.0, 4096.0 / 16384, -768.0 / 16384, 320.0 / 16384, -175.0 / 16384);
+constexpr auto GEO_VINCENTY_B = polyCoeffs(0.0, 256.0 / 1024, -128.0 / 1024, 74.0 / 1024, -47.0 / 1024);
+
+/**
+ * Vincenty's inverse method for one register of point pairs. Lanes stop
+ * once lambda moves by at most 1e-12 rad, or at once for coincident
+ * points, and keep their lambda while the rest of the register iterates.
+ * sigma comes from asin or acos, whichever argument is below 1 / sqrt(2)
+ * and so well conditioned, in place of the atan2 the method asks for.
+ */
+template <class Ops>
+static inline typename Ops::V vincentyBlock(typename Ops::V lat1, typename Ops::V lon1, typename Ops::V lat2, typename Ops::V lon2) noexcept
+{
+    using V = typename Ops::V;
+
+    constexpr double a = GEO_WGS84_A;
+    constexpr double f = GEO_WGS84_F;
+    constexpr double b = a * (1 - f);
+
+    V rad  = V(GEO_RADIANS);
+    V zero = V(0.0);
+    V one  = V(1.0);
+    V two  = V(2.0);
+
+    /* The reduced latitudes, tan U = (1 - f) tan lat, without dividing by cos lat at the poles */
+    auto reduce = [&](V lat, V &sinU, V &cosU) {
+        V s    = sin(lat * rad) * V(1 - f);
+        V c    = cos(lat * rad);
+        V norm = one / Ops::sqrt(c.fmadd(c, s * s));
+        sinU   = s * norm;
+        cosU   = c * norm;
+    };
+    V sinU1, cosU1, sinU2, cosU2;
+    reduce(lat1, sinU1, cosU1);
+    reduce(lat2, sinU2, cosU2);
+
+    V cosU12 = cosU1 * cosU2;
+    V sinU12 = sinU1 * sinU2;
+    V L      = (lon2 - lon1) * rad;
+    V lambda = L;
+    V sinSigma, cosSigma, sigma, cos2Alpha, cos2SigmaM;
+
+    auto     done = Ops::lt(one, zero);
+    unsigned all  = (1u << Ops::lanes) - 1;
+    for (int iteration = 0; iteration < GEO_VINCENTY_ITERATIONS && Ops::bits(done) != all; iteration++) {
+        V sinLambda = sin(lambda);
+        V cosLambda = cos(lambda);
+        V t1        = cosU2 * sinLambda;
+        V t2        = (cosU1 * sinU2) - (sinU1 * cosU2 * cosLambda);
+        sinSigma    = Ops::sqrt(t1.fmadd(t1, t2 * t2));
+        cosSigma    = cosU12.fmadd(cosLambda, sinU12);
+
+        V byAsin = asin(sinSigma);
+        byAsin   = Ops::select(Ops::lt(cosSigma, zero), V(std::numbers::pi) - byAsin, byAsin);
+        sigma    = Ops::select(Ops::le(sinSigma, Ops::abs(cosSigma)), byAsin, acos(cosSigma));
+
+        V sinAlpha = cosU12 * sinLambda / sinSigma;
+        cos2Alpha  = one - sinAlpha * sinAlpha;
+        cos2SigmaM = Ops::select(Ops::lt(zero, cos2Alpha), cosSigma - two * sinU12 / cos2Alpha, zero);
+
+        V C    = V(f / 16) * cos2Alpha * (V(4.0) + V(f) * (V(4.0) - V(3.0) * cos2Alpha));
+        V tail = (C * cosSigma).fmadd(two * cos2SigmaM * cos2SigmaM - one, cos2SigmaM);
+        V next = L + (one - C) * V(f) * sinAlpha * (sigma + C * sinSigma * tail);
+
+        done   = Ops::either(done, Ops::either(Ops::le(Ops::abs(next - lambda), V(1e-12)), Ops::le(sinSigma, zero)));
+        lambda = Ops::select(done, lambda, next);
+    }
+
+    V u2      = cos2Alpha * V((a * a - b * b) / (b * b));
+    V A       = poly<GEO_VINCENTY_A>(u2);
+    V B       = poly<GEO_VINCENTY_B>(u2);
+    V cos2sm2 = cos2SigmaM * cos2SigmaM;
+    V inner   = cosSigma * (two * cos2sm2 - one) - B / V(6.0) * cos2SigmaM * (V(4.0) * sinSigma * sinSigma - V(3.0)) * (V(4.0) * cos2sm2 - V(3.0));
+    V dSigma  = B * sinSigma * (cos2SigmaM + B / V(4.0) * inner);
+    V s       = V(b) * A * (sigma - dSigma);
+
+    /* Coincident points divide by sin sigma = 0 above */
+    s = Ops::select(Ops::le(sinSigma, zero), zero, s);
+    return Ops::select(done, s, V(std::numeric_limits<double>::quiet_NaN()));
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Great-circle distances between the pairs (lat1[i], lon1[i]) and (lat2[i], lon2[i])
+ *
+ * In float the relative error stays within about 2e-6 up to 0.9 pi r and
+ * about 6e-6 within a degree of a pole. Near-antipodal pairs are ill
+ * conditioned: the haversine term nears 1 and asin magnifies its rounding,
+ * so errors there reach kilometres. Use double for such pairs; its
+ * relative error stays below 2e-14.
+ */
+static inline void haversine(const float *lat1, const float *lon1, const float *lat2, const float *lon2, size_t n, float *out,
+                             double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::haversinePairs(lat1, lon1, lat2, lon2, n, out, radius);
+}
+
+static inline void haversine(const double *lat1, const double *lon1, const double *lat2, const double *lon2, size_t n, double *out,
+                             double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::haversinePairs(lat1, lon1, lat2, lon2, n, out, radius);
+}
+
+/**
+ * @brief Great-circle distances from (lat0, lon0) to each of n points
+ */
+static inline void haversine(float lat0, float lon0, const float *lat, const float *lon, size_t n, float *out, double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::haversineFrom(lat0, lon0, lat, lon, n, out, radius);
+}
+
+static inline void haversine(double lat0, double lon0, const double *lat, const double *lon, size_t n, double *out,
+                             double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::haversineFrom(lat0, lon0, lat, lon, n, out, radius);
+}
+
+/**
+ * @brief Writes the ids of the points within meters of (lat0, lon0) to rows and returns how many there are
+ *
+ * rows needs room for n ids, as for filter(). The distance bound is turned
+ * into a bound on the haversine once, so each point costs two sines and
+ * a cosine but no square root or arcsine. Points within rounding of the
+ * boundary may fall either way.
+ */
+static inline size_t withinRadius(float lat0, float lon0, const float *lat, const float *lon, size_t n, double meters, uint32_t *rows,
+                                  double radius = GEO_EARTH_RADIUS) noexcept
+{
+    return slimm::detail::withinRadiusRows(lat0, lon0, lat, lon, n, meters, rows, radius);
+}
+
+static inline size_t withinRadius(double lat0, double lon0, const double *lat, const double *lon, size_t n, double meters, uint32_t *rows,
+                                  double radius = GEO_EARTH_RADIUS) noexcept
+{
+    return slimm::detail::withinRadiusRows(lat0, lon0, lat, lon, n, meters, rows, radius);
+}
+
+/**
+ * @brief Sets bit i of bitmap when point i is within meters of (lat0, lon0)
+ *
+ * bitmap has (n + 63) / 64 words; the bits past n in the last word are cleared.
+ */
+static inline void withinRadiusMask(float lat0, float lon0, const float *lat, const float *lon, size_t n, double meters, uint64_t *bitmap,
+                                    double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::withinRadiusBitmap(lat0, lon0, lat, lon, n, meters, bitmap, radius);
+}
+
+static inline void withinRadiusMask(double lat0, double lon0, const double *lat, const double *lon, size_t n, double meters, uint64_t *bitmap,
+                                    double radius = GEO_EARTH_RADIUS) noexcept
+{
+    slimm::detail::withinRadiusBitmap(lat0, lon0, lat, lon, n, meters, bitmap, radius);
+}
+
+/**
+ * @brief Returns the id of the point closest to (lat0, lon0), the lowest one on ties, or n when there is none
+ *
+ * Points are compared by their haversine, which orders them like the
+ * distance, and only the winner's distance is computed and stored to
+ * distance when it is not null. NaN coordinates never win.
+ */
+static inline size_t nearestPoint(float lat0, float lon0, const float *lat, const float *lon, size_t n, float *distance = nullptr,
+                                  double radius = GEO_EARTH_RADIUS) noexcept
+{
+    return slimm::detail::nearest(lat0, lon0, lat, lon, n, distance, radius);
+}
+
+static inline size_t nearestPoint(double lat0, double lon0, const double *lat, const double *lon, size_t n, double *distance = nullptr,
+                                  double radius = GEO_EARTH_RADIUS) noexcept
+{
+    return slimm::detail::nearest(lat0, lon0, lat, lon, n, distance, radius);
+}
+
+/**
+ * @brief Ellipsoidal distances on WGS-84 between the pairs (lat1[i], lon1[i]) and (lat2[i], lon2[i])
+ *
+ * Vincenty's inverse method, accurate to well under a millimetre where
+ * haversine is off by up to 0.5 %. Double only: the iteration converges to
+ * 1e-12 rad, which float cannot represent. Nearly antipodal pairs, where
+ * the method does not converge, come back as NaN.
+ */
+static inline void vincenty(const double *lat1, const double *lon1, const double *lat2, const double *lon2, size_t n, double *out) noexcept
+{
+    using Ops = slimm::detail::GeoLanes<double>;
+
+    for (size_t i = 0; i < n; i += Ops::lanes) {
+        size_t count = std::min(Ops::lanes, n - i);
+        auto   s     = slimm::detail::vincentyBlock<Ops>(slimm::detail::geoLoad<Ops>(lat1 + i, count), slimm::detail::geoLoad<Ops>(lon1 + i, count),
+                                                         slimm::detail::geoLoad<Ops>(lat2 + i, count), slimm::detail::geoLoad<Ops>(lon2 + i, count));
+        slimm::detail::geoStore<Ops>(out + i, s, count);
+    }
+}
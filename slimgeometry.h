@@ -0,0 +1,576 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include "slimmintrin.h"
+
+namespace slimm
+{
+namespace detail
+{
+
+#if defined(__AVX512F__)
+using GeomFloat = FLOATX16;
+#else
+using GeomFloat = FLOATX8;
+#endif
+
+constexpr size_t GEOM_LANES = sizeof(GeomFloat) / sizeof(float);
+
+template <int imm8>
+static inline __m128 swizzle(__m128 v) noexcept
+{
+    return FLOATX4(v).shuffle<imm8>(v);
+}
+
+/* (a * b.yzx - a.yzx * b).yzx, the w lane stays 0 */
+static inline __m128 cross3(__m128 a, __m128 b) noexcept
+{
+    constexpr int YZX = _MM_SHUFFLE(3, 0, 2, 1);
+    __m128 t = _mm_fmsub_ps(a, swizzle<YZX>(b), _mm_mul_ps(swizzle<YZX>(a), b));
+    return swizzle<YZX>(t);
+}
+
+/* 2 x 2 row-major blocks packed as (m00, m01, m10, m11): A B, A# B and A B# */
+static inline __m128 mat2Mul(__m128 a, __m128 b) noexcept
+{
+    return _mm_fmadd_ps(a, swizzle<_MM_SHUFFLE(3, 0, 3, 0)>(b),
+                        _mm_mul_ps(swizzle<_MM_SHUFFLE(2, 3, 0, 1)>(a), swizzle<_MM_SHUFFLE(1, 2, 1, 2)>(b)));
+}
+
+static inline __m128 mat2AdjMul(__m128 a, __m128 b) noexcept
+{
+    return _mm_fmsub_ps(swizzle<_MM_SHUFFLE(0, 0, 3, 3)>(a), b,
+                        _mm_mul_ps(swizzle<_MM_SHUFFLE(2, 2, 1, 1)>(a), swizzle<_MM_SHUFFLE(1, 0, 3, 2)>(b)));
+}
+
+static inline __m128 mat2MulAdj(__m128 a, __m128 b) noexcept
+{
+    return _mm_fmsub_ps(a, swizzle<_MM_SHUFFLE(0, 3, 0, 3)>(b),
+                        _mm_mul_ps(swizzle<_MM_SHUFFLE(2, 3, 0, 1)>(a), swizzle<_MM_SHUFFLE(1, 2, 1, 2)>(b)));
+}
+
+} // namespace detail
+} // namespace slimm
+
+/**
+ * Three-component vector in a FLOATX4 whose w lane stays 0.
+ */
+struct Vec3
+{
+public:
+    Vec3() noexcept
+    {
+    }
+
+    Vec3(__m128 other) noexcept :
+        v{ other }
+    {
+    }
+
+    Vec3(float x, float y, float z) noexcept :
+        v{ x, y, z, 0.0f }
+    {
+    }
+
+    float x() const noexcept
+    {
+        return _mm_cvtss_f32(v);
+    }
+
+    float y() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0x55>(v));
+    }
+
+    float z() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0xAA>(v));
+    }
+
+    Vec3 operator+(const Vec3 &other) const noexcept
+    {
+        return _mm_add_ps(v, other.v);
+    }
+
+    Vec3 operator-(const Vec3 &other) const noexcept
+    {
+        return _mm_sub_ps(v, other.v);
+    }
+
+    Vec3 operator*(float s) const noexcept
+    {
+        return _mm_mul_ps(v, _mm_set1_ps(s));
+    }
+
+    float dot(const Vec3 &other) const noexcept
+    {
+        return _mm_cvtss_f32(_mm_dp_ps(v, other.v, 0x71));
+    }
+
+    Vec3 cross(const Vec3 &other) const noexcept
+    {
+        return slimm::detail::cross3(v, other.v);
+    }
+
+    float length() const noexcept
+    {
+        return std::sqrt(dot(*this));
+    }
+
+    Vec3 normalized() const noexcept
+    {
+        return _mm_div_ps(v, _mm_sqrt_ps(_mm_dp_ps(v, v, 0x7F)));
+    }
+
+public:
+    FLOATX4 v;
+};
+
+struct Vec4
+{
+public:
+    Vec4() noexcept
+    {
+    }
+
+    Vec4(__m128 other) noexcept :
+        v{ other }
+    {
+    }
+
+    Vec4(float x, float y, float z, float w) noexcept :
+        v{ x, y, z, w }
+    {
+    }
+
+    Vec4(const Vec3 &xyz, float w) noexcept :
+        v{ _mm_insert_ps(xyz.v, _mm_set_ss(w), 0x30) }
+    {
+    }
+
+    float x() const noexcept
+    {
+        return _mm_cvtss_f32(v);
+    }
+
+    float y() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0x55>(v));
+    }
+
+    float z() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0xAA>(v));
+    }
+
+    float w() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0xFF>(v));
+    }
+
+    Vec4 operator+(const Vec4 &other) const noexcept
+    {
+        return _mm_add_ps(v, other.v);
+    }
+
+    Vec4 operator-(const Vec4 &other) const noexcept
+    {
+        return _mm_sub_ps(v, other.v);
+    }
+
+    Vec4 operator*(float s) const noexcept
+    {
+        return _mm_mul_ps(v, _mm_set1_ps(s));
+    }
+
+    float dot(const Vec4 &other) const noexcept
+    {
+        return _mm_cvtss_f32(_mm_dp_ps(v, other.v, 0xF1));
+    }
+
+    float length() const noexcept
+    {
+        return std::sqrt(dot(*this));
+    }
+
+    Vec4 normalized() const noexcept
+    {
+        return _mm_div_ps(v, _mm_sqrt_ps(_mm_dp_ps(v, v, 0xFF)));
+    }
+
+    /** @brief xyz divided by w */
+    Vec3 project() const noexcept
+    {
+        __m128 p = _mm_div_ps(v, slimm::detail::swizzle<0xFF>(v));
+        return _mm_blend_ps(p, _mm_setzero_ps(), 0x8);
+    }
+
+public:
+    FLOATX4 v;
+};
+
+/**
+ * Quaternion (x, y, z, w) with w the scalar part.
+ */
+struct Quat
+{
+public:
+    Quat() noexcept
+    {
+    }
+
+    Quat(__m128 other) noexcept :
+        v{ other }
+    {
+    }
+
+    Quat(float x, float y, float z, float w) noexcept :
+        v{ x, y, z, w }
+    {
+    }
+
+    static Quat identity() noexcept
+    {
+        return Quat(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+
+    /**
+     * @brief Rotation by angle radians about a unit axis
+     */
+    static Quat axisAngle(const Vec3 &axis, float angle) noexcept
+    {
+        Vec3 xyz = axis * std::sin(angle / 2);
+        return Quat(Vec4(xyz, std::cos(angle / 2)).v);
+    }
+
+    float x() const noexcept
+    {
+        return _mm_cvtss_f32(v);
+    }
+
+    float y() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0x55>(v));
+    }
+
+    float z() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0xAA>(v));
+    }
+
+    float w() const noexcept
+    {
+        return _mm_cvtss_f32(slimm::detail::swizzle<0xFF>(v));
+    }
+
+    /**
+     * @brief Hamilton product, the rotation of other followed by this
+     *
+     * Each component of this scales a signed permutation of other:
+     * w (x, y, z, w) + x (w, -z, y, -x) + y (z, w, -x, -y) + z (-y, x, w, -z).
+     */
+    Quat operator*(const Quat &other) const noexcept
+    {
+        using slimm::detail::swizzle;
+
+        __m128 q = other.v;
+        __m128 r = _mm_mul_ps(swizzle<0xFF>(v), q);
+        __m128 a = _mm_xor_ps(swizzle<_MM_SHUFFLE(0, 1, 2, 3)>(q), _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f));
+        __m128 b = _mm_xor_ps(swizzle<_MM_SHUFFLE(1, 0, 3, 2)>(q), _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f));
+        __m128 c = _mm_xor_ps(swizzle<_MM_SHUFFLE(2, 3, 0, 1)>(q), _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f));
+        r        = _mm_fmadd_ps(swizzle<0x00>(v), a, r);
+        r        = _mm_fmadd_ps(swizzle<0x55>(v), b, r);
+        return _mm_fmadd_ps(swizzle<0xAA>(v), c, r);
+    }
+
+    Quat conjugate() const noexcept
+    {
+        return _mm_xor_ps(v, _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f));
+    }
+
+    float dot(const Quat &other) const noexcept
+    {
+        return _mm_cvtss_f32(_mm_dp_ps(v, other.v, 0xF1));
+    }
+
+    Quat normalized() const noexcept
+    {
+        return _mm_div_ps(v, _mm_sqrt_ps(_mm_dp_ps(v, v, 0xFF)));
+    }
+
+    /**
+     * @brief Rotates p by this unit quaternion: p + w t + u x t with t = 2 u x p
+     */
+    Vec3 rotate(const Vec3 &p) const noexcept
+    {
+        __m128 u = _mm_blend_ps(v, _mm_setzero_ps(), 0x8);
+        __m128 t = slimm::detail::cross3(u, p.v);
+        t        = _mm_add_ps(t, t);
+        __m128 r = _mm_fmadd_ps(slimm::detail::swizzle<0xFF>(v), t, p.v);
+        return _mm_add_ps(r, slimm::detail::cross3(u, t));
+    }
+
+public:
+    FLOATX4 v;
+};
+
+/**
+ * @brief Spherical interpolation between unit quaternions along the shorter arc
+ */
+static inline Quat slerp(const Quat &a, const Quat &b, float t) noexcept
+{
+    float  cosine = a.dot(b);
+    __m128 target = b.v;
+    if (cosine < 0) {
+        cosine = -cosine;
+        target = _mm_xor_ps(target, _mm_set1_ps(-0.0f));
+    }
+
+    float wa, wb;
+    if (cosine > 0.9995f) {
+        /* Nearly parallel: the normalized lerp is indistinguishable and avoids dividing by sin ~ 0 */
+        wa = 1 - t;
+        wb = t;
+    } else {
+        float angle = std::acos(cosine);
+        float s     = 1 / std::sin(angle);
+        wa          = std::sin((1 - t) * angle) * s;
+        wb          = std::sin(t * angle) * s;
+    }
+    Quat r(_mm_fmadd_ps(a.v, _mm_set1_ps(wa), _mm_mul_ps(target, _mm_set1_ps(wb))));
+    return cosine > 0.9995f ? r.normalized() : r;
+}
+
+/**
+ * Column-major 4 x 4 matrix, one FLOATX4 per column.
+ */
+struct Mat4
+{
+public:
+    Mat4() noexcept
+    {
+    }
+
+    Mat4(const Vec4 &c0, const Vec4 &c1, const Vec4 &c2, const Vec4 &c3) noexcept :
+        c{ c0.v, c1.v, c2.v, c3.v }
+    {
+    }
+
+    static Mat4 identity() noexcept
+    {
+        return { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+    }
+
+    static Mat4 translation(const Vec3 &t) noexcept
+    {
+        return { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { t, 1 } };
+    }
+
+    static Mat4 scaling(const Vec3 &s) noexcept
+    {
+        return { { s.x(), 0, 0, 0 }, { 0, s.y(), 0, 0 }, { 0, 0, s.z(), 0 }, { 0, 0, 0, 1 } };
+    }
+
+    /**
+     * @brief Rotation matrix of a unit quaternion
+     */
+    static Mat4 rotation(const Quat &q) noexcept
+    {
+        float x = q.x(), y = q.y(), z = q.z(), w = q.w();
+        return { { 1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y), 0 },
+                 { 2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x), 0 },
+                 { 2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y), 0 },
+                 { 0, 0, 0, 1 } };
+    }
+
+    float operator()(size_t row, size_t col) const noexcept
+    {
+        alignas(16) float column[4];
+        _mm_store_ps(column, c[col]);
+        return column[row];
+    }
+
+    Vec4 operator*(const Vec4 &p) const noexcept
+    {
+        using slimm::detail::swizzle;
+
+        __m128 r = _mm_mul_ps(c[0], swizzle<0x00>(p.v));
+        r        = _mm_fmadd_ps(c[1], swizzle<0x55>(p.v), r);
+        r        = _mm_fmadd_ps(c[2], swizzle<0xAA>(p.v), r);
+        return _mm_fmadd_ps(c[3], swizzle<0xFF>(p.v), r);
+    }
+
+    Mat4 operator*(const Mat4 &other) const noexcept
+    {
+        Mat4 r;
+        for (size_t i = 0; i < 4; i++) {
+            r.c[i] = (*this * Vec4(other.c[i])).v;
+        }
+        return r;
+    }
+
+    /**
+     * @brief The point (p, 1) through the matrix, without the perspective divide
+     */
+    Vec3 transformPoint(const Vec3 &p) const noexcept
+    {
+        return _mm_blend_ps((*this * Vec4(p, 1.0f)).v, _mm_setzero_ps(), 0x8);
+    }
+
+    Mat4 transposed() const noexcept
+    {
+        Mat4 r = *this;
+        _MM_TRANSPOSE4_PS(r.c[0].v, r.c[1].v, r.c[2].v, r.c[3].v);
+        return r;
+    }
+
+    /**
+     * @brief General inverse by 2 x 2 blocks; singular matrices give non-finite entries
+     *
+     * With M = | A B ; C D | and X#, the adjugate of X, the inverse is
+     * 1 / |M| times the adjugates of |D| A - B D#C, |B| C - D (A#B)#,
+     * |C| B - A (D#C)# and |A| D - C A#B, where
+     * |M| = |A| |D| + |B| |C| - tr(A#B D#C). Feeding the columns as rows
+     * inverts the transpose, whose rows are the columns of the inverse.
+     */
+    Mat4 inverse() const noexcept
+    {
+        using namespace slimm::detail;
+
+        __m128 a = _mm_movelh_ps(c[0], c[1]);
+        __m128 b = _mm_movehl_ps(c[1], c[0]);
+        __m128 e = _mm_movelh_ps(c[2], c[3]);
+        __m128 d = _mm_movehl_ps(c[3], c[2]);
+
+        /* (|A|, |B|, |C|, |D|) */
+        __m128 dets = _mm_fmsub_ps(FLOATX4(c[0]).shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(c[2]), FLOATX4(c[1]).shuffle<_MM_SHUFFLE(3, 1, 3, 1)>(c[3]),
+                                   _mm_mul_ps(FLOATX4(c[0]).shuffle<_MM_SHUFFLE(3, 1, 3, 1)>(c[2]), FLOATX4(c[1]).shuffle<_MM_SHUFFLE(2, 0, 2, 0)>(c[3])));
+        __m128 detA = swizzle<0x00>(dets);
+        __m128 detB = swizzle<0x55>(dets);
+        __m128 detC = swizzle<0xAA>(dets);
+        __m128 detD = swizzle<0xFF>(dets);
+
+        __m128 dc = mat2AdjMul(d, e);
+        __m128 ab = mat2AdjMul(a, b);
+        __m128 x  = _mm_fmsub_ps(detD, a, mat2Mul(b, dc));
+        __m128 w  = _mm_fmsub_ps(detA, d, mat2Mul(e, ab));
+        __m128 y  = _mm_fmsub_ps(detB, e, mat2MulAdj(d, ab));
+        __m128 z  = _mm_fmsub_ps(detC, b, mat2MulAdj(a, dc));
+
+        __m128 trace = _mm_mul_ps(ab, swizzle<_MM_SHUFFLE(3, 1, 2, 0)>(dc));
+        trace        = _mm_hadd_ps(trace, trace);
+        trace        = _mm_hadd_ps(trace, trace);
+        __m128 det   = _mm_sub_ps(_mm_fmadd_ps(detA, detD, _mm_mul_ps(detB, detC)), trace);
+        __m128 scale = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+        x = _mm_mul_ps(x, scale);
+        y = _mm_mul_ps(y, scale);
+        z = _mm_mul_ps(z, scale);
+        w = _mm_mul_ps(w, scale);
+
+        Mat4 r;
+        r.c[0] = FLOATX4(x).shuffle<_MM_SHUFFLE(1, 3, 1, 3)>(y);
+        r.c[1] = FLOATX4(x).shuffle<_MM_SHUFFLE(0, 2, 0, 2)>(y);
+        r.c[2] = FLOATX4(z).shuffle<_MM_SHUFFLE(1, 3, 1, 3)>(w);
+        r.c[3] = FLOATX4(z).shuffle<_MM_SHUFFLE(0, 2, 0, 2)>(w);
+        return r;
+    }
+
+public:
+    FLOATX4 c[4];
+};
+
+namespace slimm
+{
+namespace detail
+{
+
+/* Structure-of-arrays transform; W is the homogeneous coordinate of the inputs */
+template <int W, bool PROJECT>
+static inline void geomTransform(const Mat4 &m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n) noexcept
+{
+    using V            = GeomFloat;
+    constexpr size_t L = GEOM_LANES;
+
+    alignas(16) float e[16];
+    for (size_t i = 0; i < 4; i++) {
+        _mm_store_ps(e + 4 * i, m.c[i]);
+    }
+    /* e[4 * col + row] */
+    auto row = [&](size_t r, float px, float py, float pz) { return e[r] * px + e[4 + r] * py + e[8 + r] * pz + W * e[12 + r]; };
+
+    V m00(e[0]), m01(e[4]), m02(e[8]), m03(W * e[12]);
+    V m10(e[1]), m11(e[5]), m12(e[9]), m13(W * e[13]);
+    V m20(e[2]), m21(e[6]), m22(e[10]), m23(W * e[14]);
+    V m30(e[3]), m31(e[7]), m32(e[11]), m33(W * e[15]);
+
+    const size_t end = n - n % L;
+    for (size_t i = 0; i < end; i += L) {
+        V px, py, pz;
+        px.loadu(x + i);
+        py.loadu(y + i);
+        pz.loadu(z + i);
+        V rx = px.fmadd(m00, py.fmadd(m01, pz.fmadd(m02, m03)));
+        V ry = px.fmadd(m10, py.fmadd(m11, pz.fmadd(m12, m13)));
+        V rz = px.fmadd(m20, py.fmadd(m21, pz.fmadd(m22, m23)));
+        if constexpr (PROJECT) {
+            V rw = px.fmadd(m30, py.fmadd(m31, pz.fmadd(m32, m33)));
+            rx   = rx / rw;
+            ry   = ry / rw;
+            rz   = rz / rw;
+        }
+        rx.storeu(ox + i);
+        ry.storeu(oy + i);
+        rz.storeu(oz + i);
+    }
+    for (size_t i = end; i < n; i++) {
+        float px = x[i], py = y[i], pz = z[i];
+        float rx = row(0, px, py, pz), ry = row(1, px, py, pz), rz = row(2, px, py, pz);
+        if constexpr (PROJECT) {
+            float rw = row(3, px, py, pz);
+            rx /= rw;
+            ry /= rw;
+            rz /= rw;
+        }
+        ox[i] = rx;
+        oy[i] = ry;
+        oz[i] = rz;
+    }
+}
+
+} // namespace detail
+} // namespace slimm
+
+/**
+ * @brief Points (x, y, z, 1) of n-element coordinate arrays through m, ignoring its last row
+ *
+ * A register of FLOATX8 or FLOATX16 lanes of each coordinate is transformed
+ * at a time. The outputs may be the input arrays.
+ */
+static inline void transformPoints(const Mat4 &m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n) noexcept
+{
+    slimm::detail::geomTransform<1, false>(m, x, y, z, ox, oy, oz, n);
+}
+
+/**
+ * @brief Directions (x, y, z, 0) through m; translation does not apply
+ */
+static inline void transformVectors(const Mat4 &m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n) noexcept
+{
+    slimm::detail::geomTransform<0, false>(m, x, y, z, ox, oy, oz, n);
+}
+
+/**
+ * @brief Points (x, y, z, 1) through m followed by the perspective divide
+ */
+static inline void projectPoints(const Mat4 &m, const float *x, const float *y, const float *z, float *ox, float *oy, float *oz, size_t n) noexcept
+{
+    slimm::detail::geomTransform<1, true>(m, x, y, z, ox, oy, oz, n);
+}
@@ -0,0 +1,866 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+static constexpr uint32_t XXH_PRIME32_1 = 0x9E3779B1U;
+static constexpr uint32_t XXH_PRIME32_2 = 0x85EBCA77U;
+static constexpr uint32_t XXH_PRIME32_3 = 0xC2B2AE3DU;
+static constexpr uint32_t XXH_PRIME32_4 = 0x27D4EB2FU;
+static constexpr uint32_t XXH_PRIME32_5 = 0x165667B1U;
+
+static constexpr uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static constexpr uint64_t XXH_PRIME_MX1 = 0x165667919E3779F9ULL;
+static constexpr uint64_t XXH_PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+static constexpr size_t XXH3_SECRET_SIZE = 192;
+static constexpr size_t XXH3_STRIPE_LEN  = 64;
+static constexpr size_t XXH3_MIDSIZE_MAX = 240;
+
+alignas(64) static constexpr uint8_t XXH3_SECRET[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static constexpr uint64_t WYHASH_SECRET[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL
+};
+
+/* Castagnoli polynomial, bit-reflected */
+static constexpr uint32_t CRC32C_POLY = 0x82F63B78U;
+
+static constexpr size_t CRC32C_LONG_BLOCK  = 4096;
+static constexpr size_t CRC32C_SHORT_BLOCK = 256;
+
+static inline uint64_t read64(const uint8_t *p) noexcept
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const uint8_t *p) noexcept
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint32_t rotl32(uint32_t x, int r) noexcept
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint64_t swap64(uint64_t x) noexcept
+{
+    return _bswap64(x);
+}
+
+static inline void mul128(uint64_t a, uint64_t b, uint64_t &lo, uint64_t &hi) noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    lo = _umul128(a, b, &hi);
+#else
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    lo = static_cast<uint64_t>(r);
+    hi = static_cast<uint64_t>(r >> 64);
+#endif
+}
+
+static inline uint64_t mul128Fold(uint64_t a, uint64_t b) noexcept
+{
+    uint64_t lo, hi;
+    mul128(a, b, lo, hi);
+    return lo ^ hi;
+}
+
+/**
+ * Per-width lane helpers, overloaded on the raw register type so that the
+ * batch kernels below are written once for UINT*X4/X8 and UINT*X8/X16.
+ */
+static inline __m256i add64(__m256i a, __m256i b) noexcept { return _mm256_add_epi64(a, b); }
+static inline __m512i add64(__m512i a, __m512i b) noexcept { return _mm512_add_epi64(a, b); }
+static inline __m256i add32(__m256i a, __m256i b) noexcept { return _mm256_add_epi32(a, b); }
+static inline __m512i add32(__m512i a, __m512i b) noexcept { return _mm512_add_epi32(a, b); }
+static inline __m256i xorv(__m256i a, __m256i b) noexcept { return _mm256_xor_si256(a, b); }
+static inline __m512i xorv(__m512i a, __m512i b) noexcept { return _mm512_xor_si512(a, b); }
+static inline __m256i andv(__m256i a, __m256i b) noexcept { return _mm256_and_si256(a, b); }
+static inline __m512i andv(__m512i a, __m512i b) noexcept { return _mm512_and_si512(a, b); }
+static inline __m256i mulEpu32(__m256i a, __m256i b) noexcept { return _mm256_mul_epu32(a, b); }
+static inline __m512i mulEpu32(__m512i a, __m512i b) noexcept { return _mm512_mul_epu32(a, b); }
+static inline __m256i mullo32(__m256i a, __m256i b) noexcept { return _mm256_mullo_epi32(a, b); }
+static inline __m512i mullo32(__m512i a, __m512i b) noexcept { return _mm512_mullo_epi32(a, b); }
+
+template <int n> static inline __m256i srli64(__m256i a) noexcept { return _mm256_srli_epi64(a, n); }
+template <int n> static inline __m512i srli64(__m512i a) noexcept { return _mm512_srli_epi64(a, n); }
+template <int n> static inline __m256i slli64(__m256i a) noexcept { return _mm256_slli_epi64(a, n); }
+template <int n> static inline __m512i slli64(__m512i a) noexcept { return _mm512_slli_epi64(a, n); }
+template <int n> static inline __m256i srli32(__m256i a) noexcept { return _mm256_srli_epi32(a, n); }
+template <int n> static inline __m512i srli32(__m512i a) noexcept { return _mm512_srli_epi32(a, n); }
+
+static inline void loadu(__m256i &v, const void *p) noexcept { v = _mm256_loadu_si256(static_cast<const __m256i *>(p)); }
+static inline void loadu(__m512i &v, const void *p) noexcept { v = _mm512_loadu_si512(p); }
+static inline void storeu(void *p, __m256i v) noexcept { _mm256_storeu_si256(static_cast<__m256i *>(p), v); }
+static inline void storeu(void *p, __m512i v) noexcept { _mm512_storeu_si512(p, v); }
+
+template <class V> static inline V set64(uint64_t x) noexcept;
+template <> inline __m256i set64<__m256i>(uint64_t x) noexcept { return _mm256_set1_epi64x(static_cast<int64_t>(x)); }
+template <> inline __m512i set64<__m512i>(uint64_t x) noexcept { return _mm512_set1_epi64(static_cast<int64_t>(x)); }
+
+template <class V> static inline V set32(uint32_t x) noexcept;
+template <> inline __m256i set32<__m256i>(uint32_t x) noexcept { return _mm256_set1_epi32(static_cast<int32_t>(x)); }
+template <> inline __m512i set32<__m512i>(uint32_t x) noexcept { return _mm512_set1_epi32(static_cast<int32_t>(x)); }
+
+/* Swaps adjacent 64-bit lanes */
+static inline __m256i swapPairs64(__m256i a) noexcept { return _mm256_shuffle_epi32(a, _MM_SHUFFLE(1, 0, 3, 2)); }
+static inline __m512i swapPairs64(__m512i a) noexcept { return _mm512_shuffle_epi32(a, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(1, 0, 3, 2))); }
+
+static inline __m256i mullo64(__m256i a, __m256i b) noexcept
+{
+#if defined(__AVX512DQ__) && defined(__AVX512VL__)
+    return _mm256_mullo_epi64(a, b);
+#else
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+#endif
+}
+
+static inline __m512i mullo64(__m512i a, __m512i b) noexcept
+{
+#if defined(__AVX512DQ__)
+    return _mm512_mullo_epi64(a, b);
+#else
+    __m512i cross = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a, 32), b), _mm512_mul_epu32(a, _mm512_srli_epi64(b, 32)));
+    return _mm512_add_epi64(_mm512_mul_epu32(a, b), _mm512_slli_epi64(cross, 32));
+#endif
+}
+
+template <int r>
+static inline __m256i rotl64(__m256i a) noexcept
+{
+#if defined(__AVX512VL__)
+    return _mm256_rol_epi64(a, r);
+#else
+    return _mm256_or_si256(_mm256_slli_epi64(a, r), _mm256_srli_epi64(a, 64 - r));
+#endif
+}
+
+template <int r>
+static inline __m512i rotl64(__m512i a) noexcept
+{
+    return _mm512_rol_epi64(a, r);
+}
+
+template <int r>
+static inline __m256i rotl32(__m256i a) noexcept
+{
+#if defined(__AVX512VL__)
+    return _mm256_rol_epi32(a, r);
+#else
+    return _mm256_or_si256(_mm256_slli_epi32(a, r), _mm256_srli_epi32(a, 32 - r));
+#endif
+}
+
+template <int r>
+static inline __m512i rotl32(__m512i a) noexcept
+{
+    return _mm512_rol_epi32(a, r);
+}
+
+/* Full 64x64->128 multiply per lane built from four 32x32->64 products: a <- low, b <- high */
+template <class V>
+static inline void mul128(V &a, V &b) noexcept
+{
+    V mask = set64<V>(0xFFFFFFFFULL);
+    V ah = srli64<32>(a);
+    V bh = srli64<32>(b);
+    V ll = mulEpu32(a, b);
+    V lh = mulEpu32(a, bh);
+    V hl = mulEpu32(ah, b);
+    V hh = mulEpu32(ah, bh);
+
+    V mid = add64(add64(srli64<32>(ll), andv(lh, mask)), andv(hl, mask));
+    a = add64(ll, slli64<32>(add64(lh, hl)));
+    b = add64(add64(hh, srli64<32>(lh)), add64(srli64<32>(hl), srli64<32>(mid)));
+}
+
+static inline uint64_t xxh64Round(uint64_t acc, uint64_t input) noexcept
+{
+    acc += input * XXH_PRIME64_2;
+    acc  = rotl64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh64MergeRound(uint64_t acc, uint64_t val) noexcept
+{
+    acc ^= xxh64Round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static inline uint64_t xxh64Avalanche(uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint32_t xxh32Round(uint32_t acc, uint32_t input) noexcept
+{
+    acc += input * XXH_PRIME32_2;
+    acc  = rotl32(acc, 13);
+    return acc * XXH_PRIME32_1;
+}
+
+static inline uint32_t xxh32Avalanche(uint32_t h) noexcept
+{
+    h ^= h >> 15;
+    h *= XXH_PRIME32_2;
+    h ^= h >> 13;
+    h *= XXH_PRIME32_3;
+    h ^= h >> 16;
+    return h;
+}
+
+static inline uint64_t xxh3Avalanche(uint64_t h) noexcept
+{
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t xxh3Rrmxmx(uint64_t h, uint64_t len) noexcept
+{
+    h ^= rotl64(h, 49) ^ rotl64(h, 24);
+    h *= XXH_PRIME_MX2;
+    h ^= (h >> 35) + len;
+    h *= XXH_PRIME_MX2;
+    return h ^ (h >> 28);
+}
+
+static inline uint64_t xxh3Mix16(const uint8_t *p, const uint8_t *secret, uint64_t seed) noexcept
+{
+    return mul128Fold(read64(p) ^ (read64(secret) + seed), read64(p + 8) ^ (read64(secret + 8) - seed));
+}
+
+static inline uint64_t xxh3Short(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed) noexcept
+{
+    if (len > 8) {
+        uint64_t lo  = read64(p) ^ ((read64(secret + 24) ^ read64(secret + 32)) + seed);
+        uint64_t hi  = read64(p + len - 8) ^ ((read64(secret + 40) ^ read64(secret + 48)) - seed);
+        uint64_t acc = len + swap64(lo) + hi + mul128Fold(lo, hi);
+        return xxh3Avalanche(acc);
+    }
+    if (len >= 4) {
+        seed ^= static_cast<uint64_t>(_bswap(static_cast<int>(static_cast<uint32_t>(seed)))) << 32;
+        uint64_t input = read32(p + len - 4) + (static_cast<uint64_t>(read32(p)) << 32);
+        uint64_t flip  = (read64(secret + 8) ^ read64(secret + 16)) - seed;
+        return xxh3Rrmxmx(input ^ flip, len);
+    }
+    if (len > 0) {
+        uint32_t combined = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[len >> 1]) << 24) |
+                            static_cast<uint32_t>(p[len - 1]) | (static_cast<uint32_t>(len) << 8);
+        uint64_t flip = (read32(secret) ^ read32(secret + 4)) + seed;
+        return xxh64Avalanche(combined ^ flip);
+    }
+    return xxh64Avalanche(seed ^ (read64(secret + 56) ^ read64(secret + 64)));
+}
+
+static inline uint64_t xxh3Medium(const uint8_t *p, size_t len, const uint8_t *secret, uint64_t seed) noexcept
+{
+    uint64_t acc = len * XXH_PRIME64_1;
+    if (len <= 128) {
+        if (len > 32) {
+            if (len > 64) {
+                if (len > 96) {
+                    acc += xxh3Mix16(p + 48, secret + 96, seed);
+                    acc += xxh3Mix16(p + len - 64, secret + 112, seed);
+                }
+                acc += xxh3Mix16(p + 32, secret + 64, seed);
+                acc += xxh3Mix16(p + len - 48, secret + 80, seed);
+            }
+            acc += xxh3Mix16(p + 16, secret + 32, seed);
+            acc += xxh3Mix16(p + len - 32, secret + 48, seed);
+        }
+        acc += xxh3Mix16(p, secret, seed);
+        acc += xxh3Mix16(p + len - 16, secret + 16, seed);
+        return xxh3Avalanche(acc);
+    }
+
+    size_t rounds = len / 16;
+    for (size_t i = 0; i < 8; i++) {
+        acc += xxh3Mix16(p + 16 * i, secret + 16 * i, seed);
+    }
+    acc = xxh3Avalanche(acc);
+
+    uint64_t tail = xxh3Mix16(p + len - 16, secret + 136 - 17, seed);
+    for (size_t i = 8; i < rounds; i++) {
+        tail += xxh3Mix16(p + 16 * i, secret + 16 * (i - 8) + 3, seed);
+    }
+    return xxh3Avalanche(acc + tail);
+}
+
+#if defined(__AVX512F__)
+using Xxh3Lanes = UINT64X8;
+#else
+using Xxh3Lanes = UINT64X4;
+#endif
+
+static constexpr size_t XXH3_LANE_VECTORS = XXH3_STRIPE_LEN / sizeof(Xxh3Lanes);
+
+/* One 64-byte stripe: acc[i ^ 1] += data[i]; acc[i] += lo32(data[i] ^ key[i]) * hi32(data[i] ^ key[i]) */
+static inline void xxh3Accumulate(Xxh3Lanes *acc, const uint8_t *p, const uint8_t *secret) noexcept
+{
+    for (size_t i = 0; i < XXH3_LANE_VECTORS; i++) {
+        Xxh3Lanes::value_type data, key;
+        loadu(data, p + i * sizeof(Xxh3Lanes));
+        loadu(key, secret + i * sizeof(Xxh3Lanes));
+        key = xorv(data, key);
+        acc[i] = add64(mulEpu32(key, srli64<32>(key)), add64(acc[i], swapPairs64(data)));
+    }
+}
+
+static inline void xxh3Scramble(Xxh3Lanes *acc, const uint8_t *secret) noexcept
+{
+    using V = Xxh3Lanes::value_type;
+    V prime = set64<V>(XXH_PRIME32_1);
+    for (size_t i = 0; i < XXH3_LANE_VECTORS; i++) {
+        V key;
+        loadu(key, secret + i * sizeof(Xxh3Lanes));
+        V a = xorv(xorv(acc[i].v, srli64<47>(acc[i].v)), key);
+        acc[i] = add64(mulEpu32(a, prime), slli64<32>(mulEpu32(srli64<32>(a), prime)));
+    }
+}
+
+static inline uint64_t xxh3Long(const uint8_t *p, size_t len, const uint8_t *secret) noexcept
+{
+    constexpr size_t stripesPerBlock = (XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / 8;
+    constexpr size_t blockLen = XXH3_STRIPE_LEN * stripesPerBlock;
+
+    alignas(64) uint64_t state[8] = {
+        XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+        XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1
+    };
+
+    Xxh3Lanes acc[XXH3_LANE_VECTORS];
+    for (size_t i = 0; i < XXH3_LANE_VECTORS; i++) {
+        loadu(acc[i].v, state + i * (8 / XXH3_LANE_VECTORS));
+    }
+
+    size_t blocks = (len - 1) / blockLen;
+    for (size_t n = 0; n < blocks; n++) {
+        const uint8_t *block = p + n * blockLen;
+        for (size_t s = 0; s < stripesPerBlock; s++) {
+            xxh3Accumulate(acc, block + s * XXH3_STRIPE_LEN, secret + s * 8);
+        }
+        xxh3Scramble(acc, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+    }
+
+    size_t stripes = ((len - 1) - blockLen * blocks) / XXH3_STRIPE_LEN;
+    for (size_t s = 0; s < stripes; s++) {
+        xxh3Accumulate(acc, p + blocks * blockLen + s * XXH3_STRIPE_LEN, secret + s * 8);
+    }
+    xxh3Accumulate(acc, p + len - XXH3_STRIPE_LEN, secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - 7);
+
+    for (size_t i = 0; i < XXH3_LANE_VECTORS; i++) {
+        storeu(state + i * (8 / XXH3_LANE_VECTORS), acc[i].v);
+    }
+
+    uint64_t result = len * XXH_PRIME64_1;
+    for (size_t i = 0; i < 4; i++) {
+        result += mul128Fold(state[2 * i] ^ read64(secret + 11 + 16 * i), state[2 * i + 1] ^ read64(secret + 11 + 16 * i + 8));
+    }
+    return xxh3Avalanche(result);
+}
+
+/* XXH64 of a single 8-byte input, one key per lane */
+template <class V>
+static inline V xxh64Lanes(V key, uint64_t seed) noexcept
+{
+    V k = mullo64(rotl64<31>(mullo64(key, set64<V>(XXH_PRIME64_2))), set64<V>(XXH_PRIME64_1));
+    V h = xorv(set64<V>(seed + XXH_PRIME64_5 + 8), k);
+    h = add64(mullo64(rotl64<27>(h), set64<V>(XXH_PRIME64_1)), set64<V>(XXH_PRIME64_4));
+
+    h = mullo64(xorv(h, srli64<33>(h)), set64<V>(XXH_PRIME64_2));
+    h = mullo64(xorv(h, srli64<29>(h)), set64<V>(XXH_PRIME64_3));
+    return xorv(h, srli64<32>(h));
+}
+
+/* XXH32 of a single 4-byte input, one key per lane */
+template <class V>
+static inline V xxh32Lanes(V key, uint32_t seed) noexcept
+{
+    V h = add32(set32<V>(seed + XXH_PRIME32_5 + 4), mullo32(key, set32<V>(XXH_PRIME32_3)));
+    h = mullo32(rotl32<17>(h), set32<V>(XXH_PRIME32_4));
+
+    h = mullo32(xorv(h, srli32<15>(h)), set32<V>(XXH_PRIME32_2));
+    h = mullo32(xorv(h, srli32<13>(h)), set32<V>(XXH_PRIME32_3));
+    return xorv(h, srli32<16>(h));
+}
+
+static inline uint64_t wyhashSeed(uint64_t seed) noexcept
+{
+    return seed ^ mul128Fold(seed ^ WYHASH_SECRET[0], WYHASH_SECRET[1]);
+}
+
+/* wyhash of a single 8-byte input, one key per lane; seed must already be mixed by wyhashSeed */
+template <class V>
+static inline V wyhashLanes(V key, uint64_t seed) noexcept
+{
+    V a = xorv(rotl64<32>(key), set64<V>(WYHASH_SECRET[1]));
+    V b = xorv(key, set64<V>(seed));
+    mul128(a, b);
+
+    a = xorv(a, set64<V>(WYHASH_SECRET[0] ^ 8));
+    b = xorv(b, set64<V>(WYHASH_SECRET[1]));
+    mul128(a, b);
+    return xorv(a, b);
+}
+
+static inline uint64_t wyhashKey(uint64_t key, uint64_t seed) noexcept
+{
+    uint64_t a = rotl64(key, 32) ^ WYHASH_SECRET[1];
+    uint64_t b = key ^ seed;
+    mul128(a, b, a, b);
+    return mul128Fold(a ^ WYHASH_SECRET[0] ^ 8, b ^ WYHASH_SECRET[1]);
+}
+
+/* x^n mod P in the bit-reflected domain used by the crc32 instruction */
+static constexpr uint32_t crc32cXPow(size_t n) noexcept
+{
+    uint32_t r = 0x80000000U;
+    for (size_t i = 0; i < n; i++) {
+        r = (r & 1) ? (r >> 1) ^ CRC32C_POLY : r >> 1;
+    }
+    return r;
+}
+
+static inline uint32_t crc32cTail(uint32_t crc, const uint8_t *p, size_t len) noexcept
+{
+    uint64_t c = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        c = _mm_crc32_u64(c, read64(p));
+    }
+    crc = static_cast<uint32_t>(c);
+    for (; len > 0; len--, p++) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+
+/**
+ * Runs the crc32 instruction over three adjacent blocks at once to hide its
+ * 3-cycle latency, then shifts the first two partial CRCs past the blocks
+ * that follow them with a carry-less multiply and merges the three.
+ */
+template <size_t BLOCK>
+static inline uint32_t crc32cTriple(uint32_t crc, const uint8_t *p) noexcept
+{
+    constexpr uint32_t shift1 = crc32cXPow(BLOCK * 8 - 33);
+    constexpr uint32_t shift2 = crc32cXPow(BLOCK * 16 - 33);
+
+    uint64_t c0 = crc, c1 = 0, c2 = 0;
+    for (size_t i = 0; i < BLOCK; i += 8) {
+        c0 = _mm_crc32_u64(c0, read64(p + i));
+        c1 = _mm_crc32_u64(c1, read64(p + BLOCK + i));
+        c2 = _mm_crc32_u64(c2, read64(p + 2 * BLOCK + i));
+    }
+
+    __m128i k = _mm_set_epi64x(shift1, shift2);
+    __m128i c = _mm_set_epi64x(static_cast<int64_t>(c1), static_cast<int64_t>(c0));
+    __m128i m = _mm_xor_si128(_mm_clmulepi64_si128(c, k, 0x00), _mm_clmulepi64_si128(c, k, 0x11));
+    return static_cast<uint32_t>(_mm_crc32_u64(0, _mm_cvtsi128_si64(m)) ^ c2);
+}
+
+/* Folds a 128-bit remainder forward by the distance encoded in k */
+static inline __m128i crc32cFold128(__m128i x, __m128i k) noexcept
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief XXH64 of 8-byte keys, one per lane; bit-compatible with XXH64(&key, 8, seed)
+ */
+static inline UINT64X4 xxhash64(const UINT64X4 &keys, uint64_t seed = 0) noexcept
+{
+    return slimm::detail::xxh64Lanes(keys.v, seed);
+}
+
+static inline UINT64X8 xxhash64(const UINT64X8 &keys, uint64_t seed = 0) noexcept
+{
+    return slimm::detail::xxh64Lanes(keys.v, seed);
+}
+
+/**
+ * @brief XXH32 of 4-byte keys, one per lane; bit-compatible with XXH32(&key, 4, seed)
+ */
+static inline UINT32X8 xxhash32(const UINT32X8 &keys, uint32_t seed = 0) noexcept
+{
+    return slimm::detail::xxh32Lanes(keys.v, seed);
+}
+
+static inline UINT32X16 xxhash32(const UINT32X16 &keys, uint32_t seed = 0) noexcept
+{
+    return slimm::detail::xxh32Lanes(keys.v, seed);
+}
+
+/**
+ * @brief wyhash (final4) of 8-byte keys, one per lane; bit-compatible with wyhash(&key, 8, seed, _wyp)
+ */
+static inline UINT64X4 wyhash(const UINT64X4 &keys, uint64_t seed = 0) noexcept
+{
+    return slimm::detail::wyhashLanes(keys.v, slimm::detail::wyhashSeed(seed));
+}
+
+static inline UINT64X8 wyhash(const UINT64X8 &keys, uint64_t seed = 0) noexcept
+{
+    return slimm::detail::wyhashLanes(keys.v, slimm::detail::wyhashSeed(seed));
+}
+
+/**
+ * @brief Scalar XXH64 of an arbitrary buffer
+ */
+static inline uint64_t xxhash64(const void *data, size_t len, uint64_t seed = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    const uint8_t *p   = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + len;
+
+    uint64_t h;
+    if (len >= 32) {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+        do {
+            v1 = xxh64Round(v1, read64(p));
+            v2 = xxh64Round(v2, read64(p + 8));
+            v3 = xxh64Round(v3, read64(p + 16));
+            v4 = xxh64Round(v4, read64(p + 24));
+            p += 32;
+        } while (end - p >= 32);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh64MergeRound(h, v1);
+        h = xxh64MergeRound(h, v2);
+        h = xxh64MergeRound(h, v3);
+        h = xxh64MergeRound(h, v4);
+    } else {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += len;
+    for (; end - p >= 8; p += 8) {
+        h ^= xxh64Round(0, read64(p));
+        h  = rotl64(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    if (end - p >= 4) {
+        h ^= read32(p) * XXH_PRIME64_1;
+        h  = rotl64(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= *p * XXH_PRIME64_5;
+        h  = rotl64(h, 11) * XXH_PRIME64_1;
+    }
+
+    return xxh64Avalanche(h);
+}
+
+/**
+ * @brief Scalar XXH32 of an arbitrary buffer
+ */
+static inline uint32_t xxhash32(const void *data, size_t len, uint32_t seed = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    const uint8_t *p   = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + len;
+
+    uint32_t h;
+    if (len >= 16) {
+        uint32_t v1 = seed + XXH_PRIME32_1 + XXH_PRIME32_2;
+        uint32_t v2 = seed + XXH_PRIME32_2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - XXH_PRIME32_1;
+        do {
+            v1 = xxh32Round(v1, read32(p));
+            v2 = xxh32Round(v2, read32(p + 4));
+            v3 = xxh32Round(v3, read32(p + 8));
+            v4 = xxh32Round(v4, read32(p + 12));
+            p += 16;
+        } while (end - p >= 16);
+
+        h = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    } else {
+        h = seed + XXH_PRIME32_5;
+    }
+
+    h += static_cast<uint32_t>(len);
+    for (; end - p >= 4; p += 4) {
+        h += read32(p) * XXH_PRIME32_3;
+        h  = rotl32(h, 17) * XXH_PRIME32_4;
+    }
+    for (; p < end; p++) {
+        h += *p * XXH_PRIME32_5;
+        h  = rotl32(h, 11) * XXH_PRIME32_1;
+    }
+
+    return xxh32Avalanche(h);
+}
+
+/**
+ * @brief XXH3 (64-bit) of an arbitrary buffer; bit-compatible with XXH3_64bits_withSeed()
+ *
+ * Inputs longer than 240 bytes run the eight-accumulator stripe loop on
+ * UINT64X8, or on a pair of UINT64X4 without AVX-512.
+ */
+static inline uint64_t xxhash3(const void *data, size_t len, uint64_t seed = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    if (len <= 16) {
+        return xxh3Short(p, len, XXH3_SECRET, seed);
+    }
+    if (len <= XXH3_MIDSIZE_MAX) {
+        return xxh3Medium(p, len, XXH3_SECRET, seed);
+    }
+    if (seed == 0) {
+        return xxh3Long(p, len, XXH3_SECRET);
+    }
+
+    alignas(64) uint8_t secret[XXH3_SECRET_SIZE];
+    for (size_t i = 0; i < XXH3_SECRET_SIZE; i += 16) {
+        uint64_t lo = read64(XXH3_SECRET + i) + seed;
+        uint64_t hi = read64(XXH3_SECRET + i + 8) - seed;
+        std::memcpy(secret + i, &lo, sizeof(lo));
+        std::memcpy(secret + i + 8, &hi, sizeof(hi));
+    }
+    return xxh3Long(p, len, secret);
+}
+
+/**
+ * @brief Scalar wyhash (final4) of an arbitrary buffer with the default secret
+ */
+static inline uint64_t wyhash(const void *data, size_t len, uint64_t seed = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    const uint8_t  *p = static_cast<const uint8_t *>(data);
+    const uint64_t *s = WYHASH_SECRET;
+
+    seed = wyhashSeed(seed);
+
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (static_cast<uint64_t>(read32(p)) << 32) | read32(p + ((len >> 3) << 2));
+            b = (static_cast<uint64_t>(read32(p + len - 4)) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mul128Fold(read64(p) ^ s[1], read64(p + 8) ^ seed);
+                see1 = mul128Fold(read64(p + 16) ^ s[2], read64(p + 24) ^ see1);
+                see2 = mul128Fold(read64(p + 32) ^ s[3], read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mul128Fold(read64(p) ^ s[1], read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read64(p + i - 16);
+        b = read64(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+    mul128(a, b, a, b);
+    return mul128Fold(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+/**
+ * @brief Hashes count 8-byte keys into hashes with XXH64, eight (or four) lanes at a time
+ */
+static inline void xxhash64(const uint64_t *keys, uint64_t *hashes, size_t count, uint64_t seed = 0) noexcept
+{
+#if defined(__AVX512F__)
+    using Lanes = UINT64X8;
+#else
+    using Lanes = UINT64X4;
+#endif
+    constexpr size_t width = sizeof(Lanes) / sizeof(uint64_t);
+
+    size_t i = 0;
+    for (; i + width <= count; i += width) {
+        Lanes::value_type k;
+        slimm::detail::loadu(k, keys + i);
+        slimm::detail::storeu(hashes + i, xxhash64(Lanes{ k }, seed).v);
+    }
+    for (; i < count; i++) {
+        hashes[i] = xxhash64(keys + i, sizeof(uint64_t), seed);
+    }
+}
+
+/**
+ * @brief Hashes count 4-byte keys into hashes with XXH32, sixteen (or eight) lanes at a time
+ */
+static inline void xxhash32(const uint32_t *keys, uint32_t *hashes, size_t count, uint32_t seed = 0) noexcept
+{
+#if defined(__AVX512F__)
+    using Lanes = UINT32X16;
+#else
+    using Lanes = UINT32X8;
+#endif
+    constexpr size_t width = sizeof(Lanes) / sizeof(uint32_t);
+
+    size_t i = 0;
+    for (; i + width <= count; i += width) {
+        Lanes::value_type k;
+        slimm::detail::loadu(k, keys + i);
+        slimm::detail::storeu(hashes + i, xxhash32(Lanes{ k }, seed).v);
+    }
+    for (; i < count; i++) {
+        hashes[i] = xxhash32(keys + i, sizeof(uint32_t), seed);
+    }
+}
+
+/**
+ * @brief Hashes count 8-byte keys into hashes with wyhash, eight (or four) lanes at a time
+ */
+static inline void wyhash(const uint64_t *keys, uint64_t *hashes, size_t count, uint64_t seed = 0) noexcept
+{
+#if defined(__AVX512F__)
+    using Lanes = UINT64X8;
+#else
+    using Lanes = UINT64X4;
+#endif
+    constexpr size_t width = sizeof(Lanes) / sizeof(uint64_t);
+
+    uint64_t mixed = slimm::detail::wyhashSeed(seed);
+
+    size_t i = 0;
+    for (; i + width <= count; i += width) {
+        Lanes::value_type k;
+        slimm::detail::loadu(k, keys + i);
+        slimm::detail::storeu(hashes + i, slimm::detail::wyhashLanes(k, mixed));
+    }
+    for (; i < count; i++) {
+        hashes[i] = slimm::detail::wyhashKey(keys[i], mixed);
+    }
+}
+
+/**
+ * @brief CRC-32C (Castagnoli) with the crc32 instruction interleaved over three streams
+ *
+ * crc is the result of a previous call to continue a running checksum, or 0.
+ */
+static inline uint32_t crc32c(const void *data, size_t len, uint32_t crc = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint32_t c = ~crc;
+
+    for (; len >= 3 * CRC32C_LONG_BLOCK; len -= 3 * CRC32C_LONG_BLOCK, p += 3 * CRC32C_LONG_BLOCK) {
+        c = crc32cTriple<CRC32C_LONG_BLOCK>(c, p);
+    }
+    for (; len >= 3 * CRC32C_SHORT_BLOCK; len -= 3 * CRC32C_SHORT_BLOCK, p += 3 * CRC32C_SHORT_BLOCK) {
+        c = crc32cTriple<CRC32C_SHORT_BLOCK>(c, p);
+    }
+
+    return ~crc32cTail(c, p, len);
+}
+
+/**
+ * @brief CRC-32C by folding four 128-bit lanes with PCLMULQDQ
+ *
+ * The remaining 128-bit remainder is reduced with the crc32 instruction.
+ * Produces the same value as crc32c().
+ */
+static inline uint32_t crc32cFold(const void *data, size_t len, uint32_t crc = 0) noexcept
+{
+    using namespace slimm::detail;
+
+    if (len < 64) {
+        return crc32c(data, len, crc);
+    }
+
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    const __m128i k512 = _mm_set_epi64x(crc32cXPow(512 - 33), crc32cXPow(512 + 31));
+    const __m128i k128 = _mm_set_epi64x(crc32cXPow(128 - 33), crc32cXPow(128 + 31));
+
+    __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 48));
+    x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128(static_cast<int>(~crc)));
+    p += 64;
+    len -= 64;
+
+    for (; len >= 64; len -= 64, p += 64) {
+        x0 = _mm_xor_si128(crc32cFold128(x0, k512), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        x1 = _mm_xor_si128(crc32cFold128(x1, k512), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16)));
+        x2 = _mm_xor_si128(crc32cFold128(x2, k512), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32)));
+        x3 = _mm_xor_si128(crc32cFold128(x3, k512), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 48)));
+    }
+
+    x1 = _mm_xor_si128(crc32cFold128(x0, k128), x1);
+    x2 = _mm_xor_si128(crc32cFold128(x1, k128), x2);
+    x3 = _mm_xor_si128(crc32cFold128(x2, k128), x3);
+    for (; len >= 16; len -= 16, p += 16) {
+        x3 = _mm_xor_si128(crc32cFold128(x3, k128), _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+    }
+
+    uint64_t c = _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(x3)));
+    c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm_extract_epi64(x3, 1)));
+    return ~crc32cTail(static_cast<uint32_t>(c), p, len);
+}
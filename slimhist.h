@@ -0,0 +1,449 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+
+/**
+ * Counting strategies. Tables interleaves private count tables so that
+ * neighbouring elements never increment the same counter back to back,
+ * Conflict gathers, increments and scatters 16 bins at a time with the
+ * AVX-512CD conflict detection and Compare counts every bin with vector
+ * compares, which only pays off for a handful of bins. Direct increments
+ * the output in place; it needs no setup, which suits inputs shorter than
+ * the bin count.
+ */
+enum class HistogramMethod
+{
+    Auto,
+    Tables,
+    Conflict,
+    Compare,
+    Direct,
+};
+
+namespace slimm::detail
+{
+
+/* Bin counts at or below which compare-and-count wins, for bytes and for 32-bit values */
+static constexpr uint32_t HIST_COMPARE_BYTE_BINS = 16;
+static constexpr uint32_t HIST_COMPARE_BINS      = 8;
+
+/* Bin counts up to which four private tables still sit comfortably in L2 */
+static constexpr uint32_t HIST_TABLE_BINS = 1 << 14;
+
+/*
+ * Input lengths below which Direct beats zeroing and folding the private
+ * tables even when every element hits the same bin. Byte tables live on
+ * the stack and cost about a quarter of what heap tables do per bin.
+ */
+static constexpr uint32_t HIST_DIRECT_BYTES = 64;
+
+/* Elements each thread should own before threading pays for the reduction */
+static constexpr size_t HIST_MIN_CHUNK = 1 << 18;
+
+/**
+ * Interleaved private count tables. Values at or above bins land in an
+ * overflow slot that is dropped, which keeps the inner loop free of
+ * branches. Four tables cover runs of equal values; one table is used when
+ * four copies would no longer fit in cache.
+ */
+struct HistogramTables
+{
+    std::vector<uint32_t> tables;
+    size_t                stride;
+    size_t                copies;
+    uint32_t              bins;
+
+    explicit HistogramTables(uint32_t bins)
+        : stride(bins + 1), copies(bins <= HIST_TABLE_BINS ? 4 : 1), bins(bins)
+    {
+        tables.resize(copies * stride);
+    }
+
+    template <class T>
+    void count(const T *data, size_t n) noexcept
+    {
+        uint32_t *t0 = tables.data();
+        uint32_t *t1 = t0 + (copies > 1 ? stride : 0);
+        uint32_t *t2 = t0 + (copies > 1 ? 2 * stride : 0);
+        uint32_t *t3 = t0 + (copies > 1 ? 3 * stride : 0);
+
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            t0[std::min<uint32_t>(data[i], bins)]++;
+            t1[std::min<uint32_t>(data[i + 1], bins)]++;
+            t2[std::min<uint32_t>(data[i + 2], bins)]++;
+            t3[std::min<uint32_t>(data[i + 3], bins)]++;
+        }
+        for (; i < n; i++) {
+            t0[std::min<uint32_t>(data[i], bins)]++;
+        }
+    }
+
+    void fold(uint32_t *counts) const noexcept
+    {
+        for (size_t c = 0; c < copies; c++) {
+            const uint32_t *t = tables.data() + c * stride;
+            for (uint32_t b = 0; b < bins; b++) {
+                counts[b] += t[b];
+            }
+        }
+    }
+};
+
+template <class T>
+static inline void histogramDirect(const T *data, size_t n, uint32_t *counts, uint32_t bins) noexcept
+{
+    for (size_t i = 0; i < n; i++) {
+        if (data[i] < bins) {
+            counts[data[i]]++;
+        }
+    }
+}
+
+template <class T>
+static inline void histogramTables(const T *data, size_t n, uint32_t *counts, uint32_t bins)
+{
+    HistogramTables tables(bins);
+    tables.count(data, n);
+    tables.fold(counts);
+}
+
+/* 256 tables' worth of bytes is small enough to live on the stack */
+static inline void histogramTables(const uint8_t *data, size_t n, uint32_t *counts, uint32_t bins) noexcept
+{
+    alignas(64) uint32_t tables[4][256] = {};
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        std::memcpy(&x, data + i, sizeof(x));
+        tables[0][x & 0xFF]++;
+        tables[1][(x >> 8) & 0xFF]++;
+        tables[2][(x >> 16) & 0xFF]++;
+        tables[3][(x >> 24) & 0xFF]++;
+        tables[0][(x >> 32) & 0xFF]++;
+        tables[1][(x >> 40) & 0xFF]++;
+        tables[2][(x >> 48) & 0xFF]++;
+        tables[3][x >> 56]++;
+    }
+    for (; i < n; i++) {
+        tables[0][data[i]]++;
+    }
+
+    for (uint32_t b = 0; b < bins; b++) {
+        counts[b] += tables[0][b] + tables[1][b] + tables[2][b] + tables[3][b];
+    }
+}
+
+/**
+ * Byte compare-and-count: every bin owns one UINT8X32 accumulator that is
+ * decremented by the compare mask and drained with psadbw before it can
+ * wrap. Each block is re-read once per bin, from L1.
+ */
+static inline void histogramCompare(const uint8_t *data, size_t n, uint32_t *counts, uint32_t bins) noexcept
+{
+    constexpr size_t BLOCK = 255 * 32;
+
+    size_t vectors = n / 32 * 32;
+    for (size_t begin = 0; begin < vectors; begin += BLOCK) {
+        size_t end = std::min(begin + BLOCK, vectors);
+        for (uint32_t b = 0; b < bins; b++) {
+            __m256i bin = _mm256_set1_epi8(static_cast<char>(b));
+            __m256i acc = _mm256_setzero_si256();
+            for (size_t i = begin; i < end; i += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                acc = _mm256_sub_epi8(acc, _mm256_cmpeq_epi8(v, bin));
+            }
+            __m256i sum = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+            __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            counts[b] += static_cast<uint32_t>(_mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1));
+        }
+    }
+    for (size_t i = vectors; i < n; i++) {
+        if (data[i] < bins) {
+            counts[data[i]]++;
+        }
+    }
+}
+
+/* 32-bit compare-and-count; the lanes cannot wrap before 2^32 elements per lane */
+static inline void histogramCompare(const uint32_t *data, size_t n, uint32_t *counts, uint32_t bins) noexcept
+{
+    constexpr size_t BLOCK = 1024;
+
+    size_t vectors = n / 8 * 8;
+    for (size_t begin = 0; begin < vectors; begin += BLOCK) {
+        size_t end = std::min(begin + BLOCK, vectors);
+        for (uint32_t b = 0; b < bins; b++) {
+            __m256i bin = _mm256_set1_epi32(static_cast<int>(b));
+            __m256i acc = _mm256_setzero_si256();
+            for (size_t i = begin; i < end; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(v, bin));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            half = _mm_add_epi32(half, _mm_unpackhi_epi64(half, half));
+            half = _mm_add_epi32(half, _mm_srli_epi64(half, 32));
+            counts[b] += static_cast<uint32_t>(_mm_cvtsi128_si32(half));
+        }
+    }
+    for (size_t i = vectors; i < n; i++) {
+        if (data[i] < bins) {
+            counts[data[i]]++;
+        }
+    }
+}
+
+#if defined(__AVX512CD__)
+/* Per-lane popcount of conflict masks, which never use more than the low 15 bits */
+static inline __m512i conflictCount(__m512i conflict) noexcept
+{
+#if defined(__AVX512VPOPCNTDQ__)
+    return _mm512_popcnt_epi32(conflict);
+#else
+    const __m512i nibbles = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    const __m512i low     = _mm512_set1_epi8(0x0F);
+    __m512i bytes = _mm512_add_epi8(_mm512_shuffle_epi8(nibbles, _mm512_and_si512(conflict, low)),
+                                    _mm512_shuffle_epi8(nibbles, _mm512_and_si512(_mm512_srli_epi32(conflict, 4), low)));
+    return _mm512_and_si512(_mm512_add_epi32(bytes, _mm512_srli_epi32(bytes, 8)), _mm512_set1_epi32(0xFF));
+#endif
+}
+
+/**
+ * Each lane adds one plus the number of earlier lanes sharing its bin.
+ * Scatters to the same address retire from the lowest lane to the highest,
+ * so the last lane of every group leaves the full count behind.
+ */
+static inline void histogramConflict(__m512i idx, uint32_t *counts, uint32_t bins) noexcept
+{
+    __mmask16 valid = _mm512_cmplt_epu32_mask(idx, _mm512_set1_epi32(static_cast<int>(bins)));
+    __m512i   add   = _mm512_add_epi32(conflictCount(_mm512_maskz_conflict_epi32(valid, idx)), _mm512_set1_epi32(1));
+    __m512i   cnt   = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), valid, idx, counts, 4);
+    _mm512_mask_i32scatter_epi32(counts, valid, idx, _mm512_add_epi32(cnt, add), 4);
+}
+
+template <class T>
+static inline void histogramConflict(const T *data, size_t n, uint32_t *counts, uint32_t bins) noexcept
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if constexpr (sizeof(T) == 1) {
+            histogramConflict(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i))), counts, bins);
+        } else {
+            histogramConflict(_mm512_loadu_si512(data + i), counts, bins);
+        }
+    }
+    for (; i < n; i++) {
+        if (data[i] < bins) {
+            counts[data[i]]++;
+        }
+    }
+}
+#endif
+
+/* Picks the strategy for n elements; Auto only counts in place when the table setup would dominate */
+template <class T>
+static inline HistogramMethod histogramMethod(size_t n, uint32_t bins, HistogramMethod method) noexcept
+{
+#if !defined(__AVX512CD__)
+    if (method == HistogramMethod::Conflict) {
+        method = HistogramMethod::Auto;
+    }
+#endif
+    if (method != HistogramMethod::Auto) {
+        return method;
+    }
+    if (bins <= (sizeof(T) == 1 ? HIST_COMPARE_BYTE_BINS : HIST_COMPARE_BINS)) {
+        return HistogramMethod::Compare;
+    }
+#if defined(__AVX512CD__)
+    if (sizeof(T) > 1) {
+        return HistogramMethod::Conflict;
+    }
+#endif
+    if (n < (sizeof(T) == 1 ? HIST_DIRECT_BYTES : bins)) {
+        return HistogramMethod::Direct;
+    }
+    return HistogramMethod::Tables;
+}
+
+/* Adds the histogram of data to counts */
+template <class T>
+static inline void histogram(const T *data, size_t n, uint32_t *counts, uint32_t bins, HistogramMethod method)
+{
+    switch (histogramMethod<T>(n, bins, method)) {
+    case HistogramMethod::Compare:
+        histogramCompare(data, n, counts, bins);
+        break;
+    case HistogramMethod::Direct:
+        histogramDirect(data, n, counts, bins);
+        break;
+#if defined(__AVX512CD__)
+    case HistogramMethod::Conflict:
+        histogramConflict(data, n, counts, bins);
+        break;
+#endif
+    default:
+        histogramTables(data, n, counts, bins);
+        break;
+    }
+}
+
+/* Every thread counts a contiguous chunk into its own table, the tables are summed at the end */
+template <class T>
+static inline void parallelHistogram(const T *data, size_t n, uint32_t *counts, uint32_t bins, HistogramMethod method, unsigned threads)
+{
+    threads = resolveThreads(threads);
+    size_t chunks = std::min<size_t>(threads, n / HIST_MIN_CHUNK);
+    if (chunks <= 1) {
+        histogram(data, n, counts, bins, method);
+        return;
+    }
+
+    size_t chunk = (n + chunks - 1) / chunks;
+    std::vector<uint32_t> partial(chunks * bins);
+    parallelFor(chunks, threads, [&](size_t c) {
+        size_t begin = c * chunk;
+        histogram(data + begin, std::min(chunk, n - begin), partial.data() + c * bins, bins, method);
+    });
+
+    for (size_t c = 0; c < chunks; c++) {
+        const uint32_t *p = partial.data() + c * bins;
+        for (uint32_t b = 0; b < bins; b++) {
+            counts[b] += p[b];
+        }
+    }
+}
+
+/* Maps floats in [lo, hi) to bin indices; everything else, NaN included, maps to bins */
+static inline void histogramBins(const float *x, size_t n, uint32_t *idx, float lo, float hi, uint32_t bins) noexcept
+{
+    const float scale = static_cast<float>(bins) / (hi - lo);
+
+    size_t i = 0;
+#if defined(__AVX512F__)
+    __m512 vlo = _mm512_set1_ps(lo), vhi = _mm512_set1_ps(hi), vscale = _mm512_set1_ps(scale);
+    __m512i top = _mm512_set1_epi32(static_cast<int>(bins - 1)), out = _mm512_set1_epi32(static_cast<int>(bins));
+    for (; i + 16 <= n; i += 16) {
+        __m512    v     = _mm512_loadu_ps(x + i);
+        __mmask16 valid = _mm512_cmp_ps_mask(v, vlo, _CMP_GE_OQ) & _mm512_cmp_ps_mask(v, vhi, _CMP_LT_OQ);
+        __m512i   bin   = _mm512_min_epu32(_mm512_cvttps_epi32(_mm512_mul_ps(_mm512_sub_ps(v, vlo), vscale)), top);
+        _mm512_storeu_si512(idx + i, _mm512_mask_blend_epi32(valid, out, bin));
+    }
+#else
+    __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi), vscale = _mm256_set1_ps(scale);
+    __m256i top = _mm256_set1_epi32(static_cast<int>(bins - 1)), out = _mm256_set1_epi32(static_cast<int>(bins));
+    for (; i + 8 <= n; i += 8) {
+        __m256  v     = _mm256_loadu_ps(x + i);
+        __m256  valid = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LT_OQ));
+        __m256i bin   = _mm256_min_epu32(_mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(v, vlo), vscale)), top);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(idx + i), _mm256_blendv_epi8(out, bin, _mm256_castps_si256(valid)));
+    }
+#endif
+    for (; i < n; i++) {
+        bool valid = x[i] >= lo && x[i] < hi;
+        idx[i] = valid ? std::min(static_cast<uint32_t>((x[i] - lo) * scale), bins - 1) : bins;
+    }
+}
+
+static inline void histogram(const float *x, size_t n, float lo, float hi, uint32_t *counts, uint32_t bins, HistogramMethod method)
+{
+    constexpr size_t BLOCK = 1024;
+
+    method = histogramMethod<uint32_t>(n, bins, method);
+    std::vector<HistogramTables> tables;
+    if (method == HistogramMethod::Tables) {
+        tables.emplace_back(bins);
+    }
+
+    alignas(64) uint32_t idx[BLOCK];
+    for (size_t i = 0; i < n; i += BLOCK) {
+        size_t len = std::min(BLOCK, n - i);
+        histogramBins(x + i, len, idx, lo, hi, bins);
+        if (tables.empty()) {
+            histogram(idx, len, counts, bins, method);
+        } else {
+            tables[0].count(idx, len);
+        }
+    }
+    if (!tables.empty()) {
+        tables[0].fold(counts);
+    }
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Counts how often every byte value below bins occurs; counts[0..bins) is overwritten
+ *
+ * Bytes at or above bins are ignored. Auto compares against every bin for
+ * a handful of bins and uses interleaved private tables otherwise, except
+ * for inputs too short to pay for the tables, which are counted in place.
+ * Runs on the calling thread; parallelHistogram splits large inputs.
+ */
+static inline void histogram(const uint8_t *data, size_t n, uint32_t *counts, uint32_t bins = 256,
+                             HistogramMethod method = HistogramMethod::Auto)
+{
+    std::fill(counts, counts + bins, 0);
+    slimm::detail::histogram(data, n, counts, std::min<uint32_t>(bins, 256), method);
+}
+
+/**
+ * @brief Counts how often every value below bins occurs; counts[0..bins) is overwritten
+ *
+ * Values at or above bins are ignored. Auto compares against every bin for
+ * a handful of bins and otherwise prefers the AVX-512CD conflict kernel,
+ * which keeps pace with private tables at every bin count and pulls ahead
+ * once they stop fitting in cache. Without it, inputs shorter than bins
+ * are counted in place rather than through private tables.
+ */
+static inline void histogram(const uint32_t *data, size_t n, uint32_t *counts, uint32_t bins,
+                             HistogramMethod method = HistogramMethod::Auto)
+{
+    std::fill(counts, counts + bins, 0);
+    slimm::detail::histogram(data, n, counts, bins, method);
+}
+
+/**
+ * @brief Histogram of bins equal-width buckets over [lo, hi); values outside the range and NaNs are ignored
+ */
+static inline void histogram(const float *data, size_t n, float lo, float hi, uint32_t *counts, uint32_t bins,
+                             HistogramMethod method = HistogramMethod::Auto)
+{
+    std::fill(counts, counts + bins, 0);
+    slimm::detail::histogram(data, n, lo, hi, counts, bins, method);
+}
+
+/**
+ * @brief Multithreaded byte histogram; threads = 0 uses every hardware thread
+ *
+ * Every thread takes at least 256K elements, so shorter inputs run on the
+ * calling thread exactly as histogram() does.
+ */
+static inline void parallelHistogram(const uint8_t *data, size_t n, uint32_t *counts, uint32_t bins = 256,
+                                     HistogramMethod method = HistogramMethod::Auto, unsigned threads = 0)
+{
+    std::fill(counts, counts + bins, 0);
+    slimm::detail::parallelHistogram(data, n, counts, std::min<uint32_t>(bins, 256), method, threads);
+}
+
+/**
+ * @brief Multithreaded value histogram; threads = 0 uses every hardware thread
+ */
+static inline void parallelHistogram(const uint32_t *data, size_t n, uint32_t *counts, uint32_t bins,
+                                     HistogramMethod method = HistogramMethod::Auto, unsigned threads = 0)
+{
+    std::fill(counts, counts + bins, 0);
+    slimm::detail::parallelHistogram(data, n, counts, bins, method, threads);
+}
@@ -0,0 +1,331 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+#if defined(__AVX512BW__)
+using LutBytes = __m512i;
+#else
+using LutBytes = __m256i;
+#endif
+
+static inline __m128i lutLow128(const LutBytes &v) noexcept
+{
+#if defined(__AVX512BW__)
+    return _mm512_castsi512_si128(v);
+#else
+    return _mm256_castsi256_si128(v);
+#endif
+}
+
+static inline __m256i lutLow256(const LutBytes &v) noexcept
+{
+#if defined(__AVX512BW__)
+    return _mm512_castsi512_si256(v);
+#else
+    return v;
+#endif
+}
+
+/*
+ * pshufb cascade over 16-entry chunks. j counts down by 16 per chunk, so
+ * it lies in [0, 15] exactly for the chunk that holds the entry; adding
+ * 0x70 with unsigned saturation keeps those low nibbles and pushes every
+ * other lane to bit 7 set, where pshufb returns zero. OR-ing the chunks
+ * then needs no blend.
+ */
+template <size_t N>
+static inline __m128i lutCascade(const LutBytes *chunks, __m128i idx) noexcept
+{
+    __m128i j = _mm_and_si128(idx, _mm_set1_epi8(static_cast<char>(N - 1)));
+    if constexpr (N == 16) {
+        return _mm_shuffle_epi8(lutLow128(chunks[0]), j);
+    } else {
+        __m128i r = _mm_shuffle_epi8(lutLow128(chunks[0]), _mm_adds_epu8(j, _mm_set1_epi8(0x70)));
+        for (size_t k = 1; k < N / 16; k++) {
+            j = _mm_sub_epi8(j, _mm_set1_epi8(16));
+            r = _mm_or_si128(r, _mm_shuffle_epi8(lutLow128(chunks[k]), _mm_adds_epu8(j, _mm_set1_epi8(0x70))));
+        }
+        return r;
+    }
+}
+
+template <size_t N>
+static inline __m256i lutCascade(const LutBytes *chunks, __m256i idx) noexcept
+{
+    __m256i j = _mm256_and_si256(idx, _mm256_set1_epi8(static_cast<char>(N - 1)));
+    if constexpr (N == 16) {
+        return _mm256_shuffle_epi8(lutLow256(chunks[0]), j);
+    } else {
+        __m256i r = _mm256_shuffle_epi8(lutLow256(chunks[0]), _mm256_adds_epu8(j, _mm256_set1_epi8(0x70)));
+        for (size_t k = 1; k < N / 16; k++) {
+            j = _mm256_sub_epi8(j, _mm256_set1_epi8(16));
+            r = _mm256_or_si256(r, _mm256_shuffle_epi8(lutLow256(chunks[k]), _mm256_adds_epu8(j, _mm256_set1_epi8(0x70))));
+        }
+        return r;
+    }
+}
+
+#if defined(__AVX512BW__)
+template <size_t N>
+static inline __m512i lutCascade(const LutBytes *chunks, __m512i idx) noexcept
+{
+    __m512i j = _mm512_and_si512(idx, _mm512_set1_epi8(static_cast<char>(N - 1)));
+    if constexpr (N == 16) {
+        return _mm512_shuffle_epi8(chunks[0], j);
+    } else {
+        __m512i r = _mm512_shuffle_epi8(chunks[0], _mm512_adds_epu8(j, _mm512_set1_epi8(0x70)));
+        for (size_t k = 1; k < N / 16; k++) {
+            j = _mm512_sub_epi8(j, _mm512_set1_epi8(16));
+            r = _mm512_or_si512(r, _mm512_shuffle_epi8(chunks[k], _mm512_adds_epu8(j, _mm512_set1_epi8(0x70))));
+        }
+        return r;
+    }
+}
+#endif
+
+} // namespace slimm::detail
+
+/**
+ * A lookup table of N = 16, 32, 64 or 128 bytes held in registers,
+ * indexed by the byte lanes of UINT8X16/32/64. Index i selects entry
+ * i mod N.
+ *
+ * Every 16-entry chunk is kept broadcast to each 128-bit lane and looked
+ * up with a pshufb cascade, N / 16 shuffles per register. With AVX-512
+ * VBMI a UINT8X64 lookup is a single permutexvar for up to 64 entries
+ * and a single permutex2var for 128.
+ *
+ * The table is a plain value: construct it outside the loop and the
+ * compiler keeps its registers live across iterations.
+ */
+template <class T, size_t N>
+class Lut
+{
+    static_assert(std::is_integral_v<T> && sizeof(T) == 1, "byte tables hold int8_t or uint8_t entries");
+    static_assert(N == 16 || N == 32 || N == 64 || N == 128, "byte tables have 16, 32, 64 or 128 entries");
+
+    using Bytes16 = std::conditional_t<std::is_signed_v<T>, INT8X16, UINT8X16>;
+    using Bytes32 = std::conditional_t<std::is_signed_v<T>, INT8X32, UINT8X32>;
+    using Bytes64 = std::conditional_t<std::is_signed_v<T>, INT8X64, UINT8X64>;
+
+public:
+    explicit Lut(const T *entries) noexcept
+    {
+        for (size_t k = 0; k < N / 16; k++) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(entries + 16 * k));
+#if defined(__AVX512BW__)
+            chunks[k] = _mm512_broadcast_i32x4(chunk);
+#else
+            chunks[k] = _mm256_broadcastsi128_si256(chunk);
+#endif
+        }
+#if defined(__AVX512VBMI__)
+        for (size_t k = 0; k < (N + 63) / 64; k++) {
+            table[k] = _mm512_maskz_loadu_epi8(N >= 64 ? ~0ULL : (1ULL << N) - 1, entries + 64 * k);
+        }
+#endif
+    }
+
+    explicit Lut(const std::array<T, N> &entries) noexcept :
+        Lut(entries.data())
+    {
+    }
+
+    Bytes16 lookup(const UINT8X16 &idx) const noexcept
+    {
+        return slimm::detail::lutCascade<N>(chunks, idx.v);
+    }
+
+    Bytes32 lookup(const UINT8X32 &idx) const noexcept
+    {
+        return slimm::detail::lutCascade<N>(chunks, idx.v);
+    }
+
+#if defined(__AVX512BW__)
+    Bytes64 lookup(const UINT8X64 &idx) const noexcept
+    {
+#if defined(__AVX512VBMI__)
+        if constexpr (N == 16) {
+            return _mm512_shuffle_epi8(chunks[0], _mm512_and_si512(idx.v, _mm512_set1_epi8(15)));
+        } else if constexpr (N == 128) {
+            return _mm512_permutex2var_epi8(table[0], idx.v, table[1]);
+        } else {
+            return _mm512_permutexvar_epi8(_mm512_and_si512(idx.v, _mm512_set1_epi8(static_cast<char>(N - 1))), table[0]);
+        }
+#else
+        return slimm::detail::lutCascade<N>(chunks, idx.v);
+#endif
+    }
+#endif
+
+    /**
+     * @brief dst[i] = entry[idx[i] mod N] for n indices
+     */
+    void lookup(const uint8_t *idx, T *dst, size_t n) const noexcept
+    {
+        size_t i = 0;
+#if defined(__AVX512BW__)
+        for (; i + 64 <= n; i += 64) {
+            _mm512_storeu_si512(dst + i, lookup(UINT8X64(_mm512_loadu_si512(idx + i))).v);
+        }
+        if (i < n) {
+            __mmask64 m = (~0ULL) >> (64 - (n - i));
+            _mm512_mask_storeu_epi8(dst + i, m, lookup(UINT8X64(_mm512_maskz_loadu_epi8(m, idx + i))).v);
+        }
+#else
+        for (; i + 32 <= n; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), lookup(UINT8X32(v)).v);
+        }
+        if (i < n) {
+            alignas(32) uint8_t buffer[32] = {};
+            std::memcpy(buffer, idx + i, n - i);
+            __m256i v = lookup(UINT8X32(_mm256_load_si256(reinterpret_cast<const __m256i *>(buffer)))).v;
+            _mm256_store_si256(reinterpret_cast<__m256i *>(buffer), v);
+            std::memcpy(dst + i, buffer, n - i);
+        }
+#endif
+    }
+
+private:
+    slimm::detail::LutBytes chunks[N / 16];
+#if defined(__AVX512VBMI__)
+    __m512i table[(N + 63) / 64];
+#endif
+};
+
+/**
+ * A float table of N = 8, 16 or 32 entries held in registers, looked up
+ * by the int32 lanes of INT32X16 with permutexvar, or permutex2var for
+ * 32 entries. AVX2 builds use INT32X8 with permutevar8x32 per 8 entries
+ * and a blend per index bit above them.
+ *
+ * interpolate() maps [low, high] linearly onto the entries and returns
+ * the linear interpolation between the two nearest ones, clamping x to
+ * [low, high]; NaN reads as low.
+ */
+template <size_t N>
+class Lut<float, N>
+{
+    static_assert(N == 8 || N == 16 || N == 32, "float tables have 8, 16 or 32 entries");
+
+public:
+    explicit Lut(const float *entries, float low = 0.0f, float high = static_cast<float>(N - 1)) noexcept :
+        lo{ low },
+        scale{ static_cast<float>(N - 1) / (high - low) }
+    {
+#if defined(__AVX512F__)
+        for (size_t k = 0; k < (N + 15) / 16; k++) {
+            table[k] = _mm512_maskz_loadu_ps(N >= 16 ? 0xFFFF : (1u << N) - 1, entries + 16 * k);
+        }
+#else
+        for (size_t k = 0; k < N / 8; k++) {
+            table[k] = _mm256_loadu_ps(entries + 8 * k);
+        }
+#endif
+    }
+
+    explicit Lut(const std::array<float, N> &entries, float low = 0.0f, float high = static_cast<float>(N - 1)) noexcept :
+        Lut(entries.data(), low, high)
+    {
+    }
+
+#if defined(__AVX512F__)
+    /** @brief Lane i holds entry[idx[i] mod N] */
+    FLOATX16 lookup(const INT32X16 &idx) const noexcept
+    {
+        __m512i i = _mm512_and_si512(idx.v, _mm512_set1_epi32(N - 1));
+        if constexpr (N == 32) {
+            return _mm512_permutex2var_ps(table[0], i, table[1]);
+        } else {
+            return _mm512_permutexvar_ps(i, table[0]);
+        }
+    }
+
+    FLOATX16 interpolate(const FLOATX16 &x) const noexcept
+    {
+        __m512  t = _mm512_mul_ps(_mm512_sub_ps(x.v, _mm512_set1_ps(lo)), _mm512_set1_ps(scale));
+        t         = _mm512_min_ps(_mm512_max_ps(t, _mm512_setzero_ps()), _mm512_set1_ps(static_cast<float>(N - 1)));
+        __m512i i = _mm512_min_epi32(_mm512_cvttps_epi32(t), _mm512_set1_epi32(N - 2));
+        __m512  f = _mm512_sub_ps(t, _mm512_cvtepi32_ps(i));
+        __m512  a = lookup(i).v;
+        __m512  b = lookup(_mm512_add_epi32(i, _mm512_set1_epi32(1))).v;
+        return _mm512_fmadd_ps(f, _mm512_sub_ps(b, a), a);
+    }
+#else
+    /** @brief Lane i holds entry[idx[i] mod N] */
+    FLOATX8 lookup(const INT32X8 &idx) const noexcept
+    {
+        __m256i i = _mm256_and_si256(idx.v, _mm256_set1_epi32(N - 1));
+        __m256  r = _mm256_permutevar8x32_ps(table[0], i);
+        if constexpr (N >= 16) {
+            __m256 bit3 = _mm256_castsi256_ps(_mm256_slli_epi32(i, 28));
+            r           = _mm256_blendv_ps(r, _mm256_permutevar8x32_ps(table[1], i), bit3);
+            if constexpr (N == 32) {
+                __m256 upper = _mm256_blendv_ps(_mm256_permutevar8x32_ps(table[2], i), _mm256_permutevar8x32_ps(table[3], i), bit3);
+                r            = _mm256_blendv_ps(r, upper, _mm256_castsi256_ps(_mm256_slli_epi32(i, 27)));
+            }
+        }
+        return r;
+    }
+
+    FLOATX8 interpolate(const FLOATX8 &x) const noexcept
+    {
+        __m256  t = _mm256_mul_ps(_mm256_sub_ps(x.v, _mm256_set1_ps(lo)), _mm256_set1_ps(scale));
+        t         = _mm256_min_ps(_mm256_max_ps(t, _mm256_setzero_ps()), _mm256_set1_ps(static_cast<float>(N - 1)));
+        __m256i i = _mm256_min_epi32(_mm256_cvttps_epi32(t), _mm256_set1_epi32(N - 2));
+        __m256  f = _mm256_sub_ps(t, _mm256_cvtepi32_ps(i));
+        __m256  a = lookup(i).v;
+        __m256  b = lookup(_mm256_add_epi32(i, _mm256_set1_epi32(1))).v;
+        return _mm256_fmadd_ps(f, _mm256_sub_ps(b, a), a);
+    }
+#endif
+
+    /**
+     * @brief dst[i] = interpolate(src[i]) for n values; src and dst may be the same array
+     */
+    void interpolate(const float *src, float *dst, size_t n) const noexcept
+    {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= n; i += 16) {
+            _mm512_storeu_ps(dst + i, interpolate(FLOATX16(_mm512_loadu_ps(src + i))).v);
+        }
+        if (i < n) {
+            __mmask16 m = static_cast<__mmask16>((1u << (n - i)) - 1);
+            _mm512_mask_storeu_ps(dst + i, m, interpolate(FLOATX16(_mm512_maskz_loadu_ps(m, src + i))).v);
+        }
+#else
+        for (; i + 8 <= n; i += 8) {
+            _mm256_storeu_ps(dst + i, interpolate(FLOATX8(_mm256_loadu_ps(src + i))).v);
+        }
+        if (i < n) {
+            __m256i m = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n - i)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            _mm256_maskstore_ps(dst + i, m, interpolate(FLOATX8(_mm256_maskload_ps(src + i, m))).v);
+        }
+#endif
+    }
+
+private:
+#if defined(__AVX512F__)
+    __m512 table[(N + 15) / 16];
+#else
+    __m256 table[N / 8];
+#endif
+    float lo;
+    float scale;
+};
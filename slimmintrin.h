@@ -4,6 +4,8 @@
  * This library is distributed under the Apache-2.0 license.
  */
 
+#pragma once
+
 #include <cstdint>
 #include <concepts>
 #include <immintrin.h>
@@ -313,6 +315,12 @@ public:
         return _mm512_shuffle_ps(v, a, imm8);
     }
 
+    template <int rounding>
+    FLOATX16 round() const noexcept
+    {
+        return _mm512_roundscale_ps(v, rounding);
+    }
+
     FLOATX16 floor() const noexcept
     {
         return _mm512_floor_ps(v);
@@ -401,6 +409,11 @@ public:
         _mm_storeu_pd(dst, v);
     }
 
+    DOUBLEX2 fmadd(const DOUBLEX2 &a, const DOUBLEX2 &b) const noexcept
+    {
+        return _mm_fmadd_pd(v, a, b);
+    }
+
     template <int imm8>
     DOUBLEX2 shuffle(const DOUBLEX2 &a) const noexcept
     {
@@ -501,6 +514,11 @@ public:
         _mm256_storeu_pd(dst, v);
     }
 
+    DOUBLEX4 fmadd(const DOUBLEX4 &a, const DOUBLEX4 &b) const noexcept
+    {
+        return _mm256_fmadd_pd(v, a, b);
+    }
+
     template <int imm8>
     DOUBLEX4 shuffle(const DOUBLEX4 &a) const noexcept
     {
@@ -596,12 +614,23 @@ public:
         _mm512_storeu_pd(dst, v);
     }
 
+    DOUBLEX8 fmadd(const DOUBLEX8 &a, const DOUBLEX8 &b) const noexcept
+    {
+        return _mm512_fmadd_pd(v, a, b);
+    }
+
     template <int imm8>
     DOUBLEX8 shuffle(const DOUBLEX8 &a) const noexcept
     {
         return _mm512_shuffle_pd(v, a, imm8);
     }
 
+    template <int rounding>
+    DOUBLEX8 round() const noexcept
+    {
+        return _mm512_roundscale_pd(v, rounding);
+    }
+
     DOUBLEX8 floor() const noexcept
     {
         return _mm512_floor_pd(v);
@@ -685,6 +714,11 @@ public:
         _mm_storeu_epi8(dst, v);
     }
 
+    INT8X16 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi8(v);
+    }
+
 public:
     __m128i v;
 };
@@ -758,6 +792,11 @@ public:
         _mm_storeu_epi8(dst, v);
     }
 
+    UINT8X16 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi8(v);
+    }
+
 public:
     __m128i v;
 };
@@ -841,6 +880,11 @@ public:
         return _mm_cvtepi16_epi8(v);
     }
 
+    INT16X8 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi16(v);
+    }
+
 public:
     __m128i v;
 };
@@ -924,6 +968,11 @@ public:
         return _mm_cvtepi16_epi8(v);
     }
 
+    UINT16X8 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi16(v);
+    }
+
 public:
     __m128i v;
 };
@@ -1002,6 +1051,21 @@ public:
         _mm_storeu_epi32(dst, v);
     }
 
+    INT32X4 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi32(v);
+    }
+
+    INT32X4 lzcnt() const noexcept
+    {
+        return _mm_lzcnt_epi32(v);
+    }
+
+    INT32X4 tzcnt() const noexcept
+    {
+        return _mm_sub_epi32(_mm_set1_epi32(32), _mm_lzcnt_epi32(_mm_andnot_si128(v, _mm_sub_epi32(v, _mm_set1_epi32(1)))));
+    }
+
 public:
     __m128i v;
 };
@@ -1080,6 +1144,21 @@ public:
         _mm_storeu_epi32(dst, v);
     }
 
+    UINT32X4 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi32(v);
+    }
+
+    UINT32X4 lzcnt() const noexcept
+    {
+        return _mm_lzcnt_epi32(v);
+    }
+
+    UINT32X4 tzcnt() const noexcept
+    {
+        return _mm_sub_epi32(_mm_set1_epi32(32), _mm_lzcnt_epi32(_mm_andnot_si128(v, _mm_sub_epi32(v, _mm_set1_epi32(1)))));
+    }
+
 public:
     __m128i v;
 };
@@ -1153,6 +1232,21 @@ public:
         _mm_storeu_epi64(dst, v);
     }
 
+    INT64X2 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi64(v);
+    }
+
+    INT64X2 lzcnt() const noexcept
+    {
+        return _mm_lzcnt_epi64(v);
+    }
+
+    INT64X2 tzcnt() const noexcept
+    {
+        return _mm_sub_epi64(_mm_set1_epi64x(64), _mm_lzcnt_epi64(_mm_andnot_si128(v, _mm_sub_epi64(v, _mm_set1_epi64x(1)))));
+    }
+
 public:
     __m128i v;
 };
@@ -1226,6 +1320,21 @@ public:
         _mm_storeu_epi64(dst, v);
     }
 
+    UINT64X2 popcnt() const noexcept
+    {
+        return _mm_popcnt_epi64(v);
+    }
+
+    UINT64X2 lzcnt() const noexcept
+    {
+        return _mm_lzcnt_epi64(v);
+    }
+
+    UINT64X2 tzcnt() const noexcept
+    {
+        return _mm_sub_epi64(_mm_set1_epi64x(64), _mm_lzcnt_epi64(_mm_andnot_si128(v, _mm_sub_epi64(v, _mm_set1_epi64x(1)))));
+    }
+
 public:
     __m128i v;
 };
@@ -1299,6 +1408,11 @@ public:
         _mm256_storeu_epi8(dst, v);
     }
 
+    INT8X32 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi8(v);
+    }
+
 public:
     __m256i v;
 };
@@ -1372,6 +1486,11 @@ public:
         _mm256_storeu_epi8(dst, v);
     }
 
+    UINT8X32 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi8(v);
+    }
+
 public:
     __m256i v;
 };
@@ -1455,6 +1574,11 @@ public:
         return _mm256_cvtepi16_epi8(v);
     }
 
+    INT16X16 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi16(v);
+    }
+
 public:
     __m256i v;
 };
@@ -1538,6 +1662,11 @@ public:
         return _mm256_cvtepi16_epi8(v);
     }
 
+    UINT16X16 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi16(v);
+    }
+
 public:
     __m256i v;
 };
@@ -1616,6 +1745,21 @@ public:
         _mm256_storeu_epi32(dst, v);
     }
 
+    INT32X8 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi32(v);
+    }
+
+    INT32X8 lzcnt() const noexcept
+    {
+        return _mm256_lzcnt_epi32(v);
+    }
+
+    INT32X8 tzcnt() const noexcept
+    {
+        return _mm256_sub_epi32(_mm256_set1_epi32(32), _mm256_lzcnt_epi32(_mm256_andnot_si256(v, _mm256_sub_epi32(v, _mm256_set1_epi32(1)))));
+    }
+
 public:
     __m256i v;
 };
@@ -1694,6 +1838,21 @@ public:
         _mm256_storeu_epi32(dst, v);
     }
 
+    UINT32X8 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi32(v);
+    }
+
+    UINT32X8 lzcnt() const noexcept
+    {
+        return _mm256_lzcnt_epi32(v);
+    }
+
+    UINT32X8 tzcnt() const noexcept
+    {
+        return _mm256_sub_epi32(_mm256_set1_epi32(32), _mm256_lzcnt_epi32(_mm256_andnot_si256(v, _mm256_sub_epi32(v, _mm256_set1_epi32(1)))));
+    }
+
 public:
     __m256i v;
 };
@@ -1767,6 +1926,21 @@ public:
         _mm256_storeu_epi64(dst, v);
     }
 
+    INT64X4 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi64(v);
+    }
+
+    INT64X4 lzcnt() const noexcept
+    {
+        return _mm256_lzcnt_epi64(v);
+    }
+
+    INT64X4 tzcnt() const noexcept
+    {
+        return _mm256_sub_epi64(_mm256_set1_epi64x(64), _mm256_lzcnt_epi64(_mm256_andnot_si256(v, _mm256_sub_epi64(v, _mm256_set1_epi64x(1)))));
+    }
+
 public:
     __m256i v;
 };
@@ -1840,6 +2014,21 @@ public:
         _mm256_storeu_epi64(dst, v);
     }
 
+    UINT64X4 popcnt() const noexcept
+    {
+        return _mm256_popcnt_epi64(v);
+    }
+
+    UINT64X4 lzcnt() const noexcept
+    {
+        return _mm256_lzcnt_epi64(v);
+    }
+
+    UINT64X4 tzcnt() const noexcept
+    {
+        return _mm256_sub_epi64(_mm256_set1_epi64x(64), _mm256_lzcnt_epi64(_mm256_andnot_si256(v, _mm256_sub_epi64(v, _mm256_set1_epi64x(1)))));
+    }
+
 public:
     __m256i v;
 };
@@ -1908,6 +2097,11 @@ public:
         _mm512_storeu_epi8(dst, v);
     }
 
+    INT8X64 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi8(v);
+    }
+
 public:
     __m512i v;
 };
@@ -1976,6 +2170,11 @@ public:
         _mm512_storeu_epi8(dst, v);
     }
 
+    UINT8X64 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi8(v);
+    }
+
 public:
     __m512i v;
 };
@@ -2054,6 +2253,11 @@ public:
         return _mm512_cvtepi16_epi8(v);
     }
 
+    INT16X32 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi16(v);
+    }
+
 public:
     __m512i v;
 };
@@ -2132,6 +2336,11 @@ public:
         return _mm512_cvtepi16_epi8(v);
     }
 
+    UINT16X32 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi16(v);
+    }
+
 public:
     __m512i v;
 };
@@ -2205,6 +2414,21 @@ public:
         _mm512_storeu_epi32(dst, v);
     }
 
+    INT32X16 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi32(v);
+    }
+
+    INT32X16 lzcnt() const noexcept
+    {
+        return _mm512_lzcnt_epi32(v);
+    }
+
+    INT32X16 tzcnt() const noexcept
+    {
+        return _mm512_sub_epi32(_mm512_set1_epi32(32), _mm512_lzcnt_epi32(_mm512_andnot_si512(v, _mm512_sub_epi32(v, _mm512_set1_epi32(1)))));
+    }
+
 public:
     __m512i v;
 };
@@ -2278,6 +2502,21 @@ public:
         _mm512_storeu_epi32(dst, v);
     }
 
+    UINT32X16 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi32(v);
+    }
+
+    UINT32X16 lzcnt() const noexcept
+    {
+        return _mm512_lzcnt_epi32(v);
+    }
+
+    UINT32X16 tzcnt() const noexcept
+    {
+        return _mm512_sub_epi32(_mm512_set1_epi32(32), _mm512_lzcnt_epi32(_mm512_andnot_si512(v, _mm512_sub_epi32(v, _mm512_set1_epi32(1)))));
+    }
+
 public:
     __m512i v;
 };
@@ -2346,6 +2585,21 @@ public:
         _mm512_storeu_epi64(dst, v);
     }
 
+    INT64X8 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi64(v);
+    }
+
+    INT64X8 lzcnt() const noexcept
+    {
+        return _mm512_lzcnt_epi64(v);
+    }
+
+    INT64X8 tzcnt() const noexcept
+    {
+        return _mm512_sub_epi64(_mm512_set1_epi64(64), _mm512_lzcnt_epi64(_mm512_andnot_si512(v, _mm512_sub_epi64(v, _mm512_set1_epi64(1)))));
+    }
+
 public:
     __m512i v;
 };
@@ -2414,6 +2668,21 @@ public:
         _mm512_storeu_epi64(dst, v);
     }
 
+    UINT64X8 popcnt() const noexcept
+    {
+        return _mm512_popcnt_epi64(v);
+    }
+
+    UINT64X8 lzcnt() const noexcept
+    {
+        return _mm512_lzcnt_epi64(v);
+    }
+
+    UINT64X8 tzcnt() const noexcept
+    {
+        return _mm512_sub_epi64(_mm512_set1_epi64(64), _mm512_lzcnt_epi64(_mm512_andnot_si512(v, _mm512_sub_epi64(v, _mm512_set1_epi64(1)))));
+    }
+
 public:
     __m512i v;
 };
@@ -2523,6 +2792,31 @@ static inline FLOATX16 max(const FLOATX16 &a, const FLOATX16 &b) noexcept
     return _mm512_max_ps(a, b);
 }
 
+static inline DOUBLEX2 pow(const DOUBLEX2 &a, const DOUBLEX2 &b) noexcept
+{
+    return _mm_pow_pd(a, b);
+}
+
+static inline DOUBLEX2 sin(const DOUBLEX2 &a) noexcept
+{
+    return _mm_sin_pd(a);
+}
+
+static inline DOUBLEX2 cos(const DOUBLEX2 &a) noexcept
+{
+    return _mm_cos_pd(a);
+}
+
+static inline DOUBLEX2 asin(const DOUBLEX2 &a) noexcept
+{
+    return _mm_asin_pd(a);
+}
+
+static inline DOUBLEX2 acos(const DOUBLEX2 &a) noexcept
+{
+    return _mm_acos_pd(a);
+}
+
 static inline DOUBLEX2 min(const DOUBLEX2 &a, const DOUBLEX2 &b) noexcept
 {
     return _mm_min_pd(a, b);
@@ -2533,6 +2827,31 @@ static inline DOUBLEX2 max(const DOUBLEX2 &a, const DOUBLEX2 &b) noexcept
     return _mm_max_pd(a, b);
 }
 
+static inline DOUBLEX4 pow(const DOUBLEX4 &a, const DOUBLEX4 &b) noexcept
+{
+    return _mm256_pow_pd(a, b);
+}
+
+static inline DOUBLEX4 sin(const DOUBLEX4 &a) noexcept
+{
+    return _mm256_sin_pd(a);
+}
+
+static inline DOUBLEX4 cos(const DOUBLEX4 &a) noexcept
+{
+    return _mm256_cos_pd(a);
+}
+
+static inline DOUBLEX4 asin(const DOUBLEX4 &a) noexcept
+{
+    return _mm256_asin_pd(a);
+}
+
+static inline DOUBLEX4 acos(const DOUBLEX4 &a) noexcept
+{
+    return _mm256_acos_pd(a);
+}
+
 static inline DOUBLEX4 min(const DOUBLEX4 &a, const DOUBLEX4 &b) noexcept
 {
     return _mm256_min_pd(a, b);
@@ -2543,6 +2862,31 @@ static inline DOUBLEX4 max(const DOUBLEX4 &a, const DOUBLEX4 &b) noexcept
     return _mm256_max_pd(a, b);
 }
 
+static inline DOUBLEX8 pow(const DOUBLEX8 &a, const DOUBLEX8 &b) noexcept
+{
+    return _mm512_pow_pd(a, b);
+}
+
+static inline DOUBLEX8 sin(const DOUBLEX8 &a) noexcept
+{
+    return _mm512_sin_pd(a);
+}
+
+static inline DOUBLEX8 cos(const DOUBLEX8 &a) noexcept
+{
+    return _mm512_cos_pd(a);
+}
+
+static inline DOUBLEX8 asin(const DOUBLEX8 &a) noexcept
+{
+    return _mm512_asin_pd(a);
+}
+
+static inline DOUBLEX8 acos(const DOUBLEX8 &a) noexcept
+{
+    return _mm512_acos_pd(a);
+}
+
 static inline DOUBLEX8 min(const DOUBLEX8 &a, const DOUBLEX8 &b) noexcept
 {
     return _mm512_min_pd(a, b);
@@ -0,0 +1,140 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+namespace slimm::detail
+{
+
+/* 0 means one thread per hardware thread */
+static inline unsigned resolveThreads(unsigned threads) noexcept
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return threads != 0 ? threads : 1;
+}
+
+/**
+ * Runs fn(task) for every task in [0, tasks) on up to `threads` threads,
+ * the calling thread included. Tasks are handed out dynamically, so uneven
+ * task costs balance themselves.
+ */
+template <class F>
+static inline void parallelFor(size_t tasks, unsigned threads, F &&fn)
+{
+    threads = static_cast<unsigned>(std::min<size_t>(resolveThreads(threads), tasks));
+    if (threads <= 1) {
+        for (size_t task = 0; task < tasks; task++) {
+            fn(task);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t task; (task = next.fetch_add(1, std::memory_order_relaxed)) < tasks;) {
+            fn(task);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+/* Data cache sizes in bytes per level; a missing level reads 0 */
+struct CacheSizes
+{
+    size_t l1;
+    size_t l2;
+    size_t l3;
+};
+
+static inline void cpuidCount(unsigned leaf, unsigned subleaf, unsigned regs[4]) noexcept
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++) {
+        regs[i] = static_cast<unsigned>(r[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/**
+ * Walks the deterministic cache parameters, CPUID leaf 4 on Intel and
+ * 0x8000001D on AMD and Hygon, which share one layout; the vendor string
+ * of leaf 0 picks the leaf. Levels the CPU does not report fall back to
+ * 32 KiB of L1 and 1 MiB of L2.
+ */
+static inline CacheSizes cacheSizes() noexcept
+{
+    static const CacheSizes sizes = [] {
+        CacheSizes found{ 0, 0, 0 };
+        unsigned   regs[4];
+
+        cpuidCount(0, 0, regs);
+        unsigned basic = regs[0];
+        char     vendor[12];
+        std::memcpy(vendor, &regs[1], 4);
+        std::memcpy(vendor + 4, &regs[3], 4);
+        std::memcpy(vendor + 8, &regs[2], 4);
+        bool amd = std::memcmp(vendor, "AuthenticAMD", 12) == 0 || std::memcmp(vendor, "HygonGenuine", 12) == 0;
+
+        cpuidCount(0x80000000, 0, regs);
+        unsigned leaf = amd ? (regs[0] >= 0x8000001D ? 0x8000001D : 0) : (basic >= 4 ? 4 : 0);
+
+        for (unsigned sub = 0; leaf != 0 && sub < 16; sub++) {
+            cpuidCount(leaf, sub, regs);
+            unsigned type = regs[0] & 0x1f;
+            if (type == 0) {
+                break;
+            }
+            if (type == 2) {
+                continue;
+            }
+            size_t bytes = size_t((regs[1] >> 22) + 1) * (((regs[1] >> 12) & 0x3ff) + 1) * ((regs[1] & 0xfff) + 1) * (size_t(regs[2]) + 1);
+            switch ((regs[0] >> 5) & 7) {
+            case 1:
+                found.l1 = bytes;
+                break;
+            case 2:
+                found.l2 = bytes;
+                break;
+            case 3:
+                found.l3 = bytes;
+                break;
+            }
+        }
+        found.l1 = found.l1 != 0 ? found.l1 : size_t(32) << 10;
+        found.l2 = found.l2 != 0 ? found.l2 : size_t(1) << 20;
+        return found;
+    }();
+    return sizes;
+}
+
+} // namespace slimm::detail
@@ -0,0 +1,247 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include "slimmintrin.h"
+
+/**
+ * Polynomials with coefficients fixed at compile time. A coefficient table
+ * is a constexpr std::array of c0, c1, ..., cn in ascending order, passed
+ * as a template argument, so every coefficient becomes a broadcast
+ * constant folded into its fmadd and the evaluation unrolls completely.
+ * Any of FLOATX4/8/16, DOUBLEX2/4/8, float or double can be evaluated.
+ *
+ *     constexpr auto expTaylor = polyCoeffs(1.0, 1.0, 1.0 / 2, 1.0 / 6);
+ *     FLOATX16 y = poly<expTaylor>(x);
+ *     FLOATX16 z = poly<expTaylor, PolyScheme::Estrin>(x);
+ */
+enum class PolyScheme
+{
+    Horner, /* one fmadd per coefficient in a single chain, fewest operations */
+    Estrin, /* pairs, then pairs of pairs in x^2, x^4, ...; log2 depth for more ILP */
+};
+
+namespace slimm::detail
+{
+
+template <class V>
+struct PolyTraits
+{
+    using scalar = V;
+};
+
+template <>
+struct PolyTraits<FLOATX4>
+{
+    using scalar = float;
+};
+
+template <>
+struct PolyTraits<FLOATX8>
+{
+    using scalar = float;
+};
+
+template <>
+struct PolyTraits<FLOATX16>
+{
+    using scalar = float;
+};
+
+template <>
+struct PolyTraits<DOUBLEX2>
+{
+    using scalar = double;
+};
+
+template <>
+struct PolyTraits<DOUBLEX4>
+{
+    using scalar = double;
+};
+
+template <>
+struct PolyTraits<DOUBLEX8>
+{
+    using scalar = double;
+};
+
+template <class V>
+concept PolyOperand = std::floating_point<typename PolyTraits<V>::scalar>;
+
+/* a * b + c */
+template <class V>
+static inline V polyFma(const V &a, const V &b, const V &c) noexcept
+{
+    if constexpr (std::is_floating_point_v<V>) {
+        return std::fma(a, b, c);
+    } else {
+        return a.fmadd(b, c);
+    }
+}
+
+/* The wrapper operators are not const, so they work on copies */
+template <class V>
+static inline V polyMul(V a, const V &b) noexcept
+{
+    return a * b;
+}
+
+template <class V>
+static inline V polyDiv(V a, const V &b) noexcept
+{
+    return a / b;
+}
+
+template <class V>
+static inline V polyRound(const V &x) noexcept
+{
+    if constexpr (std::is_floating_point_v<V>) {
+        return std::nearbyint(x);
+    } else {
+        return x.template round<_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC>();
+    }
+}
+
+template <class V>
+static inline V polyFloor(const V &x) noexcept
+{
+    if constexpr (std::is_floating_point_v<V>) {
+        return std::floor(x);
+    } else {
+        return x.floor();
+    }
+}
+
+template <class V>
+static inline V polyConst(double c) noexcept
+{
+    return V(static_cast<typename PolyTraits<V>::scalar>(c));
+}
+
+template <auto C, size_t K, class V>
+static inline V polyHorner(const V &x, const V &acc) noexcept
+{
+    if constexpr (K == 0) {
+        return acc;
+    } else {
+        return polyHorner<C, K - 1>(x, polyFma(acc, x, polyConst<V>(C[K - 1])));
+    }
+}
+
+template <size_t I, class V, size_t N>
+static inline V polyEstrinPair(const std::array<V, N> &t, const V &xp) noexcept
+{
+    if constexpr (2 * I + 1 < N) {
+        return polyFma(t[2 * I + 1], xp, t[2 * I]);
+    } else {
+        return t[2 * I];
+    }
+}
+
+/* Folds t[2i] + t[2i + 1] xp level by level, squaring xp in between */
+template <class V, size_t N>
+static inline V polyEstrin(const std::array<V, N> &t, const V &xp) noexcept
+{
+    if constexpr (N == 1) {
+        return t[0];
+    } else {
+        auto next = [&]<size_t... I>(std::index_sequence<I...>) {
+            return std::array<V, (N + 1) / 2>{ polyEstrinPair<I>(t, xp)... };
+        }(std::make_index_sequence<(N + 1) / 2>{});
+        return polyEstrin(next, polyMul(xp, xp));
+    }
+}
+
+template <auto C, PolyScheme S, class V>
+static inline V polyEval(const V &x) noexcept
+{
+    constexpr size_t N = C.size();
+    static_assert(N > 0, "a polynomial needs at least one coefficient");
+
+    if constexpr (S == PolyScheme::Horner) {
+        return polyHorner<C, N - 1>(x, polyConst<V>(C[N - 1]));
+    } else {
+        auto t = [&]<size_t... I>(std::index_sequence<I...>) {
+            return std::array<V, N>{ polyConst<V>(C[I])... };
+        }(std::make_index_sequence<N>{});
+        return polyEstrin(t, x);
+    }
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief A coefficient table c0, c1, ..., cn for poly and rational
+ */
+template <class... T>
+static constexpr std::array<double, sizeof...(T)> polyCoeffs(T... c) noexcept
+{
+    return { static_cast<double>(c)... };
+}
+
+/**
+ * @brief c0 + c1 x + ... + cn x^n for the constexpr table C
+ */
+template <auto C, PolyScheme S = PolyScheme::Horner, slimm::detail::PolyOperand V>
+static inline V poly(const V &x) noexcept
+{
+    return slimm::detail::polyEval<C, S>(x);
+}
+
+/**
+ * @brief P(x) / Q(x) for the constexpr tables P and Q
+ *
+ * Both polynomials are independent chains, so they overlap in the
+ * pipeline and the division is the only extra latency.
+ */
+template <auto P, auto Q, PolyScheme S = PolyScheme::Horner, slimm::detail::PolyOperand V>
+static inline V rational(const V &x) noexcept
+{
+    return slimm::detail::polyDiv(slimm::detail::polyEval<P, S>(x), slimm::detail::polyEval<Q, S>(x));
+}
+
+/**
+ * @brief Returns r = x - n c with n = round(x / c), so |r| <= c / 2 up to rounding
+ *
+ * c is split into its nearest value plus a correction term and both
+ * products are subtracted with an fmadd (Cody and Waite), so r keeps its
+ * relative accuracy while n c stays well below 2^(mantissa bits) c. For
+ * double lanes the correction is zero, as C itself is a double.
+ */
+template <double C, slimm::detail::PolyOperand V>
+static inline V reduceNearest(const V &x, V &n) noexcept
+{
+    using scalar        = typename slimm::detail::PolyTraits<V>::scalar;
+    constexpr scalar hi = static_cast<scalar>(C);
+    constexpr scalar lo = static_cast<scalar>(C - static_cast<double>(hi));
+
+    n   = slimm::detail::polyRound(slimm::detail::polyMul(x, V(static_cast<scalar>(1.0 / C))));
+    V r = slimm::detail::polyFma(n, V(-hi), x);
+    return slimm::detail::polyFma(n, V(-lo), r);
+}
+
+/**
+ * @brief Returns r = x - n c with n = floor(x / c), so 0 <= r < c up to rounding
+ */
+template <double C, slimm::detail::PolyOperand V>
+static inline V reduceFloor(const V &x, V &n) noexcept
+{
+    using scalar        = typename slimm::detail::PolyTraits<V>::scalar;
+    constexpr scalar hi = static_cast<scalar>(C);
+    constexpr scalar lo = static_cast<scalar>(C - static_cast<double>(hi));
+
+    n   = slimm::detail::polyFloor(slimm::detail::polyMul(x, V(static_cast<scalar>(1.0 / C))));
+    V r = slimm::detail::polyFma(n, V(-hi), x);
+    return slimm::detail::polyFma(n, V(-lo), r);
+}
@@ -0,0 +1,449 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "slimmintrin.h"
+
+/*
+ * Affine quantization: q = clamp(round(x / scale) + zeroPoint, qmin, qmax)
+ * and x = (q - zeroPoint) * scale, with rounding to nearest even.
+ *
+ * Quantizing multiplies by 1 / scale and adds the zero point in one fused
+ * multiply-add before rounding, in the vector body and the tail alike, so
+ * the result does not depend on n or the instruction set. Int4 values are
+ * signed, within [-8, 7], and packed two per byte with the lower index in
+ * the low nibble; per-channel int4 rows are padded to whole bytes.
+ */
+
+namespace slimm
+{
+namespace detail
+{
+
+enum class QuantKind
+{
+    Int8,
+    Uint8,
+    Int4,
+};
+
+template <QuantKind K>
+struct QuantTraits;
+
+template <>
+struct QuantTraits<QuantKind::Int8>
+{
+    static constexpr int32_t QMIN = -128;
+    static constexpr int32_t QMAX = 127;
+};
+
+template <>
+struct QuantTraits<QuantKind::Uint8>
+{
+    static constexpr int32_t QMIN = 0;
+    static constexpr int32_t QMAX = 255;
+};
+
+template <>
+struct QuantTraits<QuantKind::Int4>
+{
+    static constexpr int32_t QMIN = -8;
+    static constexpr int32_t QMAX = 7;
+};
+
+template <class T>
+constexpr QuantKind QUANT_KIND_OF = std::is_same_v<T, int8_t> ? QuantKind::Int8 : QuantKind::Uint8;
+
+/* Bytes taken by n values */
+template <QuantKind K>
+constexpr size_t quantBytes(size_t n) noexcept
+{
+    return K == QuantKind::Int4 ? (n + 1) / 2 : n;
+}
+
+/* The byte packing below needs AVX-512BW, the float side alone would not */
+#if defined(__AVX512BW__)
+using QuantFloat = FLOATX16;
+using QuantInt   = __m512i;
+#else
+using QuantFloat = FLOATX8;
+using QuantInt   = __m256i;
+#endif
+
+constexpr size_t QUANT_LANES = sizeof(QuantFloat) / sizeof(float);
+/* Values quantized per iteration, four vectors narrowed together */
+constexpr size_t QUANT_BLOCK = 4 * QUANT_LANES;
+/* Rows sharing one load of x in the fused dequantize-GEMV */
+constexpr size_t QUANT_GEMV_GROUP = 4;
+
+constexpr int QUANT_ROUNDING = _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC;
+
+template <QuantKind K>
+static inline int32_t quantizeValue(float x, float inv, float zero) noexcept
+{
+    float t = std::fma(x, inv, zero);
+    /* Written so that NaN ends up at QMIN, as with max_ps below */
+    t = t > QuantTraits<K>::QMIN ? t : static_cast<float>(QuantTraits<K>::QMIN);
+    t = t < QuantTraits<K>::QMAX ? t : static_cast<float>(QuantTraits<K>::QMAX);
+    return static_cast<int32_t>(std::nearbyint(t));
+}
+
+template <QuantKind K>
+static inline int32_t quantCode(const uint8_t *src, size_t i) noexcept
+{
+    if constexpr (K == QuantKind::Int4) {
+        int32_t nibble = (i & 1) ? src[i >> 1] >> 4 : src[i >> 1] & 0xf;
+        return (nibble ^ 8) - 8;
+    } else if constexpr (K == QuantKind::Int8) {
+        return static_cast<int8_t>(src[i]);
+    } else {
+        return src[i];
+    }
+}
+
+#if defined(__AVX512BW__)
+static inline float quantSum(__m512 v) noexcept
+{
+    return _mm512_reduce_add_ps(v);
+}
+#else
+static inline float quantSum(__m256 v) noexcept
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s        = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s        = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+/*
+ * Int4 values to int32: every packed byte is copied to the two lanes of
+ * its nibbles, then the low nibble is shifted up by 28 and the high one by
+ * 24, so that one arithmetic shift right by 28 sign-extends either.
+ */
+static inline __m128i int4Duplicate(__m128i packed) noexcept
+{
+    return _mm_shuffle_epi8(packed, _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7));
+}
+
+/* Quantized values i .. i + QUANT_LANES - 1 widened to int32, i a multiple of QUANT_LANES */
+template <QuantKind K>
+static inline QuantInt quantCodes(const uint8_t *src, size_t i) noexcept
+{
+#if defined(__AVX512BW__)
+    if constexpr (K == QuantKind::Int4) {
+        __m512i q = _mm512_cvtepu8_epi32(int4Duplicate(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i / 2))));
+        q         = _mm512_sllv_epi32(q, _mm512_setr_epi32(28, 24, 28, 24, 28, 24, 28, 24, 28, 24, 28, 24, 28, 24, 28, 24));
+        return _mm512_srai_epi32(q, 28);
+    } else if constexpr (K == QuantKind::Int8) {
+        return _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+    } else {
+        return _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+    }
+#else
+    if constexpr (K == QuantKind::Int4) {
+        int32_t packed;
+        std::memcpy(&packed, src + i / 2, sizeof(packed));
+        __m256i q = _mm256_cvtepu8_epi32(int4Duplicate(_mm_cvtsi32_si128(packed)));
+        q         = _mm256_sllv_epi32(q, _mm256_setr_epi32(28, 24, 28, 24, 28, 24, 28, 24));
+        return _mm256_srai_epi32(q, 28);
+    } else if constexpr (K == QuantKind::Int8) {
+        return _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+    } else {
+        return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+    }
+#endif
+}
+
+/* One vector of floats scaled, shifted, clamped and rounded to int32 */
+template <QuantKind K>
+static inline QuantInt quantizeLanes(const float *src, const QuantFloat &inv, const QuantFloat &zero) noexcept
+{
+    QuantFloat x;
+    x.loadu(src);
+    x = x.fmadd(inv, zero);
+#if defined(__AVX512BW__)
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(QuantTraits<K>::QMIN)), _mm512_set1_ps(QuantTraits<K>::QMAX));
+#else
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(QuantTraits<K>::QMIN)), _mm256_set1_ps(QuantTraits<K>::QMAX));
+#endif
+    return x.round<QUANT_ROUNDING>().cvt2int32();
+}
+
+/*
+ * QUANT_BLOCK values from src to dst. The int32 results are already in
+ * range, so the saturating packs only narrow them; packs work within
+ * 128-bit lanes and the dword permute puts the four vectors back in order.
+ */
+template <QuantKind K>
+static inline void quantizeBlock(const float *src, uint8_t *dst, const QuantFloat &inv, const QuantFloat &zero) noexcept
+{
+    QuantInt q0 = quantizeLanes<K>(src, inv, zero);
+    QuantInt q1 = quantizeLanes<K>(src + QUANT_LANES, inv, zero);
+    QuantInt q2 = quantizeLanes<K>(src + 2 * QUANT_LANES, inv, zero);
+    QuantInt q3 = quantizeLanes<K>(src + 3 * QUANT_LANES, inv, zero);
+#if defined(__AVX512BW__)
+    __m512i w0 = _mm512_packs_epi32(q0, q1);
+    __m512i w1 = _mm512_packs_epi32(q2, q3);
+    __m512i b  = K == QuantKind::Uint8 ? _mm512_packus_epi16(w0, w1) : _mm512_packs_epi16(w0, w1);
+    b          = _mm512_permutexvar_epi32(_mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15), b);
+    if constexpr (K == QuantKind::Int4) {
+        __m512i lo = _mm512_and_si512(b, _mm512_set1_epi16(0x000f));
+        __m512i hi = _mm512_and_si512(_mm512_srli_epi16(b, 4), _mm512_set1_epi16(0x00f0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), _mm512_cvtepi16_epi8(_mm512_or_si512(lo, hi)));
+    } else if constexpr (K == QuantKind::Int8) {
+        INT8X64(b).storeu(reinterpret_cast<int8_t *>(dst));
+    } else {
+        UINT8X64(b).storeu(dst);
+    }
+#else
+    __m256i w0 = _mm256_packs_epi32(q0, q1);
+    __m256i w1 = _mm256_packs_epi32(q2, q3);
+    __m256i b  = K == QuantKind::Uint8 ? _mm256_packus_epi16(w0, w1) : _mm256_packs_epi16(w0, w1);
+    b          = _mm256_permutevar8x32_epi32(b, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    if constexpr (K == QuantKind::Int4) {
+        __m256i lo = _mm256_and_si256(b, _mm256_set1_epi16(0x000f));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(b, 4), _mm256_set1_epi16(0x00f0));
+        __m256i p  = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_or_si256(lo, hi), lo), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm256_castsi256_si128(p));
+    } else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), b);
+    }
+#endif
+}
+
+template <QuantKind K>
+static inline void quantizeSpan(const float *src, uint8_t *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    float inv  = 1.0f / scale;
+    float zero = static_cast<float>(zeroPoint);
+    QuantFloat invv(inv), zerov(zero);
+
+    size_t end = n - n % QUANT_BLOCK;
+    for (size_t i = 0; i < end; i += QUANT_BLOCK) {
+        quantizeBlock<K>(src + i, dst + quantBytes<K>(i), invv, zerov);
+    }
+    if constexpr (K == QuantKind::Int4) {
+        for (size_t i = end; i < n; i += 2) {
+            int32_t lo = quantizeValue<K>(src[i], inv, zero);
+            int32_t hi = i + 1 < n ? quantizeValue<K>(src[i + 1], inv, zero) : 0;
+            dst[i / 2] = static_cast<uint8_t>((lo & 0xf) | (hi & 0xf) << 4);
+        }
+    } else {
+        for (size_t i = end; i < n; i++) {
+            dst[i] = static_cast<uint8_t>(quantizeValue<K>(src[i], inv, zero));
+        }
+    }
+}
+
+template <QuantKind K>
+static inline void dequantizeSpan(const uint8_t *src, float *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    QuantFloat scalev(scale);
+    size_t end = n - n % QUANT_LANES;
+    for (size_t i = 0; i < end; i += QUANT_LANES) {
+#if defined(__AVX512BW__)
+        QuantFloat x = _mm512_cvtepi32_ps(_mm512_sub_epi32(quantCodes<K>(src, i), _mm512_set1_epi32(zeroPoint)));
+#else
+        QuantFloat x = _mm256_cvtepi32_ps(_mm256_sub_epi32(quantCodes<K>(src, i), _mm256_set1_epi32(zeroPoint)));
+#endif
+        (x * scalev).storeu(dst + i);
+    }
+    for (size_t i = end; i < n; i++) {
+        dst[i] = static_cast<float>(quantCode<K>(src, i) - zeroPoint) * scale;
+    }
+}
+
+/*
+ * sums[j] = sum over c of (q[j][c] - zeroPoints[j]) * x[c] for N rows.
+ * The weights are widened and converted in registers and consumed by the
+ * FMA right away, so no float copy of a row is ever written.
+ */
+template <QuantKind K, size_t N>
+static inline void gemvRows(const uint8_t *const *rows, const int32_t *zeroPoints, const float *x, size_t cols, float *sums) noexcept
+{
+    QuantFloat acc[N];
+    QuantInt zero[N];
+    for (size_t j = 0; j < N; j++) {
+        acc[j] = QuantFloat(0.0f);
+#if defined(__AVX512BW__)
+        zero[j] = _mm512_set1_epi32(zeroPoints[j]);
+#else
+        zero[j] = _mm256_set1_epi32(zeroPoints[j]);
+#endif
+    }
+
+    size_t end = cols - cols % QUANT_LANES;
+    for (size_t c = 0; c < end; c += QUANT_LANES) {
+        QuantFloat xv;
+        xv.loadu(x + c);
+        for (size_t j = 0; j < N; j++) {
+#if defined(__AVX512BW__)
+            QuantFloat w = _mm512_cvtepi32_ps(_mm512_sub_epi32(quantCodes<K>(rows[j], c), zero[j]));
+#else
+            QuantFloat w = _mm256_cvtepi32_ps(_mm256_sub_epi32(quantCodes<K>(rows[j], c), zero[j]));
+#endif
+            acc[j] = w.fmadd(xv, acc[j]);
+        }
+    }
+
+    for (size_t j = 0; j < N; j++) {
+        float sum = quantSum(acc[j]);
+        for (size_t c = end; c < cols; c++) {
+            sum += static_cast<float>(quantCode<K>(rows[j], c) - zeroPoints[j]) * x[c];
+        }
+        sums[j] = sum;
+    }
+}
+
+/* step is 1 for per-channel parameters and 0 for one pair shared by every row */
+template <QuantKind K>
+static inline void dequantizeGemvRows(const uint8_t *w, size_t rows, size_t cols, const float *scales, const int32_t *zeroPoints, size_t step,
+                                      const float *x, float *y) noexcept
+{
+    size_t stride = quantBytes<K>(cols);
+    size_t end    = rows - rows % QUANT_GEMV_GROUP;
+    const uint8_t *group[QUANT_GEMV_GROUP];
+    int32_t zero[QUANT_GEMV_GROUP];
+    float sums[QUANT_GEMV_GROUP];
+
+    for (size_t r = 0; r < end; r += QUANT_GEMV_GROUP) {
+        for (size_t j = 0; j < QUANT_GEMV_GROUP; j++) {
+            group[j] = w + (r + j) * stride;
+            zero[j]  = zeroPoints[(r + j) * step];
+        }
+        gemvRows<K, QUANT_GEMV_GROUP>(group, zero, x, cols, sums);
+        for (size_t j = 0; j < QUANT_GEMV_GROUP; j++) {
+            y[r + j] = sums[j] * scales[(r + j) * step];
+        }
+    }
+    for (size_t r = end; r < rows; r++) {
+        const uint8_t *row = w + r * stride;
+        gemvRows<K, 1>(&row, zeroPoints + r * step, x, cols, sums);
+        y[r] = sums[0] * scales[r * step];
+    }
+}
+
+} // namespace detail
+} // namespace slimm
+
+/**
+ * @brief Quantizes n floats to int8_t or uint8_t with one scale and zero point
+ */
+template <class T>
+static inline void quantize(const float *src, T *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "quantize supports int8_t and uint8_t");
+    using namespace slimm::detail;
+    quantizeSpan<QUANT_KIND_OF<T>>(src, reinterpret_cast<uint8_t *>(dst), n, scale, zeroPoint);
+}
+
+/**
+ * @brief Quantizes n floats to signed int4, (n + 1) / 2 bytes with the odd high nibble left zero
+ */
+static inline void quantizeInt4(const float *src, uint8_t *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    slimm::detail::quantizeSpan<slimm::detail::QuantKind::Int4>(src, dst, n, scale, zeroPoint);
+}
+
+template <class T>
+static inline void dequantize(const T *src, float *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "dequantize supports int8_t and uint8_t");
+    using namespace slimm::detail;
+    dequantizeSpan<QUANT_KIND_OF<T>>(reinterpret_cast<const uint8_t *>(src), dst, n, scale, zeroPoint);
+}
+
+static inline void dequantizeInt4(const uint8_t *src, float *dst, size_t n, float scale, int32_t zeroPoint) noexcept
+{
+    slimm::detail::dequantizeSpan<slimm::detail::QuantKind::Int4>(src, dst, n, scale, zeroPoint);
+}
+
+/**
+ * @brief Quantizes a rows x cols matrix with one scale and zero point per row
+ */
+template <class T>
+static inline void quantizePerChannel(const float *src, T *dst, size_t rows, size_t cols, const float *scales, const int32_t *zeroPoints) noexcept
+{
+    for (size_t r = 0; r < rows; r++) {
+        quantize(src + r * cols, dst + r * cols, cols, scales[r], zeroPoints[r]);
+    }
+}
+
+/**
+ * @brief Quantizes a rows x cols matrix to int4 with one scale and zero point per row, each row (cols + 1) / 2 bytes
+ */
+static inline void quantizeInt4PerChannel(const float *src, uint8_t *dst, size_t rows, size_t cols, const float *scales,
+                                          const int32_t *zeroPoints) noexcept
+{
+    size_t stride = (cols + 1) / 2;
+    for (size_t r = 0; r < rows; r++) {
+        quantizeInt4(src + r * cols, dst + r * stride, cols, scales[r], zeroPoints[r]);
+    }
+}
+
+template <class T>
+static inline void dequantizePerChannel(const T *src, float *dst, size_t rows, size_t cols, const float *scales, const int32_t *zeroPoints) noexcept
+{
+    for (size_t r = 0; r < rows; r++) {
+        dequantize(src + r * cols, dst + r * cols, cols, scales[r], zeroPoints[r]);
+    }
+}
+
+static inline void dequantizeInt4PerChannel(const uint8_t *src, float *dst, size_t rows, size_t cols, const float *scales,
+                                            const int32_t *zeroPoints) noexcept
+{
+    size_t stride = (cols + 1) / 2;
+    for (size_t r = 0; r < rows; r++) {
+        dequantizeInt4(src + r * stride, dst + r * cols, cols, scales[r], zeroPoints[r]);
+    }
+}
+
+/**
+ * @brief y = dequantize(w) * x for a rows x cols int8_t or uint8_t matrix with per-row scales and zero points
+ *
+ * The weights are dequantized in registers as they are consumed; the float
+ * matrix is never materialized.
+ */
+template <class T>
+static inline void dequantizeGemv(const T *w, size_t rows, size_t cols, const float *scales, const int32_t *zeroPoints, const float *x,
+                                  float *y) noexcept
+{
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "dequantizeGemv supports int8_t and uint8_t");
+    using namespace slimm::detail;
+    dequantizeGemvRows<QUANT_KIND_OF<T>>(reinterpret_cast<const uint8_t *>(w), rows, cols, scales, zeroPoints, 1, x, y);
+}
+
+/**
+ * @brief y = dequantize(w) * x for a rows x cols int8_t or uint8_t matrix with one scale and zero point
+ */
+template <class T>
+static inline void dequantizeGemv(const T *w, size_t rows, size_t cols, float scale, int32_t zeroPoint, const float *x, float *y) noexcept
+{
+    static_assert(std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t>, "dequantizeGemv supports int8_t and uint8_t");
+    using namespace slimm::detail;
+    dequantizeGemvRows<QUANT_KIND_OF<T>>(reinterpret_cast<const uint8_t *>(w), rows, cols, &scale, &zeroPoint, 0, x, y);
+}
+
+/**
+ * @brief y = dequantize(w) * x for an int4 matrix laid out as quantizeInt4PerChannel writes it, with per-row parameters
+ */
+static inline void dequantizeGemvInt4(const uint8_t *w, size_t rows, size_t cols, const float *scales, const int32_t *zeroPoints, const float *x,
+                                      float *y) noexcept
+{
+    slimm::detail::dequantizeGemvRows<slimm::detail::QuantKind::Int4>(w, rows, cols, scales, zeroPoints, 1, x, y);
+}
+
+static inline void dequantizeGemvInt4(const uint8_t *w, size_t rows, size_t cols, float scale, int32_t zeroPoint, const float *x, float *y) noexcept
+{
+    slimm::detail::dequantizeGemvRows<slimm::detail::QuantKind::Int4>(w, rows, cols, &scale, &zeroPoint, 0, x, y);
+}
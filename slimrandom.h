@@ -0,0 +1,537 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "slimmintrin.h"
+#include "slimhash.h"
+
+/*
+ * Two generators share one interface: bits() returns a register of raw
+ * random bits, and the distributions below take any generator and turn
+ * its registers into UINT32X*, FLOATX* or DOUBLEX* values or fill spans.
+ *
+ * Xoshiro256pp runs one xoshiro256++ state per 64-bit lane, so its stream
+ * depends on the register width. Philox4x32 is counter based: word i of
+ * a stream is a pure function of (key, stream, i), the same on every
+ * instruction set, and any position can be reached with seek(). Bulk
+ * fills consume whole registers, so a Philox sequence of fills matches
+ * across instruction sets when each length is a multiple of 16 values or
+ * each fill starts from seek().
+ */
+
+namespace slimm::detail
+{
+
+#if defined(__AVX512F__)
+using RngBits   = __m512i;
+using RngUint32 = UINT32X16;
+using RngFloat  = FLOATX16;
+using RngDouble = DOUBLEX8;
+#else
+using RngBits   = __m256i;
+using RngUint32 = UINT32X8;
+using RngFloat  = FLOATX8;
+using RngDouble = DOUBLEX4;
+#endif
+
+constexpr size_t RNG_LANES64 = sizeof(RngBits) / sizeof(uint64_t);
+constexpr size_t RNG_LANES32 = sizeof(RngBits) / sizeof(uint32_t);
+
+static inline uint64_t splitmix64(uint64_t &x) noexcept
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+    z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z          = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline void xoshiroStep(uint64_t s[4]) noexcept
+{
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+}
+
+/* Advances s by the number of steps the polynomial encodes, 2^128 for jump and 2^192 for long jump */
+static inline void xoshiroJump(uint64_t s[4], const uint64_t (&poly)[4]) noexcept
+{
+    uint64_t t[4] = {};
+    for (uint64_t word : poly) {
+        for (int b = 0; b < 64; b++) {
+            if (word & (1ULL << b)) {
+                for (int i = 0; i < 4; i++) {
+                    t[i] ^= s[i];
+                }
+            }
+            xoshiroStep(s);
+        }
+    }
+    std::memcpy(s, t, sizeof(t));
+}
+
+static constexpr uint64_t XOSHIRO_JUMP[4]      = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+static constexpr uint64_t XOSHIRO_LONG_JUMP[4] = { 0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL };
+
+static constexpr uint32_t PHILOX_M0 = 0xD2511F53U;
+static constexpr uint32_t PHILOX_M1 = 0xCD9E8D57U;
+static constexpr uint32_t PHILOX_W0 = 0x9E3779B9U;
+static constexpr uint32_t PHILOX_W1 = 0xBB67AE85U;
+
+/* Odd 32-bit lanes from b, even ones from a */
+static inline __m256i blendOdd32(__m256i a, __m256i b) noexcept { return _mm256_blend_epi32(a, b, 0xAA); }
+static inline __m512i blendOdd32(__m512i a, __m512i b) noexcept { return _mm512_mask_blend_epi32(0xAAAA, a, b); }
+
+/* Full 32x32->64 products of every lane with m, split into the low and high halves */
+static inline void mulHiLo32(RngBits a, RngBits m, RngBits &lo, RngBits &hi) noexcept
+{
+    RngBits even = mulEpu32(a, m);
+    RngBits odd  = mulEpu32(srli64<32>(a), m);
+    lo           = blendOdd32(even, slli64<32>(odd));
+    hi           = blendOdd32(srli64<32>(even), odd);
+}
+
+/*
+ * Four registers holding word 0, 1, 2 and 3 of consecutive counters to
+ * the stream order, counter by counter: a 4x4 transpose inside every
+ * 128-bit lane and then, with more than two lanes, a 128-bit shuffle.
+ */
+static inline void philoxInterleave(RngBits x[4]) noexcept
+{
+#if defined(__AVX512F__)
+    __m512i a0 = _mm512_unpacklo_epi32(x[0], x[1]), a1 = _mm512_unpackhi_epi32(x[0], x[1]);
+    __m512i a2 = _mm512_unpacklo_epi32(x[2], x[3]), a3 = _mm512_unpackhi_epi32(x[2], x[3]);
+    __m512i t0 = _mm512_unpacklo_epi64(a0, a2), t1 = _mm512_unpackhi_epi64(a0, a2);
+    __m512i t2 = _mm512_unpacklo_epi64(a1, a3), t3 = _mm512_unpackhi_epi64(a1, a3);
+    __m512i u0 = _mm512_shuffle_i32x4(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)), u1 = _mm512_shuffle_i32x4(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m512i u2 = _mm512_shuffle_i32x4(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)), u3 = _mm512_shuffle_i32x4(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    x[0]       = _mm512_shuffle_i32x4(u0, u1, _MM_SHUFFLE(2, 0, 2, 0));
+    x[1]       = _mm512_shuffle_i32x4(u0, u1, _MM_SHUFFLE(3, 1, 3, 1));
+    x[2]       = _mm512_shuffle_i32x4(u2, u3, _MM_SHUFFLE(2, 0, 2, 0));
+    x[3]       = _mm512_shuffle_i32x4(u2, u3, _MM_SHUFFLE(3, 1, 3, 1));
+#else
+    __m256i a0 = _mm256_unpacklo_epi32(x[0], x[1]), a1 = _mm256_unpackhi_epi32(x[0], x[1]);
+    __m256i a2 = _mm256_unpacklo_epi32(x[2], x[3]), a3 = _mm256_unpackhi_epi32(x[2], x[3]);
+    __m256i t0 = _mm256_unpacklo_epi64(a0, a2), t1 = _mm256_unpackhi_epi64(a0, a2);
+    __m256i t2 = _mm256_unpacklo_epi64(a1, a3), t3 = _mm256_unpackhi_epi64(a1, a3);
+    x[0]       = _mm256_permute2x128_si256(t0, t1, 0x20);
+    x[1]       = _mm256_permute2x128_si256(t2, t3, 0x20);
+    x[2]       = _mm256_permute2x128_si256(t0, t1, 0x31);
+    x[3]       = _mm256_permute2x128_si256(t2, t3, 0x31);
+#endif
+}
+
+} // namespace slimm::detail
+
+/**
+ * xoshiro256++ with one state per 64-bit lane.
+ *
+ * Lane k starts 2^128 steps after lane k - 1, and stream s starts 2^192
+ * steps after stream s - 1, so lanes and streams never overlap. bits()
+ * returns RNG_LANES64 outputs, one per lane.
+ */
+class Xoshiro256pp
+{
+public:
+    explicit Xoshiro256pp(uint64_t seed, uint64_t stream = 0) noexcept
+    {
+        using namespace slimm::detail;
+        uint64_t state[4], lanes[4][RNG_LANES64];
+        for (uint64_t &w : state) {
+            w = splitmix64(seed);
+        }
+        for (uint64_t i = 0; i < stream; i++) {
+            xoshiroJump(state, XOSHIRO_LONG_JUMP);
+        }
+        for (size_t k = 0; k < RNG_LANES64; k++) {
+            for (int i = 0; i < 4; i++) {
+                lanes[i][k] = state[i];
+            }
+            xoshiroJump(state, XOSHIRO_JUMP);
+        }
+        for (int i = 0; i < 4; i++) {
+            loadu(this->s[i], lanes[i]);
+        }
+    }
+
+    slimm::detail::RngBits bits() noexcept
+    {
+        using namespace slimm::detail;
+        RngBits result = add64(rotl64<23>(add64(s[0], s[3])), s[0]);
+        RngBits t      = slli64<17>(s[1]);
+        s[2]           = xorv(s[2], s[0]);
+        s[3]           = xorv(s[3], s[1]);
+        s[1]           = xorv(s[1], s[2]);
+        s[0]           = xorv(s[0], s[3]);
+        s[2]           = xorv(s[2], t);
+        s[3]           = rotl64<45>(s[3]);
+        return result;
+    }
+
+private:
+    slimm::detail::RngBits s[4];
+};
+
+/**
+ * Philox4x32-10 counter-based generator.
+ *
+ * Counter i of stream s is (i, s) as four 32-bit words, low first, and
+ * encrypts to words 4i .. 4i + 3 of the stream. bits() returns the next
+ * RNG_LANES32 words in stream order.
+ */
+class Philox4x32
+{
+public:
+    explicit Philox4x32(uint64_t key, uint64_t stream = 0) noexcept :
+        key{ static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32) }, stream{ stream }
+    {
+    }
+
+    /**
+     * @brief Continues the stream at word 4 * counter
+     */
+    void seek(uint64_t counter) noexcept
+    {
+        this->counter = counter;
+        used          = 4;
+    }
+
+    slimm::detail::RngBits bits() noexcept
+    {
+        if (used == 4) {
+            refill();
+        }
+        return buffer[used++];
+    }
+
+private:
+    /* Encrypts the next RNG_LANES32 counters, one per 32-bit lane */
+    void refill() noexcept
+    {
+        using namespace slimm::detail;
+        constexpr size_t n = RNG_LANES32;
+        uint32_t lo[n], hi[n];
+        for (size_t i = 0; i < n; i++) {
+            lo[i] = static_cast<uint32_t>(counter + i);
+            hi[i] = static_cast<uint32_t>((counter + i) >> 32);
+        }
+        counter += n;
+
+        RngBits x[4], m0 = set32<RngBits>(PHILOX_M0), m1 = set32<RngBits>(PHILOX_M1);
+        loadu(x[0], lo);
+        loadu(x[1], hi);
+        x[2]       = set32<RngBits>(static_cast<uint32_t>(stream));
+        x[3]       = set32<RngBits>(static_cast<uint32_t>(stream >> 32));
+        RngBits k0 = set32<RngBits>(key[0]), k1 = set32<RngBits>(key[1]);
+        for (int round = 0; round < 10; round++) {
+            RngBits lo0, hi0, lo1, hi1;
+            mulHiLo32(x[0], m0, lo0, hi0);
+            mulHiLo32(x[2], m1, lo1, hi1);
+            x[0] = xorv(xorv(hi1, x[1]), k0);
+            x[1] = lo1;
+            x[2] = xorv(xorv(hi0, x[3]), k1);
+            x[3] = lo0;
+            k0   = add32(k0, set32<RngBits>(PHILOX_W0));
+            k1   = add32(k1, set32<RngBits>(PHILOX_W1));
+        }
+        philoxInterleave(x);
+        for (int i = 0; i < 4; i++) {
+            buffer[i] = x[i];
+        }
+        used = 0;
+    }
+
+    uint32_t key[2];
+    uint64_t stream;
+    uint64_t counter = 0;
+    size_t used      = 4;
+    slimm::detail::RngBits buffer[4];
+};
+
+namespace slimm::detail
+{
+
+/* [0, 1) with 24 bits from each 32-bit word */
+static inline RngFloat uniformFloatFromBits(RngBits b) noexcept
+{
+#if defined(__AVX512F__)
+    return _mm512_mul_ps(_mm512_cvtepi32_ps(srli32<8>(b)), _mm512_set1_ps(0x1p-24f));
+#else
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(srli32<8>(b)), _mm256_set1_ps(0x1p-24f));
+#endif
+}
+
+/* [0, 1) with 52 bits from each 64-bit word, through the mantissa of [1, 2) */
+static inline RngDouble uniformDoubleFromBits(RngBits b) noexcept
+{
+    RngBits one = set64<RngBits>(0x3FF0000000000000ULL);
+#if defined(__AVX512F__)
+    return _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(srli64<12>(b), one)), _mm512_set1_pd(1.0));
+#else
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(srli64<12>(b), one)), _mm256_set1_pd(1.0));
+#endif
+}
+
+/* ln x for normal positive x, the Cephes logf reduction and polynomial */
+static inline RngFloat rngLog(RngFloat x) noexcept
+{
+#if defined(__AVX512F__)
+    __m512i i = _mm512_castps_si512(x);
+    RngFloat e = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(i, 23), _mm512_set1_epi32(126)));
+    RngFloat m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(i, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F000000)));
+    __mmask16 small = _mm512_cmp_ps_mask(m, _mm512_set1_ps(0.707106781f), _CMP_LT_OQ);
+    e = _mm512_mask_sub_ps(e, small, e, _mm512_set1_ps(1.0f));
+    m = _mm512_mask_add_ps(m, small, m, m);
+#else
+    __m256i i = _mm256_castps_si256(x);
+    RngFloat e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(i, 23), _mm256_set1_epi32(126)));
+    RngFloat m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(i, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+    __m256 small = _mm256_cmp_ps(m, _mm256_set1_ps(0.707106781f), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(small, _mm256_set1_ps(1.0f)));
+    m = _mm256_add_ps(m, _mm256_and_ps(small, m));
+#endif
+    RngFloat f = m - RngFloat(1.0f);
+    RngFloat z = f * f;
+    RngFloat p(7.0376836292e-2f);
+    p = p.fmadd(f, RngFloat(-1.1514610310e-1f));
+    p = p.fmadd(f, RngFloat(1.1676998740e-1f));
+    p = p.fmadd(f, RngFloat(-1.2420140846e-1f));
+    p = p.fmadd(f, RngFloat(1.4249322787e-1f));
+    p = p.fmadd(f, RngFloat(-1.6668057665e-1f));
+    p = p.fmadd(f, RngFloat(2.0000714765e-1f));
+    p = p.fmadd(f, RngFloat(-2.4999993993e-1f));
+    p = p.fmadd(f, RngFloat(3.3333331174e-1f));
+    RngFloat y = p * f * z;
+    y = e.fmadd(RngFloat(-2.12194440e-4f), y);
+    y = z.fmadd(RngFloat(-0.5f), y);
+    return e.fmadd(RngFloat(0.693359375f), f + y);
+}
+
+/*
+ * Box-Muller on each pair of 32-bit words (a, b): the even lane gets
+ * r cos(t) and the odd lane r sin(t) with r = sqrt(-2 ln u), u from a in
+ * (0, 1], and t = 2 pi b / 2^32. Pairing adjacent words keeps the output
+ * independent of the register width. The angle is reduced in integers:
+ * t = k pi / 2 + y with |y| <= pi / 4, and sin t = cos(t - pi / 2) moves
+ * the odd lanes back a quadrant, so each lane evaluates one cosine.
+ */
+static inline RngFloat normalFromBits(RngBits b) noexcept
+{
+    constexpr int QUARTER_BACK = static_cast<int>(0xC0000000U);
+#if defined(__AVX512F__)
+    __m512i a     = _mm512_shuffle_epi32(b, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(2, 2, 0, 0)));
+    __m512i t     = _mm512_shuffle_epi32(b, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(3, 3, 1, 1)));
+    t             = _mm512_add_epi32(t, _mm512_set_epi32(QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0));
+    __m512i k     = _mm512_srli_epi32(_mm512_add_epi32(t, _mm512_set1_epi32(1 << 29)), 30);
+    RngFloat y    = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(t, _mm512_slli_epi32(k, 30))), _mm512_set1_ps(0x1.921fb6p-30f));
+    RngFloat u    = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_srli_epi32(a, 8), _mm512_set1_epi32(1))), _mm512_set1_ps(0x1p-24f));
+    __mmask16 odd = _mm512_test_epi32_mask(k, _mm512_set1_epi32(1));
+    __m512i sign  = _mm512_slli_epi32(_mm512_and_si512(_mm512_add_epi32(k, _mm512_set1_epi32(1)), _mm512_set1_epi32(2)), 30);
+#else
+    __m256i a     = _mm256_shuffle_epi32(b, _MM_SHUFFLE(2, 2, 0, 0));
+    __m256i t     = _mm256_shuffle_epi32(b, _MM_SHUFFLE(3, 3, 1, 1));
+    t             = _mm256_add_epi32(t, _mm256_set_epi32(QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0, QUARTER_BACK, 0));
+    __m256i k     = _mm256_srli_epi32(_mm256_add_epi32(t, _mm256_set1_epi32(1 << 29)), 30);
+    RngFloat y    = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(t, _mm256_slli_epi32(k, 30))), _mm256_set1_ps(0x1.921fb6p-30f));
+    RngFloat u    = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_srli_epi32(a, 8), _mm256_set1_epi32(1))), _mm256_set1_ps(0x1p-24f));
+    __m256 odd    = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(k, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    __m256i sign  = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(k, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30);
+#endif
+    /* The Cephes sinf and cosf polynomials on [-pi / 4, pi / 4] */
+    RngFloat z = y * y;
+    RngFloat s = RngFloat(-1.9515295891e-4f).fmadd(z, RngFloat(8.3321608736e-3f)).fmadd(z, RngFloat(-1.6666654611e-1f));
+    s          = (s * z).fmadd(y, y);
+    RngFloat c = RngFloat(2.443315711809948e-5f).fmadd(z, RngFloat(-1.388731625493765e-3f)).fmadd(z, RngFloat(4.166664568298827e-2f));
+    c          = (c * z).fmadd(z, z.fmadd(RngFloat(-0.5f), RngFloat(1.0f)));
+
+    RngFloat r = rngLog(u) * RngFloat(-2.0f);
+#if defined(__AVX512F__)
+    RngFloat trig = _mm512_mask_blend_ps(odd, c, s);
+    trig          = _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(trig), sign));
+    return _mm512_mul_ps(_mm512_sqrt_ps(r), trig);
+#else
+    RngFloat trig = _mm256_blendv_ps(c, s, odd);
+    trig          = _mm256_xor_ps(trig, _mm256_castsi256_ps(sign));
+    return _mm256_mul_ps(_mm256_sqrt_ps(r), trig);
+#endif
+}
+
+/* Stores the first n < RNG_LANES32 words of a register */
+static inline void storePartial(void *dst, RngBits v, size_t bytes) noexcept
+{
+    alignas(64) uint8_t tmp[sizeof(RngBits)];
+    storeu(tmp, v);
+    std::memcpy(dst, tmp, bytes);
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief RNG_LANES32 uniform 32-bit words
+ */
+template <class G>
+static inline slimm::detail::RngUint32 uniformUint32(G &g) noexcept
+{
+    return g.bits();
+}
+
+/**
+ * @brief Uniform floats in [0, 1), multiples of 2^-24
+ */
+template <class G>
+static inline slimm::detail::RngFloat uniformFloat(G &g) noexcept
+{
+    return slimm::detail::uniformFloatFromBits(g.bits());
+}
+
+/**
+ * @brief Uniform doubles in [0, 1), multiples of 2^-52
+ */
+template <class G>
+static inline slimm::detail::RngDouble uniformDouble(G &g) noexcept
+{
+    return slimm::detail::uniformDoubleFromBits(g.bits());
+}
+
+/**
+ * @brief Standard normal floats by Box-Muller, truncated at about 5.77 sigma by the 24-bit uniforms
+ */
+template <class G>
+static inline slimm::detail::RngFloat normalFloat(G &g) noexcept
+{
+    return slimm::detail::normalFromBits(g.bits());
+}
+
+/**
+ * @brief Fills dst with n random 32-bit words
+ *
+ * Bulk fills draw whole registers, so a tail of n that is not a multiple
+ * of the register width discards the rest of the last one.
+ */
+template <class G>
+static inline void fillBits(G &g, uint32_t *dst, size_t n) noexcept
+{
+    using namespace slimm::detail;
+    size_t end = n - n % RNG_LANES32;
+    for (size_t i = 0; i < end; i += RNG_LANES32) {
+        storeu(dst + i, g.bits());
+    }
+    if (end < n) {
+        storePartial(dst + end, g.bits(), (n - end) * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Fills dst with n floats uniform in [lo, hi)
+ */
+template <class G>
+static inline void fillUniform(G &g, float *dst, size_t n, float lo = 0.0f, float hi = 1.0f) noexcept
+{
+    using namespace slimm::detail;
+    RngFloat scale(hi - lo), offset(lo);
+    size_t end = n - n % RNG_LANES32;
+    for (size_t i = 0; i < end; i += RNG_LANES32) {
+        uniformFloatFromBits(g.bits()).fmadd(scale, offset).storeu(dst + i);
+    }
+    if (end < n) {
+        RngFloat v = uniformFloatFromBits(g.bits()).fmadd(scale, offset);
+        float tmp[RNG_LANES32];
+        v.storeu(tmp);
+        std::memcpy(dst + end, tmp, (n - end) * sizeof(float));
+    }
+}
+
+/**
+ * @brief Fills dst with n doubles uniform in [lo, hi)
+ */
+template <class G>
+static inline void fillUniform(G &g, double *dst, size_t n, double lo = 0.0, double hi = 1.0) noexcept
+{
+    using namespace slimm::detail;
+    RngDouble scale(hi - lo), offset(lo);
+    size_t end = n - n % RNG_LANES64;
+    for (size_t i = 0; i < end; i += RNG_LANES64) {
+        (uniformDoubleFromBits(g.bits()) * scale + offset).storeu(dst + i);
+    }
+    if (end < n) {
+        RngDouble v = (uniformDoubleFromBits(g.bits()) * scale + offset);
+        double tmp[RNG_LANES64];
+        v.storeu(tmp);
+        std::memcpy(dst + end, tmp, (n - end) * sizeof(double));
+    }
+}
+
+/**
+ * @brief Fills dst with n normal floats of the given mean and standard deviation
+ */
+template <class G>
+static inline void fillNormal(G &g, float *dst, size_t n, float mean = 0.0f, float stddev = 1.0f) noexcept
+{
+    using namespace slimm::detail;
+    RngFloat scale(stddev), offset(mean);
+    size_t end = n - n % RNG_LANES32;
+    for (size_t i = 0; i < end; i += RNG_LANES32) {
+        normalFromBits(g.bits()).fmadd(scale, offset).storeu(dst + i);
+    }
+    if (end < n) {
+        RngFloat v = normalFromBits(g.bits()).fmadd(scale, offset);
+        float tmp[RNG_LANES32];
+        v.storeu(tmp);
+        std::memcpy(dst + end, tmp, (n - end) * sizeof(float));
+    }
+}
+
+/**
+ * @brief Fills dst with n integers uniform in [0, bound), bound > 0, without bias
+ *
+ * Lemire's multiply-and-reject: a word w maps to (w * bound) >> 32 unless
+ * the low half of the product falls below 2^32 mod bound, which happens
+ * with probability under bound / 2^32. Accepted values keep the order of
+ * the words they came from.
+ */
+template <class G>
+static inline void fillBounded(G &g, uint32_t *dst, size_t n, uint32_t bound) noexcept
+{
+    using namespace slimm::detail;
+    uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+    RngBits b          = set32<RngBits>(bound);
+    size_t i           = 0;
+    while (i < n) {
+        RngBits lo, hi;
+        mulHiLo32(g.bits(), b, lo, hi);
+#if defined(__AVX512F__)
+        uint32_t accept = _mm512_cmpge_epu32_mask(lo, _mm512_set1_epi32(static_cast<int>(threshold)));
+        if (accept == 0xFFFF && n - i >= RNG_LANES32) {
+            storeu(dst + i, hi);
+            i += RNG_LANES32;
+            continue;
+        }
+#else
+        __m256i below = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(threshold ^ 0x80000000U)),
+                                          _mm256_xor_si256(lo, _mm256_set1_epi32(INT32_MIN)));
+        uint32_t accept = ~static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(below))) & 0xFF;
+        if (accept == 0xFF && n - i >= RNG_LANES32) {
+            storeu(dst + i, hi);
+            i += RNG_LANES32;
+            continue;
+        }
+#endif
+        uint32_t words[RNG_LANES32];
+        storeu(words, hi);
+        for (size_t k = 0; k < RNG_LANES32 && i < n; k++) {
+            if (accept & (1u << k)) {
+                dst[i++] = words[k];
+            }
+        }
+    }
+}
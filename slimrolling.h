@@ -0,0 +1,909 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+#include "slimscan.h"
+
+/**
+ * Sliding-window statistics over time series on FLOATX8 and DOUBLEX4.
+ * The batch kernels write one result per full window, n - window + 1 of
+ * them, for the windows starting at sample 0, 1, ...; RollingWindow
+ * also reports the partial windows while it fills up.
+ *
+ * Sums and variances slide in O(1) per sample: the variance uses the
+ * sliding form of Welford's update, and both are recomputed from the
+ * window every ROLLING_RESYNC outputs so rounding cannot build up over
+ * long series. Minima and maxima use van Herk/Gil-Werman: block suffix
+ * and block prefix extremes combined, a few comparisons per sample for
+ * any window length. NaN samples give unspecified minima and maxima.
+ *
+ * Many series are stored interleaved, sample t of series s at
+ * src[t * series + s], and slide side by side in the lanes.
+ */
+
+namespace slimm::detail
+{
+
+/* Sliding sums are recomputed from the window after this many outputs, or after one window when that is longer */
+constexpr size_t ROLLING_RESYNC = 4096;
+
+/* Below this window length a minimum or maximum is taken directly over shifted loads */
+constexpr size_t ROLLING_DIRECT = 16;
+
+/* Samples per thread below which the batch kernels stay serial */
+constexpr size_t ROLLING_MIN_CHUNK = 1 << 16;
+
+/* Interleaved series are processed in panels of this many bytes of every sample row */
+constexpr size_t ROLLING_PANEL_BYTES = 4096;
+
+/**
+ * Lane operations of the rolling kernels on top of ScanLanes. up<k> moves
+ * every lane up by k and down<k> down by k, repeating the edge lane where
+ * nothing shifts in, which is harmless for min and max: the edge lane is
+ * always part of the same segment when the segment mask lets it in.
+ * Index registers hold positions within a block of the window length, in
+ * lanes as wide as the value lanes; wrap and unwrap bring them back into
+ * [0, span) after a step of at most span.
+ */
+template <class T>
+struct RollingLanes;
+
+template <>
+struct RollingLanes<float> : ScanLanes<FLOATX8>
+{
+    using index = __m256i;
+
+    static raw load(const float *p, size_t n) noexcept { return _mm256_maskload_ps(p, prefix(n)); }
+    static void store(float *p, raw v, size_t n) noexcept { _mm256_maskstore_ps(p, prefix(n), v); }
+    static raw sub(raw a, raw b) noexcept { return _mm256_sub_ps(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm256_mul_ps(a, b); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_ps(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_ps(a, b); }
+    static raw select(raw m, raw a, raw b) noexcept { return _mm256_blendv_ps(b, a, m); }
+    static raw front(raw v) noexcept { return _mm256_permutevar8x32_ps(v, _mm256_setzero_si256()); }
+    static raw shiftIn(raw v, raw carry) noexcept { return _mm256_blend_ps(up<1>(v), carry, 0x01); }
+    static index iota() noexcept { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    static index positions(size_t x) noexcept { return _mm256_set1_epi32(static_cast<int>(x)); }
+    static index advance(index a, index b) noexcept { return _mm256_add_epi32(a, b); }
+    static index retreat(index a, index b) noexcept { return _mm256_sub_epi32(a, b); }
+    static index wrap(index pos, index span) noexcept { return _mm256_sub_epi32(pos, _mm256_andnot_si256(_mm256_cmpgt_epi32(span, pos), span)); }
+    static index unwrap(index pos, index span) noexcept { return _mm256_add_epi32(pos, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), pos), span)); }
+    static raw greater(index a, index b) noexcept { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(a, b)); }
+    static __m256i prefix(size_t n) noexcept { return _mm256_cmpgt_epi32(positions(n), iota()); }
+
+    template <int k>
+    static raw up(raw v) noexcept
+    {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(std::max(0 - k, 0), std::max(1 - k, 0), std::max(2 - k, 0), std::max(3 - k, 0),
+                                                             std::max(4 - k, 0), std::max(5 - k, 0), std::max(6 - k, 0), 7 - k));
+    }
+
+    template <int k>
+    static raw down(raw v) noexcept
+    {
+        return _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(k, std::min(1 + k, 7), std::min(2 + k, 7), std::min(3 + k, 7), std::min(4 + k, 7),
+                                                             std::min(5 + k, 7), std::min(6 + k, 7), 7));
+    }
+};
+
+template <>
+struct RollingLanes<double> : ScanLanes<DOUBLEX4>
+{
+    using index = __m256i;
+
+    static raw load(const double *p, size_t n) noexcept { return _mm256_maskload_pd(p, prefix(n)); }
+    static void store(double *p, raw v, size_t n) noexcept { _mm256_maskstore_pd(p, prefix(n), v); }
+    static raw sub(raw a, raw b) noexcept { return _mm256_sub_pd(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm256_mul_pd(a, b); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_pd(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_pd(a, b); }
+    static raw select(raw m, raw a, raw b) noexcept { return _mm256_blendv_pd(b, a, m); }
+    static raw front(raw v) noexcept { return _mm256_permute4x64_pd(v, 0x00); }
+    static raw shiftIn(raw v, raw carry) noexcept { return _mm256_blend_pd(up<1>(v), carry, 0x01); }
+    static index iota() noexcept { return _mm256_setr_epi64x(0, 1, 2, 3); }
+    static index positions(size_t x) noexcept { return _mm256_set1_epi64x(static_cast<int64_t>(x)); }
+    static index advance(index a, index b) noexcept { return _mm256_add_epi64(a, b); }
+    static index retreat(index a, index b) noexcept { return _mm256_sub_epi64(a, b); }
+    static index wrap(index pos, index span) noexcept { return _mm256_sub_epi64(pos, _mm256_andnot_si256(_mm256_cmpgt_epi64(span, pos), span)); }
+    static index unwrap(index pos, index span) noexcept { return _mm256_add_epi64(pos, _mm256_and_si256(_mm256_cmpgt_epi64(_mm256_setzero_si256(), pos), span)); }
+    static raw greater(index a, index b) noexcept { return _mm256_castsi256_pd(_mm256_cmpgt_epi64(a, b)); }
+    static __m256i prefix(size_t n) noexcept { return _mm256_cmpgt_epi64(positions(n), iota()); }
+
+    template <int k>
+    static raw up(raw v) noexcept
+    {
+        constexpr int imm = std::max(0 - k, 0) | std::max(1 - k, 0) << 2 | std::max(2 - k, 0) << 4 | (3 - k) << 6;
+        return _mm256_permute4x64_pd(v, imm);
+    }
+
+    template <int k>
+    static raw down(raw v) noexcept
+    {
+        constexpr int imm = k | std::min(1 + k, 3) << 2 | std::min(2 + k, 3) << 4 | 3 << 6;
+        return _mm256_permute4x64_pd(v, imm);
+    }
+};
+
+/* The first count lanes from p; the others read as zero */
+template <class Ops>
+static inline typename Ops::raw rollingLoad(const typename Ops::scalar *p, size_t count) noexcept
+{
+    return count == Ops::lanes ? Ops::loadu(p) : Ops::load(p, count);
+}
+
+template <class Ops>
+static inline void rollingStore(typename Ops::scalar *p, typename Ops::raw v, size_t count) noexcept
+{
+    if (count == Ops::lanes) {
+        Ops::storeu(p, v);
+    } else {
+        Ops::store(p, v, count);
+    }
+}
+
+/* max when MAX, else min; like maxps and minps, the scalar form returns b unless a wins outright */
+template <bool MAX, class Ops>
+static inline typename Ops::raw extreme(typename Ops::raw a, typename Ops::raw b) noexcept
+{
+    if constexpr (MAX) {
+        return Ops::max(a, b);
+    } else {
+        return Ops::min(a, b);
+    }
+}
+
+template <bool MAX, class T>
+static inline T extremeOf(T a, T b) noexcept
+{
+    if constexpr (MAX) {
+        return a > b ? a : b;
+    } else {
+        return a < b ? a : b;
+    }
+}
+
+template <bool MAX, class T>
+static inline T extremeIdentity() noexcept
+{
+    return MAX ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+}
+
+/* The extreme of n contiguous samples, the identity when n is zero */
+template <bool MAX, class Ops>
+static inline typename Ops::scalar extremeReduce(const typename Ops::scalar *src, size_t n) noexcept
+{
+    using T = typename Ops::scalar;
+
+    auto   a0 = Ops::set1(extremeIdentity<MAX, T>()), a1 = a0;
+    size_t i  = 0;
+    for (; i + 2 * Ops::lanes <= n; i += 2 * Ops::lanes) {
+        a0 = extreme<MAX, Ops>(a0, Ops::loadu(src + i));
+        a1 = extreme<MAX, Ops>(a1, Ops::loadu(src + i + Ops::lanes));
+    }
+    alignas(32) T lane[Ops::lanes];
+    Ops::storeu(lane, extreme<MAX, Ops>(a0, a1));
+
+    T e = extremeIdentity<MAX, T>();
+    for (size_t l = 0; l < Ops::lanes; l++) {
+        e = extremeOf<MAX>(e, lane[l]);
+    }
+    for (; i < n; i++) {
+        e = extremeOf<MAX>(e, src[i]);
+    }
+    return e;
+}
+
+/* sum((x - mean)^2) over n contiguous samples, the exact start of a sliding variance */
+template <class Ops>
+static inline typename Ops::scalar squaredDeviations(const typename Ops::scalar *src, size_t n, typename Ops::scalar mean) noexcept
+{
+    using T = typename Ops::scalar;
+
+    auto   mu = Ops::set1(mean);
+    auto   a0 = Ops::set1(0), a1 = a0;
+    size_t i  = 0;
+    for (; i + 2 * Ops::lanes <= n; i += 2 * Ops::lanes) {
+        auto d0 = Ops::sub(Ops::loadu(src + i), mu);
+        auto d1 = Ops::sub(Ops::loadu(src + i + Ops::lanes), mu);
+        a0      = Ops::add(a0, Ops::mul(d0, d0));
+        a1      = Ops::add(a1, Ops::mul(d1, d1));
+    }
+    T m2 = Ops::first(Ops::last(Ops::scan(Ops::add(a0, a1))));
+    for (; i < n; i++) {
+        m2 += (src[i] - mean) * (src[i] - mean);
+    }
+    return m2;
+}
+
+enum class RollingMoment
+{
+    Sum,
+    Mean,
+    Variance,
+};
+
+/* What a moment kernel stores: the sum, the mean, or m2 over the degrees of freedom */
+template <class T>
+struct RollingScale
+{
+    T reciprocal; /* 1 / window, turns sums into means */
+    T output;     /* 1 for sums, 1 / window for means, 1 / (window - ddof) for variances */
+
+    RollingScale(RollingMoment moment, size_t window, size_t ddof) noexcept
+        : reciprocal(T(1) / static_cast<T>(window))
+    {
+        switch (moment) {
+        case RollingMoment::Sum:
+            output = T(1);
+            break;
+        case RollingMoment::Mean:
+            output = reciprocal;
+            break;
+        case RollingMoment::Variance:
+            output = window > ddof ? T(1) / static_cast<T>(window - ddof) : std::numeric_limits<T>::quiet_NaN();
+            break;
+        }
+    }
+};
+
+static inline size_t rollingPeriod(size_t window, size_t lanes) noexcept
+{
+    return std::max(ROLLING_RESYNC, (window + lanes - 1) / lanes * lanes);
+}
+
+/**
+ * Outputs [begin, end) of a moment along one series. The window at
+ * begin is summed afresh and its mean becomes the origin the sums are
+ * kept relative to, so the sliding updates round at the scale of the
+ * deviations rather than of the samples. Every register of outputs then
+ * takes the differences x[j + w - 1] - x[j - 1] through an in-register
+ * scan, and for the variance the increments
+ * (xin - xout)(xin + xout - mean - prev) through a second one, each
+ * carried over from the last lane.
+ */
+template <class T, RollingMoment M>
+static inline void rollingSpan(const T *x, size_t w, T *dst, size_t begin, size_t end, const RollingScale<T> &scale) noexcept
+{
+    using Ops          = RollingLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    T total  = reduce<Ops>(x + begin, w);
+    T origin = total * scale.reciprocal;
+    T base   = M == RollingMoment::Mean ? origin : origin * static_cast<T>(w);
+    T sum    = total - origin * static_cast<T>(w);
+    T mean   = sum * scale.reciprocal;
+    T m2     = M == RollingMoment::Variance ? squaredDeviations<Ops>(x + begin, w, origin + mean) : T(0);
+    dst[begin] = M == RollingMoment::Variance ? m2 * scale.output : sum * scale.output + base;
+
+    auto   reciprocal = Ops::set1(scale.reciprocal);
+    auto   output     = Ops::set1(scale.output);
+    auto   zero       = Ops::set1(0);
+    auto   shift      = Ops::set1(origin);
+    auto   offset     = Ops::set1(base);
+    auto   sums       = Ops::set1(sum);
+    auto   means      = Ops::set1(mean);
+    auto   m2s        = Ops::set1(m2);
+    size_t j          = begin + 1;
+    for (; j + L <= end; j += L) {
+        auto xin  = Ops::loadu(x + j + w - 1);
+        auto xout = Ops::loadu(x + j - 1);
+        auto d    = Ops::sub(xin, xout);
+        auto s    = Ops::add(Ops::scan(d), sums);
+        if constexpr (M == RollingMoment::Variance) {
+            auto mu   = Ops::mul(s, reciprocal);
+            auto prev = Ops::shiftIn(mu, means);
+            auto dev  = Ops::add(Ops::sub(xin, shift), Ops::sub(xout, shift));
+            auto e    = Ops::mul(d, Ops::sub(dev, Ops::add(mu, prev)));
+            auto q    = Ops::add(Ops::scan(e), m2s);
+            Ops::storeu(dst + j, Ops::mul(Ops::max(q, zero), output));
+            means = Ops::last(mu);
+            m2s   = Ops::last(q);
+        } else {
+            Ops::storeu(dst + j, Ops::add(Ops::mul(s, output), offset));
+        }
+        sums = Ops::last(s);
+    }
+
+    sum  = Ops::first(sums);
+    mean = Ops::first(means);
+    m2   = Ops::first(m2s);
+    for (; j < end; j++) {
+        T xin  = x[j + w - 1];
+        T xout = x[j - 1];
+        sum += xin - xout;
+        if constexpr (M == RollingMoment::Variance) {
+            T mu = sum * scale.reciprocal;
+            m2 += (xin - xout) * ((xin - origin) + (xout - origin) - (mu + mean));
+            mean   = mu;
+            dst[j] = std::max(m2, T(0)) * scale.output;
+        } else {
+            dst[j] = sum * scale.output + base;
+        }
+    }
+}
+
+/* Every resync period starts from an exact window, so the periods are independent tasks */
+template <class T, RollingMoment M>
+static inline size_t rollingSeries(const T *x, size_t n, size_t w, T *dst, size_t ddof, unsigned threads) noexcept
+{
+    if (w == 0 || n < w) {
+        return 0;
+    }
+
+    RollingScale<T> scale(M, w, ddof);
+    size_t          m       = n - w + 1;
+    size_t          period  = rollingPeriod(w, RollingLanes<T>::lanes);
+    size_t          periods = (m + period - 1) / period;
+    size_t          per     = std::max<size_t>(1, ROLLING_MIN_CHUNK / period);
+    size_t          tasks   = std::min<size_t>(resolveThreads(threads), (periods + per - 1) / per);
+    size_t          chunk   = (periods + tasks - 1) / tasks;
+    parallelFor(tasks, threads, [&](size_t task) {
+        for (size_t p = task * chunk; p < std::min(periods, (task + 1) * chunk); p++) {
+            rollingSpan<T, M>(x, w, dst, p * period, std::min(m, (p + 1) * period), scale);
+        }
+    });
+    return m;
+}
+
+/* Runs fn(i, lanes) over the registers of count interleaved series, the last one possibly partial */
+template <class Ops, class F>
+static inline void rollingLanes(size_t count, F &&fn) noexcept
+{
+    for (size_t i = 0; i < count; i += Ops::lanes) {
+        fn(i, std::min(Ops::lanes, count - i));
+    }
+}
+
+/**
+ * Moments of up to a panel of interleaved series. Rows are walked in
+ * time order and each one is read across the panel, so the rows stream
+ * from memory, while the window state of the panel stays in L1. Sums are
+ * kept relative to an origin per series, as in rollingSpan.
+ */
+template <class T, RollingMoment M>
+static inline void rollingPanel(const T *x, size_t steps, size_t stride, size_t count, size_t w, T *dst, const RollingScale<T> &scale)
+{
+    using Ops          = RollingLanes<T>;
+    using raw          = typename Ops::raw;
+    constexpr size_t L = Ops::lanes;
+
+    size_t         width = (count + L - 1) / L * L;
+    std::vector<T> state(4 * width);
+    T             *origins = state.data();
+    T             *sums    = origins + width;
+    T             *means   = sums + width;
+    T             *m2s     = means + width;
+
+    raw    reciprocal = Ops::set1(scale.reciprocal);
+    raw    output     = Ops::set1(scale.output);
+    raw    zero       = Ops::set1(0);
+    raw    length     = Ops::set1(static_cast<T>(w));
+    size_t m          = steps - w + 1;
+    size_t period     = rollingPeriod(w, 1);
+    for (size_t begin = 0; begin < m; begin += period) {
+        std::fill(state.begin(), state.end(), T(0));
+        for (size_t t = begin; t < begin + w; t++) {
+            rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+                Ops::storeu(sums + i, Ops::add(Ops::loadu(sums + i), rollingLoad<Ops>(x + t * stride + i, lanes)));
+            });
+        }
+        rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+            raw total  = Ops::loadu(sums + i);
+            raw origin = Ops::mul(total, reciprocal);
+            raw sum    = Ops::sub(total, Ops::mul(origin, length));
+            Ops::storeu(origins + i, origin);
+            Ops::storeu(sums + i, sum);
+            Ops::storeu(means + i, Ops::mul(sum, reciprocal));
+            if constexpr (M != RollingMoment::Variance) {
+                raw base = M == RollingMoment::Mean ? origin : Ops::mul(origin, length);
+                rollingStore<Ops>(dst + begin * stride + i, Ops::add(Ops::mul(sum, output), base), lanes);
+            }
+        });
+        if constexpr (M == RollingMoment::Variance) {
+            for (size_t t = begin; t < begin + w; t++) {
+                rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+                    raw d = Ops::sub(rollingLoad<Ops>(x + t * stride + i, lanes), Ops::add(Ops::loadu(origins + i), Ops::loadu(means + i)));
+                    Ops::storeu(m2s + i, Ops::add(Ops::loadu(m2s + i), Ops::mul(d, d)));
+                });
+            }
+            rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+                rollingStore<Ops>(dst + begin * stride + i, Ops::mul(Ops::loadu(m2s + i), output), lanes);
+            });
+        }
+
+        for (size_t j = begin + 1; j < std::min(m, begin + period); j++) {
+            rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+                raw xin    = rollingLoad<Ops>(x + (j + w - 1) * stride + i, lanes);
+                raw xout   = rollingLoad<Ops>(x + (j - 1) * stride + i, lanes);
+                raw origin = Ops::loadu(origins + i);
+                raw d      = Ops::sub(xin, xout);
+                raw sum    = Ops::add(Ops::loadu(sums + i), d);
+                Ops::storeu(sums + i, sum);
+                if constexpr (M == RollingMoment::Variance) {
+                    raw mu  = Ops::mul(sum, reciprocal);
+                    raw dev = Ops::add(Ops::sub(xin, origin), Ops::sub(xout, origin));
+                    raw m2  = Ops::add(Ops::loadu(m2s + i), Ops::mul(d, Ops::sub(dev, Ops::add(mu, Ops::loadu(means + i)))));
+                    Ops::storeu(means + i, mu);
+                    Ops::storeu(m2s + i, m2);
+                    rollingStore<Ops>(dst + j * stride + i, Ops::mul(Ops::max(m2, zero), output), lanes);
+                } else {
+                    raw base = M == RollingMoment::Mean ? origin : Ops::mul(origin, length);
+                    rollingStore<Ops>(dst + j * stride + i, Ops::add(Ops::mul(sum, output), base), lanes);
+                }
+            });
+        }
+    }
+}
+
+/**
+ * van Herk/Gil-Werman on up to a panel of interleaved series. Rows are
+ * cut into blocks of w; a backward pass stores the suffix extreme of
+ * every block into dst and a forward pass folds in the prefix extreme of
+ * the next block, so output j = extreme(suffix(j), prefix(j + w - 1)).
+ */
+template <class T, bool MAX>
+static inline void extremePanel(const T *x, size_t steps, size_t stride, size_t count, size_t w, T *dst)
+{
+    using Ops          = RollingLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    std::vector<T> run((count + L - 1) / L * L);
+    auto           fold = [&](size_t t, bool restart) {
+        rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+            auto v = rollingLoad<Ops>(x + t * stride + i, lanes);
+            Ops::storeu(run.data() + i, restart ? v : extreme<MAX, Ops>(v, Ops::loadu(run.data() + i)));
+        });
+    };
+
+    size_t m = steps - w + 1;
+    std::fill(run.begin(), run.end(), extremeIdentity<MAX, T>());
+    for (size_t j = std::min(steps, (m - 1) / w * w + w); j-- > 0;) {
+        fold(j, (j + 1) % w == 0);
+        if (j < m) {
+            rollingLanes<Ops>(count, [&](size_t i, size_t lanes) { rollingStore<Ops>(dst + j * stride + i, Ops::loadu(run.data() + i), lanes); });
+        }
+    }
+
+    for (size_t t = 0; t < steps; t++) {
+        fold(t, t % w == 0);
+        if (t + 1 >= w) {
+            rollingLanes<Ops>(count, [&](size_t i, size_t lanes) {
+                T *out = dst + (t + 1 - w) * stride + i;
+                rollingStore<Ops>(out, extreme<MAX, Ops>(rollingLoad<Ops>(out, lanes), Ops::loadu(run.data() + i)), lanes);
+            });
+        }
+    }
+}
+
+/* Panels of interleaved series spread over threads */
+template <class T, class F>
+static inline size_t rollingPanels(size_t steps, size_t series, size_t w, unsigned threads, F &&panel) noexcept
+{
+    if (w == 0 || steps < w || series == 0) {
+        return 0;
+    }
+
+    constexpr size_t PANEL  = ROLLING_PANEL_BYTES / sizeof(T);
+    size_t           panels = (series + PANEL - 1) / PANEL;
+    size_t           per    = std::max<size_t>(1, ROLLING_MIN_CHUNK / (PANEL * steps));
+    size_t           tasks  = std::max<size_t>(1, std::min<size_t>(resolveThreads(threads), (panels + per - 1) / per));
+    size_t           chunk  = (panels + tasks - 1) / tasks;
+    parallelFor(tasks, threads, [&](size_t task) {
+        for (size_t p = task * chunk; p < std::min(panels, (task + 1) * chunk); p++) {
+            panel(p * PANEL, std::min(PANEL, series - p * PANEL));
+        }
+    });
+    return steps - w + 1;
+}
+
+template <class T, RollingMoment M>
+static inline size_t rollingInterleaved(const T *x, size_t steps, size_t series, size_t w, T *dst, size_t ddof, unsigned threads) noexcept
+{
+    RollingScale<T> scale(M, w, ddof);
+    return rollingPanels<T>(steps, series, w, threads, [&](size_t first, size_t count) {
+        rollingPanel<T, M>(x + first, steps, series, count, w, dst + first, scale);
+    });
+}
+
+template <class T, bool MAX>
+static inline size_t extremeInterleaved(const T *x, size_t steps, size_t series, size_t w, T *dst, unsigned threads) noexcept
+{
+    return rollingPanels<T>(steps, series, w, threads, [&](size_t first, size_t count) {
+        extremePanel<T, MAX>(x + first, steps, series, count, w, dst + first);
+    });
+}
+
+/**
+ * van Herk/Gil-Werman along one series. The block prefix and suffix
+ * extremes come from segmented in-register scans: a lane only takes the
+ * lane k below (or above) it when its position in the block is at least
+ * k (or at most w - 1 - k), and the carry from the previous register
+ * only where the block continues across the register edge.
+ */
+template <class T, bool MAX>
+static inline size_t extremeSeries(const T *x, size_t n, size_t w, T *dst) noexcept
+{
+    using Ops          = RollingLanes<T>;
+    using raw          = typename Ops::raw;
+    constexpr size_t L = Ops::lanes;
+
+    if (w == 0 || n < w) {
+        return 0;
+    }
+
+    size_t m = n - w + 1;
+    size_t j = 0;
+    if (w < ROLLING_DIRECT) {
+        for (; j + L <= m; j += L) {
+            raw v = Ops::loadu(x + j);
+            for (size_t k = 1; k < w; k++) {
+                v = extreme<MAX, Ops>(v, Ops::loadu(x + j + k));
+            }
+            Ops::storeu(dst + j, v);
+        }
+        for (; j < m; j++) {
+            dst[j] = extremeReduce<MAX, Ops>(x + j, w);
+        }
+        return m;
+    }
+
+    auto iota = Ops::iota();
+    auto span = Ops::positions(w);
+    auto step = Ops::positions(L);
+
+    /* Suffix extremes of the outputs, backwards from the block holding the last one */
+    T    tail  = extremeReduce<MAX, Ops>(x + m, std::min(n, (m - 1) / w * w + w) - m);
+    raw  carry = Ops::set1(tail);
+    auto below = Ops::advance(Ops::positions(w - L), iota);
+    j          = m;
+    if (j >= L) {
+        auto pos = Ops::wrap(Ops::advance(Ops::positions((m - L) % w), iota), span);
+        for (; j >= L; j -= L) {
+            raw v = Ops::loadu(x + j - L);
+            v     = Ops::select(Ops::greater(Ops::positions(w - 1), pos), extreme<MAX, Ops>(v, Ops::template down<1>(v)), v);
+            v     = Ops::select(Ops::greater(Ops::positions(w - 2), pos), extreme<MAX, Ops>(v, Ops::template down<2>(v)), v);
+            if constexpr (L > 4) {
+                v = Ops::select(Ops::greater(Ops::positions(w - 4), pos), extreme<MAX, Ops>(v, Ops::template down<4>(v)), v);
+            }
+            v = Ops::select(Ops::greater(below, pos), extreme<MAX, Ops>(v, carry), v);
+            Ops::storeu(dst + j - L, v);
+            carry = Ops::front(v);
+            pos   = Ops::unwrap(Ops::retreat(pos, step), span);
+        }
+    }
+    for (T s = j < m ? dst[j] : tail; j-- > 0;) {
+        s      = (j + 1) % w == 0 ? x[j] : extremeOf<MAX>(x[j], s);
+        dst[j] = s;
+    }
+
+    /* Prefix extremes from w - 1 on, folded into output p - w + 1 */
+    auto pos = Ops::wrap(Ops::advance(Ops::positions(w - 1), iota), span);
+    carry    = Ops::set1(extremeReduce<MAX, Ops>(x, w - 1));
+    size_t p = w - 1;
+    for (; p + L <= n; p += L) {
+        raw v = Ops::loadu(x + p);
+        v     = Ops::select(Ops::greater(pos, Ops::positions(0)), extreme<MAX, Ops>(v, Ops::template up<1>(v)), v);
+        v     = Ops::select(Ops::greater(pos, Ops::positions(1)), extreme<MAX, Ops>(v, Ops::template up<2>(v)), v);
+        if constexpr (L > 4) {
+            v = Ops::select(Ops::greater(pos, Ops::positions(3)), extreme<MAX, Ops>(v, Ops::template up<4>(v)), v);
+        }
+        v = Ops::select(Ops::greater(pos, iota), extreme<MAX, Ops>(v, carry), v);
+        Ops::storeu(dst + p - w + 1, extreme<MAX, Ops>(Ops::loadu(dst + p - w + 1), v));
+        carry = Ops::last(v);
+        pos   = Ops::wrap(Ops::advance(pos, step), span);
+    }
+    for (T s = Ops::first(carry); p < n; p++) {
+        s              = p % w == 0 ? x[p] : extremeOf<MAX>(s, x[p]);
+        dst[p - w + 1] = extremeOf<MAX>(dst[p - w + 1], s);
+    }
+    return m;
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief dst[j] = src[j] + ... + src[j + window - 1]; returns the number of outputs, n - window + 1
+ *
+ * Returns 0 when the series is shorter than the window. threads = 0 uses
+ * every hardware thread.
+ */
+static inline size_t rollingSum(const float *src, size_t n, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<float, slimm::detail::RollingMoment::Sum>(src, n, window, dst, 0, threads);
+}
+
+static inline size_t rollingSum(const double *src, size_t n, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<double, slimm::detail::RollingMoment::Sum>(src, n, window, dst, 0, threads);
+}
+
+/**
+ * @brief Sums over the windows of `series` interleaved series; sample t of series s is src[t * series + s]
+ *
+ * dst is interleaved the same way, one row per window; returns the number
+ * of rows, steps - window + 1.
+ */
+static inline size_t rollingSum(const float *src, size_t steps, size_t series, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<float, slimm::detail::RollingMoment::Sum>(src, steps, series, window, dst, 0, threads);
+}
+
+static inline size_t rollingSum(const double *src, size_t steps, size_t series, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<double, slimm::detail::RollingMoment::Sum>(src, steps, series, window, dst, 0, threads);
+}
+
+/**
+ * @brief Window means; returns the number of outputs, n - window + 1
+ */
+static inline size_t rollingMean(const float *src, size_t n, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<float, slimm::detail::RollingMoment::Mean>(src, n, window, dst, 0, threads);
+}
+
+static inline size_t rollingMean(const double *src, size_t n, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<double, slimm::detail::RollingMoment::Mean>(src, n, window, dst, 0, threads);
+}
+
+static inline size_t rollingMean(const float *src, size_t steps, size_t series, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<float, slimm::detail::RollingMoment::Mean>(src, steps, series, window, dst, 0, threads);
+}
+
+static inline size_t rollingMean(const double *src, size_t steps, size_t series, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<double, slimm::detail::RollingMoment::Mean>(src, steps, series, window, dst, 0, threads);
+}
+
+/**
+ * @brief Window variances with window - ddof degrees of freedom; returns the number of outputs, n - window + 1
+ *
+ * ddof = 1 gives the sample variance and ddof = 0 the population
+ * variance; windows no longer than ddof give NaN.
+ */
+static inline size_t rollingVariance(const float *src, size_t n, size_t window, float *dst, size_t ddof = 1, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<float, slimm::detail::RollingMoment::Variance>(src, n, window, dst, ddof, threads);
+}
+
+static inline size_t rollingVariance(const double *src, size_t n, size_t window, double *dst, size_t ddof = 1, unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingSeries<double, slimm::detail::RollingMoment::Variance>(src, n, window, dst, ddof, threads);
+}
+
+static inline size_t rollingVariance(const float *src, size_t steps, size_t series, size_t window, float *dst, size_t ddof = 1,
+                                     unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<float, slimm::detail::RollingMoment::Variance>(src, steps, series, window, dst, ddof, threads);
+}
+
+static inline size_t rollingVariance(const double *src, size_t steps, size_t series, size_t window, double *dst, size_t ddof = 1,
+                                     unsigned threads = 1) noexcept
+{
+    return slimm::detail::rollingInterleaved<double, slimm::detail::RollingMoment::Variance>(src, steps, series, window, dst, ddof, threads);
+}
+
+/**
+ * @brief Window minima; returns the number of outputs, n - window + 1
+ */
+static inline size_t rollingMin(const float *src, size_t n, size_t window, float *dst) noexcept
+{
+    return slimm::detail::extremeSeries<float, false>(src, n, window, dst);
+}
+
+static inline size_t rollingMin(const double *src, size_t n, size_t window, double *dst) noexcept
+{
+    return slimm::detail::extremeSeries<double, false>(src, n, window, dst);
+}
+
+static inline size_t rollingMin(const float *src, size_t steps, size_t series, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::extremeInterleaved<float, false>(src, steps, series, window, dst, threads);
+}
+
+static inline size_t rollingMin(const double *src, size_t steps, size_t series, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::extremeInterleaved<double, false>(src, steps, series, window, dst, threads);
+}
+
+/**
+ * @brief Window maxima; returns the number of outputs, n - window + 1
+ */
+static inline size_t rollingMax(const float *src, size_t n, size_t window, float *dst) noexcept
+{
+    return slimm::detail::extremeSeries<float, true>(src, n, window, dst);
+}
+
+static inline size_t rollingMax(const double *src, size_t n, size_t window, double *dst) noexcept
+{
+    return slimm::detail::extremeSeries<double, true>(src, n, window, dst);
+}
+
+static inline size_t rollingMax(const float *src, size_t steps, size_t series, size_t window, float *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::extremeInterleaved<float, true>(src, steps, series, window, dst, threads);
+}
+
+static inline size_t rollingMax(const double *src, size_t steps, size_t series, size_t window, double *dst, unsigned threads = 1) noexcept
+{
+    return slimm::detail::extremeInterleaved<double, true>(src, steps, series, window, dst, threads);
+}
+
+/**
+ * Streaming window statistics over `series` series at once: push() adds
+ * one sample to every series and the queries report on the last `window`
+ * samples, or on all of them while fewer have arrived. A push costs O(1)
+ * per series; once per window it also rebuilds the block suffix extremes
+ * and resyncs the sums from the buffered samples, O(window) per series,
+ * so the cost per sample stays constant but that push takes longer.
+ */
+template <class T>
+class RollingWindow
+{
+public:
+    RollingWindow(size_t series, size_t window)
+        : seriesCount(series), span(std::max<size_t>(window, 1)), width((series + Ops::lanes - 1) / Ops::lanes * Ops::lanes),
+          samples(span * width), suffixMin(span * width), suffixMax(span * width), origins(width), sums(width), m2s(width), prefixMin(width),
+          prefixMax(width)
+    {
+    }
+
+    size_t series() const noexcept { return seriesCount; }
+    size_t window() const noexcept { return span; }
+    size_t size() const noexcept { return std::min(count, span); }
+
+    /**
+     * @brief Adds sample row[s] to series s
+     */
+    void push(const T *row) noexcept
+    {
+        using raw = typename Ops::raw;
+
+        size_t slot = count % span;
+        if (slot == 0 && count != 0) {
+            rebuild();
+        }
+
+        size_t k          = size();
+        bool   full       = count >= span;
+        raw    reciprocal = Ops::set1(T(1) / static_cast<T>(full ? span : k + 1));
+        raw    previous   = Ops::set1(k == 0 ? T(0) : T(1) / static_cast<T>(k));
+        T     *ring       = samples.data() + slot * width;
+        for (size_t i = 0; i < width; i += Ops::lanes) {
+            raw x = slimm::detail::rollingLoad<Ops>(row + i, std::min(Ops::lanes, seriesCount - i));
+            if (count == 0) {
+                Ops::storeu(origins.data() + i, x);
+            }
+            raw origin = Ops::loadu(origins.data() + i);
+            raw in     = Ops::sub(x, origin);
+            raw out    = full ? Ops::sub(Ops::loadu(ring + i), origin) : Ops::set1(0);
+            raw sum    = Ops::loadu(sums.data() + i);
+            raw mean   = Ops::mul(sum, full ? reciprocal : previous);
+            sum        = Ops::add(sum, Ops::sub(in, out));
+            raw mu     = Ops::mul(sum, reciprocal);
+            raw m2     = full ? Ops::mul(Ops::sub(in, out), Ops::sub(Ops::add(in, out), Ops::add(mu, mean)))
+                              : Ops::mul(Ops::sub(in, mean), Ops::sub(in, mu));
+            Ops::storeu(m2s.data() + i, Ops::add(Ops::loadu(m2s.data() + i), m2));
+            Ops::storeu(sums.data() + i, sum);
+            Ops::storeu(ring + i, x);
+            Ops::storeu(prefixMin.data() + i, slot == 0 ? x : Ops::min(Ops::loadu(prefixMin.data() + i), x));
+            Ops::storeu(prefixMax.data() + i, slot == 0 ? x : Ops::max(Ops::loadu(prefixMax.data() + i), x));
+        }
+        count++;
+    }
+
+    /**
+     * @brief Adds one sample to a single series
+     */
+    void push(T sample) noexcept { push(&sample); }
+
+    /**
+     * @brief out[s] is the sum over the window of series s
+     */
+    void sum(T *out) const noexcept
+    {
+        auto length = Ops::set1(static_cast<T>(size()));
+        report(out, [&](size_t i) { return Ops::add(Ops::loadu(sums.data() + i), Ops::mul(Ops::loadu(origins.data() + i), length)); });
+    }
+
+    void mean(T *out) const noexcept
+    {
+        auto reciprocal = Ops::set1(T(1) / static_cast<T>(size()));
+        report(out, [&](size_t i) { return Ops::add(Ops::mul(Ops::loadu(sums.data() + i), reciprocal), Ops::loadu(origins.data() + i)); });
+    }
+
+    /**
+     * @brief Variances with size() - ddof degrees of freedom, NaN while size() <= ddof
+     */
+    void variance(T *out, size_t ddof = 1) const noexcept
+    {
+        auto scale = Ops::set1(size() > ddof ? T(1) / static_cast<T>(size() - ddof) : std::numeric_limits<T>::quiet_NaN());
+        auto zero  = Ops::set1(0);
+        report(out, [&](size_t i) { return Ops::mul(Ops::max(Ops::loadu(m2s.data() + i), zero), scale); });
+    }
+
+    void minimum(T *out) const noexcept { extreme(out, suffixMin, prefixMin, [](auto a, auto b) { return Ops::min(a, b); }); }
+    void maximum(T *out) const noexcept { extreme(out, suffixMax, prefixMax, [](auto a, auto b) { return Ops::max(a, b); }); }
+
+private:
+    using Ops = slimm::detail::RollingLanes<T>;
+
+    /* Runs when a block of span samples completes: suffix extremes of the block, and the origin, sums and m2 afresh */
+    void rebuild() noexcept
+    {
+        using raw = typename Ops::raw;
+
+        raw reciprocal = Ops::set1(T(1) / static_cast<T>(span));
+        for (size_t i = 0; i < width; i += Ops::lanes) {
+            raw lo  = Ops::loadu(samples.data() + (span - 1) * width + i);
+            raw hi  = lo;
+            raw sum = Ops::set1(0);
+            for (size_t t = span; t-- > 0;) {
+                raw x = Ops::loadu(samples.data() + t * width + i);
+                lo    = Ops::min(x, lo);
+                hi    = Ops::max(x, hi);
+                sum   = Ops::add(sum, x);
+                Ops::storeu(suffixMin.data() + t * width + i, lo);
+                Ops::storeu(suffixMax.data() + t * width + i, hi);
+            }
+            raw origin = Ops::mul(sum, reciprocal);
+            raw m2     = Ops::set1(0);
+            sum        = Ops::sub(sum, Ops::mul(origin, Ops::set1(static_cast<T>(span))));
+            raw center = Ops::add(origin, Ops::mul(sum, reciprocal));
+            for (size_t t = 0; t < span; t++) {
+                raw d = Ops::sub(Ops::loadu(samples.data() + t * width + i), center);
+                m2    = Ops::add(m2, Ops::mul(d, d));
+            }
+            Ops::storeu(origins.data() + i, origin);
+            Ops::storeu(sums.data() + i, sum);
+            Ops::storeu(m2s.data() + i, m2);
+        }
+    }
+
+    template <class F>
+    void report(T *out, F &&value) const noexcept
+    {
+        for (size_t i = 0; i < seriesCount; i += Ops::lanes) {
+            auto v = count == 0 ? Ops::set1(std::numeric_limits<T>::quiet_NaN()) : value(i);
+            slimm::detail::rollingStore<Ops>(out + i, v, std::min(Ops::lanes, seriesCount - i));
+        }
+    }
+
+    /* The window is the tail of the previous block after the last slot written, then the current block so far */
+    template <class F>
+    void extreme(T *out, const std::vector<T> &suffix, const std::vector<T> &prefix, F &&pick) const noexcept
+    {
+        size_t last = (count + span - 1) % span;
+        bool   wrap = count > span && last + 1 < span;
+        report(out, [&](size_t i) {
+            auto v = Ops::loadu(prefix.data() + i);
+            return wrap ? pick(Ops::loadu(suffix.data() + (last + 1) * width + i), v) : v;
+        });
+    }
+
+    size_t         seriesCount;
+    size_t         span;
+    size_t         width;
+    size_t         count = 0;
+    std::vector<T> samples;
+    std::vector<T> suffixMin;
+    std::vector<T> suffixMax;
+    std::vector<T> origins; /* sums are kept relative to origin, the first sample or the mean at the last rebuild */
+    std::vector<T> sums;
+    std::vector<T> m2s;
+    std::vector<T> prefixMin;
+    std::vector<T> prefixMax;
+};
@@ -0,0 +1,481 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+
+namespace slimm::detail
+{
+
+/**
+ * Lane operations of the prefix-sum kernels. `scan` is the in-register
+ * inclusive scan built from log2(lanes) shift-and-add steps, `shift1` moves
+ * every lane up by one with zero shifted in, and `last` broadcasts the
+ * highest lane.
+ */
+template <class V>
+struct ScanLanes;
+
+template <>
+struct ScanLanes<INT32X8>
+{
+    using scalar = int32_t;
+    using raw    = __m256i;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi32(x); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_epi32(a, b); }
+    static scalar first(raw v) noexcept { return _mm256_cvtsi256_si32(v); }
+    static raw last(raw v) noexcept { return _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7)); }
+
+    static raw shift1(raw v) noexcept
+    {
+        raw up = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        return _mm256_blend_epi32(up, _mm256_setzero_si256(), 0x01);
+    }
+
+    static raw scan(raw v) noexcept
+    {
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+        v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+        raw low = _mm256_shuffle_epi32(v, 0xFF);
+        return _mm256_add_epi32(v, _mm256_permute2x128_si256(low, low, 0x08));
+    }
+};
+
+template <>
+struct ScanLanes<FLOATX8>
+{
+    using scalar = float;
+    using raw    = __m256;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_ps(p); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_ps(p, v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_ps(x); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_ps(a, b); }
+    static scalar first(raw v) noexcept { return _mm256_cvtss_f32(v); }
+    static raw last(raw v) noexcept { return _mm256_permutevar8x32_ps(v, _mm256_set1_epi32(7)); }
+
+    static raw shift1(raw v) noexcept
+    {
+        raw up = _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        return _mm256_blend_ps(up, _mm256_setzero_ps(), 0x01);
+    }
+
+    static raw scan(raw v) noexcept
+    {
+        v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 4)));
+        v = _mm256_add_ps(v, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(v), 8)));
+        raw low = _mm256_shuffle_ps(v, v, 0xFF);
+        return _mm256_add_ps(v, _mm256_permute2f128_ps(low, low, 0x08));
+    }
+};
+
+template <>
+struct ScanLanes<DOUBLEX4>
+{
+    using scalar = double;
+    using raw    = __m256d;
+
+    static constexpr size_t lanes = 4;
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_pd(p); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_pd(p, v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_pd(x); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_pd(a, b); }
+    static scalar first(raw v) noexcept { return _mm256_cvtsd_f64(v); }
+    static raw last(raw v) noexcept { return _mm256_permute4x64_pd(v, 0xFF); }
+
+    static raw shift1(raw v) noexcept
+    {
+        return _mm256_blend_pd(_mm256_permute4x64_pd(v, 0x90), _mm256_setzero_pd(), 0x01);
+    }
+
+    static raw scan(raw v) noexcept
+    {
+        v = _mm256_add_pd(v, _mm256_castsi256_pd(_mm256_slli_si256(_mm256_castpd_si256(v), 8)));
+        return _mm256_add_pd(v, _mm256_blend_pd(_mm256_setzero_pd(), _mm256_permute4x64_pd(v, 0x55), 0x0C));
+    }
+};
+
+template <>
+struct ScanLanes<INT32X16>
+{
+    using scalar = int32_t;
+    using raw    = __m512i;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static void storeu(scalar *p, raw v) noexcept { _mm512_storeu_si512(p, v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi32(x); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_epi32(a, b); }
+    static scalar first(raw v) noexcept { return _mm512_cvtsi512_si32(v); }
+    static raw last(raw v) noexcept { return _mm512_permutexvar_epi32(_mm512_set1_epi32(15), v); }
+    static raw shift1(raw v) noexcept { return _mm512_alignr_epi32(v, _mm512_setzero_si512(), 15); }
+
+    static raw scan(raw v) noexcept
+    {
+        raw zero = _mm512_setzero_si512();
+        v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 15));
+        v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 14));
+        v = _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 12));
+        return _mm512_add_epi32(v, _mm512_alignr_epi32(v, zero, 8));
+    }
+};
+
+template <>
+struct ScanLanes<FLOATX16>
+{
+    using scalar = float;
+    using raw    = __m512;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_ps(p); }
+    static void storeu(scalar *p, raw v) noexcept { _mm512_storeu_ps(p, v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_ps(x); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_ps(a, b); }
+    static scalar first(raw v) noexcept { return _mm512_cvtss_f32(v); }
+    static raw last(raw v) noexcept { return _mm512_permutexvar_ps(_mm512_set1_epi32(15), v); }
+    static raw shift1(raw v) noexcept { return up<1>(v); }
+
+    template <int n>
+    static raw up(raw v) noexcept
+    {
+        return _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(v), _mm512_setzero_si512(), 16 - n));
+    }
+
+    static raw scan(raw v) noexcept
+    {
+        v = _mm512_add_ps(v, up<1>(v));
+        v = _mm512_add_ps(v, up<2>(v));
+        v = _mm512_add_ps(v, up<4>(v));
+        return _mm512_add_ps(v, up<8>(v));
+    }
+};
+
+template <>
+struct ScanLanes<DOUBLEX8>
+{
+    using scalar = double;
+    using raw    = __m512d;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_pd(p); }
+    static void storeu(scalar *p, raw v) noexcept { _mm512_storeu_pd(p, v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_pd(x); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_pd(a, b); }
+    static scalar first(raw v) noexcept { return _mm512_cvtsd_f64(v); }
+    static raw last(raw v) noexcept { return _mm512_permutexvar_pd(_mm512_set1_epi64(7), v); }
+    static raw shift1(raw v) noexcept { return up<1>(v); }
+
+    template <int n>
+    static raw up(raw v) noexcept
+    {
+        return _mm512_castsi512_pd(_mm512_alignr_epi64(_mm512_castpd_si512(v), _mm512_setzero_si512(), 8 - n));
+    }
+
+    static raw scan(raw v) noexcept
+    {
+        v = _mm512_add_pd(v, up<1>(v));
+        v = _mm512_add_pd(v, up<2>(v));
+        return _mm512_add_pd(v, up<4>(v));
+    }
+};
+
+/**
+ * Scans four registers independently and only then chains their totals,
+ * so the loop-carried dependency is one add per register instead of a
+ * full scan plus broadcast. Returns init plus the sum of all n inputs.
+ */
+template <class Ops, bool EXCLUSIVE>
+static inline typename Ops::scalar scan(const typename Ops::scalar *src, typename Ops::scalar *dst, size_t n, typename Ops::scalar init) noexcept
+{
+    constexpr size_t L = Ops::lanes;
+
+    auto   carry = Ops::set1(init);
+    size_t i     = 0;
+    for (; i + 4 * L <= n; i += 4 * L) {
+        auto s0 = Ops::scan(Ops::loadu(src + i));
+        auto s1 = Ops::scan(Ops::loadu(src + i + L));
+        auto s2 = Ops::scan(Ops::loadu(src + i + 2 * L));
+        auto s3 = Ops::scan(Ops::loadu(src + i + 3 * L));
+
+        auto c1 = Ops::add(carry, Ops::last(s0));
+        auto c2 = Ops::add(c1, Ops::last(s1));
+        auto c3 = Ops::add(c2, Ops::last(s2));
+        if constexpr (EXCLUSIVE) {
+            Ops::storeu(dst + i, Ops::add(carry, Ops::shift1(s0)));
+            Ops::storeu(dst + i + L, Ops::add(c1, Ops::shift1(s1)));
+            Ops::storeu(dst + i + 2 * L, Ops::add(c2, Ops::shift1(s2)));
+            Ops::storeu(dst + i + 3 * L, Ops::add(c3, Ops::shift1(s3)));
+        } else {
+            Ops::storeu(dst + i, Ops::add(carry, s0));
+            Ops::storeu(dst + i + L, Ops::add(c1, s1));
+            Ops::storeu(dst + i + 2 * L, Ops::add(c2, s2));
+            Ops::storeu(dst + i + 3 * L, Ops::add(c3, s3));
+        }
+        carry = Ops::add(c3, Ops::last(s3));
+    }
+    for (; i + L <= n; i += L) {
+        auto s = Ops::scan(Ops::loadu(src + i));
+        Ops::storeu(dst + i, Ops::add(carry, EXCLUSIVE ? Ops::shift1(s) : s));
+        carry = Ops::add(carry, Ops::last(s));
+    }
+
+    auto sum = Ops::first(carry);
+    for (; i < n; i++) {
+        auto x = src[i];
+        if constexpr (EXCLUSIVE) {
+            dst[i] = sum;
+            sum   += x;
+        } else {
+            sum   += x;
+            dst[i] = sum;
+        }
+    }
+    return sum;
+}
+
+template <class Ops>
+static inline typename Ops::scalar reduce(const typename Ops::scalar *src, size_t n) noexcept
+{
+    constexpr size_t L = Ops::lanes;
+
+    auto   a0 = Ops::set1(0), a1 = Ops::set1(0), a2 = Ops::set1(0), a3 = Ops::set1(0);
+    size_t i  = 0;
+    for (; i + 4 * L <= n; i += 4 * L) {
+        a0 = Ops::add(a0, Ops::loadu(src + i));
+        a1 = Ops::add(a1, Ops::loadu(src + i + L));
+        a2 = Ops::add(a2, Ops::loadu(src + i + 2 * L));
+        a3 = Ops::add(a3, Ops::loadu(src + i + 3 * L));
+    }
+    for (; i + L <= n; i += L) {
+        a0 = Ops::add(a0, Ops::loadu(src + i));
+    }
+
+    auto sum = Ops::first(Ops::last(Ops::scan(Ops::add(Ops::add(a0, a1), Ops::add(a2, a3)))));
+    for (; i < n; i++) {
+        sum += src[i];
+    }
+    return sum;
+}
+
+/* Below this many elements per thread the serial scan wins over a second pass */
+static constexpr size_t SCAN_MIN_BLOCK = 1 << 16;
+
+/**
+ * Two-pass block scan: every block is reduced in parallel, the block sums
+ * are scanned serially, then every block is scanned from its own offset.
+ */
+template <class Ops, bool EXCLUSIVE>
+static inline typename Ops::scalar parallelScan(const typename Ops::scalar *src, typename Ops::scalar *dst, size_t n,
+                                                typename Ops::scalar init, unsigned threads)
+{
+    using scalar = typename Ops::scalar;
+
+    threads = resolveThreads(threads);
+    if (threads == 1 || n < 2 * SCAN_MIN_BLOCK) {
+        return scan<Ops, EXCLUSIVE>(src, dst, n, init);
+    }
+
+    size_t blocks = std::min<size_t>(threads, n / SCAN_MIN_BLOCK);
+    size_t block  = (n / blocks + Ops::lanes - 1) / Ops::lanes * Ops::lanes;
+    blocks        = (n + block - 1) / block;
+
+    std::vector<scalar> offsets(blocks);
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t begin = b * block;
+        offsets[b] = reduce<Ops>(src + begin, std::min(block, n - begin));
+    });
+
+    scalar sum = init;
+    for (auto &offset : offsets) {
+        scalar total = offset;
+        offset = sum;
+        sum   += total;
+    }
+
+    parallelFor(blocks, threads, [&](size_t b) {
+        size_t begin = b * block;
+        scan<Ops, EXCLUSIVE>(src + begin, dst + begin, std::min(block, n - begin), offsets[b]);
+    });
+    return sum;
+}
+
+#if defined(__AVX512F__)
+using ScanInt32  = ScanLanes<INT32X16>;
+using ScanFloat  = ScanLanes<FLOATX16>;
+using ScanDouble = ScanLanes<DOUBLEX8>;
+#else
+using ScanInt32  = ScanLanes<INT32X8>;
+using ScanFloat  = ScanLanes<FLOATX8>;
+using ScanDouble = ScanLanes<DOUBLEX4>;
+#endif
+
+} // namespace slimm::detail
+
+/**
+ * @brief Lane i of the result holds the sum of lanes 0..i
+ */
+static inline INT32X8 inclusiveScan(const INT32X8 &v) noexcept
+{
+    return slimm::detail::ScanLanes<INT32X8>::scan(v.v);
+}
+
+static inline INT32X16 inclusiveScan(const INT32X16 &v) noexcept
+{
+    return slimm::detail::ScanLanes<INT32X16>::scan(v.v);
+}
+
+static inline FLOATX8 inclusiveScan(const FLOATX8 &v) noexcept
+{
+    return slimm::detail::ScanLanes<FLOATX8>::scan(v.v);
+}
+
+static inline FLOATX16 inclusiveScan(const FLOATX16 &v) noexcept
+{
+    return slimm::detail::ScanLanes<FLOATX16>::scan(v.v);
+}
+
+static inline DOUBLEX4 inclusiveScan(const DOUBLEX4 &v) noexcept
+{
+    return slimm::detail::ScanLanes<DOUBLEX4>::scan(v.v);
+}
+
+static inline DOUBLEX8 inclusiveScan(const DOUBLEX8 &v) noexcept
+{
+    return slimm::detail::ScanLanes<DOUBLEX8>::scan(v.v);
+}
+
+/**
+ * @brief Lane i of the result holds the sum of lanes 0..i-1, lane 0 is zero
+ */
+static inline INT32X8 exclusiveScan(const INT32X8 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<INT32X8>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+static inline INT32X16 exclusiveScan(const INT32X16 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<INT32X16>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+static inline FLOATX8 exclusiveScan(const FLOATX8 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<FLOATX8>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+static inline FLOATX16 exclusiveScan(const FLOATX16 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<FLOATX16>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+static inline DOUBLEX4 exclusiveScan(const DOUBLEX4 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<DOUBLEX4>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+static inline DOUBLEX8 exclusiveScan(const DOUBLEX8 &v) noexcept
+{
+    using Ops = slimm::detail::ScanLanes<DOUBLEX8>;
+    return Ops::shift1(Ops::scan(v.v));
+}
+
+/**
+ * @brief dst[i] = init + src[0] + ... + src[i]; returns init plus the sum of all n inputs
+ *
+ * src and dst may be the same array.
+ */
+static inline int32_t inclusiveScan(const int32_t *src, int32_t *dst, size_t n, int32_t init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanInt32, false>(src, dst, n, init);
+}
+
+static inline float inclusiveScan(const float *src, float *dst, size_t n, float init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanFloat, false>(src, dst, n, init);
+}
+
+static inline double inclusiveScan(const double *src, double *dst, size_t n, double init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanDouble, false>(src, dst, n, init);
+}
+
+/**
+ * @brief dst[i] = init + src[0] + ... + src[i-1]; returns init plus the sum of all n inputs
+ *
+ * src and dst may be the same array.
+ */
+static inline int32_t exclusiveScan(const int32_t *src, int32_t *dst, size_t n, int32_t init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanInt32, true>(src, dst, n, init);
+}
+
+static inline float exclusiveScan(const float *src, float *dst, size_t n, float init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanFloat, true>(src, dst, n, init);
+}
+
+static inline double exclusiveScan(const double *src, double *dst, size_t n, double init = 0) noexcept
+{
+    return slimm::detail::scan<slimm::detail::ScanDouble, true>(src, dst, n, init);
+}
+
+/**
+ * @brief Multithreaded inclusiveScan for large arrays; threads = 0 uses every hardware thread
+ *
+ * Floating-point results may differ from the serial scan in the last bits
+ * because block sums are added in a different order.
+ */
+static inline int32_t parallelInclusiveScan(const int32_t *src, int32_t *dst, size_t n, int32_t init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanInt32, false>(src, dst, n, init, threads);
+}
+
+static inline float parallelInclusiveScan(const float *src, float *dst, size_t n, float init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanFloat, false>(src, dst, n, init, threads);
+}
+
+static inline double parallelInclusiveScan(const double *src, double *dst, size_t n, double init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanDouble, false>(src, dst, n, init, threads);
+}
+
+/**
+ * @brief Multithreaded exclusiveScan for large arrays; threads = 0 uses every hardware thread
+ */
+static inline int32_t parallelExclusiveScan(const int32_t *src, int32_t *dst, size_t n, int32_t init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanInt32, true>(src, dst, n, init, threads);
+}
+
+static inline float parallelExclusiveScan(const float *src, float *dst, size_t n, float init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanFloat, true>(src, dst, n, init, threads);
+}
+
+static inline double parallelExclusiveScan(const double *src, double *dst, size_t n, double init = 0, unsigned threads = 0)
+{
+    return slimm::detail::parallelScan<slimm::detail::ScanDouble, true>(src, dst, n, init, threads);
+}
@@ -0,0 +1,389 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimfilter.h"
+
+namespace slimm::detail
+{
+
+/* Elements per pass of the index-tracking scans, so indices fit an int32 lane */
+static constexpr size_t SELECT_CHUNK = size_t(1) << 30;
+
+/* Independent (value, index) accumulators per scan step */
+static constexpr size_t SELECT_UNROLL = 4;
+
+/**
+ * Lane operations of the selection kernels. Every value register is paired
+ * with an int32 register holding the element index of each lane; better
+ * lanes are merged into both with the same blend.
+ */
+template <class V>
+struct SelectLanes;
+
+template <>
+struct SelectLanes<FLOATX16>
+{
+    using scalar = float;
+    using raw    = __m512;
+    using index  = __m512i;
+    using mask   = __mmask16;
+    using filter = FilterLanes<FLOATX16>;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_ps(p); }
+    static void storeu(scalar *p, raw a) noexcept { _mm512_storeu_ps(p, a); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_ps(x); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static raw blend(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_ps(m, a, b); }
+    static index blend(mask m, index a, index b) noexcept { return _mm512_mask_blend_epi32(m, a, b); }
+    static index iota(int32_t base) noexcept { return _mm512_add_epi32(_mm512_set1_epi32(base), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)); }
+    static index advance(index a, int32_t step) noexcept { return _mm512_add_epi32(a, _mm512_set1_epi32(step)); }
+    static void storeIndex(int32_t *p, index a) noexcept { _mm512_storeu_si512(p, a); }
+};
+
+template <>
+struct SelectLanes<INT32X16>
+{
+    using scalar = int32_t;
+    using raw    = __m512i;
+    using index  = __m512i;
+    using mask   = __mmask16;
+    using filter = FilterLanes<INT32X16>;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static void storeu(scalar *p, raw a) noexcept { _mm512_storeu_si512(p, a); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi32(x); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmplt_epi32_mask(a, b); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmpgt_epi32_mask(a, b); }
+    static raw blend(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_epi32(m, a, b); }
+    static index iota(int32_t base) noexcept { return _mm512_add_epi32(_mm512_set1_epi32(base), _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)); }
+    static index advance(index a, int32_t step) noexcept { return _mm512_add_epi32(a, _mm512_set1_epi32(step)); }
+    static void storeIndex(int32_t *p, index a) noexcept { _mm512_storeu_si512(p, a); }
+};
+
+template <>
+struct SelectLanes<FLOATX8>
+{
+    using scalar = float;
+    using raw    = __m256;
+    using index  = __m256i;
+    using mask   = __m256;
+    using filter = FilterLanes<FLOATX8>;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_ps(p); }
+    static void storeu(scalar *p, raw a) noexcept { _mm256_storeu_ps(p, a); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_ps(x); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static raw blend(mask m, raw a, raw b) noexcept { return _mm256_blendv_ps(a, b, m); }
+    static index blend(mask m, index a, index b) noexcept { return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), m)); }
+    static index iota(int32_t base) noexcept { return _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+    static index advance(index a, int32_t step) noexcept { return _mm256_add_epi32(a, _mm256_set1_epi32(step)); }
+    static void storeIndex(int32_t *p, index a) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+};
+
+template <>
+struct SelectLanes<INT32X8>
+{
+    using scalar = int32_t;
+    using raw    = __m256i;
+    using index  = __m256i;
+    using mask   = __m256i;
+    using filter = FilterLanes<INT32X8>;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static void storeu(scalar *p, raw a) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi32(x); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_cmpgt_epi32(b, a); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_cmpgt_epi32(a, b); }
+    static raw blend(mask m, raw a, raw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    static index iota(int32_t base) noexcept { return _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)); }
+    static index advance(index a, int32_t step) noexcept { return _mm256_add_epi32(a, _mm256_set1_epi32(step)); }
+    static void storeIndex(int32_t *p, index a) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a); }
+};
+
+#if defined(__AVX512F__)
+using SelectFloat = SelectLanes<FLOATX16>;
+using SelectInt32 = SelectLanes<INT32X16>;
+#else
+using SelectFloat = SelectLanes<FLOATX8>;
+using SelectInt32 = SelectLanes<INT32X8>;
+#endif
+
+/* a ranks strictly before b; false whenever a is NaN */
+template <bool MAX, class T>
+static inline bool ahead(T a, T b) noexcept
+{
+    return MAX ? a > b : a < b;
+}
+
+/*
+ * Index of the first best element of x[0, n) that ranks strictly before
+ * start, or n if there is none. Each lane keeps its own best with a strict
+ * compare, so it holds the lowest index of its value; the lanes are merged
+ * by value and then by index.
+ */
+template <class Ops, bool MAX>
+static inline size_t argBestChunk(const typename Ops::scalar *x, size_t n, typename Ops::scalar &start) noexcept
+{
+    using T = typename Ops::scalar;
+
+    constexpr size_t L = Ops::lanes;
+    constexpr size_t U = SELECT_UNROLL;
+
+    const auto better = [](auto a, auto b) { return MAX ? Ops::gt(a, b) : Ops::lt(a, b); };
+
+    typename Ops::raw   best[U];
+    typename Ops::index at[U];
+    typename Ops::index ids[U];
+    for (size_t u = 0; u < U; u++) {
+        best[u] = Ops::set1(start);
+        at[u]   = Ops::iota(0);
+        ids[u]  = Ops::iota(static_cast<int32_t>(u * L));
+    }
+
+    size_t i = 0;
+    for (; i + U * L <= n; i += U * L) {
+        for (size_t u = 0; u < U; u++) {
+            auto v  = Ops::loadu(x + i + u * L);
+            auto m  = better(v, best[u]);
+            best[u] = Ops::blend(m, best[u], v);
+            at[u]   = Ops::blend(m, at[u], ids[u]);
+            ids[u]  = Ops::advance(ids[u], static_cast<int32_t>(U * L));
+        }
+    }
+
+    alignas(64) T       values[U * L];
+    alignas(64) int32_t indices[U * L];
+    for (size_t u = 0; u < U; u++) {
+        Ops::storeu(values + u * L, best[u]);
+        Ops::storeIndex(indices + u * L, at[u]);
+    }
+
+    /* A lane still equal to start never took an element */
+    size_t found = n;
+    for (size_t j = 0; j < U * L; j++) {
+        if (ahead<MAX>(values[j], start) || (found != n && values[j] == start && static_cast<size_t>(indices[j]) < found)) {
+            start = values[j];
+            found = static_cast<size_t>(indices[j]);
+        }
+    }
+    for (; i < n; i++) {
+        if (ahead<MAX>(x[i], start)) {
+            start = x[i];
+            found = i;
+        }
+    }
+    return found;
+}
+
+template <class Ops, bool MAX>
+static inline size_t argBest(const typename Ops::scalar *x, size_t n) noexcept
+{
+    using T = typename Ops::scalar;
+    using N = std::numeric_limits<T>;
+
+    const T worst = N::has_infinity ? (MAX ? -N::infinity() : N::infinity()) : (MAX ? N::lowest() : N::max());
+
+    T      best  = worst;
+    size_t found = n;
+    for (size_t base = 0; base < n; base += SELECT_CHUNK) {
+        size_t m = std::min(SELECT_CHUNK, n - base);
+        size_t j = argBestChunk<Ops, MAX>(x + base, m, best);
+        if (j != m) {
+            found = base + j;
+        }
+    }
+
+    /* Nothing ranked before the identity: the answer is its first copy, NaNs aside */
+    if (found == n) {
+        for (size_t i = 0; i < n; i++) {
+            if (x[i] == worst) {
+                return i;
+            }
+        }
+    }
+    return found;
+}
+
+/* Ranks the larger (MAX) or smaller value first, and the lower index among equals */
+template <bool MAX>
+struct SelectOrder
+{
+    template <class T>
+    bool operator()(const std::pair<T, uint32_t> &a, const std::pair<T, uint32_t> &b) const noexcept
+    {
+        return a.first != b.first ? ahead<MAX>(a.first, b.first) : a.second < b.second;
+    }
+};
+
+/* Candidates buffered between two compactions of the kept elements back to k */
+static constexpr size_t SELECT_POOL = 256;
+
+/*
+ * The k best elements. Every register is compared against a broadcast of
+ * the worst element kept so far, and only the lanes ranking strictly
+ * before it are compressed into row ids and appended to a pool. Once the
+ * pool holds max(2k, SELECT_POOL) entries it is cut back to the best k
+ * with nth_element and the threshold tightens, so on most data nearly
+ * every register is rejected by a single compare, and input sorted in the
+ * wrong direction still costs O(n) rather than a heap update per element.
+ * Equal values arriving later have higher indices and rank after the
+ * threshold, so the strict compare is also the tie-break.
+ */
+template <class Ops, bool MAX>
+static inline size_t selectTop(const typename Ops::scalar *x, size_t n, size_t k, typename Ops::scalar *values, uint32_t *indices)
+{
+    using T     = typename Ops::scalar;
+    using F     = typename Ops::filter;
+    using Entry = std::pair<T, uint32_t>;
+
+    static_assert(F::lanes == FILTER_BLOCK, "one register per filter block");
+
+    const SelectOrder<MAX> order;
+    const size_t           capacity = std::max(2 * k, SELECT_POOL);
+
+    std::vector<Entry> pool;
+    pool.reserve(std::min(capacity, n) + 2 * FILTER_BLOCK);
+
+    size_t i = 0;
+    for (; i < n && pool.size() < k; i++) {
+        if (x[i] == x[i]) {
+            pool.emplace_back(x[i], static_cast<uint32_t>(i));
+        }
+    }
+
+    if (k != 0 && pool.size() == k) {
+        Entry worst = *std::max_element(pool.begin(), pool.end(), order);
+
+        const auto compact = [&]() {
+            std::nth_element(pool.begin(), pool.begin() + (k - 1), pool.end(), order);
+            pool.resize(k);
+            worst = pool.back();
+        };
+        const auto pass = [](typename F::raw v, typename F::raw threshold) { return MAX ? F::gt(v, threshold) : F::lt(v, threshold); };
+
+        uint32_t rows[FILTER_BLOCK];
+        auto     threshold = F::set1(worst.first);
+        for (; i + 2 * FILTER_BLOCK <= n; i += 2 * FILTER_BLOCK) {
+            unsigned m0 = pass(F::loadu(x + i), threshold);
+            unsigned m1 = pass(F::loadu(x + i + FILTER_BLOCK), threshold);
+            if ((m0 | m1) == 0) {
+                continue;
+            }
+            for (size_t j = 0, count = compressRows(rows, m0, i); j < count; j++) {
+                pool.emplace_back(x[rows[j]], rows[j]);
+            }
+            for (size_t j = 0, count = compressRows(rows, m1, i + FILTER_BLOCK); j < count; j++) {
+                pool.emplace_back(x[rows[j]], rows[j]);
+            }
+            if (pool.size() >= capacity) {
+                compact();
+                threshold = F::set1(worst.first);
+            }
+        }
+        for (; i < n; i++) {
+            Entry entry(x[i], static_cast<uint32_t>(i));
+            if (order(entry, worst)) {
+                pool.push_back(entry);
+            }
+        }
+        if (pool.size() > k) {
+            compact();
+        }
+    }
+
+    std::sort(pool.begin(), pool.end(), order);
+    for (size_t j = 0; j < pool.size(); j++) {
+        if (values != nullptr) {
+            values[j] = pool[j].first;
+        }
+        if (indices != nullptr) {
+            indices[j] = pool[j].second;
+        }
+    }
+    return pool.size();
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Index of the smallest element, the lowest one among ties
+ *
+ * Tracks a value and an index register per accumulator and merges the
+ * lanes at the end. NaNs are skipped; returns n if n is 0 or every
+ * element is NaN.
+ */
+static inline size_t argmin(const float *x, size_t n) noexcept
+{
+    return slimm::detail::argBest<slimm::detail::SelectFloat, false>(x, n);
+}
+
+static inline size_t argmin(const int32_t *x, size_t n) noexcept
+{
+    return slimm::detail::argBest<slimm::detail::SelectInt32, false>(x, n);
+}
+
+/**
+ * @brief Index of the largest element, the lowest one among ties
+ */
+static inline size_t argmax(const float *x, size_t n) noexcept
+{
+    return slimm::detail::argBest<slimm::detail::SelectFloat, true>(x, n);
+}
+
+static inline size_t argmax(const int32_t *x, size_t n) noexcept
+{
+    return slimm::detail::argBest<slimm::detail::SelectInt32, true>(x, n);
+}
+
+/**
+ * @brief The k largest of n elements, largest first, with their indices
+ *
+ * Equal values are ranked by lower index and NaNs are never selected.
+ * Either output may be null. Returns the number of results, which is
+ * less than k only when x holds fewer than k non-NaN elements. n must
+ * be below 2^32.
+ */
+static inline size_t topK(const float *x, size_t n, size_t k, float *values, uint32_t *indices)
+{
+    return slimm::detail::selectTop<slimm::detail::SelectFloat, true>(x, n, k, values, indices);
+}
+
+static inline size_t topK(const int32_t *x, size_t n, size_t k, int32_t *values, uint32_t *indices)
+{
+    return slimm::detail::selectTop<slimm::detail::SelectInt32, true>(x, n, k, values, indices);
+}
+
+/**
+ * @brief The k smallest of n elements, smallest first, with their indices
+ */
+static inline size_t bottomK(const float *x, size_t n, size_t k, float *values, uint32_t *indices)
+{
+    return slimm::detail::selectTop<slimm::detail::SelectFloat, false>(x, n, k, values, indices);
+}
+
+static inline size_t bottomK(const int32_t *x, size_t n, size_t k, int32_t *values, uint32_t *indices)
+{
+    return slimm::detail::selectTop<slimm::detail::SelectInt32, false>(x, n, k, values, indices);
+}
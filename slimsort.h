@@ -0,0 +1,1107 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+/* Key that loadN pads the tail with; it sorts after every other key but NaN */
+template <class T>
+static constexpr T sortPad() noexcept
+{
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+/**
+ * Lane operations used by the sorting networks and the partition step.
+ * Each specialization binds one key vector to the payload vector that is
+ * carried along in key-value mode. `compress` selects between the AVX-512
+ * compress-store partition and the AVX2 permutation-table partition.
+ */
+template <class V>
+struct SortLanes;
+
+template <>
+struct SortLanes<INT32X16>
+{
+    using vector  = INT32X16;
+    using values  = UINT32X16;
+    using scalar  = int32_t;
+    using payload = uint32_t;
+    using raw     = __m512i;
+    using praw    = __m512i;
+    using index   = __m512i;
+    using mask    = __mmask16;
+
+    static constexpr size_t lanes    = 16;
+    static constexpr bool   compress = true;
+
+    static raw loadN(const scalar *p, size_t n) noexcept { return _mm512_mask_loadu_epi32(set1(sortPad<scalar>()), prefix(n), p); }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm512_mask_storeu_epi32(p, prefix(n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm512_maskz_loadu_epi32(prefix(n), p); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm512_mask_storeu_epi32(p, prefix(n), v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi32(x); }
+    static raw min(raw a, raw b) noexcept { return _mm512_min_epi32(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm512_max_epi32(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm512_loadu_si512(i); }
+    static raw permute(raw v, index i) noexcept { return _mm512_permutexvar_epi32(i, v); }
+    static praw ppermute(praw v, index i) noexcept { return _mm512_permutexvar_epi32(i, v); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm512_mask_blend_epi32(M, a, b); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_epi32(m, a, b); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm512_mask_blend_epi32(m, a, b); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return static_cast<mask>((a & ~M) | (b & M)); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmplt_epi32_mask(a, b); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmpgt_epi32_mask(a, b); }
+    static mask ge(raw a, raw b) noexcept { return _mm512_cmpge_epi32_mask(a, b); }
+    static size_t count(mask m) noexcept { return static_cast<size_t>(_mm_popcnt_u32(m)); }
+    static void compressStoreu(scalar *p, mask m, raw v) noexcept { _mm512_mask_compressstoreu_epi32(p, m, v); }
+    static void pcompressStoreu(payload *p, mask m, praw v) noexcept { _mm512_mask_compressstoreu_epi32(p, m, v); }
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm512_loadu_si512(p); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1U << n) - 1); }
+};
+
+template <>
+struct SortLanes<FLOATX16>
+{
+    using vector  = FLOATX16;
+    using values  = UINT32X16;
+    using scalar  = float;
+    using payload = uint32_t;
+    using raw     = __m512;
+    using praw    = __m512i;
+    using index   = __m512i;
+    using mask    = __mmask16;
+
+    static constexpr size_t lanes    = 16;
+    static constexpr bool   compress = true;
+
+    static raw loadN(const scalar *p, size_t n) noexcept { return _mm512_mask_loadu_ps(set1(sortPad<scalar>()), prefix(n), p); }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm512_mask_storeu_ps(p, prefix(n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm512_maskz_loadu_epi32(prefix(n), p); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm512_mask_storeu_epi32(p, prefix(n), v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_ps(x); }
+    static raw min(raw a, raw b) noexcept { return _mm512_min_ps(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm512_max_ps(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm512_loadu_si512(i); }
+    static raw permute(raw v, index i) noexcept { return _mm512_permutexvar_ps(i, v); }
+    static praw ppermute(praw v, index i) noexcept { return _mm512_permutexvar_epi32(i, v); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm512_mask_blend_ps(M, a, b); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_ps(m, a, b); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm512_mask_blend_epi32(m, a, b); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return static_cast<mask>((a & ~M) | (b & M)); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static mask ge(raw a, raw b) noexcept { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static size_t count(mask m) noexcept { return static_cast<size_t>(_mm_popcnt_u32(m)); }
+    static void compressStoreu(scalar *p, mask m, raw v) noexcept { _mm512_mask_compressstoreu_ps(p, m, v); }
+    static void pcompressStoreu(payload *p, mask m, praw v) noexcept { _mm512_mask_compressstoreu_epi32(p, m, v); }
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_ps(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm512_loadu_si512(p); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1U << n) - 1); }
+};
+
+template <>
+struct SortLanes<INT64X8>
+{
+    using vector  = INT64X8;
+    using values  = UINT64X8;
+    using scalar  = int64_t;
+    using payload = uint64_t;
+    using raw     = __m512i;
+    using praw    = __m512i;
+    using index   = __m512i;
+    using mask    = __mmask8;
+
+    static constexpr size_t lanes    = 8;
+    static constexpr bool   compress = true;
+
+    static raw loadN(const scalar *p, size_t n) noexcept { return _mm512_mask_loadu_epi64(set1(sortPad<scalar>()), prefix(n), p); }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm512_mask_storeu_epi64(p, prefix(n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm512_maskz_loadu_epi64(prefix(n), p); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm512_mask_storeu_epi64(p, prefix(n), v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_epi64(x); }
+    static raw min(raw a, raw b) noexcept { return _mm512_min_epi64(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm512_max_epi64(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(i))); }
+    static raw permute(raw v, index i) noexcept { return _mm512_permutexvar_epi64(i, v); }
+    static praw ppermute(praw v, index i) noexcept { return _mm512_permutexvar_epi64(i, v); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm512_mask_blend_epi64(M, a, b); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_epi64(m, a, b); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm512_mask_blend_epi64(m, a, b); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return static_cast<mask>((a & ~M) | (b & M)); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmplt_epi64_mask(a, b); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmpgt_epi64_mask(a, b); }
+    static mask ge(raw a, raw b) noexcept { return _mm512_cmpge_epi64_mask(a, b); }
+    static size_t count(mask m) noexcept { return static_cast<size_t>(_mm_popcnt_u32(m)); }
+    static void compressStoreu(scalar *p, mask m, raw v) noexcept { _mm512_mask_compressstoreu_epi64(p, m, v); }
+    static void pcompressStoreu(payload *p, mask m, praw v) noexcept { _mm512_mask_compressstoreu_epi64(p, m, v); }
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_si512(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm512_loadu_si512(p); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1U << n) - 1); }
+};
+
+template <>
+struct SortLanes<DOUBLEX8>
+{
+    using vector  = DOUBLEX8;
+    using values  = UINT64X8;
+    using scalar  = double;
+    using payload = uint64_t;
+    using raw     = __m512d;
+    using praw    = __m512i;
+    using index   = __m512i;
+    using mask    = __mmask8;
+
+    static constexpr size_t lanes    = 8;
+    static constexpr bool   compress = true;
+
+    static raw loadN(const scalar *p, size_t n) noexcept { return _mm512_mask_loadu_pd(set1(sortPad<scalar>()), prefix(n), p); }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm512_mask_storeu_pd(p, prefix(n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm512_maskz_loadu_epi64(prefix(n), p); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm512_mask_storeu_epi64(p, prefix(n), v); }
+    static raw set1(scalar x) noexcept { return _mm512_set1_pd(x); }
+    static raw min(raw a, raw b) noexcept { return _mm512_min_pd(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm512_max_pd(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm512_cvtepi32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(i))); }
+    static raw permute(raw v, index i) noexcept { return _mm512_permutexvar_pd(i, v); }
+    static praw ppermute(praw v, index i) noexcept { return _mm512_permutexvar_epi64(i, v); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm512_mask_blend_pd(M, a, b); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm512_mask_blend_pd(m, a, b); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm512_mask_blend_epi64(m, a, b); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return static_cast<mask>((a & ~M) | (b & M)); }
+    static mask lt(raw a, raw b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static mask gt(raw a, raw b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static mask ge(raw a, raw b) noexcept { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+    static size_t count(mask m) noexcept { return static_cast<size_t>(_mm_popcnt_u32(m)); }
+    static void compressStoreu(scalar *p, mask m, raw v) noexcept { _mm512_mask_compressstoreu_pd(p, m, v); }
+    static void pcompressStoreu(payload *p, mask m, praw v) noexcept { _mm512_mask_compressstoreu_epi64(p, m, v); }
+    static raw loadu(const scalar *p) noexcept { return _mm512_loadu_pd(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm512_loadu_si512(p); }
+    static mask prefix(size_t n) noexcept { return static_cast<mask>((1U << n) - 1); }
+};
+
+/**
+ * Byte-packed lane orders for the AVX2 partition: entry `bits` lists the
+ * 32-bit lanes whose key stays left (bit clear) followed by the lanes that
+ * move right (bit set). With 64-bit keys each key spans two 32-bit lanes.
+ */
+template <size_t LANES>
+static constexpr std::array<uint64_t, (1U << LANES)> makePartitionTable() noexcept
+{
+    constexpr size_t span = 8 / LANES;
+
+    std::array<uint64_t, (1U << LANES)> table{};
+    for (size_t bits = 0; bits < table.size(); bits++) {
+        uint64_t entry = 0;
+        size_t   slot  = 0;
+        for (int right = 0; right < 2; right++) {
+            for (size_t lane = 0; lane < LANES; lane++) {
+                if (((bits >> lane) & 1) != static_cast<size_t>(right)) {
+                    continue;
+                }
+                for (size_t s = 0; s < span; s++, slot++) {
+                    entry |= static_cast<uint64_t>(lane * span + s) << (8 * slot);
+                }
+            }
+        }
+        table[bits] = entry;
+    }
+    return table;
+}
+
+template <size_t LANES>
+static constexpr std::array<uint64_t, (1U << LANES)> PARTITION_TABLE = makePartitionTable<LANES>();
+
+template <size_t LANES>
+static inline __m256i partitionOrder(unsigned bits) noexcept
+{
+    return _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<int64_t>(PARTITION_TABLE<LANES>[bits])));
+}
+
+/* Lane i of the result is all-ones when first <= i < last, in 32-bit lanes */
+static inline __m256i laneRange32(size_t first, size_t last) noexcept
+{
+    __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i lo = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(first)), iota);
+    __m256i hi = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(last)), iota);
+    return _mm256_andnot_si256(lo, hi);
+}
+
+/* Same as laneRange32 for 64-bit lanes */
+static inline __m256i laneRange64(size_t first, size_t last) noexcept
+{
+    __m256i iota = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i lo = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(first)), iota);
+    __m256i hi = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<int64_t>(last)), iota);
+    return _mm256_andnot_si256(lo, hi);
+}
+
+template <>
+struct SortLanes<INT32X8>
+{
+    using vector  = INT32X8;
+    using values  = UINT32X8;
+    using scalar  = int32_t;
+    using payload = uint32_t;
+    using raw     = __m256i;
+    using praw    = __m256i;
+    using index   = __m256i;
+    using mask    = __m256i;
+
+    static constexpr size_t lanes    = 8;
+    static constexpr bool   compress = false;
+
+    static raw loadN(const scalar *p, size_t n) noexcept
+    {
+        __m256i m = laneRange32(0, n);
+        return _mm256_blendv_epi8(set1(sortPad<scalar>()), _mm256_maskload_epi32(p, m), m);
+    }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm256_maskstore_epi32(p, laneRange32(0, n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm256_maskload_epi32(reinterpret_cast<const int *>(p), laneRange32(0, n)); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int *>(p), laneRange32(0, n), v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi32(x); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_epi32(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_epi32(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i)); }
+    static raw permute(raw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    static praw ppermute(praw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm256_blend_epi32(a, b, M); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return _mm256_blend_epi32(a, b, M); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_cmpgt_epi32(b, a); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_cmpgt_epi32(a, b); }
+    static mask ge(raw a, raw b) noexcept { return _mm256_xor_si256(_mm256_cmpgt_epi32(b, a), _mm256_set1_epi32(-1)); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+    static index order(unsigned bits) noexcept { return partitionOrder<lanes>(bits); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void pstoreu(payload *p, praw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void storeRange(scalar *p, size_t first, size_t last, raw v) noexcept { _mm256_maskstore_epi32(p, laneRange32(first, last), v); }
+    static void pstoreRange(payload *p, size_t first, size_t last, praw v) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int *>(p), laneRange32(first, last), v); }
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static praw ploadu(const payload *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+};
+
+template <>
+struct SortLanes<FLOATX8>
+{
+    using vector  = FLOATX8;
+    using values  = UINT32X8;
+    using scalar  = float;
+    using payload = uint32_t;
+    using raw     = __m256;
+    using praw    = __m256i;
+    using index   = __m256i;
+    using mask    = __m256i;
+
+    static constexpr size_t lanes    = 8;
+    static constexpr bool   compress = false;
+
+    static raw loadN(const scalar *p, size_t n) noexcept
+    {
+        __m256i m = laneRange32(0, n);
+        return _mm256_blendv_ps(set1(sortPad<scalar>()), _mm256_maskload_ps(p, m), _mm256_castsi256_ps(m));
+    }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm256_maskstore_ps(p, laneRange32(0, n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm256_maskload_epi32(reinterpret_cast<const int *>(p), laneRange32(0, n)); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int *>(p), laneRange32(0, n), v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_ps(x); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_ps(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_ps(a, b); }
+    static index makeIndex(const int *i) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i)); }
+    static raw permute(raw v, index i) noexcept { return _mm256_permutevar8x32_ps(v, i); }
+    static praw ppermute(praw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm256_blend_ps(a, b, M); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(m)); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return _mm256_blend_epi32(a, b, M); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    static mask ge(raw a, raw b) noexcept { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GE_OQ)); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(m))); }
+    static index order(unsigned bits) noexcept { return partitionOrder<lanes>(bits); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_ps(p, v); }
+    static void pstoreu(payload *p, praw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void storeRange(scalar *p, size_t first, size_t last, raw v) noexcept { _mm256_maskstore_ps(p, laneRange32(first, last), v); }
+    static void pstoreRange(payload *p, size_t first, size_t last, praw v) noexcept { _mm256_maskstore_epi32(reinterpret_cast<int *>(p), laneRange32(first, last), v); }
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_ps(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+};
+
+template <>
+struct SortLanes<INT64X4>
+{
+    using vector  = INT64X4;
+    using values  = UINT64X4;
+    using scalar  = int64_t;
+    using payload = uint64_t;
+    using raw     = __m256i;
+    using praw    = __m256i;
+    using index   = __m256i;
+    using mask    = __m256i;
+
+    static constexpr size_t lanes    = 4;
+    static constexpr bool   compress = false;
+
+    /* Spreads a 4-lane constant mask over the 32-bit halves of each 64-bit lane */
+    static constexpr unsigned widen(unsigned m) noexcept
+    {
+        return (m & 1) * 0x03 | (m & 2) * 0x06 | (m & 4) * 0x0C | (m & 8) * 0x18;
+    }
+
+    static raw loadN(const scalar *p, size_t n) noexcept
+    {
+        __m256i m = laneRange64(0, n);
+        return _mm256_blendv_epi8(set1(sortPad<scalar>()), _mm256_maskload_epi64(reinterpret_cast<const long long *>(p), m), m);
+    }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(0, n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm256_maskload_epi64(reinterpret_cast<const long long *>(p), laneRange64(0, n)); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(0, n), v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_epi64x(x); }
+    static raw min(raw a, raw b) noexcept { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+    static raw max(raw a, raw b) noexcept { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+    static index makeIndex(const int *i) noexcept
+    {
+        return _mm256_setr_epi32(2 * i[0], 2 * i[0] + 1, 2 * i[1], 2 * i[1] + 1, 2 * i[2], 2 * i[2] + 1, 2 * i[3], 2 * i[3] + 1);
+    }
+    static raw permute(raw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    static praw ppermute(praw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm256_blend_epi32(a, b, widen(M)); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return _mm256_blend_epi32(a, b, widen(M)); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_cmpgt_epi64(b, a); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_cmpgt_epi64(a, b); }
+    static mask ge(raw a, raw b) noexcept { return _mm256_xor_si256(_mm256_cmpgt_epi64(b, a), _mm256_set1_epi64x(-1)); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+    static index order(unsigned bits) noexcept { return partitionOrder<lanes>(bits); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void pstoreu(payload *p, praw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void storeRange(scalar *p, size_t first, size_t last, raw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(first, last), v); }
+    static void pstoreRange(payload *p, size_t first, size_t last, praw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(first, last), v); }
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static praw ploadu(const payload *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+};
+
+template <>
+struct SortLanes<DOUBLEX4>
+{
+    using vector  = DOUBLEX4;
+    using values  = UINT64X4;
+    using scalar  = double;
+    using payload = uint64_t;
+    using raw     = __m256d;
+    using praw    = __m256i;
+    using index   = __m256i;
+    using mask    = __m256i;
+
+    static constexpr size_t lanes    = 4;
+    static constexpr bool   compress = false;
+
+    static raw loadN(const scalar *p, size_t n) noexcept
+    {
+        __m256i m = laneRange64(0, n);
+        return _mm256_blendv_pd(set1(sortPad<scalar>()), _mm256_maskload_pd(p, m), _mm256_castsi256_pd(m));
+    }
+    static void storeN(scalar *p, size_t n, raw v) noexcept { _mm256_maskstore_pd(p, laneRange64(0, n), v); }
+    static praw ploadN(const payload *p, size_t n) noexcept { return _mm256_maskload_epi64(reinterpret_cast<const long long *>(p), laneRange64(0, n)); }
+    static void pstoreN(payload *p, size_t n, praw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(0, n), v); }
+    static raw set1(scalar x) noexcept { return _mm256_set1_pd(x); }
+    static raw min(raw a, raw b) noexcept { return _mm256_min_pd(a, b); }
+    static raw max(raw a, raw b) noexcept { return _mm256_max_pd(a, b); }
+    static index makeIndex(const int *i) noexcept { return SortLanes<INT64X4>::makeIndex(i); }
+    static raw permute(raw v, index i) noexcept { return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), i)); }
+    static praw ppermute(praw v, index i) noexcept { return _mm256_permutevar8x32_epi32(v, i); }
+    template <unsigned M> static raw blend(raw a, raw b) noexcept { return _mm256_blend_pd(a, b, M); }
+    static raw select(mask m, raw a, raw b) noexcept { return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(m)); }
+    static praw pselect(mask m, praw a, praw b) noexcept { return _mm256_blendv_epi8(a, b, m); }
+    template <unsigned M> static mask mix(mask a, mask b) noexcept { return SortLanes<INT64X4>::mix<M>(a, b); }
+    static mask lt(raw a, raw b) noexcept { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+    static mask gt(raw a, raw b) noexcept { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+    static mask ge(raw a, raw b) noexcept { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GE_OQ)); }
+    static unsigned bits(mask m) noexcept { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(m))); }
+    static index order(unsigned bits) noexcept { return partitionOrder<lanes>(bits); }
+    static void storeu(scalar *p, raw v) noexcept { _mm256_storeu_pd(p, v); }
+    static void pstoreu(payload *p, praw v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    static void storeRange(scalar *p, size_t first, size_t last, raw v) noexcept { _mm256_maskstore_pd(p, laneRange64(first, last), v); }
+    static void pstoreRange(payload *p, size_t first, size_t last, praw v) noexcept { _mm256_maskstore_epi64(reinterpret_cast<long long *>(p), laneRange64(first, last), v); }
+    static raw loadu(const scalar *p) noexcept { return _mm256_loadu_pd(p); }
+    static praw ploadu(const payload *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+};
+
+/* Lane i compares against lane i ^ j */
+template <size_t LANES>
+static constexpr std::array<int, LANES> bitonicPartner(size_t j) noexcept
+{
+    std::array<int, LANES> idx{};
+    for (size_t i = 0; i < LANES; i++) {
+        idx[i] = static_cast<int>(i ^ j);
+    }
+    return idx;
+}
+
+/* Lanes that keep the larger value of their pair in stage (k, j) of an ascending bitonic sort */
+template <size_t LANES>
+static constexpr unsigned bitonicUpper(size_t k, size_t j) noexcept
+{
+    unsigned m = 0;
+    for (size_t i = 0; i < LANES; i++) {
+        if (((i & j) != 0) != ((i & k) != 0)) {
+            m |= 1U << i;
+        }
+    }
+    return m;
+}
+
+template <size_t LANES>
+static constexpr std::array<int, LANES> reversedLanes() noexcept
+{
+    std::array<int, LANES> idx{};
+    for (size_t i = 0; i < LANES; i++) {
+        idx[i] = static_cast<int>(LANES - 1 - i);
+    }
+    return idx;
+}
+
+template <class Ops, size_t k, size_t j>
+static inline typename Ops::raw bitonicStep(typename Ops::raw v) noexcept
+{
+    static constexpr std::array<int, Ops::lanes> partner = bitonicPartner<Ops::lanes>(j);
+    auto p = Ops::permute(v, Ops::makeIndex(partner.data()));
+    return Ops::template blend<bitonicUpper<Ops::lanes>(k, j)>(Ops::min(v, p), Ops::max(v, p));
+}
+
+template <class Ops, size_t k, size_t j>
+static inline void bitonicStep(typename Ops::raw &v, typename Ops::praw &payload) noexcept
+{
+    static constexpr std::array<int, Ops::lanes> partner = bitonicPartner<Ops::lanes>(j);
+    auto i = Ops::makeIndex(partner.data());
+    auto p = Ops::permute(v, i);
+    auto swap = Ops::template mix<bitonicUpper<Ops::lanes>(k, j)>(Ops::lt(p, v), Ops::gt(p, v));
+    v = Ops::select(swap, v, p);
+    payload = Ops::pselect(swap, payload, Ops::ppermute(payload, i));
+}
+
+template <class Ops, size_t k = 2, size_t j = 1, class... Payload>
+static inline void bitonicSort(typename Ops::raw &v, Payload &...payload) noexcept
+{
+    if constexpr (sizeof...(Payload) == 0) {
+        v = bitonicStep<Ops, k, j>(v);
+    } else {
+        bitonicStep<Ops, k, j>(v, payload...);
+    }
+
+    if constexpr (j > 1) {
+        bitonicSort<Ops, k, j / 2>(v, payload...);
+    } else if constexpr (k < Ops::lanes) {
+        bitonicSort<Ops, k * 2, k>(v, payload...);
+    }
+}
+
+/* Sorts a bitonic register ascending */
+template <class Ops, size_t j = Ops::lanes / 2, class... Payload>
+static inline void bitonicMerge(typename Ops::raw &v, Payload &...payload) noexcept
+{
+    if constexpr (sizeof...(Payload) == 0) {
+        v = bitonicStep<Ops, Ops::lanes, j>(v);
+    } else {
+        bitonicStep<Ops, Ops::lanes, j>(v, payload...);
+    }
+
+    if constexpr (j > 1) {
+        bitonicMerge<Ops, j / 2>(v, payload...);
+    }
+}
+
+/* Merges two sorted registers so that a holds the lower and b the upper half */
+template <class Ops, class... Payload>
+static inline void bitonicMerge2(typename Ops::raw &a, typename Ops::raw &b, Payload &...payload) noexcept
+{
+    static constexpr std::array<int, Ops::lanes> reversed = reversedLanes<Ops::lanes>();
+    auto i = Ops::makeIndex(reversed.data());
+    b = Ops::permute(b, i);
+
+    if constexpr (sizeof...(Payload) == 0) {
+        auto lo = Ops::min(a, b);
+        b = Ops::max(a, b);
+        a = lo;
+        bitonicMerge<Ops>(a);
+        bitonicMerge<Ops>(b);
+    } else {
+        auto [pa, pb] = std::tie(payload...);
+        pb = Ops::ppermute(pb, i);
+        auto swap = Ops::gt(a, b);
+        auto lo  = Ops::select(swap, a, b);
+        auto plo = Ops::pselect(swap, pa, pb);
+        b  = Ops::select(swap, b, a);
+        pb = Ops::pselect(swap, pb, pa);
+        a  = lo;
+        pa = plo;
+        bitonicMerge<Ops>(a, pa);
+        bitonicMerge<Ops>(b, pb);
+    }
+}
+
+template <class K, class P>
+static inline void insertionSort(K *keys, P *vals, size_t n) noexcept
+{
+    for (size_t i = 1; i < n; i++) {
+        K key = keys[i];
+        P val = vals[i];
+        size_t j = i;
+        for (; j > 0 && key < keys[j - 1]; j--) {
+            keys[j] = keys[j - 1];
+            vals[j] = vals[j - 1];
+        }
+        keys[j] = key;
+        vals[j] = val;
+    }
+}
+
+/* Sorts up to 2 * lanes keys in registers, padding the tail with the largest key */
+template <class Ops, bool KV>
+static inline void sortSmall(typename Ops::scalar *keys, typename Ops::payload *vals, size_t n) noexcept
+{
+    constexpr size_t L = Ops::lanes;
+
+    if constexpr (KV) {
+        /* The network is not stable: a key equal to the pad may trade places with a pad lane and lose its value */
+        for (size_t i = 0; i < n; i++) {
+            if (keys[i] == sortPad<typename Ops::scalar>()) {
+                insertionSort(keys, vals, n);
+                return;
+            }
+        }
+    }
+
+    if (n <= L) {
+        auto a = Ops::loadN(keys, n);
+        if constexpr (KV) {
+            auto pa = Ops::ploadN(vals, n);
+            bitonicSort<Ops>(a, pa);
+            Ops::pstoreN(vals, n, pa);
+        } else {
+            bitonicSort<Ops>(a);
+        }
+        Ops::storeN(keys, n, a);
+        return;
+    }
+
+    auto a = Ops::loadu(keys);
+    auto b = Ops::loadN(keys + L, n - L);
+    if constexpr (KV) {
+        auto pa = Ops::ploadu(vals);
+        auto pb = Ops::ploadN(vals + L, n - L);
+        bitonicSort<Ops>(a, pa);
+        bitonicSort<Ops>(b, pb);
+        bitonicMerge2<Ops>(a, b, pa, pb);
+        Ops::pstoreN(vals, L, pa);
+        Ops::pstoreN(vals + L, n - L, pb);
+    } else {
+        bitonicSort<Ops>(a);
+        bitonicSort<Ops>(b);
+        bitonicMerge2<Ops>(a, b);
+    }
+    Ops::storeN(keys, L, a);
+    Ops::storeN(keys + L, n - L, b);
+}
+
+/**
+ * Writes the keys of one register that belong left of the pivot at lStore
+ * and the rest just below rStore. `safe` is cleared inside the main loop,
+ * where at least one register of free space is known to exist on both sides
+ * and the AVX2 path may store whole registers.
+ */
+template <class Ops, bool KV, bool STRICT, bool SAFE>
+static inline void partitionVector(typename Ops::scalar *keys, typename Ops::payload *vals, size_t &lStore, size_t &rStore,
+                                   typename Ops::raw v, typename Ops::praw pv, typename Ops::raw pivot) noexcept
+{
+    constexpr size_t L = Ops::lanes;
+
+    auto right = STRICT ? Ops::gt(v, pivot) : Ops::ge(v, pivot);
+    if constexpr (Ops::compress) {
+        size_t nRight = Ops::count(right);
+        Ops::compressStoreu(keys + lStore, static_cast<typename Ops::mask>(~right), v);
+        Ops::compressStoreu(keys + rStore - nRight, right, v);
+        if constexpr (KV) {
+            Ops::pcompressStoreu(vals + lStore, static_cast<typename Ops::mask>(~right), pv);
+            Ops::pcompressStoreu(vals + rStore - nRight, right, pv);
+        }
+        lStore += L - nRight;
+        rStore -= nRight;
+    } else {
+        unsigned bits   = Ops::bits(right);
+        size_t   nRight = static_cast<size_t>(_mm_popcnt_u32(bits));
+        size_t   nLeft  = L - nRight;
+        auto order = Ops::order(bits);
+        v = Ops::permute(v, order);
+        if constexpr (KV) {
+            pv = Ops::ppermute(pv, order);
+        }
+        if constexpr (SAFE) {
+            Ops::storeRange(keys + lStore, 0, nLeft, v);
+            Ops::storeRange(keys + rStore - L, nLeft, L, v);
+            if constexpr (KV) {
+                Ops::pstoreRange(vals + lStore, 0, nLeft, pv);
+                Ops::pstoreRange(vals + rStore - L, nLeft, L, pv);
+            }
+        } else {
+            Ops::storeu(keys + lStore, v);
+            Ops::storeu(keys + rStore - L, v);
+            if constexpr (KV) {
+                Ops::pstoreu(vals + lStore, pv);
+                Ops::pstoreu(vals + rStore - L, pv);
+            }
+        }
+        lStore += nLeft;
+        rStore -= nRight;
+    }
+}
+
+/**
+ * In-place partition of [0, n): keys below the pivot (not above it if STRICT)
+ * end up first. Returns the size of the left part.
+ */
+template <class Ops, bool KV, bool STRICT>
+static inline size_t partition(typename Ops::scalar *keys, typename Ops::payload *vals, size_t n, typename Ops::scalar pivot) noexcept
+{
+    constexpr size_t L = Ops::lanes;
+
+    size_t left = 0, right = n;
+    while ((right - left) % L != 0) {
+        /* The negated vector compares, so a key goes the same way on either path */
+        bool stays = STRICT ? !(keys[left] > pivot) : !(keys[left] >= pivot);
+        if (stays) {
+            left++;
+        } else {
+            right--;
+            std::swap(keys[left], keys[right]);
+            if constexpr (KV) {
+                std::swap(vals[left], vals[right]);
+            }
+        }
+    }
+    auto vpivot = Ops::set1(pivot);
+    auto first  = Ops::loadu(keys + left);
+    auto last   = Ops::loadu(keys + right - L);
+    typename Ops::praw pfirst{}, plast{};
+    if constexpr (KV) {
+        pfirst = Ops::ploadu(vals + left);
+        plast  = Ops::ploadu(vals + right - L);
+    }
+
+    size_t lStore = left, rStore = right;
+    left  += L;
+    right -= L;
+    while (left < right) {
+        typename Ops::raw v;
+        typename Ops::praw pv{};
+        if (rStore - right < left - lStore) {
+            right -= L;
+            v = Ops::loadu(keys + right);
+            if constexpr (KV) {
+                pv = Ops::ploadu(vals + right);
+            }
+        } else {
+            v = Ops::loadu(keys + left);
+            if constexpr (KV) {
+                pv = Ops::ploadu(vals + left);
+            }
+            left += L;
+        }
+        partitionVector<Ops, KV, STRICT, false>(keys, vals, lStore, rStore, v, pv, vpivot);
+    }
+    partitionVector<Ops, KV, STRICT, true>(keys, vals, lStore, rStore, first, pfirst, vpivot);
+    partitionVector<Ops, KV, STRICT, true>(keys, vals, lStore, rStore, last, plast, vpivot);
+
+    return lStore;
+}
+
+template <class K, class P, bool KV>
+static inline void siftDown(K *keys, P *vals, size_t root, size_t n) noexcept
+{
+    for (size_t child; (child = 2 * root + 1) < n; root = child) {
+        if (child + 1 < n && keys[child] < keys[child + 1]) {
+            child++;
+        }
+        if (!(keys[root] < keys[child])) {
+            return;
+        }
+        std::swap(keys[root], keys[child]);
+        if constexpr (KV) {
+            std::swap(vals[root], vals[child]);
+        }
+    }
+}
+
+/* Worst-case fallback once the recursion budget is spent */
+template <class K, class P, bool KV>
+static inline void heapSort(K *keys, P *vals, size_t n) noexcept
+{
+    for (size_t i = n / 2; i-- > 0;) {
+        siftDown<K, P, KV>(keys, vals, i, n);
+    }
+    for (size_t i = n; i-- > 1;) {
+        std::swap(keys[0], keys[i]);
+        if constexpr (KV) {
+            std::swap(vals[0], vals[i]);
+        }
+        siftDown<K, P, KV>(keys, vals, 0, i);
+    }
+}
+
+/*
+ * Moves NaN keys behind all others, carrying values along, and returns the
+ * count of the rest. The networks and the partition never see a NaN, which
+ * they would otherwise trade for the pad or split inconsistently.
+ */
+template <class K, class P, bool KV>
+static inline size_t nanToEnd(K *keys, P *vals, size_t n) noexcept
+{
+    if constexpr (std::numeric_limits<K>::has_quiet_NaN) {
+        size_t kept = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (keys[i] == keys[i]) {
+                if (kept != i) {
+                    std::swap(keys[kept], keys[i]);
+                    if constexpr (KV) {
+                        std::swap(vals[kept], vals[i]);
+                    }
+                }
+                kept++;
+            }
+        }
+        return kept;
+    } else {
+        return n;
+    }
+}
+
+template <class T>
+static inline T median3(T a, T b, T c) noexcept
+{
+    if (b < a) {
+        std::swap(a, b);
+    }
+    if (c < b) {
+        b = c < a ? a : c;
+    }
+    return b;
+}
+
+template <class Ops, bool KV>
+static inline void quicksort(typename Ops::scalar *keys, typename Ops::payload *vals, size_t n, int budget) noexcept
+{
+    while (n > 2 * Ops::lanes) {
+        if (budget-- == 0) {
+            heapSort<typename Ops::scalar, typename Ops::payload, KV>(keys, vals, n);
+            return;
+        }
+
+        auto   pivot = median3(keys[n / 4], keys[n / 2], keys[n - n / 4 - 1]);
+        size_t mid   = partition<Ops, KV, false>(keys, vals, n, pivot);
+        if (mid == 0) {
+            /* pivot is the smallest key: peel off every copy of it, they are in place already */
+            mid = partition<Ops, KV, true>(keys, vals, n, pivot);
+            keys += mid;
+            vals += KV ? mid : 0;
+            n    -= mid;
+            continue;
+        }
+
+        if (mid < n - mid) {
+            quicksort<Ops, KV>(keys, vals, mid, budget);
+            keys += mid;
+            vals += KV ? mid : 0;
+            n    -= mid;
+        } else {
+            quicksort<Ops, KV>(keys + mid, KV ? vals + mid : vals, n - mid, budget);
+            n = mid;
+        }
+    }
+    sortSmall<Ops, KV>(keys, vals, n);
+}
+
+template <class Ops, bool KV>
+static inline void sort(typename Ops::scalar *keys, typename Ops::payload *vals, size_t n) noexcept
+{
+    n = nanToEnd<typename Ops::scalar, typename Ops::payload, KV>(keys, vals, n);
+
+    int budget = 2;
+    for (size_t m = n; m > 1; m >>= 1) {
+        budget += 2;
+    }
+    quicksort<Ops, KV>(keys, vals, n, budget);
+}
+
+/* Quickselect over the same partition step: only the side holding k is kept */
+template <class Ops, bool KV>
+static inline void nthElement(typename Ops::scalar *keys, typename Ops::payload *vals, size_t n, size_t k) noexcept
+{
+    n = nanToEnd<typename Ops::scalar, typename Ops::payload, KV>(keys, vals, n);
+    if (k >= n) {
+        return;
+    }
+
+    int budget = 2;
+    for (size_t m = n; m > 1; m >>= 1) {
+        budget += 2;
+    }
+
+    while (n > 2 * Ops::lanes) {
+        if (budget-- == 0) {
+            heapSort<typename Ops::scalar, typename Ops::payload, KV>(keys, vals, n);
+            return;
+        }
+
+        auto   pivot = median3(keys[n / 4], keys[n / 2], keys[n - n / 4 - 1]);
+        size_t mid   = partition<Ops, KV, false>(keys, vals, n, pivot);
+        if (mid == 0) {
+            /* every key is >= pivot: the copies of pivot go first and are final */
+            mid = partition<Ops, KV, true>(keys, vals, n, pivot);
+            if (k < mid) {
+                return;
+            }
+        } else if (k < mid) {
+            n = mid;
+            continue;
+        }
+        keys += mid;
+        vals += KV ? mid : 0;
+        n    -= mid;
+        k    -= mid;
+    }
+    sortSmall<Ops, KV>(keys, vals, n);
+}
+
+#if defined(__AVX512F__)
+using SortInt32  = SortLanes<INT32X16>;
+using SortFloat  = SortLanes<FLOATX16>;
+using SortInt64  = SortLanes<INT64X8>;
+using SortDouble = SortLanes<DOUBLEX8>;
+#else
+using SortInt32  = SortLanes<INT32X8>;
+using SortFloat  = SortLanes<FLOATX8>;
+using SortInt64  = SortLanes<INT64X4>;
+using SortDouble = SortLanes<DOUBLEX4>;
+#endif
+
+template <class Ops>
+static inline void argsort(const typename Ops::scalar *keys, typename Ops::payload *indices, size_t n)
+{
+    std::vector<typename Ops::scalar> scratch(keys, keys + n);
+    for (size_t i = 0; i < n; i++) {
+        indices[i] = static_cast<typename Ops::payload>(i);
+    }
+    sort<Ops, true>(scratch.data(), indices, n);
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Sorts the lanes ascending with a bitonic network
+ */
+static inline INT32X8 sort(const INT32X8 &v) noexcept
+{
+    __m256i r = v.v;
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<INT32X8>>(r);
+    return r;
+}
+
+static inline FLOATX8 sort(const FLOATX8 &v) noexcept
+{
+    __m256 r = v.v;
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<FLOATX8>>(r);
+    return r;
+}
+
+static inline INT32X16 sort(const INT32X16 &v) noexcept
+{
+    __m512i r = v.v;
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<INT32X16>>(r);
+    return r;
+}
+
+static inline FLOATX16 sort(const FLOATX16 &v) noexcept
+{
+    __m512 r = v.v;
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<FLOATX16>>(r);
+    return r;
+}
+
+/**
+ * @brief Sorts the key lanes ascending and applies the same permutation to values
+ */
+static inline void sort(INT32X8 &keys, UINT32X8 &values) noexcept
+{
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<INT32X8>>(keys.v, values.v);
+}
+
+static inline void sort(FLOATX8 &keys, UINT32X8 &values) noexcept
+{
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<FLOATX8>>(keys.v, values.v);
+}
+
+static inline void sort(INT32X16 &keys, UINT32X16 &values) noexcept
+{
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<INT32X16>>(keys.v, values.v);
+}
+
+static inline void sort(FLOATX16 &keys, UINT32X16 &values) noexcept
+{
+    slimm::detail::bitonicSort<slimm::detail::SortLanes<FLOATX16>>(keys.v, values.v);
+}
+
+/**
+ * @brief Sorts n keys ascending in place
+ *
+ * Quicksort whose partition step uses compress-store on AVX-512 and a
+ * permutation table on AVX2; partitions of up to two registers are
+ * finished with bitonic networks. Not stable; NaN keys are kept and
+ * placed after all others, in no particular order among themselves.
+ */
+static inline void sort(int32_t *data, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortInt32, false>(data, nullptr, n);
+}
+
+static inline void sort(float *data, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortFloat, false>(data, nullptr, n);
+}
+
+static inline void sort(int64_t *data, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortInt64, false>(data, nullptr, n);
+}
+
+static inline void sort(double *data, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortDouble, false>(data, nullptr, n);
+}
+
+/**
+ * @brief Sorts n keys ascending in place, moving values along with their keys
+ */
+static inline void sort(int32_t *keys, uint32_t *values, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortInt32, true>(keys, values, n);
+}
+
+static inline void sort(float *keys, uint32_t *values, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortFloat, true>(keys, values, n);
+}
+
+static inline void sort(int64_t *keys, uint64_t *values, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortInt64, true>(keys, values, n);
+}
+
+static inline void sort(double *keys, uint64_t *values, size_t n) noexcept
+{
+    slimm::detail::sort<slimm::detail::SortDouble, true>(keys, values, n);
+}
+
+/**
+ * @brief Writes the indices that would sort keys ascending; keys are left untouched
+ */
+static inline void argsort(const int32_t *keys, uint32_t *indices, size_t n)
+{
+    slimm::detail::argsort<slimm::detail::SortInt32>(keys, indices, n);
+}
+
+static inline void argsort(const float *keys, uint32_t *indices, size_t n)
+{
+    slimm::detail::argsort<slimm::detail::SortFloat>(keys, indices, n);
+}
+
+static inline void argsort(const int64_t *keys, uint64_t *indices, size_t n)
+{
+    slimm::detail::argsort<slimm::detail::SortInt64>(keys, indices, n);
+}
+
+static inline void argsort(const double *keys, uint64_t *indices, size_t n)
+{
+    slimm::detail::argsort<slimm::detail::SortDouble>(keys, indices, n);
+}
+
+/**
+ * @brief Moves the key that belongs at position k of the sorted order there
+ *
+ * Keys before k compare <= data[k] and keys after it >= data[k], as with
+ * std::nth_element. Runs the sort's partition as a quickselect and falls
+ * back to heap sort on the remaining range if the pivots keep degrading.
+ * Does nothing when k >= n. NaN keys rank after all others, as in sort().
+ */
+static inline void nthElement(int32_t *data, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortInt32, false>(data, nullptr, n, k);
+    }
+}
+
+static inline void nthElement(float *data, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortFloat, false>(data, nullptr, n, k);
+    }
+}
+
+static inline void nthElement(int64_t *data, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortInt64, false>(data, nullptr, n, k);
+    }
+}
+
+static inline void nthElement(double *data, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortDouble, false>(data, nullptr, n, k);
+    }
+}
+
+/**
+ * @brief Selects position k of the key order, moving values along with their keys
+ */
+static inline void nthElement(int32_t *keys, uint32_t *values, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortInt32, true>(keys, values, n, k);
+    }
+}
+
+static inline void nthElement(float *keys, uint32_t *values, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortFloat, true>(keys, values, n, k);
+    }
+}
+
+static inline void nthElement(int64_t *keys, uint64_t *values, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortInt64, true>(keys, values, n, k);
+    }
+}
+
+static inline void nthElement(double *keys, uint64_t *values, size_t n, size_t k) noexcept
+{
+    if (k < n) {
+        slimm::detail::nthElement<slimm::detail::SortDouble, true>(keys, values, n, k);
+    }
+}
@@ -0,0 +1,384 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+
+namespace slimm::detail
+{
+
+/**
+ * Lane operations of the SpMV kernels: gathers of x through 32-bit column
+ * indices, and masked variants for the last few nonzeros of a CSR row and
+ * the padding of a SELL chunk.
+ */
+template <class T>
+struct SpmvLanes;
+
+template <>
+struct SpmvLanes<float>
+{
+#if defined(__AVX512F__)
+    using raw   = __m512;
+    using index = __m512i;
+    using mask  = __mmask16;
+
+    static constexpr size_t lanes = 16;
+
+    static raw zero() noexcept { return _mm512_setzero_ps(); }
+    static mask tail(size_t n) noexcept { return static_cast<mask>((1u << n) - 1); }
+    static raw load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+    static raw load(const float *p, mask m) noexcept { return _mm512_maskz_loadu_ps(m, p); }
+    static index loadIndex(const int32_t *p) noexcept { return _mm512_loadu_si512(p); }
+    static index loadIndex(const int32_t *p, mask m) noexcept { return _mm512_maskz_loadu_epi32(m, p); }
+    static raw gather(const float *x, index i) noexcept { return _mm512_i32gather_ps(i, x, 4); }
+    static raw gather(const float *x, index i, mask m) noexcept { return _mm512_mask_i32gather_ps(zero(), m, i, x, 4); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+    static float sum(raw v) noexcept { return _mm512_reduce_add_ps(v); }
+    static void store(float *p, raw v) noexcept { _mm512_storeu_ps(p, v); }
+    static void scatter(float *y, mask m, index slots, raw v) noexcept { _mm512_mask_i32scatter_ps(y, m, slots, v, 4); }
+    static mask live(index lengths, int k) noexcept { return _mm512_cmpgt_epi32_mask(lengths, _mm512_set1_epi32(k)); }
+#else
+    using raw   = __m256;
+    using index = __m256i;
+    using mask  = __m256i;
+
+    static constexpr size_t lanes = 8;
+
+    static raw zero() noexcept { return _mm256_setzero_ps(); }
+    static raw load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+    static raw load(const float *p, mask m) noexcept { return _mm256_maskload_ps(p, m); }
+    static index loadIndex(const int32_t *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static index loadIndex(const int32_t *p, mask m) noexcept { return _mm256_maskload_epi32(p, m); }
+    static raw gather(const float *x, index i) noexcept { return _mm256_i32gather_ps(x, i, 4); }
+    static raw gather(const float *x, index i, mask m) noexcept { return _mm256_mask_i32gather_ps(zero(), x, i, _mm256_castsi256_ps(m), 4); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+    static void store(float *p, raw v) noexcept { _mm256_storeu_ps(p, v); }
+
+    static mask live(index lengths, int k) noexcept { return _mm256_cmpgt_epi32(lengths, _mm256_set1_epi32(k)); }
+
+    static mask tail(size_t n) noexcept
+    {
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+
+    static float sum(raw v) noexcept
+    {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s        = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s        = _mm_add_ss(s, _mm_movehdup_ps(s));
+        return _mm_cvtss_f32(s);
+    }
+#endif
+};
+
+template <>
+struct SpmvLanes<double>
+{
+#if defined(__AVX512F__)
+    using raw   = __m512d;
+    using index = __m256i;
+    using mask  = __mmask8;
+
+    static constexpr size_t lanes = 8;
+
+    static raw zero() noexcept { return _mm512_setzero_pd(); }
+    static mask tail(size_t n) noexcept { return static_cast<mask>((1u << n) - 1); }
+    static raw load(const double *p) noexcept { return _mm512_loadu_pd(p); }
+    static raw load(const double *p, mask m) noexcept { return _mm512_maskz_loadu_pd(m, p); }
+    static index loadIndex(const int32_t *p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    static raw gather(const double *x, index i) noexcept { return _mm512_i32gather_pd(i, x, 8); }
+    static raw gather(const double *x, index i, mask m) noexcept { return _mm512_mask_i32gather_pd(zero(), m, i, x, 8); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+    static double sum(raw v) noexcept { return _mm512_reduce_add_pd(v); }
+    static void store(double *p, raw v) noexcept { _mm512_storeu_pd(p, v); }
+    static void scatter(double *y, mask m, index slots, raw v) noexcept { _mm512_mask_i32scatter_pd(y, m, slots, v, 8); }
+
+    static mask live(index lengths, int k) noexcept
+    {
+        return static_cast<mask>(_mm512_cmpgt_epi32_mask(_mm512_castsi256_si512(lengths), _mm512_set1_epi32(k)));
+    }
+
+    /* A 512-bit masked load keeps this within AVX-512F; masked-off lanes never fault */
+    static index loadIndex(const int32_t *p, mask m) noexcept
+    {
+        return _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(m, p));
+    }
+#else
+    using raw   = __m256d;
+    using index = __m128i;
+    using mask  = __m128i;
+
+    static constexpr size_t lanes = 4;
+
+    static raw zero() noexcept { return _mm256_setzero_pd(); }
+    static raw load(const double *p) noexcept { return _mm256_loadu_pd(p); }
+    static raw load(const double *p, mask m) noexcept { return _mm256_maskload_pd(p, _mm256_cvtepi32_epi64(m)); }
+    static index loadIndex(const int32_t *p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+    static index loadIndex(const int32_t *p, mask m) noexcept { return _mm_maskload_epi32(p, m); }
+    static raw gather(const double *x, index i) noexcept { return _mm256_i32gather_pd(x, i, 8); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+    static void store(double *p, raw v) noexcept { _mm256_storeu_pd(p, v); }
+
+    static raw gather(const double *x, index i, mask m) noexcept
+    {
+        return _mm256_mask_i32gather_pd(zero(), x, i, _mm256_castsi256_pd(_mm256_cvtepi32_epi64(m)), 8);
+    }
+
+    static mask live(index lengths, int k) noexcept { return _mm_cmpgt_epi32(lengths, _mm_set1_epi32(k)); }
+
+    static mask tail(size_t n) noexcept
+    {
+        return _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(n)), _mm_setr_epi32(0, 1, 2, 3));
+    }
+
+    static double sum(raw v) noexcept
+    {
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+#endif
+};
+
+/* Below this many nonzeros per thread a second thread costs more than it saves */
+constexpr size_t SPMV_MIN_CHUNK = 1 << 15;
+
+/**
+ * Splits [0, count) into ranges of about equal weight, where prefix holds
+ * the running weight with prefix[0] = 0 and prefix[count] the total, and
+ * runs fn(begin, end) for every range on up to threads threads.
+ */
+template <class Offset, class F>
+static inline void spmvPartition(const Offset *prefix, size_t count, unsigned threads, F &&fn)
+{
+    size_t total = static_cast<size_t>(prefix[count] - prefix[0]);
+    size_t parts = std::min<size_t>(resolveThreads(threads), total / SPMV_MIN_CHUNK);
+    if (parts <= 1) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    std::vector<size_t> bounds(parts + 1, count);
+    bounds[0] = 0;
+    for (size_t p = 1; p < parts; p++) {
+        auto target = static_cast<Offset>(prefix[0] + total * p / parts);
+        bounds[p]   = static_cast<size_t>(std::lower_bound(prefix, prefix + count + 1, target) - prefix);
+        bounds[p]   = std::min(std::max(bounds[p], bounds[p - 1]), count);
+    }
+    parallelFor(parts, threads, [&](size_t p) {
+        if (bounds[p] < bounds[p + 1]) {
+            fn(bounds[p], bounds[p + 1]);
+        }
+    });
+}
+
+/* One gathered fmadd per register of a row's nonzeros, then a horizontal sum */
+template <class T, class Offset>
+static inline void spmvCsrRows(const Offset *rowPtr, const int32_t *colIdx, const T *values, const T *x, T *y, size_t begin, size_t end) noexcept
+{
+    using Ops          = SpmvLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    for (size_t r = begin; r < end; r++) {
+        size_t j    = static_cast<size_t>(rowPtr[r]);
+        size_t last = static_cast<size_t>(rowPtr[r + 1]);
+        auto   acc  = Ops::zero();
+        for (; j + L <= last; j += L) {
+            acc = Ops::fmadd(Ops::load(values + j), Ops::gather(x, Ops::loadIndex(colIdx + j)), acc);
+        }
+        if (j < last) {
+            auto m = Ops::tail(last - j);
+            acc    = Ops::fmadd(Ops::load(values + j, m), Ops::gather(x, Ops::loadIndex(colIdx + j, m), m), acc);
+        }
+        y[r] = Ops::sum(acc);
+    }
+}
+
+} // namespace slimm::detail
+
+/**
+ * A sparse matrix in SELL-C-sigma format, converted from CSR.
+ *
+ * Rows are sorted by decreasing length within windows of sigma rows and
+ * cut into chunks of C rows, C being the lane count of T. Every chunk is
+ * stored column by column, padded to its longest row with explicit
+ * zeros, so one register of values and one of column indices cover the
+ * same position in C rows. SpMV then needs no horizontal sums and no
+ * remainder loops. Columns past the chunk's shortest row mask the padded
+ * lanes out of the gather, so an inf or NaN in x only reaches the rows
+ * that reference it. A larger sigma means less padding but scatters y
+ * over a wider window.
+ */
+template <class T>
+class SellMatrix
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "SellMatrix holds float or double values");
+
+public:
+    static constexpr size_t C = slimm::detail::SpmvLanes<T>::lanes;
+
+    template <class Offset>
+    SellMatrix(const Offset *rowPtr, const int32_t *colIdx, const T *values, size_t rows, size_t cols, size_t sigma = 32 * C) :
+        rowCount{ rows },
+        colCount{ cols },
+        nonzeros{ rows != 0 ? static_cast<size_t>(rowPtr[rows] - rowPtr[0]) : 0 }
+    {
+        size_t chunks = (rows + C - 1) / C;
+        perm.resize(chunks * C);
+        std::iota(perm.begin(), perm.begin() + rows, 0);
+        std::fill(perm.begin() + rows, perm.end(), 0);
+
+        auto length = [&](int32_t r) { return static_cast<size_t>(rowPtr[r + 1] - rowPtr[r]); };
+        sorted      = sigma > 1;
+        if (sorted) {
+            for (size_t w = 0; w < rows; w += sigma) {
+                std::stable_sort(perm.begin() + w, perm.begin() + std::min(rows, w + sigma),
+                                 [&](int32_t a, int32_t b) { return length(a) > length(b); });
+            }
+        }
+
+        chunkPtr.assign(chunks + 1, 0);
+        denseEnd.assign(chunks, 0);
+        lengths.assign(chunks * C, 0);
+        for (size_t c = 0; c < chunks; c++) {
+            size_t width = 0;
+            size_t dense = SIZE_MAX;
+            for (size_t l = 0; l < C && c * C + l < rows; l++) {
+                size_t len = length(perm[c * C + l]);
+                width      = std::max(width, len);
+                dense      = std::min(dense, len);
+
+                lengths[c * C + l] = static_cast<int32_t>(len);
+            }
+            chunkPtr[c + 1] = chunkPtr[c] + width * C;
+            denseEnd[c]     = chunkPtr[c] + dense * C;
+        }
+
+        indices.assign(chunkPtr[chunks], 0);
+        entries.assign(chunkPtr[chunks], T(0));
+        for (size_t c = 0; c < chunks; c++) {
+            for (size_t l = 0; l < C && c * C + l < rows; l++) {
+                int32_t row   = perm[c * C + l];
+                auto    first = static_cast<size_t>(rowPtr[row]);
+                for (size_t k = 0; k < length(row); k++) {
+                    indices[chunkPtr[c] + k * C + l] = colIdx[first + k];
+                    entries[chunkPtr[c] + k * C + l] = values[first + k];
+                }
+            }
+        }
+    }
+
+    size_t rows() const noexcept
+    {
+        return rowCount;
+    }
+
+    size_t columns() const noexcept
+    {
+        return colCount;
+    }
+
+    size_t nonzeroCount() const noexcept
+    {
+        return nonzeros;
+    }
+
+    /** @brief Stored entries including padding; stored() / nonzeroCount() - 1 is the padding overhead */
+    size_t stored() const noexcept
+    {
+        return entries.size();
+    }
+
+    /**
+     * @brief y = A x; chunks are split over threads by stored entries, threads = 0 uses every hardware thread
+     */
+    void multiply(const T *x, T *y, unsigned threads = 1) const
+    {
+        slimm::detail::spmvPartition(chunkPtr.data(), chunkPtr.size() - 1, threads, [&](size_t begin, size_t end) {
+            multiplyChunks(x, y, begin, end);
+        });
+    }
+
+private:
+    void multiplyChunks(const T *x, T *y, size_t begin, size_t end) const noexcept
+    {
+        using Ops = slimm::detail::SpmvLanes<T>;
+
+        for (size_t c = begin; c < end; c++) {
+            auto   acc = Ops::zero();
+            size_t j   = chunkPtr[c];
+            for (; j < denseEnd[c]; j += C) {
+                acc = Ops::fmadd(Ops::load(entries.data() + j), Ops::gather(x, Ops::loadIndex(indices.data() + j)), acc);
+            }
+
+            /* Past the shortest row only the lanes still inside their row gather x; the rest add 0 * 0 */
+            auto lens = Ops::loadIndex(lengths.data() + c * C);
+            for (int k = static_cast<int>((j - chunkPtr[c]) / C); j < chunkPtr[c + 1]; j += C, k++) {
+                auto m = Ops::live(lens, k);
+                acc    = Ops::fmadd(Ops::load(entries.data() + j), Ops::gather(x, Ops::loadIndex(indices.data() + j), m), acc);
+            }
+
+            size_t live = std::min(C, rowCount - c * C);
+            if (!sorted && live == C) {
+                Ops::store(y + c * C, acc);
+                continue;
+            }
+#if defined(__AVX512F__)
+            auto m = Ops::tail(live);
+            Ops::scatter(y, m, Ops::loadIndex(perm.data() + c * C, m), acc);
+#else
+            alignas(32) T lane[C];
+            Ops::store(lane, acc);
+            for (size_t l = 0; l < live; l++) {
+                y[perm[c * C + l]] = lane[l];
+            }
+#endif
+        }
+    }
+
+    size_t               rowCount;
+    size_t               colCount;
+    size_t               nonzeros;
+    bool                 sorted;
+    std::vector<size_t>  chunkPtr;
+    std::vector<size_t>  denseEnd;
+    std::vector<int32_t> lengths;
+    std::vector<int32_t> indices;
+    std::vector<T>       entries;
+    std::vector<int32_t> perm;
+};
+
+/**
+ * @brief y = A x for a CSR matrix of rows rows; rows are split over threads by nonzero count, threads = 0 uses every hardware thread
+ *
+ * rowPtr holds rows + 1 offsets of any integer type into colIdx and
+ * values. Each register of a row's nonzeros gathers its x entries; the
+ * last few use masked loads and gathers.
+ */
+template <class T, class Offset>
+static inline void spmv(const Offset *rowPtr, const int32_t *colIdx, const T *values, size_t rows, const T *x, T *y, unsigned threads = 1)
+{
+    slimm::detail::spmvPartition(rowPtr, rows, threads, [&](size_t begin, size_t end) {
+        slimm::detail::spmvCsrRows(rowPtr, colIdx, values, x, y, begin, end);
+    });
+}
+
+/**
+ * @brief y = A x for a SELL-C-sigma matrix
+ */
+template <class T>
+static inline void spmv(const SellMatrix<T> &a, const T *x, T *y, unsigned threads = 1)
+{
+    a.multiply(x, y, threads);
+}
@@ -0,0 +1,622 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+
+/**
+ * Stencil weights over a cube of side 2R + 1 in D dimensions, stored x
+ * fastest, then y, then z. Zero weights are skipped at compile time, so
+ * a mask passed as a template argument unrolls into exactly one fmadd per
+ * nonzero point.
+ *
+ *     constexpr auto heat = stencilStar<3>(1.0 - 6 * k, k);
+ *     stencilRun<heat, FLOATX16>(a, b, { nx, ny, nz }, steps, 0);
+ */
+template <int D, int R>
+struct StencilMask
+{
+    static_assert(D >= 1 && D <= 3, "stencils are 1D, 2D or 3D");
+    static_assert(R >= 1, "a stencil reaches at least one neighbour");
+
+    static constexpr int    dims   = D;
+    static constexpr int    radius = R;
+    static constexpr int    width  = 2 * R + 1;
+    static constexpr size_t rows   = D == 1 ? 1 : D == 2 ? width : width * width;
+
+    std::array<double, rows * width> w;
+
+    /* Weight of the neighbour at (dz, dy, dx), each in [-R, R]; unused dimensions pass 0 */
+    constexpr double at(int dz, int dy, int dx) const noexcept
+    {
+        return w[(((D == 3 ? dz + R : 0) * width) + (D >= 2 ? dy + R : 0)) * width + dx + R];
+    }
+};
+
+/**
+ * @brief Radius 1 weights by distance class: centre, face, edge and corner neighbours
+ *
+ * In 3D this is the 27-point stencil, and the 7-point one with edge and
+ * corner at zero; in 2D the 9-point and 5-point stencils.
+ */
+template <int D>
+static constexpr StencilMask<D, 1> stencilBox(double center, double face, double edge = 0, double corner = 0) noexcept
+{
+    StencilMask<D, 1> mask{};
+    const double      byDistance[4] = { center, face, edge, corner };
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((D < 3 && dz != 0) || (D < 2 && dy != 0)) {
+                    continue;
+                }
+                int    distance = (dz != 0) + (dy != 0) + (dx != 0);
+                size_t index    = (((D == 3 ? dz + 1 : 0) * 3) + (D >= 2 ? dy + 1 : 0)) * 3 + dx + 1;
+                mask.w[index]   = byDistance[distance];
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief The 3-, 5- or 7-point star: a centre weight and one shared by the 2D face neighbours
+ */
+template <int D>
+static constexpr StencilMask<D, 1> stencilStar(double center, double neighbor) noexcept
+{
+    return stencilBox<D>(center, neighbor);
+}
+
+/**
+ * A grid of nx * ny * nz points stored x fastest, halo included. A D-point
+ * stencil updates the points at least R away from the faces of its first
+ * D dimensions; the halo is never written. Dimensions past D are
+ * independent batches, so a 1D stencil on an nx * ny grid filters every row.
+ */
+struct StencilGrid
+{
+    size_t nx;
+    size_t ny = 1;
+    size_t nz = 1;
+};
+
+namespace slimm::detail
+{
+
+#if defined(__AVX512F__)
+using StencilFloat = FLOATX16;
+#else
+using StencilFloat = FLOATX8;
+#endif
+
+/* Below this many points per thread a step is not worth splitting */
+static constexpr size_t STENCIL_MIN_CHUNK = 1 << 15;
+
+/* Points per slab when a 1D grid is swept as a wavefront */
+static constexpr size_t STENCIL_SLAB_1D = 1 << 12;
+
+/**
+ * Lane operations of the stencil kernels. concat<K>(lo, hi) returns lanes
+ * K ... K + L - 1 of lo:hi, which turns three aligned loads into every
+ * neighbour shift of the middle one.
+ */
+template <class V>
+struct StencilLanes;
+
+/* Lanes K ... K + L - 1 of lo:hi for elements of E bytes, in 128-bit halves */
+template <int K, int E>
+static inline __m256i stencilConcat(__m256i lo, __m256i hi) noexcept
+{
+    constexpr int B = K * E;
+    if constexpr (B == 0) {
+        return lo;
+    } else if constexpr (B == 32) {
+        return hi;
+    } else {
+        __m256i mid = _mm256_permute2x128_si256(lo, hi, 0x21);
+        if constexpr (B < 16) {
+            return _mm256_alignr_epi8(mid, lo, B);
+        } else if constexpr (B == 16) {
+            return mid;
+        } else {
+            return _mm256_alignr_epi8(hi, mid, B - 16);
+        }
+    }
+}
+
+template <>
+struct StencilLanes<FLOATX8>
+{
+    using scalar = float;
+    using raw    = __m256;
+    using mask   = __m256i;
+
+    static constexpr ptrdiff_t lanes = 8;
+
+    static raw zero() noexcept { return _mm256_setzero_ps(); }
+    static raw set1(float v) noexcept { return _mm256_set1_ps(v); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_ps(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+    static raw load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+    static raw load(const float *p, mask m) noexcept { return _mm256_maskload_ps(p, m); }
+    static void store(float *p, raw v) noexcept { _mm256_storeu_ps(p, v); }
+    static void store(float *p, mask m, raw v) noexcept { _mm256_maskstore_ps(p, m, v); }
+
+    /* Lanes [lo, hi) */
+    static mask window(ptrdiff_t lo, ptrdiff_t hi) noexcept
+    {
+        __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        return _mm256_and_si256(_mm256_cmpgt_epi32(lane, _mm256_set1_epi32(static_cast<int>(lo) - 1)),
+                                _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(hi)), lane));
+    }
+
+    template <int K>
+    static raw concat(raw lo, raw hi) noexcept
+    {
+        return _mm256_castsi256_ps(stencilConcat<K, 4>(_mm256_castps_si256(lo), _mm256_castps_si256(hi)));
+    }
+};
+
+template <>
+struct StencilLanes<DOUBLEX4>
+{
+    using scalar = double;
+    using raw    = __m256d;
+    using mask   = __m256i;
+
+    static constexpr ptrdiff_t lanes = 4;
+
+    static raw zero() noexcept { return _mm256_setzero_pd(); }
+    static raw set1(double v) noexcept { return _mm256_set1_pd(v); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_pd(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+    static raw load(const double *p) noexcept { return _mm256_loadu_pd(p); }
+    static raw load(const double *p, mask m) noexcept { return _mm256_maskload_pd(p, m); }
+    static void store(double *p, raw v) noexcept { _mm256_storeu_pd(p, v); }
+    static void store(double *p, mask m, raw v) noexcept { _mm256_maskstore_pd(p, m, v); }
+
+    static mask window(ptrdiff_t lo, ptrdiff_t hi) noexcept
+    {
+        __m256i lane = _mm256_setr_epi64x(0, 1, 2, 3);
+        return _mm256_and_si256(_mm256_cmpgt_epi64(lane, _mm256_set1_epi64x(lo - 1)),
+                                _mm256_cmpgt_epi64(_mm256_set1_epi64x(hi), lane));
+    }
+
+    template <int K>
+    static raw concat(raw lo, raw hi) noexcept
+    {
+        return _mm256_castsi256_pd(stencilConcat<K, 8>(_mm256_castpd_si256(lo), _mm256_castpd_si256(hi)));
+    }
+};
+
+#if defined(__AVX512F__)
+template <>
+struct StencilLanes<FLOATX16>
+{
+    using scalar = float;
+    using raw    = __m512;
+    using mask   = __mmask16;
+
+    static constexpr ptrdiff_t lanes = 16;
+
+    static raw zero() noexcept { return _mm512_setzero_ps(); }
+    static raw set1(float v) noexcept { return _mm512_set1_ps(v); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_ps(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+    static raw load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+    static raw load(const float *p, mask m) noexcept { return _mm512_maskz_loadu_ps(m, p); }
+    static void store(float *p, raw v) noexcept { _mm512_storeu_ps(p, v); }
+    static void store(float *p, mask m, raw v) noexcept { _mm512_mask_storeu_ps(p, m, v); }
+
+    static mask window(ptrdiff_t lo, ptrdiff_t hi) noexcept
+    {
+        return static_cast<mask>(((1u << hi) - 1) & ~((1u << lo) - 1));
+    }
+
+    template <int K>
+    static raw concat(raw lo, raw hi) noexcept
+    {
+        if constexpr (K == 16) {
+            return hi;
+        } else {
+            return _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(hi), _mm512_castps_si512(lo), K));
+        }
+    }
+};
+
+template <>
+struct StencilLanes<DOUBLEX8>
+{
+    using scalar = double;
+    using raw    = __m512d;
+    using mask   = __mmask8;
+
+    static constexpr ptrdiff_t lanes = 8;
+
+    static raw zero() noexcept { return _mm512_setzero_pd(); }
+    static raw set1(double v) noexcept { return _mm512_set1_pd(v); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_pd(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+    static raw load(const double *p) noexcept { return _mm512_loadu_pd(p); }
+    static raw load(const double *p, mask m) noexcept { return _mm512_maskz_loadu_pd(m, p); }
+    static void store(double *p, raw v) noexcept { _mm512_storeu_pd(p, v); }
+    static void store(double *p, mask m, raw v) noexcept { _mm512_mask_storeu_pd(p, m, v); }
+
+    static mask window(ptrdiff_t lo, ptrdiff_t hi) noexcept
+    {
+        return static_cast<mask>(((1u << hi) - 1) & ~((1u << lo) - 1));
+    }
+
+    template <int K>
+    static raw concat(raw lo, raw hi) noexcept
+    {
+        if constexpr (K == 8) {
+            return hi;
+        } else {
+            return _mm512_castsi512_pd(_mm512_alignr_epi64(_mm512_castpd_si512(hi), _mm512_castpd_si512(lo), K));
+        }
+    }
+};
+#endif
+
+/* Mask rows, (dz, dy) pairs, with at least one nonzero weight */
+template <auto M>
+static constexpr size_t stencilRowCount() noexcept
+{
+    size_t count = 0;
+    for (size_t q = 0; q < M.rows; q++) {
+        bool used = false;
+        for (int x = 0; x < M.width; x++) {
+            used = used || M.w[q * M.width + x] != 0;
+        }
+        count += used;
+    }
+    return count;
+}
+
+template <auto M>
+static constexpr std::array<size_t, stencilRowCount<M>()> stencilRows() noexcept
+{
+    std::array<size_t, stencilRowCount<M>()> rows{};
+    size_t                                   count = 0;
+    for (size_t q = 0; q < M.rows; q++) {
+        bool used = false;
+        for (int x = 0; x < M.width; x++) {
+            used = used || M.w[q * M.width + x] != 0;
+        }
+        if (used) {
+            rows[count++] = q;
+        }
+    }
+    return rows;
+}
+
+/* The register at x shifted by S lanes, taken from the registers at x - L, x and x + L */
+template <class Ops, int S>
+static inline typename Ops::raw stencilShift(typename Ops::raw prev, typename Ops::raw cur, typename Ops::raw next) noexcept
+{
+    if constexpr (S < 0) {
+        return Ops::template concat<Ops::lanes + S>(prev, cur);
+    } else if constexpr (S > 0) {
+        return Ops::template concat<S>(cur, next);
+    } else {
+        return cur;
+    }
+}
+
+/* The nonzero weights of mask row Q against one register position */
+template <auto M, class Ops, size_t Q>
+static inline typename Ops::raw stencilTerms(typename Ops::raw prev, typename Ops::raw cur, typename Ops::raw next, typename Ops::raw acc) noexcept
+{
+    return [&]<size_t... X>(std::index_sequence<X...>) {
+        auto term = [&]<size_t I>() {
+            constexpr double weight = M.w[Q * M.width + I];
+            if constexpr (weight != 0) {
+                auto shifted = stencilShift<Ops, static_cast<int>(I) - M.radius>(prev, cur, next);
+                acc          = Ops::fmadd(shifted, Ops::set1(static_cast<typename Ops::scalar>(weight)), acc);
+            }
+        };
+        (term.template operator()<X>(), ...);
+        return acc;
+    }(std::make_index_sequence<M.width>{});
+}
+
+/* Outside [0, nx) reads as zero; only halo outputs ever see those lanes */
+template <class Ops>
+static inline typename Ops::raw stencilLoad(const typename Ops::scalar *row, ptrdiff_t x, ptrdiff_t nx) noexcept
+{
+    constexpr ptrdiff_t L = Ops::lanes;
+    if (x >= 0 && x + L <= nx) {
+        return Ops::load(row + x);
+    }
+    return Ops::load(row + x, Ops::window(std::clamp<ptrdiff_t>(-x, 0, L), std::clamp<ptrdiff_t>(nx - x, 0, L)));
+}
+
+/**
+ * Updates [x0, x1) of output row (z, y). Registers start at multiples of
+ * L from the row start and every input row keeps its previous and current
+ * register, so each input register is loaded once and its neighbour
+ * shifts come from concat instead of overlapping unaligned loads. Rows
+ * alternate between two accumulators to halve the fmadd chain. Only the
+ * blocks at either end of the row take masked loads and stores.
+ *
+ * Per-row work is a fold over compile-time row indices rather than a loop,
+ * so every array index is a constant and the row registers need not live
+ * in memory.
+ */
+template <auto M, class Ops>
+static inline void stencilRow(const StencilGrid &g, const typename Ops::scalar *src, typename Ops::scalar *dst, size_t z, size_t y,
+                              ptrdiff_t x0, ptrdiff_t x1) noexcept
+{
+    using scalar          = typename Ops::scalar;
+    using raw             = typename Ops::raw;
+    constexpr ptrdiff_t L = Ops::lanes;
+    constexpr size_t    N = stencilRowCount<M>();
+    constexpr ptrdiff_t R = M.radius;
+    static_assert(N > 0, "a stencil needs at least one nonzero weight");
+    static_assert(R <= L, "the radius must fit in one register");
+
+    auto forRows = [](auto &&fn) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (fn(std::integral_constant<size_t, I>{}), ...);
+        }(std::make_index_sequence<N>{});
+    };
+
+    const ptrdiff_t nx = static_cast<ptrdiff_t>(g.nx);
+    const ptrdiff_t ny = static_cast<ptrdiff_t>(g.ny);
+    const scalar   *in[N];
+    forRows([&](auto j) {
+        constexpr size_t    q  = stencilRows<M>()[j];
+        constexpr ptrdiff_t dz = M.dims == 3 ? static_cast<ptrdiff_t>(q / M.width) - R : 0;
+        constexpr ptrdiff_t dy = M.dims == 3 ? static_cast<ptrdiff_t>(q % M.width) - R : M.dims == 2 ? static_cast<ptrdiff_t>(q) - R : 0;
+        in[j]                  = src + ((static_cast<ptrdiff_t>(z) + dz) * ny + static_cast<ptrdiff_t>(y) + dy) * nx;
+    });
+    scalar *out = dst + (z * g.ny + y) * g.nx;
+
+    ptrdiff_t x = x0 - x0 % L;
+    raw       prev[N];
+    raw       cur[N];
+    forRows([&](auto j) {
+        prev[j] = stencilLoad<Ops>(in[j], x - L, nx);
+        cur[j]  = stencilLoad<Ops>(in[j], x, nx);
+    });
+
+    for (; x < x1; x += L) {
+        bool edge   = x < x0 || x + L > x1 || x + 2 * L > nx;
+        raw  acc[2] = { Ops::zero(), Ops::zero() };
+        forRows([&](auto j) {
+            raw next   = edge ? stencilLoad<Ops>(in[j], x + L, nx) : Ops::load(in[j] + x + L);
+            acc[j & 1] = stencilTerms<M, Ops, stencilRows<M>()[j]>(prev[j], cur[j], next, acc[j & 1]);
+            prev[j]    = cur[j];
+            cur[j]     = next;
+        });
+
+        raw sum = Ops::add(acc[0], acc[1]);
+        if (!edge) {
+            Ops::store(out + x, sum);
+        } else {
+            Ops::store(out + x, Ops::window(std::max<ptrdiff_t>(x0 - x, 0), std::min<ptrdiff_t>(x1 - x, L)), sum);
+        }
+    }
+}
+
+/**
+ * How a grid is cut for sweeping: slabs along the outermost stencil
+ * dimension (planes in 3D, rows in 2D, runs of STENCIL_SLAB_1D points in
+ * 1D), batches over the dimensions past D, and the reach of a slab into
+ * its neighbours, in slabs.
+ */
+struct StencilSweep
+{
+    size_t slabs;
+    size_t batches;
+    size_t lag;
+    size_t slabBytes;
+};
+
+template <auto M, class Ops>
+static inline StencilSweep stencilSweep(const StencilGrid &g) noexcept
+{
+    constexpr size_t R     = M.radius;
+    auto             inner = [](size_t n) { return n > 2 * R ? n - 2 * R : 0; };
+    if constexpr (M.dims == 3) {
+        return { inner(g.nx) != 0 && inner(g.ny) != 0 ? inner(g.nz) : 0, 1, R, g.nx * g.ny * sizeof(typename Ops::scalar) };
+    } else if constexpr (M.dims == 2) {
+        return { inner(g.nx) != 0 ? inner(g.ny) : 0, g.nz, R, g.nx * sizeof(typename Ops::scalar) };
+    } else {
+        return { (inner(g.nx) + STENCIL_SLAB_1D - 1) / STENCIL_SLAB_1D, g.ny * g.nz, 1, STENCIL_SLAB_1D * sizeof(typename Ops::scalar) };
+    }
+}
+
+/**
+ * Updates slabs [first, last) of one batch. 3D walks y in tiles whose
+ * 2R + 2 planes fit in half of L2 and 2D walks x in tiles whose 2R + 2
+ * rows fit in half of L1, so every input row is reused from cache by all
+ * 2R + 1 outputs that read it.
+ */
+template <auto M, class Ops>
+static inline void stencilSlabs(const StencilGrid &g, const typename Ops::scalar *src, typename Ops::scalar *dst, size_t batch, size_t first,
+                                size_t last) noexcept
+{
+    using scalar           = typename Ops::scalar;
+    constexpr size_t    R  = M.radius;
+    constexpr ptrdiff_t L  = Ops::lanes;
+    const CacheSizes    cs = cacheSizes();
+
+    /* A grid with no interior has no slabs, and g.ny - R below would wrap */
+    if (first >= last) {
+        return;
+    }
+
+    if constexpr (M.dims == 3) {
+        size_t tile = std::max<size_t>(cs.l2 / 2 / ((2 * R + 2) * g.nx * sizeof(scalar)), 2 * R + 1) - 2 * R;
+        for (size_t y0 = R; y0 < g.ny - R; y0 += tile) {
+            size_t y1 = std::min(y0 + tile, g.ny - R);
+            for (size_t p = first; p < last; p++) {
+                for (size_t y = y0; y < y1; y++) {
+                    stencilRow<M, Ops>(g, src, dst, p + R, y, R, static_cast<ptrdiff_t>(g.nx - R));
+                }
+            }
+        }
+    } else if constexpr (M.dims == 2) {
+        ptrdiff_t tile = static_cast<ptrdiff_t>(cs.l1 / 2 / ((2 * R + 2) * sizeof(scalar)));
+        tile           = std::max<ptrdiff_t>(tile - tile % L, L);
+        for (ptrdiff_t x0 = R; x0 < static_cast<ptrdiff_t>(g.nx - R); x0 += tile) {
+            ptrdiff_t x1 = std::min(x0 + tile, static_cast<ptrdiff_t>(g.nx - R));
+            for (size_t p = first; p < last; p++) {
+                stencilRow<M, Ops>(g, src, dst, batch, p + R, x0, x1);
+            }
+        }
+    } else {
+        for (size_t p = first; p < last; p++) {
+            ptrdiff_t x0 = static_cast<ptrdiff_t>(R + p * STENCIL_SLAB_1D);
+            ptrdiff_t x1 = std::min(x0 + static_cast<ptrdiff_t>(STENCIL_SLAB_1D), static_cast<ptrdiff_t>(g.nx - R));
+            stencilRow<M, Ops>(g, src, dst, batch / g.ny, batch % g.ny, x0, x1);
+        }
+    }
+}
+
+/* One time step, slabs split evenly over threads */
+template <auto M, class Ops>
+static inline void stencilStep(const StencilGrid &g, const typename Ops::scalar *src, typename Ops::scalar *dst, unsigned threads)
+{
+    StencilSweep sweep  = stencilSweep<M, Ops>(g);
+    size_t       points = g.nx * g.ny * g.nz / std::max<size_t>(sweep.batches, 1);
+    size_t       parts  = std::min<size_t>({ resolveThreads(threads), sweep.slabs, points / STENCIL_MIN_CHUNK });
+    parts               = std::max<size_t>(parts, 1);
+
+    for (size_t b = 0; b < sweep.batches; b++) {
+        parallelFor(parts, threads, [&](size_t part) {
+            stencilSlabs<M, Ops>(g, src, dst, b, sweep.slabs * part / parts, sweep.slabs * (part + 1) / parts);
+        });
+    }
+}
+
+/* Below this many fused steps in L2, a window in L3 is the better trade */
+static constexpr size_t STENCIL_MIN_FUSED = 4;
+
+/**
+ * Steps per wavefront group: the most whose window of slabs, in both
+ * buffers, fits in half of L2, or when that is fewer than
+ * STENCIL_MIN_FUSED, in a quarter of the L3 shared with the other cores.
+ */
+static inline size_t stencilFusedSteps(const StencilSweep &sweep) noexcept
+{
+    auto fit = [&](size_t budget) -> size_t {
+        size_t window = budget / (2 * std::max<size_t>(sweep.slabBytes, 1));
+        return window > 2 * sweep.lag + 1 ? (window - 2 * sweep.lag - 1) / sweep.lag : 0;
+    };
+
+    const CacheSizes cs    = cacheSizes();
+    size_t           fused = fit(cs.l2 / 2);
+    if (fused < STENCIL_MIN_FUSED && cs.l3 != 0) {
+        fused = std::max(fused, fit(cs.l3 / 4));
+    }
+    return fused;
+}
+
+/**
+ * Runs `levels` fused time steps as a wavefront. Step s of the group reads
+ * buffer (first + s - 1) & 1 and writes the other, and works on the slab
+ * `lag` slabs behind step s - 1, so a slab is read by the next step while
+ * it is still in cache and the steps two apart that share a buffer never
+ * overlap. Steps are dealt round robin to the threads; step s waits on
+ * the progress counter of step s - 1 before every slab.
+ */
+template <auto M, class Ops>
+static inline void stencilWavefront(const StencilGrid &g, typename Ops::scalar *const buffers[2], size_t batch, size_t first, size_t levels,
+                                    unsigned threads)
+{
+    StencilSweep sweep = stencilSweep<M, Ops>(g);
+    size_t       tasks = std::min<size_t>(resolveThreads(threads), levels);
+
+    std::vector<std::atomic<size_t>> done(levels + 1);
+    done[0].store(sweep.slabs, std::memory_order_relaxed);
+
+    parallelFor(tasks, static_cast<unsigned>(tasks), [&](size_t task) {
+        size_t end = (levels - 1) * sweep.lag + sweep.slabs;
+        for (size_t k = 0; k < end; k++) {
+            for (size_t s = task + 1; s <= levels; s += tasks) {
+                if (k < (s - 1) * sweep.lag || k - (s - 1) * sweep.lag >= sweep.slabs) {
+                    continue;
+                }
+                size_t p    = k - (s - 1) * sweep.lag;
+                size_t need = std::min(p + sweep.lag + 1, sweep.slabs);
+                while (done[s - 1].load(std::memory_order_acquire) < need) {
+                    std::this_thread::yield();
+                }
+                size_t step = first + s;
+                stencilSlabs<M, Ops>(g, buffers[(step - 1) & 1], buffers[step & 1], batch, p, p + 1);
+                done[s].store(p + 1, std::memory_order_release);
+            }
+        }
+    });
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief One stencil application, dst = M * src over the grid interior; the halo of dst is left as it is
+ *
+ * V picks the register: FLOATX8 or DOUBLEX4, or FLOATX16 or DOUBLEX8 with
+ * AVX-512. threads = 0 uses every hardware thread.
+ */
+template <auto M, class V = slimm::detail::StencilFloat>
+static inline void stencilApply(const typename slimm::detail::StencilLanes<V>::scalar *src, typename slimm::detail::StencilLanes<V>::scalar *dst,
+                                const StencilGrid &grid, unsigned threads = 1)
+{
+    slimm::detail::stencilStep<M, slimm::detail::StencilLanes<V>>(grid, src, dst, threads);
+}
+
+/**
+ * @brief Runs steps time steps ping-ponging between a and b, and returns the buffer holding the result
+ *
+ * b starts as a copy of a, which gives both buffers the same halo. As many
+ * steps as stencilFusedSteps allows are fused into one wavefront pass,
+ * which is where temporal blocking pays: the grid streams from memory
+ * once per group instead of once per step. Slabs too large for even two
+ * fused steps fall back to one spatially blocked step at a time.
+ */
+template <auto M, class V = slimm::detail::StencilFloat>
+static inline typename slimm::detail::StencilLanes<V>::scalar *stencilRun(typename slimm::detail::StencilLanes<V>::scalar *a,
+                                                                          typename slimm::detail::StencilLanes<V>::scalar *b,
+                                                                          const StencilGrid &grid, size_t steps, unsigned threads = 1)
+{
+    using Ops = slimm::detail::StencilLanes<V>;
+
+    typename Ops::scalar *const buffers[2] = { a, b };
+    if (steps == 0) {
+        return a;
+    }
+    std::copy(a, a + grid.nx * grid.ny * grid.nz, b);
+
+    auto   sweep = slimm::detail::stencilSweep<M, Ops>(grid);
+    size_t fused = slimm::detail::stencilFusedSteps(sweep);
+
+    if (fused < 2 || sweep.slabs < 2 * sweep.lag + 1) {
+        for (size_t s = 0; s < steps; s++) {
+            slimm::detail::stencilStep<M, Ops>(grid, buffers[s & 1], buffers[(s + 1) & 1], threads);
+        }
+        return buffers[steps & 1];
+    }
+
+    for (size_t b = 0; b < sweep.batches; b++) {
+        for (size_t s = 0; s < steps; s += fused) {
+            slimm::detail::stencilWavefront<M, Ops>(grid, buffers, b, s, std::min(fused, steps - s), threads);
+        }
+    }
+    return buffers[steps & 1];
+}
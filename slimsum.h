@@ -0,0 +1,389 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "slimmintrin.h"
+#include "slimparallel.h"
+
+/*
+ * The compensated policies rely on the compiler keeping every rounding
+ * step; -ffast-math or -fassociative-math folds the error terms to zero.
+ */
+enum class SumPolicy
+{
+    Naive,       /* plain vector accumulation, error grows with n */
+    Pairwise,    /* blocked pairwise tree, error grows with log n */
+    Kahan,       /* Kahan compensation, loses track once an addend outgrows the sum */
+    Compensated, /* Neumaier sums and Dot2 dot products, as if computed in twice the precision */
+};
+
+namespace slimm::detail
+{
+
+template <class T>
+struct SumLanes;
+
+template <>
+struct SumLanes<float>
+{
+#if defined(__AVX512F__)
+    using raw = __m512;
+
+    static constexpr size_t lanes = 16;
+
+    static raw zero() noexcept { return _mm512_setzero_ps(); }
+    static raw loadu(const float *p) noexcept { return _mm512_loadu_ps(p); }
+    static raw loadPartial(const float *p, size_t n) noexcept { return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1), p); }
+    static void storeu(float *p, raw v) noexcept { _mm512_storeu_ps(p, v); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_ps(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm512_sub_ps(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm512_mul_ps(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+    static raw fmsub(raw a, raw b, raw c) noexcept { return _mm512_fmsub_ps(a, b, c); }
+    static float sum(raw v) noexcept { return _mm512_reduce_add_ps(v); }
+#else
+    using raw = __m256;
+
+    static constexpr size_t lanes = 8;
+
+    static raw zero() noexcept { return _mm256_setzero_ps(); }
+    static raw loadu(const float *p) noexcept { return _mm256_loadu_ps(p); }
+    static void storeu(float *p, raw v) noexcept { _mm256_storeu_ps(p, v); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_ps(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm256_sub_ps(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm256_mul_ps(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+    static raw fmsub(raw a, raw b, raw c) noexcept { return _mm256_fmsub_ps(a, b, c); }
+
+    static raw loadPartial(const float *p, size_t n) noexcept
+    {
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        return _mm256_maskload_ps(p, mask);
+    }
+
+    static float sum(raw v) noexcept
+    {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s        = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        s        = _mm_add_ss(s, _mm_movehdup_ps(s));
+        return _mm_cvtss_f32(s);
+    }
+#endif
+};
+
+template <>
+struct SumLanes<double>
+{
+#if defined(__AVX512F__)
+    using raw = __m512d;
+
+    static constexpr size_t lanes = 8;
+
+    static raw zero() noexcept { return _mm512_setzero_pd(); }
+    static raw loadu(const double *p) noexcept { return _mm512_loadu_pd(p); }
+    static raw loadPartial(const double *p, size_t n) noexcept { return _mm512_maskz_loadu_pd(static_cast<__mmask8>((1u << n) - 1), p); }
+    static void storeu(double *p, raw v) noexcept { _mm512_storeu_pd(p, v); }
+    static raw add(raw a, raw b) noexcept { return _mm512_add_pd(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm512_sub_pd(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm512_mul_pd(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+    static raw fmsub(raw a, raw b, raw c) noexcept { return _mm512_fmsub_pd(a, b, c); }
+    static double sum(raw v) noexcept { return _mm512_reduce_add_pd(v); }
+#else
+    using raw = __m256d;
+
+    static constexpr size_t lanes = 4;
+
+    static raw zero() noexcept { return _mm256_setzero_pd(); }
+    static raw loadu(const double *p) noexcept { return _mm256_loadu_pd(p); }
+    static void storeu(double *p, raw v) noexcept { _mm256_storeu_pd(p, v); }
+    static raw add(raw a, raw b) noexcept { return _mm256_add_pd(a, b); }
+    static raw sub(raw a, raw b) noexcept { return _mm256_sub_pd(a, b); }
+    static raw mul(raw a, raw b) noexcept { return _mm256_mul_pd(a, b); }
+    static raw fmadd(raw a, raw b, raw c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+    static raw fmsub(raw a, raw b, raw c) noexcept { return _mm256_fmsub_pd(a, b, c); }
+
+    static raw loadPartial(const double *p, size_t n) noexcept
+    {
+        __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)), _mm256_setr_epi64x(0, 1, 2, 3));
+        return _mm256_maskload_pd(p, mask);
+    }
+
+    static double sum(raw v) noexcept
+    {
+        __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+    }
+#endif
+};
+
+/* Independent accumulators per kernel, enough to cover the add latency */
+constexpr size_t SUM_UNROLL = 4;
+/* Registers each accumulator adds plainly before the pairwise tree takes over */
+constexpr size_t PAIRWISE_DEPTH = 16;
+/* Below this many elements per thread a second thread costs more than it saves */
+constexpr size_t SUM_MIN_CHUNK = 1 << 18;
+
+/* A sum carried as an unevaluated pair: the value is sum + err */
+template <class T>
+struct SumPartial
+{
+    T sum;
+    T err;
+};
+
+/* Knuth's TwoSum: s + e equals a + b exactly, whichever of them is larger */
+template <class T>
+static inline T twoSum(T a, T b, T &e) noexcept
+{
+    T s = a + b;
+    T z = s - a;
+    e   = (a - (s - z)) + (b - z);
+    return s;
+}
+
+template <class Ops>
+static inline typename Ops::raw twoSum(typename Ops::raw a, typename Ops::raw b, typename Ops::raw &e) noexcept
+{
+    auto s = Ops::add(a, b);
+    auto z = Ops::sub(s, a);
+    e      = Ops::add(Ops::sub(a, Ops::sub(s, z)), Ops::sub(b, z));
+    return s;
+}
+
+template <class T>
+static inline SumPartial<T> mergePartial(SumPartial<T> a, SumPartial<T> b) noexcept
+{
+    T e;
+    T s = twoSum(a.sum, b.sum, e);
+    return {s, a.err + b.err + e};
+}
+
+/*
+ * One step of policy P on register x, or on the products a * b for dot
+ * products. Kahan keeps the negated error in c; Compensated keeps the
+ * error itself and, for dot products, also the rounding error of the
+ * product, which an FMA recovers exactly (Ogita, Rump and Oishi's Dot2).
+ */
+template <class Ops, SumPolicy P, bool DOT>
+static inline void sumStep(typename Ops::raw &s, typename Ops::raw &c, typename Ops::raw a, typename Ops::raw b) noexcept
+{
+    if constexpr (P == SumPolicy::Compensated) {
+        auto x = DOT ? Ops::mul(a, b) : a;
+        typename Ops::raw e;
+        s = twoSum<Ops>(s, x, e);
+        c = Ops::add(c, DOT ? Ops::add(e, Ops::fmsub(a, b, x)) : e);
+    } else if constexpr (P == SumPolicy::Kahan) {
+        auto y = Ops::sub(DOT ? Ops::mul(a, b) : a, c);
+        auto t = Ops::add(s, y);
+        c      = Ops::sub(Ops::sub(t, s), y);
+        s      = t;
+    } else if constexpr (DOT) {
+        s = Ops::fmadd(a, b, s);
+    } else {
+        s = Ops::add(s, a);
+    }
+}
+
+/*
+ * Runs policy P over n elements with SUM_UNROLL accumulator pairs and
+ * folds them into one pair of registers. The tail is a zero-padded load,
+ * which every policy adds exactly.
+ */
+template <class T, SumPolicy P, bool DOT>
+static inline void sumBlock(const T *a, const T *b, size_t n, typename SumLanes<T>::raw &sum, typename SumLanes<T>::raw &err) noexcept
+{
+    using Ops          = SumLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    typename Ops::raw s[SUM_UNROLL], c[SUM_UNROLL];
+    for (size_t u = 0; u < SUM_UNROLL; u++) {
+        s[u] = Ops::zero();
+        c[u] = Ops::zero();
+    }
+    auto step = [&](size_t u, typename Ops::raw x, const T *y, size_t r) {
+        typename Ops::raw w = x;
+        if constexpr (DOT) {
+            w = r == L ? Ops::loadu(y) : Ops::loadPartial(y, r);
+        }
+        sumStep<Ops, P, DOT>(s[u], c[u], x, w);
+    };
+
+    size_t i = 0;
+    for (; i + SUM_UNROLL * L <= n; i += SUM_UNROLL * L) {
+        for (size_t u = 0; u < SUM_UNROLL; u++) {
+            step(u, Ops::loadu(a + i + u * L), DOT ? b + i + u * L : nullptr, L);
+        }
+    }
+    for (; i + L <= n; i += L) {
+        step(0, Ops::loadu(a + i), DOT ? b + i : nullptr, L);
+    }
+    if (i < n) {
+        step(0, Ops::loadPartial(a + i, n - i), DOT ? b + i : nullptr, n - i);
+    }
+
+    if constexpr (P == SumPolicy::Kahan) {
+        for (size_t u = 0; u < SUM_UNROLL; u++) {
+            c[u] = Ops::sub(Ops::zero(), c[u]);
+        }
+    }
+    sum = s[0];
+    err = c[0];
+    for (size_t u = 1; u < SUM_UNROLL; u++) {
+        if constexpr (P == SumPolicy::Naive || P == SumPolicy::Pairwise) {
+            sum = Ops::add(sum, s[u]);
+        } else {
+            typename Ops::raw e;
+            sum = twoSum<Ops>(sum, s[u], e);
+            err = Ops::add(Ops::add(err, c[u]), e);
+        }
+    }
+}
+
+/* Plain blocks at the leaves, halved on register boundaries above them */
+template <class T, bool DOT>
+static inline typename SumLanes<T>::raw pairwiseSum(const T *a, const T *b, size_t n) noexcept
+{
+    using Ops          = SumLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    if (n <= SUM_UNROLL * PAIRWISE_DEPTH * L) {
+        typename Ops::raw sum, err;
+        sumBlock<T, SumPolicy::Pairwise, DOT>(a, b, n, sum, err);
+        return sum;
+    }
+    size_t half = n / 2 / L * L;
+    return Ops::add(pairwiseSum<T, DOT>(a, b, half), pairwiseSum<T, DOT>(a + half, DOT ? b + half : nullptr, n - half));
+}
+
+template <class T, SumPolicy P, bool DOT>
+static inline SumPartial<T> sumPartial(const T *a, const T *b, size_t n) noexcept
+{
+    using Ops          = SumLanes<T>;
+    constexpr size_t L = Ops::lanes;
+
+    if constexpr (P == SumPolicy::Pairwise) {
+        return {Ops::sum(pairwiseSum<T, DOT>(a, b, n)), 0};
+    } else {
+        typename Ops::raw sum, err;
+        sumBlock<T, P, DOT>(a, b, n, sum, err);
+        if constexpr (P == SumPolicy::Naive) {
+            return {Ops::sum(sum), 0};
+        } else {
+            T s[L], c[L];
+            Ops::storeu(s, sum);
+            Ops::storeu(c, err);
+            SumPartial<T> total{s[0], c[0]};
+            for (size_t l = 1; l < L; l++) {
+                total = mergePartial(total, SumPartial<T>{s[l], c[l]});
+            }
+            return total;
+        }
+    }
+}
+
+/* Every thread reduces a contiguous chunk; the chunk results are merged with compensation */
+template <class T, SumPolicy P, bool DOT>
+static inline T parallelSum(const T *a, const T *b, size_t n, unsigned threads)
+{
+    threads       = resolveThreads(threads);
+    size_t chunks = std::min<size_t>(threads, n / SUM_MIN_CHUNK);
+    if (chunks <= 1) {
+        auto total = sumPartial<T, P, DOT>(a, b, n);
+        return total.sum + total.err;
+    }
+
+    size_t chunk = (n + chunks - 1) / chunks;
+    std::vector<SumPartial<T>> partial(chunks);
+    parallelFor(chunks, threads, [&](size_t k) {
+        size_t begin = k * chunk;
+        partial[k]   = sumPartial<T, P, DOT>(a + begin, DOT ? b + begin : nullptr, std::min(chunk, n - begin));
+    });
+
+    SumPartial<T> total = partial[0];
+    for (size_t k = 1; k < chunks; k++) {
+        total = mergePartial(total, partial[k]);
+    }
+    return total.sum + total.err;
+}
+
+} // namespace slimm::detail
+
+/**
+ * @brief Sum of n values under policy P
+ *
+ * Naive and Pairwise run at full load bandwidth; Kahan and Compensated
+ * cost a few more adds per register, which stays below the load cost
+ * once the input is out of cache.
+ */
+template <SumPolicy P = SumPolicy::Compensated>
+static inline float reduceSum(const float *src, size_t n) noexcept
+{
+    auto total = slimm::detail::sumPartial<float, P, false>(src, nullptr, n);
+    return total.sum + total.err;
+}
+
+template <SumPolicy P = SumPolicy::Compensated>
+static inline double reduceSum(const double *src, size_t n) noexcept
+{
+    auto total = slimm::detail::sumPartial<double, P, false>(src, nullptr, n);
+    return total.sum + total.err;
+}
+
+/**
+ * @brief Sum of a[i] * b[i] over n values under policy P
+ *
+ * Compensated is Dot2: every product is split exactly with an FMA, so the
+ * result is as accurate as a dot product in twice the precision rounded
+ * once. Kahan compensates the additions only.
+ */
+template <SumPolicy P = SumPolicy::Compensated>
+static inline float dotProduct(const float *a, const float *b, size_t n) noexcept
+{
+    auto total = slimm::detail::sumPartial<float, P, true>(a, b, n);
+    return total.sum + total.err;
+}
+
+template <SumPolicy P = SumPolicy::Compensated>
+static inline double dotProduct(const double *a, const double *b, size_t n) noexcept
+{
+    auto total = slimm::detail::sumPartial<double, P, true>(a, b, n);
+    return total.sum + total.err;
+}
+
+/**
+ * @brief Multithreaded reduceSum for large arrays; threads = 0 uses every hardware thread
+ */
+template <SumPolicy P = SumPolicy::Compensated>
+static inline float parallelReduceSum(const float *src, size_t n, unsigned threads = 0)
+{
+    return slimm::detail::parallelSum<float, P, false>(src, nullptr, n, threads);
+}
+
+template <SumPolicy P = SumPolicy::Compensated>
+static inline double parallelReduceSum(const double *src, size_t n, unsigned threads = 0)
+{
+    return slimm::detail::parallelSum<double, P, false>(src, nullptr, n, threads);
+}
+
+/**
+ * @brief Multithreaded dotProduct for large arrays; threads = 0 uses every hardware thread
+ */
+template <SumPolicy P = SumPolicy::Compensated>
+static inline float parallelDotProduct(const float *a, const float *b, size_t n, unsigned threads = 0)
+{
+    return slimm::detail::parallelSum<float, P, true>(a, b, n, threads);
+}
+
+template <SumPolicy P = SumPolicy::Compensated>
+static inline double parallelDotProduct(const double *a, const double *b, size_t n, unsigned threads = 0)
+{
+    return slimm::detail::parallelSum<double, P, true>(a, b, n, threads);
+}
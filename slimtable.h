@@ -0,0 +1,361 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "slimmintrin.h"
+
+namespace slimm::detail
+{
+
+/* Fibonacci hashing: the top bits of key * 2^w / phi pick the home slot */
+static constexpr uint32_t TABLE_MUL32 = 0x9E3779B1U;
+static constexpr uint64_t TABLE_MUL64 = 0x9E3779B97F4A7C15ULL;
+
+static inline size_t tableSlot(int32_t key, unsigned shift) noexcept
+{
+    return (static_cast<uint32_t>(key) * TABLE_MUL32) >> shift;
+}
+
+static inline size_t tableSlot(int64_t key, unsigned shift) noexcept
+{
+    return static_cast<size_t>((static_cast<uint64_t>(key) * TABLE_MUL64) >> shift);
+}
+
+#if defined(__AVX512F__)
+/**
+ * Lane operations of the batched probe: 16 int32 keys per INT32X16 or
+ * 8 int64 keys per INT64X8, slots kept as lane indices of the same width.
+ */
+template <class K>
+struct ProbeLanes;
+
+template <>
+struct ProbeLanes<int32_t>
+{
+    using raw   = __m512i;
+    using mask  = __mmask16;
+    using value = __m512i;
+
+    static constexpr size_t lanes = 16;
+
+    static raw loadu(const int32_t *p) noexcept { return INT32X16(_mm512_loadu_si512(p)); }
+    static raw set1(int32_t x) noexcept { return _mm512_set1_epi32(x); }
+    static mask eq(mask m, raw a, raw b) noexcept { return _mm512_mask_cmpeq_epi32_mask(m, a, b); }
+    static raw next(raw slot, raw wrap) noexcept { return _mm512_and_si512(_mm512_add_epi32(slot, _mm512_set1_epi32(1)), wrap); }
+    static raw wrap(size_t capacity) noexcept { return _mm512_set1_epi32(static_cast<int>(capacity - 1)); }
+
+    static raw hash(raw key, unsigned shift) noexcept
+    {
+        return _mm512_srlv_epi32(_mm512_mullo_epi32(key, _mm512_set1_epi32(static_cast<int>(TABLE_MUL32))), _mm512_set1_epi32(static_cast<int>(shift)));
+    }
+
+    static raw gatherKeys(raw src, mask m, raw slot, const int32_t *keys) noexcept
+    {
+        return _mm512_mask_i32gather_epi32(src, m, slot, keys, 4);
+    }
+
+    static value gatherValues(value src, mask m, raw slot, const uint32_t *values) noexcept
+    {
+        return _mm512_mask_i32gather_epi32(src, m, slot, values, 4);
+    }
+
+    static void storeSlots(size_t *dst, raw slot) noexcept
+    {
+        alignas(64) uint32_t s[lanes];
+        _mm512_store_si512(s, slot);
+        for (size_t i = 0; i < lanes; i++) {
+            dst[i] = s[i];
+        }
+    }
+
+    static void compressRows(uint32_t *rows, mask m, size_t row) noexcept
+    {
+        const __m512i iota = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        _mm512_mask_compressstoreu_epi32(rows, m, _mm512_add_epi32(iota, _mm512_set1_epi32(static_cast<int>(row))));
+    }
+
+    static void compressValues(uint32_t *values, mask m, value v) noexcept
+    {
+        _mm512_mask_compressstoreu_epi32(values, m, v);
+    }
+};
+
+template <>
+struct ProbeLanes<int64_t>
+{
+    using raw   = __m512i;
+    using mask  = __mmask8;
+    using value = __m256i;
+
+    static constexpr size_t lanes = 8;
+
+    static raw loadu(const int64_t *p) noexcept { return INT64X8(_mm512_loadu_si512(p)); }
+    static raw set1(int64_t x) noexcept { return _mm512_set1_epi64(x); }
+    static mask eq(mask m, raw a, raw b) noexcept { return _mm512_mask_cmpeq_epi64_mask(m, a, b); }
+    static raw next(raw slot, raw wrap) noexcept { return _mm512_and_si512(_mm512_add_epi64(slot, _mm512_set1_epi64(1)), wrap); }
+    static raw wrap(size_t capacity) noexcept { return _mm512_set1_epi64(static_cast<int64_t>(capacity - 1)); }
+
+    static raw hash(raw key, unsigned shift) noexcept
+    {
+#if defined(__AVX512DQ__)
+        raw h = _mm512_mullo_epi64(key, _mm512_set1_epi64(static_cast<int64_t>(TABLE_MUL64)));
+#else
+        const raw c  = _mm512_set1_epi64(static_cast<int64_t>(TABLE_MUL64));
+        raw       lo = _mm512_mul_epu32(key, c);
+        raw       hi = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(key, 32), c), _mm512_mul_epu32(key, _mm512_srli_epi64(c, 32)));
+        raw       h  = _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32));
+#endif
+        return _mm512_srlv_epi64(h, _mm512_set1_epi64(shift));
+    }
+
+    static raw gatherKeys(raw src, mask m, raw slot, const int64_t *keys) noexcept
+    {
+        return _mm512_mask_i64gather_epi64(src, m, slot, keys, 8);
+    }
+
+    static value gatherValues(value src, mask m, raw slot, const uint32_t *values) noexcept
+    {
+        return _mm512_mask_i64gather_epi32(src, m, slot, values, 4);
+    }
+
+    static void storeSlots(size_t *dst, raw slot) noexcept
+    {
+        _mm512_storeu_si512(dst, slot);
+    }
+
+    static void compressRows(uint32_t *rows, mask m, size_t row) noexcept
+    {
+        const __m256i iota = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        _mm256_mask_compressstoreu_epi32(rows, m, _mm256_add_epi32(iota, _mm256_set1_epi32(static_cast<int>(row))));
+    }
+
+    static void compressValues(uint32_t *values, mask m, value v) noexcept
+    {
+        _mm256_mask_compressstoreu_epi32(values, m, v);
+    }
+};
+#endif
+
+} // namespace slimm::detail
+
+/**
+ * Open-addressing hash table with linear probing from int32_t or int64_t
+ * keys to 32-bit values such as build-side row ids.
+ *
+ * Keys and values live in separate arrays so that a probe can gather a
+ * register of bucket keys at once. The table doubles whenever it becomes
+ * half full. The smallest key value marks empty slots and cannot be
+ * inserted. Slots are gathered through 32-bit indices for int32_t keys,
+ * which caps those tables at 2^31 slots.
+ */
+template <class K>
+class HashTable
+{
+    static_assert(std::is_same_v<K, int32_t> || std::is_same_v<K, int64_t>, "HashTable supports int32_t and int64_t keys");
+
+public:
+    static constexpr K EMPTY = std::numeric_limits<K>::min();
+
+    explicit HashTable(size_t expected = 0)
+    {
+        size_t capacity = 16;
+        while (capacity < 2 * expected) {
+            capacity *= 2;
+        }
+        reset(capacity);
+    }
+
+    size_t size() const noexcept
+    {
+        return count;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return keys.size();
+    }
+
+    /**
+     * @brief Maps key to value, replacing any previous value; returns false for the reserved EMPTY key
+     */
+    bool insert(K key, uint32_t value)
+    {
+        if (key == EMPTY) {
+            return false;
+        }
+        if (2 * (count + 1) > keys.size()) {
+            grow();
+        }
+
+        size_t slot = slimm::detail::tableSlot(key, shift);
+        while (keys[slot] != EMPTY && keys[slot] != key) {
+            slot = (slot + 1) & (keys.size() - 1);
+        }
+        count += keys[slot] == EMPTY;
+        keys[slot]   = key;
+        values[slot] = value;
+        return true;
+    }
+
+    /**
+     * @brief Inserts n pairs, prefetching the home slots of the pairs prefetch positions ahead
+     */
+    void insert(const K *src, const uint32_t *vals, size_t n, size_t prefetch = 16)
+    {
+        if (2 * (count + n) > keys.size()) {
+            size_t capacity = keys.size();
+            while (2 * (count + n) > capacity) {
+                capacity *= 2;
+            }
+            rehash(capacity);
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (prefetch != 0 && i + prefetch < n) {
+                prefetchSlot(slimm::detail::tableSlot(src[i + prefetch], shift));
+            }
+            insert(src[i], vals[i]);
+        }
+    }
+
+    /**
+     * @brief Returns the value of key, or nullptr if it is absent
+     */
+    const uint32_t *find(K key) const noexcept
+    {
+        if (key == EMPTY) {
+            return nullptr;
+        }
+        size_t slot = slimm::detail::tableSlot(key, shift);
+        for (;;) {
+            if (keys[slot] == key) {
+                return &values[slot];
+            }
+            if (keys[slot] == EMPTY) {
+                return nullptr;
+            }
+            slot = (slot + 1) & (keys.size() - 1);
+        }
+    }
+
+    /**
+     * @brief Looks up n keys; writes the row of every key that is present and its value, returns how many
+     *
+     * rows and out need room for n entries and come out in ascending row
+     * order. With AVX-512 a register of 16 int32 or 8 int64 keys is hashed,
+     * the bucket keys are gathered and compared, and lanes that hit neither
+     * their key nor an empty slot move to the next slot and loop under a
+     * mask until the whole register is resolved. The home slots of the batch
+     * prefetch batches ahead are prefetched meanwhile; 0 disables it.
+     */
+    size_t probe(const K *src, size_t n, uint32_t *rows, uint32_t *out, size_t prefetch = 4) const noexcept
+    {
+        size_t found = 0;
+        size_t i     = 0;
+
+#if defined(__AVX512F__)
+        using Ops = slimm::detail::ProbeLanes<K>;
+        constexpr size_t B = Ops::lanes;
+
+        const auto wrap  = Ops::wrap(keys.size());
+        const auto empty = Ops::set1(EMPTY);
+        for (; i + B <= n; i += B) {
+            if (prefetch != 0 && i + (prefetch + 1) * B <= n) {
+                prefetchBatch<Ops>(src + i + prefetch * B);
+            }
+
+            auto key    = Ops::loadu(src + i);
+            auto slot   = Ops::hash(key, shift);
+            auto active = static_cast<typename Ops::mask>(~Ops::eq(static_cast<typename Ops::mask>(-1), key, empty));
+            typename Ops::mask hits = 0;
+            typename Ops::value value{};
+            while (active != 0) {
+                auto bucket = Ops::gatherKeys(empty, active, slot, keys.data());
+                auto hit    = Ops::eq(active, bucket, key);
+                value   = Ops::gatherValues(value, hit, slot, values.data());
+                hits   |= hit;
+                active &= static_cast<typename Ops::mask>(~(hit | Ops::eq(active, bucket, empty)));
+                slot    = Ops::next(slot, wrap);
+            }
+            Ops::compressRows(rows + found, hits, i);
+            Ops::compressValues(out + found, hits, value);
+            found += static_cast<size_t>(_mm_popcnt_u32(hits));
+        }
+#else
+        for (; i < n; i++) {
+            if (prefetch != 0 && i + prefetch * 8 < n) {
+                prefetchSlot(slimm::detail::tableSlot(src[i + prefetch * 8], shift));
+            }
+            if (auto v = find(src[i])) {
+                rows[found] = static_cast<uint32_t>(i);
+                out[found]  = *v;
+                found++;
+            }
+        }
+#endif
+
+        for (; i < n; i++) {
+            if (auto v = find(src[i])) {
+                rows[found] = static_cast<uint32_t>(i);
+                out[found]  = *v;
+                found++;
+            }
+        }
+        return found;
+    }
+
+private:
+    void reset(size_t capacity)
+    {
+        keys.assign(capacity, EMPTY);
+        values.assign(capacity, 0);
+        count = 0;
+        shift = static_cast<unsigned>(sizeof(K) * 8 - static_cast<unsigned>(std::countr_zero(capacity)));
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<K>        oldKeys   = std::move(keys);
+        std::vector<uint32_t> oldValues = std::move(values);
+        reset(capacity);
+        for (size_t i = 0; i < oldKeys.size(); i++) {
+            if (oldKeys[i] != EMPTY) {
+                insert(oldKeys[i], oldValues[i]);
+            }
+        }
+    }
+
+    void grow()
+    {
+        rehash(keys.size() * 2);
+    }
+
+    void prefetchSlot(size_t slot) const noexcept
+    {
+        _mm_prefetch(reinterpret_cast<const char *>(&keys[slot]), _MM_HINT_T0);
+        _mm_prefetch(reinterpret_cast<const char *>(&values[slot]), _MM_HINT_T0);
+    }
+
+    template <class Ops>
+    void prefetchBatch(const K *src) const noexcept
+    {
+        size_t slots[Ops::lanes];
+        Ops::storeSlots(slots, Ops::hash(Ops::loadu(src), shift));
+        for (size_t slot : slots) {
+            prefetchSlot(slot);
+        }
+    }
+
+    std::vector<K>        keys;
+    std::vector<uint32_t> values;
+    size_t                count = 0;
+    unsigned              shift = 0;
+};
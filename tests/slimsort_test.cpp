@@ -0,0 +1,271 @@
+/**
+ * Copyright (C) 2021-2022, by Wu Jianhua (toqsxw@outlook.com)
+ *
+ * This library is distributed under the Apache-2.0 license.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "../slimsort.h"
+
+static int failures = 0;
+
+#define EXPECT(cond)                                                        \
+    do {                                                                    \
+        if (!(cond)) {                                                      \
+            std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+/* The largest key, which is also what the sorting networks pad their tail with */
+template <class T>
+static T highest()
+{
+    return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+}
+
+/* Small keys mixed with the highest and lowest ones */
+template <class T>
+static std::vector<T> sentinelKeys(size_t n, std::mt19937 &rng)
+{
+    const T hi = highest<T>();
+    const T lo = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::min();
+
+    std::vector<T> keys(n);
+    for (auto &k : keys) {
+        unsigned r = rng() % 4;
+        k = r == 0 ? hi : r == 1 ? lo : static_cast<T>(rng() % 8);
+    }
+    return keys;
+}
+
+/* Equal, or both NaN */
+template <class T>
+static bool same(T a, T b)
+{
+    return a == b || (a != a && b != b);
+}
+
+/* Every payload is a distinct index, so each must still sit next to the key it started with */
+template <class T, class P>
+static bool paired(const std::vector<T> &original, const std::vector<T> &keys, const std::vector<P> &vals)
+{
+    std::vector<bool> seen(original.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (vals[i] >= original.size() || seen[vals[i]] || !same(original[vals[i]], keys[i])) {
+            return false;
+        }
+        seen[vals[i]] = true;
+    }
+    return true;
+}
+
+template <class T>
+static void testKeyValue()
+{
+    using P = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+    std::mt19937 rng(42);
+    for (size_t n : {1, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 64, 65, 100, 1000}) {
+        for (int round = 0; round < 8; round++) {
+            const std::vector<T> original = sentinelKeys<T>(n, rng);
+            std::vector<T>       sorted   = original;
+            std::sort(sorted.begin(), sorted.end());
+
+            std::vector<T> keys = original;
+            std::vector<P> vals(n);
+            std::iota(vals.begin(), vals.end(), P(0));
+            sort(keys.data(), vals.data(), n);
+            EXPECT(keys == sorted);
+            EXPECT(paired(original, keys, vals));
+
+            std::vector<P> indices(n);
+            argsort(original.data(), indices.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                EXPECT(original[indices[i]] == sorted[i]);
+            }
+            EXPECT(paired(original, sorted, indices));
+        }
+    }
+
+    /* n = 7 with four pad-valued keys */
+    const T        hi = highest<T>();
+    std::vector<T> keys{5, hi, 1, hi, hi, 2, hi};
+    std::vector<P> vals{0, 1, 2, 3, 4, 5, 6};
+    const auto     original = keys;
+    sort(keys.data(), vals.data(), keys.size());
+    EXPECT(paired(original, keys, vals));
+}
+
+/* Small keys, infinities and about one NaN in four */
+template <class T>
+static std::vector<T> nanKeys(size_t n, std::mt19937 &rng)
+{
+    std::vector<T> keys = sentinelKeys<T>(n, rng);
+    for (auto &k : keys) {
+        if (rng() % 4 == 0) {
+            k = std::numeric_limits<T>::quiet_NaN();
+        }
+    }
+    return keys;
+}
+
+/* The ascending non-NaN keys followed by as many NaNs as the input holds */
+template <class T>
+static std::vector<T> nanSorted(const std::vector<T> &keys)
+{
+    std::vector<T> sorted;
+    for (T k : keys) {
+        if (k == k) {
+            sorted.push_back(k);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    sorted.resize(keys.size(), std::numeric_limits<T>::quiet_NaN());
+    return sorted;
+}
+
+template <class T>
+static bool sameKeys(const std::vector<T> &a, const std::vector<T> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](T x, T y) { return same(x, y); });
+}
+
+template <class T>
+static void testNthElement()
+{
+    using P = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+    std::mt19937 rng(7);
+    for (size_t n : {1, 7, 15, 16, 17, 31, 33, 64, 100, 1000}) {
+        for (int round = 0; round < 8; round++) {
+            const std::vector<T> original = sentinelKeys<T>(n, rng);
+            std::vector<T>       sorted   = original;
+            std::sort(sorted.begin(), sorted.end());
+
+            size_t         k    = rng() % n;
+            std::vector<T> keys = original;
+            std::vector<P> vals(n);
+            std::iota(vals.begin(), vals.end(), P(0));
+            nthElement(keys.data(), vals.data(), n, k);
+            EXPECT(keys[k] == sorted[k]);
+            EXPECT(paired(original, keys, vals));
+            for (size_t i = 0; i < n; i++) {
+                EXPECT(i < k ? !(keys[k] < keys[i]) : !(keys[i] < keys[k]));
+            }
+
+            keys = original;
+            nthElement(keys.data(), n, k);
+            EXPECT(keys[k] == sorted[k]);
+        }
+    }
+
+    /* Keys {5, MAX, 1, MAX, MAX, 2, MAX}: payload 1 used to be lost and 0 duplicated */
+    const T        hi = highest<T>();
+    std::vector<T> keys{5, hi, 1, hi, hi, 2, hi};
+    std::vector<P> vals{0, 1, 2, 3, 4, 5, 6};
+    const auto     original = keys;
+    nthElement(keys.data(), vals.data(), keys.size(), 3);
+    EXPECT(keys[3] == hi);
+    EXPECT(paired(original, keys, vals));
+
+    /* NaN keys rank after all others, so any k past the rest selects a NaN */
+    if constexpr (std::numeric_limits<T>::has_quiet_NaN) {
+        const T nan = std::numeric_limits<T>::quiet_NaN();
+
+        std::vector<T> one{ nan };
+        nthElement(one.data(), one.size(), 0);
+        EXPECT(one[0] != one[0]);
+
+        for (size_t n : {1, 2, 7, 10, 16, 17, 33, 64, 100, 257, 1000}) {
+            for (int round = 0; round < 8; round++) {
+                const std::vector<T> withNaN = nanKeys<T>(n, rng);
+                const std::vector<T> sorted  = nanSorted(withNaN);
+
+                size_t         k     = rng() % n;
+                std::vector<T> keys2 = withNaN;
+                std::vector<P> vals2(n);
+                std::iota(vals2.begin(), vals2.end(), P(0));
+                nthElement(keys2.data(), vals2.data(), n, k);
+                EXPECT(same(keys2[k], sorted[k]));
+                EXPECT(paired(withNaN, keys2, vals2));
+                std::sort(keys2.begin(), keys2.end(), [](T a, T b) { return a < b || (a == a && b != b); });
+                EXPECT(sameKeys(keys2, sorted));
+
+                keys2 = withNaN;
+                nthElement(keys2.data(), n, k);
+                EXPECT(same(keys2[k], sorted[k]));
+                for (size_t i = 0; i < n && sorted[k] == sorted[k]; i++) {
+                    EXPECT(i < k ? !(keys2[k] < keys2[i]) : !(keys2[i] < keys2[k]));
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+static void testNaN()
+{
+    using P = std::conditional_t<sizeof(T) == 8, uint64_t, uint32_t>;
+
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+
+    std::vector<T> one{ nan };
+    sort(one.data(), one.size());
+    EXPECT(one[0] != one[0]);
+
+    std::vector<T> mixed{ 3, nan, 1, 2, 5, nan, 0, 7, 8, 9 };
+    sort(mixed.data(), mixed.size());
+    EXPECT(sameKeys(mixed, std::vector<T>{ 0, 1, 2, 3, 5, 7, 8, 9, nan, nan }));
+
+    std::mt19937 rng(11);
+    for (size_t n : {1, 2, 7, 10, 16, 17, 33, 64, 100, 257, 1000}) {
+        for (int round = 0; round < 8; round++) {
+            const std::vector<T> original = nanKeys<T>(n, rng);
+            const std::vector<T> sorted   = nanSorted(original);
+
+            std::vector<T> keys = original;
+            sort(keys.data(), n);
+            EXPECT(sameKeys(keys, sorted));
+
+            keys = original;
+            std::vector<P> vals(n);
+            std::iota(vals.begin(), vals.end(), P(0));
+            sort(keys.data(), vals.data(), n);
+            EXPECT(sameKeys(keys, sorted));
+            EXPECT(paired(original, keys, vals));
+
+            std::vector<P> indices(n);
+            argsort(original.data(), indices.data(), n);
+            EXPECT(paired(original, sorted, indices));
+        }
+    }
+}
+
+int main()
+{
+    testKeyValue<int32_t>();
+    testKeyValue<float>();
+    testKeyValue<int64_t>();
+    testKeyValue<double>();
+    testNaN<float>();
+    testNaN<double>();
+    testNthElement<int32_t>();
+    testNthElement<float>();
+    testNthElement<int64_t>();
+    testNthElement<double>();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "%d failures\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::puts("slimsort: all tests passed");
+    return EXIT_SUCCESS;
+}